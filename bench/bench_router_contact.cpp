@@ -0,0 +1,76 @@
+#include <crypto/crypto_libsodium.hpp>
+#include <router_contact.hpp>
+
+#include <array>
+#include <stdexcept>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  /// a signed rc of the given version like the ones gossiped between relays
+  llarp::RouterContact
+  MakeRC(uint64_t version)
+  {
+    llarp::SecretKey sign, encr;
+    llarp::CryptoManager::instance()->identity_keygen(sign);
+    llarp::CryptoManager::instance()->encryption_keygen(encr);
+    llarp::RouterContact rc;
+    rc.version = version;
+    rc.pubkey = sign.toPublic();
+    rc.enckey = encr.toPublic();
+    rc.SetNick("bench");
+    llarp::AddressInfo ai;
+    ai.rank = 1;
+    ai.dialect = "iwp";
+    ai.pubkey = rc.enckey;
+    ai.fromSockAddr(llarp::SockAddr{"1.2.3.4:1090"});
+    rc.addrs.push_back(ai);
+    if (not rc.Sign(sign))
+      throw std::runtime_error{"could not sign rc"};
+    return rc;
+  }
+
+  void
+  BM_RouterContactEncode(benchmark::State& state)
+  {
+    llarp::sodium::CryptoLibSodium crypto;
+    llarp::CryptoManager manager{&crypto};
+    const auto rc = MakeRC(state.range(0));
+    std::array<byte_t, MAX_RC_SIZE> tmp;
+    for (auto _ : state)
+    {
+      llarp_buffer_t buf{tmp};
+      if (not rc.BEncode(&buf))
+        state.SkipWithError("encode failed");
+      benchmark::DoNotOptimize(tmp);
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void
+  BM_RouterContactDecode(benchmark::State& state)
+  {
+    llarp::sodium::CryptoLibSodium crypto;
+    llarp::CryptoManager manager{&crypto};
+    const auto rc = MakeRC(state.range(0));
+    std::array<byte_t, MAX_RC_SIZE> tmp;
+    llarp_buffer_t encoded{tmp};
+    if (not rc.BEncode(&encoded))
+      throw std::runtime_error{"could not encode rc"};
+    const size_t size = encoded.cur - encoded.base;
+    for (auto _ : state)
+    {
+      llarp_buffer_t buf{tmp.data(), size};
+      llarp::RouterContact decoded;
+      if (not decoded.BDecode(&buf))
+        state.SkipWithError("decode failed");
+      benchmark::DoNotOptimize(decoded);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * size);
+  }
+}  // namespace
+
+BENCHMARK(BM_RouterContactEncode)->ArgName("version")->Arg(0)->Arg(1);
+BENCHMARK(BM_RouterContactDecode)->ArgName("version")->Arg(0)->Arg(1);
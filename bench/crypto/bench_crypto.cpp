@@ -0,0 +1,71 @@
+#include <crypto/crypto_libsodium.hpp>
+#include <crypto/verify_cache.hpp>
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  /// the keyed hash on every hidden service data frame
+  void
+  BM_HMAC(benchmark::State& state)
+  {
+    llarp::sodium::CryptoLibSodium crypto;
+    llarp::SharedSecret secret;
+    secret.Randomize();
+    std::vector<byte_t> data(state.range(0));
+    crypto.randbytes(data.data(), data.size());
+    llarp::ShortHash digest;
+    for (auto _ : state)
+    {
+      crypto.hmac(digest.data(), llarp_buffer_t{data}, secret);
+      benchmark::DoNotOptimize(digest);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+  }
+
+  /// a signed blob the size of an rc
+  struct Signed
+  {
+    llarp::PubKey pub;
+    std::vector<byte_t> data;
+    llarp::Signature sig;
+
+    explicit Signed(llarp::Crypto& crypto) : data(512)
+    {
+      llarp::SecretKey sk;
+      crypto.identity_keygen(sk);
+      pub = sk.toPublic();
+      crypto.randbytes(data.data(), data.size());
+      crypto.sign(sig, sk, llarp_buffer_t{data});
+    }
+  };
+
+  void
+  BM_Verify(benchmark::State& state)
+  {
+    llarp::sodium::CryptoLibSodium crypto;
+    const Signed blob{crypto};
+    for (auto _ : state)
+      benchmark::DoNotOptimize(crypto.verify(blob.pub, llarp_buffer_t{blob.data}, blob.sig));
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  /// the same rc gossiped to us again
+  void
+  BM_VerifyCached(benchmark::State& state)
+  {
+    llarp::sodium::CryptoLibSodium crypto;
+    llarp::CryptoManager manager{&crypto};
+    llarp::crypto::VerifyCache cache;
+    const Signed blob{crypto};
+    for (auto _ : state)
+      benchmark::DoNotOptimize(cache.Verify(blob.pub, llarp_buffer_t{blob.data}, blob.sig));
+    state.SetItemsProcessed(state.iterations());
+  }
+}  // namespace
+
+BENCHMARK(BM_HMAC)->Arg(64)->Arg(512)->Arg(1024);
+BENCHMARK(BM_Verify);
+BENCHMARK(BM_VerifyCached);
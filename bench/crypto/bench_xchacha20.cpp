@@ -0,0 +1,57 @@
+#include <crypto/crypto_libsodium.hpp>
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  constexpr size_t BatchSize = 64;
+
+  /// a drained traffic queue worth of relay messages, each with its own nonce
+  struct Batch
+  {
+    llarp::SharedSecret key;
+    std::vector<std::vector<byte_t>> messages;
+    std::vector<llarp::XChaCha20Job> jobs;
+
+    explicit Batch(size_t messageSize) : messages(BatchSize, std::vector<byte_t>(messageSize))
+    {
+      key.Randomize();
+      for (auto& msg : messages)
+      {
+        llarp::TunnelNonce nonce;
+        nonce.Randomize();
+        jobs.push_back(llarp::XChaCha20Job{msg.data(), msg.size(), &key, nonce});
+      }
+    }
+  };
+
+  void
+  BM_XChaCha20PerMessage(benchmark::State& state)
+  {
+    llarp::sodium::CryptoLibSodium crypto;
+    Batch batch{static_cast<size_t>(state.range(0))};
+    for (auto _ : state)
+    {
+      for (const auto& job : batch.jobs)
+        crypto.xchacha20(llarp_buffer_t{job.data, job.size}, *job.key, job.nonce);
+    }
+    state.SetItemsProcessed(state.iterations() * BatchSize);
+    state.SetBytesProcessed(state.iterations() * BatchSize * state.range(0));
+  }
+
+  void
+  BM_XChaCha20Batched(benchmark::State& state)
+  {
+    llarp::sodium::CryptoLibSodium crypto;
+    Batch batch{static_cast<size_t>(state.range(0))};
+    for (auto _ : state)
+      crypto.xchacha20_batch(batch.jobs);
+    state.SetItemsProcessed(state.iterations() * BatchSize);
+    state.SetBytesProcessed(state.iterations() * BatchSize * state.range(0));
+  }
+}  // namespace
+
+BENCHMARK(BM_XChaCha20PerMessage)->Arg(128)->Arg(512)->Arg(1024);
+BENCHMARK(BM_XChaCha20Batched)->Arg(128)->Arg(512)->Arg(1024);
@@ -0,0 +1,82 @@
+#include <dns/dns.hpp>
+#include <dns/message.hpp>
+#include <net/net_int.hpp>
+
+#include <array>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  using llarp::dns::Message;
+  using llarp::dns::MessageHeader;
+  using llarp::dns::Question;
+
+  constexpr auto Name = "kcpyawm9se7trdbzncimdi5t7st4p5mh9i1mg7gkpuubi4k4ku1y.loki.";
+
+  Message
+  MakeQuery()
+  {
+    Message msg{Question{Name, llarp::dns::qTypeA}};
+    msg.hdr_id = 0x1234;
+    msg.hdr_fields = llarp::dns::flags_RD;
+    return msg;
+  }
+
+  /// what we answer for a .loki name with a few addresses
+  Message
+  MakeReply()
+  {
+    auto msg = MakeQuery();
+    for (uint32_t n = 1; n <= 4; ++n)
+      msg.AddINReply(llarp::huint128_t{0x0a000000 + n}, false, 30);
+    return msg;
+  }
+
+  std::vector<byte_t>
+  Wire(const Message& msg)
+  {
+    const auto buf = msg.ToBuffer();
+    return std::vector<byte_t>(buf.buf.get(), buf.buf.get() + buf.sz);
+  }
+
+  /// parsing a query off the dns socket the way the PacketHandler does
+  void
+  BM_DNSMessageDecode(benchmark::State& state)
+  {
+    const auto wire = Wire(MakeQuery());
+    for (auto _ : state)
+    {
+      llarp_buffer_t buf{wire};
+      MessageHeader hdr;
+      if (not hdr.Decode(&buf))
+        state.SkipWithError("bad header");
+      Message msg{hdr};
+      if (not msg.Decode(&buf))
+        state.SkipWithError("bad message");
+      benchmark::DoNotOptimize(msg);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * wire.size());
+  }
+
+  /// writing out our reply to it
+  void
+  BM_DNSMessageEncode(benchmark::State& state)
+  {
+    const auto msg = MakeReply();
+    std::array<byte_t, 1500> tmp;
+    for (auto _ : state)
+    {
+      llarp_buffer_t buf{tmp};
+      if (not msg.Encode(&buf))
+        state.SkipWithError("encode failed");
+      benchmark::DoNotOptimize(tmp);
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+}  // namespace
+
+BENCHMARK(BM_DNSMessageDecode);
+BENCHMARK(BM_DNSMessageEncode);
@@ -0,0 +1,48 @@
+#include <crypto/crypto_libsodium.hpp>
+#include <iwp/message_buffer.hpp>
+#include <iwp/session.hpp>
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  using llarp::iwp::CommandOverhead;
+  using llarp::iwp::PacketOverhead;
+
+  /// one link message through iwp: hashed and cut into DATA fragments on the way out, put back
+  /// together and checked against the hash on the way in the way Session::HandleDATA does.
+  /// the session crypto around each fragment is left out, see the crypto benchmarks for that.
+  void
+  BM_IWPMessageFragments(benchmark::State& state)
+  {
+    llarp::sodium::CryptoLibSodium crypto;
+    llarp::CryptoManager manager{&crypto};
+    std::vector<byte_t> data(state.range(0));
+    crypto.randbytes(data.data(), data.size());
+    const llarp_time_t now = 1s;
+    uint64_t msgid = 0;
+    for (auto _ : state)
+    {
+      llarp::iwp::OutboundMessage tx{msgid++, data, now, nullptr};
+      llarp::iwp::InboundMessage rx{tx.m_MsgID, uint16_t(data.size()), tx.m_Digest, now};
+      // the first fragment normally rides along with XMIT, send it as DATA like the rest
+      tx.m_Acks.reset();
+      tx.FlushUnAcked(
+          [&rx, now](auto frag) {
+            const uint16_t idx = bufbe16toh(frag.data() + CommandOverhead + PacketOverhead);
+            const llarp_buffer_t buf{
+                frag.data() + PacketOverhead + 12, frag.size() - (PacketOverhead + 12)};
+            rx.HandleData(idx, buf, now);
+          },
+          now);
+      if (not rx.IsCompleted() or not rx.Verify())
+        state.SkipWithError("message did not make it");
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+  }
+}  // namespace
+
+BENCHMARK(BM_IWPMessageFragments)->Arg(256)->Arg(1024)->Arg(MAX_LINK_MSG_SIZE);
@@ -0,0 +1,201 @@
+#include <iwp/message_window.hpp>
+#include <util/time.hpp>
+
+#include <bitset>
+#include <map>
+#include <queue>
+#include <unordered_map>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  /// fragments per message, a full MAX_LINK_MSG_SIZE message
+  constexpr size_t Fragments = 8;
+  /// messages in flight each way at once
+  constexpr size_t InFlight = 32;
+  constexpr size_t ReplayWindowSize = 4096;
+
+  /// the per message state of InboundMessage and OutboundMessage, less the data
+  struct Message
+  {
+    uint64_t id;
+    std::bitset<Fragments> acks;
+    llarp_time_t lastActive;
+  };
+
+  /// the tables iwp::Session used to keep
+  struct NodeTables
+  {
+    std::map<uint64_t, Message> rx;
+    std::map<uint64_t, Message> tx;
+    std::unordered_map<uint64_t, llarp_time_t> replay;
+    std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> macks;
+
+    bool
+    XMIT(uint64_t id, llarp_time_t now)
+    {
+      if (replay.count(id))
+      {
+        macks.emplace(id);
+        return false;
+      }
+      return rx.emplace(id, Message{id, {}, now}).second;
+    }
+
+    void
+    DATA(uint64_t id, size_t frag, llarp_time_t now)
+    {
+      auto itr = rx.find(id);
+      if (itr == rx.end())
+      {
+        if (replay.count(id))
+          macks.emplace(id);
+        return;
+      }
+      itr->second.acks.set(frag);
+      itr->second.lastActive = now;
+      if (itr->second.acks.all())
+      {
+        replay.emplace(id, now);
+        rx.erase(itr);
+      }
+    }
+
+    void
+    Send(uint64_t id, llarp_time_t now)
+    {
+      tx.emplace(id, Message{id, {}, now});
+    }
+
+    void
+    ACKS(uint64_t id, size_t frag)
+    {
+      auto itr = tx.find(id);
+      if (itr == tx.end())
+        return;
+      itr->second.acks.set(frag);
+      if (itr->second.acks.all())
+        tx.erase(itr);
+    }
+
+    /// what Session::Tick did to decay the replay filter
+    void
+    Tick(llarp_time_t now)
+    {
+      auto itr = replay.begin();
+      while (itr != replay.end())
+      {
+        if (itr->second + 1200ms <= now)
+          itr = replay.erase(itr);
+        else
+          ++itr;
+      }
+      while (not macks.empty())
+        macks.pop();
+    }
+  };
+
+  /// the tables iwp::Session keeps now
+  struct WindowTables
+  {
+    llarp::iwp::MessageWindow<Message> rx{ReplayWindowSize};
+    llarp::iwp::MessageWindow<Message> tx{ReplayWindowSize};
+    llarp::iwp::ReplayWindow<ReplayWindowSize> replay;
+    std::vector<uint64_t> macks;
+
+    bool
+    XMIT(uint64_t id, llarp_time_t now)
+    {
+      if (replay.Behind(id))
+        return false;
+      if (replay.Contains(id))
+      {
+        macks.emplace_back(id);
+        return false;
+      }
+      return rx.Emplace(id, Message{id, {}, now}).second;
+    }
+
+    void
+    DATA(uint64_t id, size_t frag, llarp_time_t now)
+    {
+      auto* msg = rx.Find(id);
+      if (msg == nullptr)
+      {
+        if (replay.Contains(id))
+          macks.emplace_back(id);
+        return;
+      }
+      msg->acks.set(frag);
+      msg->lastActive = now;
+      if (msg->acks.all())
+      {
+        replay.Insert(id);
+        rx.Erase(id);
+      }
+    }
+
+    void
+    Send(uint64_t id, llarp_time_t now)
+    {
+      tx.Emplace(id, Message{id, {}, now});
+    }
+
+    void
+    ACKS(uint64_t id, size_t frag)
+    {
+      auto* msg = tx.Find(id);
+      if (msg == nullptr)
+        return;
+      msg->acks.set(frag);
+      if (msg->acks.all())
+        tx.Erase(id);
+    }
+
+    void
+    Tick(llarp_time_t)
+    {
+      macks.clear();
+    }
+  };
+
+  /// a session streaming full size messages both ways with InFlight of them interleaved, one
+  /// duplicate XMIT and fragment for every message. each iteration handles one message's XMIT,
+  /// DATA and ACKS.
+  template <typename Tables_t>
+  void
+  BM_SessionBookkeeping(benchmark::State& state)
+  {
+    Tables_t tables;
+    llarp_time_t now = 1000s;
+    uint64_t next = 0;
+    for (; next < InFlight; ++next)
+    {
+      tables.XMIT(next, now);
+      tables.Send(next, now);
+    }
+    uint64_t done = 0;
+    for (auto _ : state)
+    {
+      now += 1ms;
+      const uint64_t id = done++;
+      for (size_t frag = 0; frag < Fragments; ++frag)
+      {
+        tables.DATA(id, frag, now);
+        tables.ACKS(id, frag);
+      }
+      tables.DATA(id, 0, now);
+      benchmark::DoNotOptimize(tables.XMIT(id, now));
+      tables.XMIT(next, now);
+      tables.Send(next, now);
+      ++next;
+      if (done % 100 == 0)
+        tables.Tick(now);
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_SessionBookkeeping, NodeTables);
+BENCHMARK_TEMPLATE(BM_SessionBookkeeping, WindowTables);
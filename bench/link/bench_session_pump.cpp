@@ -0,0 +1,298 @@
+#include <crypto/crypto_libsodium.hpp>
+#include <iwp/message_buffer.hpp>
+#include <iwp/message_window.hpp>
+#include <iwp/session.hpp>
+#include <link/server.hpp>
+#include <simulation/sim_loop.hpp>
+#include <simulation/sim_network.hpp>
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  using llarp::iwp::InboundMessage;
+  using llarp::iwp::MessageWindow;
+  using llarp::iwp::OutboundMessage;
+  using llarp::iwp::PingInterval;
+
+  constexpr size_t IdleSessions = 5000;
+  constexpr size_t BusySessions = 100;
+  /// messages a busy session has in flight each way
+  constexpr size_t InFlight = 8;
+  /// how far apart event loop wakeups are
+  constexpr auto WakeupInterval = 1ms;
+
+  /// a link layer with nothing under it, for pumping stub sessions
+  struct StubLinkLayer : public llarp::ILinkLayer
+  {
+    explicit StubLinkLayer(llarp::EventLoop_ptr loop)
+        : llarp::ILinkLayer(
+            std::make_shared<llarp::KeyManager>(),
+            [this]() -> const llarp::RouterContact& { return rc; },
+            [](auto, const auto&) { return true; },
+            [](auto&, const auto&) { return true; },
+            [](auto) {},
+            [](auto, bool) { return true; },
+            [](auto, auto) { return true; },
+            [](auto) {},
+            [](auto) {},
+            []() {},
+            [](const void*, llarp::Work_t work) { work(); })
+    {
+      m_Loop = std::move(loop);
+    }
+
+    std::shared_ptr<llarp::ILinkSession>
+    NewOutboundSession(const llarp::RouterContact&, const llarp::AddressInfo&) override
+    {
+      return nullptr;
+    }
+
+    void
+    RecvFrom(const llarp::SockAddr&, llarp::ILinkSession::Packet_t) override
+    {}
+
+    const char*
+    Name() const override
+    {
+      return "stub";
+    }
+
+    uint16_t
+    Rank() const override
+    {
+      return 0;
+    }
+
+    llarp::RouterContact rc;
+  };
+
+  /// the message windows and timers of an established iwp::Session, pumped the same way but
+  /// counting the packets it would encrypt and send instead of sending them
+  struct StubSession : public llarp::ILinkSession,
+                       public std::enable_shared_from_this<StubSession>
+  {
+    StubSession(StubLinkLayer* parent, size_t msgs)
+        : m_Parent{parent}
+        , m_RXMsgs{llarp::iwp::ReplayWindowSize}
+        , m_TXMsgs{MaxSendQueueSize}
+        , m_LastTX{parent->Now()}
+    {
+      const auto now = parent->Now();
+      const Message_t data{std::vector<byte_t>(llarp::iwp::FragmentSize)};
+      for (uint64_t id = 0; id < msgs; ++id)
+      {
+        m_RXMsgs.Emplace(id, id, uint16_t(data.size()), llarp::ShortHash{}, now);
+        m_TXMsgs.Emplace(id, id, data, now, nullptr);
+      }
+    }
+
+    /// a packet came in that needs an answer
+    void
+    Queue()
+    {
+      ++m_Queued;
+      if (m_Woken)
+        return;
+      m_Woken = true;
+      m_Parent->WakeSession(weak_from_this());
+    }
+
+    void
+    Pump() override
+    {
+      const auto now = m_Parent->Now();
+      ++pumped;
+      m_Woken = true;
+      auto nextPumpAt = llarp_time_t::max();
+      if (ShouldPing())
+      {
+        SendKeepAlive();
+        nextPumpAt = now + PingInterval + 1ms;
+      }
+      else
+        nextPumpAt = m_LastTX + PingInterval + 1ms;
+      const auto send = [this](Packet_t) { ++m_Queued; };
+      m_RXMsgs.ForEach([&](uint64_t, InboundMessage& msg) {
+        if (msg.ShouldSendACKS(now))
+          msg.SendACKS(send, now);
+        nextPumpAt = std::min(nextPumpAt, msg.NextACKSAt());
+      });
+      m_TXMsgs.ForEach([&](uint64_t, OutboundMessage& msg) {
+        if (msg.ShouldFlush(now))
+          msg.FlushUnAcked(send, now);
+        nextPumpAt = std::min(nextPumpAt, msg.NextFlushAt());
+      });
+      if (not(m_NextPumpAt > now and m_NextPumpAt <= nextPumpAt))
+      {
+        m_NextPumpAt = nextPumpAt;
+        m_Parent->ScheduleSession(weak_from_this(), nextPumpAt);
+      }
+      if (m_Queued)
+      {
+        sent += m_Queued;
+        m_Queued = 0;
+        m_LastTX = now;
+      }
+      m_Woken = false;
+    }
+
+    void Tick(llarp_time_t) override
+    {}
+
+    bool
+    SendMessageBuffer(Message_t, CompletionHandler) override
+    {
+      return false;
+    }
+
+    void
+    Start() override
+    {}
+
+    void
+    Close() override
+    {}
+
+    bool
+    SendKeepAlive() override
+    {
+      ++m_Queued;
+      return true;
+    }
+
+    bool
+    IsEstablished() const override
+    {
+      return true;
+    }
+
+    bool TimedOut(llarp_time_t) const override
+    {
+      return false;
+    }
+
+    llarp::PubKey
+    GetPubKey() const override
+    {
+      return {};
+    }
+
+    bool
+    IsInbound() const override
+    {
+      return false;
+    }
+
+    const llarp::SockAddr&
+    GetRemoteEndpoint() const override
+    {
+      return m_RemoteAddr;
+    }
+
+    const llarp::RouterContact&
+    GetRemoteRC() const override
+    {
+      return m_Parent->rc;
+    }
+
+    size_t
+    SendQueueBacklog() const override
+    {
+      return m_TXMsgs.size();
+    }
+
+    llarp::ILinkLayer*
+    GetLinkLayer() const override
+    {
+      return m_Parent;
+    }
+
+    bool
+    RenegotiateSession() override
+    {
+      return true;
+    }
+
+    bool
+    ShouldPing() const override
+    {
+      return m_Parent->Now() - m_LastTX > PingInterval;
+    }
+
+    llarp::SessionStats
+    GetSessionStats() const override
+    {
+      return {};
+    }
+
+    llarp::util::StatusObject
+    ExtractStatus() const override
+    {
+      return {};
+    }
+
+    size_t pumped = 0;
+    size_t sent = 0;
+
+   private:
+    StubLinkLayer* const m_Parent;
+    MessageWindow<InboundMessage> m_RXMsgs;
+    MessageWindow<OutboundMessage> m_TXMsgs;
+    llarp_time_t m_LastTX;
+    llarp_time_t m_NextPumpAt = 0s;
+    size_t m_Queued = 0;
+    bool m_Woken = false;
+    llarp::SockAddr m_RemoteAddr;
+  };
+
+  /// each iteration is one event loop wakeup, 1ms after the last, where every busy session got a
+  /// packet from the network, pumped by ILinkLayer::Pump.  `state.range(0)` wakes every session
+  /// each time, the way every session used to be pumped, or leaves it to the sessions that
+  /// queued work and the scheduled deadlines.
+  void
+  BM_PumpSessions(benchmark::State& state)
+  {
+    llarp::sodium::CryptoLibSodium crypto;
+    llarp::CryptoManager manager{&crypto};
+    const bool pumpAll = state.range(0) != 0;
+
+    auto net = std::make_shared<llarp::simulate::Network>();
+    StubLinkLayer link{net->MakeLoop()};
+    std::vector<std::shared_ptr<StubSession>> sessions;
+    for (size_t idx = 0; idx < IdleSessions + BusySessions; ++idx)
+      sessions.emplace_back(
+          std::make_shared<StubSession>(&link, idx < BusySessions ? InFlight : 0));
+    // everyone starts out with a pump to set up their timers
+    for (const auto& session : sessions)
+      link.WakeSession(session);
+    link.Pump();
+    for (const auto& session : sessions)
+      session->pumped = 0;
+
+    const auto start = net->Now();
+    for (auto _ : state)
+    {
+      net->RunFor(WakeupInterval);
+      for (size_t idx = 0; idx < BusySessions; ++idx)
+        sessions[idx]->Queue();
+      if (pumpAll)
+      {
+        for (size_t idx = BusySessions; idx < sessions.size(); ++idx)
+          link.WakeSession(sessions[idx]);
+      }
+      link.Pump();
+    }
+    size_t pumped = 0;
+    for (const auto& session : sessions)
+      pumped += session->pumped;
+    state.SetItemsProcessed(state.iterations());
+    state.counters["pumped/wakeup"] = double(pumped) / state.iterations();
+    state.counters["sim_seconds"] = double((net->Now() - start).count()) / 1000;
+  }
+}  // namespace
+
+BENCHMARK(BM_PumpSessions)->ArgName("pump_all")->Arg(1)->Arg(0);
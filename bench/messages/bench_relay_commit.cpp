@@ -0,0 +1,78 @@
+#include <messages/relay_commit.hpp>
+
+#include <array>
+#include <stdexcept>
+#include <utility>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  /// a path build with all its frames filled, as every relay on the path gets one
+  llarp::LR_CommitMessage
+  MakeCommit()
+  {
+    llarp::LR_CommitMessage msg;
+    for (auto& frame : msg.frames)
+      frame.Randomize();
+    return msg;
+  }
+
+  /// what LinkMessageParser does: the message type first, then the message's own keys
+  bool
+  Decode(llarp::ILinkMessage& msg, llarp_buffer_t buf)
+  {
+    bool first = true;
+    return llarp::bencode_read_dict(
+        [&msg, &first](llarp_buffer_t* buffer, llarp_buffer_t* key) {
+          if (key == nullptr)
+            return true;
+          if (std::exchange(first, false))
+          {
+            llarp_buffer_t type;
+            return *key == "a" and bencode_read_string(buffer, &type);
+          }
+          return msg.DecodeKey(*key, buffer);
+        },
+        &buf);
+  }
+
+  void
+  BM_RelayCommitEncode(benchmark::State& state)
+  {
+    const auto msg = MakeCommit();
+    std::array<byte_t, MAX_LINK_MSG_SIZE> tmp;
+    for (auto _ : state)
+    {
+      llarp_buffer_t buf{tmp};
+      if (not msg.BEncode(&buf))
+        state.SkipWithError("encode failed");
+      benchmark::DoNotOptimize(tmp);
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void
+  BM_RelayCommitDecode(benchmark::State& state)
+  {
+    const auto msg = MakeCommit();
+    std::array<byte_t, MAX_LINK_MSG_SIZE> tmp;
+    llarp_buffer_t encoded{tmp};
+    if (not msg.BEncode(&encoded))
+      throw std::runtime_error{"could not encode commit"};
+    const size_t size = encoded.cur - encoded.base;
+    llarp::LR_CommitMessage decoded;
+    for (auto _ : state)
+    {
+      decoded.Clear();
+      if (not Decode(decoded, llarp_buffer_t{tmp.data(), size}))
+        state.SkipWithError("decode failed");
+      benchmark::DoNotOptimize(decoded);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * size);
+  }
+}  // namespace
+
+BENCHMARK(BM_RelayCommitEncode);
+BENCHMARK(BM_RelayCommitDecode);
@@ -0,0 +1,143 @@
+#include <net/ip_packet.hpp>
+#include <util/codel.hpp>
+#include <vpn/packet_router.hpp>
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  constexpr size_t PayloadSize = 1200;
+  constexpr size_t PacketsPerFlush = 64;
+
+  struct GetTime
+  {
+    llarp_time_t
+    operator()(const llarp::net::IPPacket& pkt) const
+    {
+      return pkt.timestamp;
+    }
+  };
+
+  struct PutTime
+  {
+    void
+    operator()(llarp::net::IPPacket& pkt) const
+    {
+      pkt.timestamp = llarp::time_now_ms();
+    }
+  };
+
+  using Queue_t = llarp::util::CoDelQueue<
+      llarp::net::IPPacket,
+      GetTime,
+      PutTime,
+      llarp::net::IPPacket::CompareOrder>;
+
+  std::vector<byte_t>
+  MakeRawPacket()
+  {
+    const std::vector<byte_t> payload(PayloadSize, 0x42);
+    const auto pkt = llarp::net::IPPacket::UDP(
+        llarp::nuint32_t{0x0100000a},
+        llarp::nuint16_t{0x1234},
+        llarp::nuint32_t{0x0200000a},
+        llarp::nuint16_t{0x3500},
+        llarp_buffer_t{payload});
+    return {pkt.buf, pkt.buf + pkt.sz};
+  }
+
+  /// push packets the way a tun endpoint does: read off the device, through the packet router
+  /// into the send queue, then flush the queue.  `copy` passes the packet on by copy at every
+  /// hop like the old by value packets did.
+  void
+  RunChain(benchmark::State& state, bool copy)
+  {
+    const auto raw = MakeRawPacket();
+    Queue_t queue{"bench", PutTime{}, llarp::util::GetNowSyscall{}};
+    llarp::vpn::PacketRouter router{[&](llarp::net::IPPacket pkt) {
+      if (copy)
+        queue.Emplace(pkt);
+      else
+        queue.Emplace(std::move(pkt));
+    }};
+
+    size_t bytes = 0;
+    const auto allocsBefore = llarp::net::IPPacket::Pool_t::ThreadAllocations();
+    for (auto _ : state)
+    {
+      for (size_t n = 0; n < PacketsPerFlush; ++n)
+      {
+        llarp::net::IPPacket pkt;
+        pkt.Load(llarp_buffer_t{raw});
+        if (copy)
+          router.HandleIPPacket(pkt);
+        else
+          router.HandleIPPacket(std::move(pkt));
+      }
+      // force codel to flush every round
+      queue.nextTickAt = 0s;
+      queue.Process([&](llarp::net::IPPacket& pkt) {
+        bytes += pkt.sz;
+        benchmark::DoNotOptimize(pkt.buf);
+      });
+    }
+    const auto packets = state.iterations() * PacketsPerFlush;
+    const auto allocs = llarp::net::IPPacket::Pool_t::ThreadAllocations() - allocsBefore;
+    state.SetItemsProcessed(packets);
+    state.SetBytesProcessed(bytes);
+    // the first allocation is the tun read, every other one is a copy along the way
+    state.counters["allocs/pkt"] = double(allocs) / packets;
+    state.counters["copies/pkt"] = double(allocs - packets) / packets;
+    state.counters["slabs"] = llarp::net::IPPacket::Pool_t::NumSlabs();
+  }
+
+  void
+  BM_IPPacketMoveThroughTun(benchmark::State& state)
+  {
+    RunChain(state, false);
+  }
+
+  void
+  BM_IPPacketCopyThroughTun(benchmark::State& state)
+  {
+    RunChain(state, true);
+  }
+
+  /// the nat an exit or a tun endpoint does on every packet, with the checksum fixups
+  void
+  BM_IPPacketRewriteAddresses(benchmark::State& state)
+  {
+    const auto raw = MakeRawPacket();
+    llarp::net::IPPacket pkt;
+    pkt.Load(llarp_buffer_t{raw});
+    uint32_t addr = 0x0300000a;
+    for (auto _ : state)
+    {
+      pkt.UpdateIPv4Address(llarp::nuint32_t{addr}, llarp::nuint32_t{addr + 1});
+      ++addr;
+      benchmark::DoNotOptimize(pkt.buf);
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void
+  BM_IPPacketZeroAddresses(benchmark::State& state)
+  {
+    const auto raw = MakeRawPacket();
+    llarp::net::IPPacket pkt;
+    for (auto _ : state)
+    {
+      pkt.Load(llarp_buffer_t{raw});
+      pkt.ZeroAddresses();
+      benchmark::DoNotOptimize(pkt.buf);
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+}  // namespace
+
+BENCHMARK(BM_IPPacketMoveThroughTun);
+BENCHMARK(BM_IPPacketCopyThroughTun);
+BENCHMARK(BM_IPPacketRewriteAddresses);
+BENCHMARK(BM_IPPacketZeroAddresses);
@@ -0,0 +1,152 @@
+#include <net/ip_range_map.hpp>
+#include <net/ip_range_trie.hpp>
+#include <net/traffic_policy.hpp>
+
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  constexpr size_t NumLookups = 1024;
+
+  /// `num` random v4 ranges between /8 and /32, plus addresses half of which land in one of them
+  struct Workload
+  {
+    std::vector<llarp::IPRange> ranges;
+    std::vector<llarp::huint128_t> addrs;
+
+    explicit Workload(size_t num)
+    {
+      std::mt19937 rng{1};
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        const auto bits = 8 + rng() % 25;
+        ranges.push_back(llarp::IPRange{
+            llarp::net::ExpandV4(llarp::huint32_t{uint32_t(rng())}),
+            llarp::netmask_ipv6_bits(96 + bits)});
+      }
+      for (size_t idx = 0; idx < NumLookups; ++idx)
+      {
+        auto addr = llarp::net::ExpandV4(llarp::huint32_t{uint32_t(rng())});
+        if (rng() % 2)
+        {
+          const auto& range = ranges[rng() % ranges.size()];
+          addr = (range.addr & range.netmask_bits) | (addr & ~range.netmask_bits);
+        }
+        addrs.push_back(addr);
+      }
+    }
+  };
+
+  void
+  BM_IPRangeMapFind(benchmark::State& state)
+  {
+    const Workload work{size_t(state.range(0))};
+    llarp::net::IPRangeMap<size_t> map;
+    for (size_t idx = 0; idx < work.ranges.size(); ++idx)
+      map.Insert(work.ranges[idx], idx);
+    size_t n = 0;
+    for (auto _ : state)
+      benchmark::DoNotOptimize(map.FindAllEntries(work.addrs[n++ % NumLookups]));
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void
+  BM_IPRangeTrieContains(benchmark::State& state)
+  {
+    const Workload work{size_t(state.range(0))};
+    llarp::net::IPRangeTrie trie;
+    for (size_t idx = 0; idx < work.ranges.size(); ++idx)
+      trie.Insert(work.ranges[idx], idx);
+    size_t n = 0;
+    for (auto _ : state)
+      benchmark::DoNotOptimize(trie.Contains(work.addrs[n++ % NumLookups]));
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  /// what TrafficPolicy and IPRangeMap used to do: check every range
+  void
+  BM_LinearScanContains(benchmark::State& state)
+  {
+    const Workload work{size_t(state.range(0))};
+    size_t n = 0;
+    for (auto _ : state)
+    {
+      const auto& addr = work.addrs[n++ % NumLookups];
+      bool found = false;
+      for (const auto& range : work.ranges)
+      {
+        if (range.Contains(addr))
+        {
+          found = true;
+          break;
+        }
+      }
+      benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  std::vector<llarp::net::IPPacket>
+  MakePackets(const Workload& work)
+  {
+    const std::vector<byte_t> payload(64, 0x42);
+    std::vector<llarp::net::IPPacket> pkts;
+    for (size_t idx = 0; idx < work.addrs.size(); ++idx)
+    {
+      pkts.push_back(llarp::net::IPPacket::UDP(
+          llarp::nuint32_t{0x0100000a},
+          llarp::nuint16_t{0x1234},
+          llarp::ToNet(llarp::net::TruncateV6(work.addrs[idx])),
+          llarp::ToNet(llarp::huint16_t{uint16_t(idx % 2 ? 53 : 80)}),
+          llarp_buffer_t{payload}));
+    }
+    return pkts;
+  }
+
+  llarp::net::TrafficPolicy
+  MakePolicy(const Workload& work)
+  {
+    llarp::net::TrafficPolicy policy;
+    policy.protocols.emplace("udp/53");
+    policy.protocols.emplace("tcp/443");
+    policy.ranges.insert(work.ranges.begin(), work.ranges.end());
+    return policy;
+  }
+
+  /// a policy as exit endpoints used to check it, copied per packet
+  void
+  BM_TrafficPolicyAllows(benchmark::State& state)
+  {
+    const Workload work{size_t(state.range(0))};
+    const auto policy = MakePolicy(work);
+    const auto pkts = MakePackets(work);
+    size_t n = 0;
+    for (auto _ : state)
+    {
+      const auto copy = policy;
+      benchmark::DoNotOptimize(copy.AllowsTraffic(pkts[n++ % NumLookups]));
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void
+  BM_CompiledTrafficPolicyAllows(benchmark::State& state)
+  {
+    const Workload work{size_t(state.range(0))};
+    const llarp::net::CompiledTrafficPolicy policy{MakePolicy(work)};
+    const auto pkts = MakePackets(work);
+    size_t n = 0;
+    for (auto _ : state)
+      benchmark::DoNotOptimize(policy.AllowsTraffic(pkts[n++ % NumLookups]));
+    state.SetItemsProcessed(state.iterations());
+  }
+}  // namespace
+
+BENCHMARK(BM_IPRangeMapFind)->Arg(10)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_IPRangeTrieContains)->Arg(10)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_LinearScanContains)->Arg(10)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_TrafficPolicyAllows)->Arg(10)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_CompiledTrafficPolicyAllows)->Arg(10)->Arg(1000)->Arg(100000);
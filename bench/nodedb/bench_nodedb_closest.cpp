@@ -0,0 +1,84 @@
+#include <nodedb.hpp>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  constexpr uint32_t NumClosest = 4;
+
+  void
+  RandomKey(std::mt19937_64& rng, llarp::AlignedBuffer<32>& key)
+  {
+    for (auto& b : key)
+      b = rng();
+  }
+
+  /// an in memory nodedb holding `num` routers with random keys
+  std::unique_ptr<llarp::NodeDB>
+  MakeNodeDB(size_t num, std::mt19937_64& rng)
+  {
+    auto nodedb = std::make_unique<llarp::NodeDB>();
+    for (size_t idx = 0; idx < num; ++idx)
+    {
+      llarp::RouterContact rc;
+      RandomKey(rng, rc.pubkey);
+      nodedb->Put(rc);
+    }
+    return nodedb;
+  }
+
+  void
+  BM_NodeDBFindClosestTo(benchmark::State& state)
+  {
+    std::mt19937_64 rng{1};
+    const auto nodedb = MakeNodeDB(state.range(0), rng);
+    llarp::dht::Key_t location;
+    for (auto _ : state)
+    {
+      RandomKey(rng, location);
+      benchmark::DoNotOptimize(nodedb->FindClosestTo(location));
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void
+  BM_NodeDBFindManyClosestTo(benchmark::State& state)
+  {
+    std::mt19937_64 rng{1};
+    const auto nodedb = MakeNodeDB(state.range(0), rng);
+    llarp::dht::Key_t location;
+    for (auto _ : state)
+    {
+      RandomKey(rng, location);
+      benchmark::DoNotOptimize(nodedb->FindManyClosestTo(location, NumClosest));
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void
+  BM_NodeDBGet(benchmark::State& state)
+  {
+    std::mt19937_64 rng{1};
+    const auto nodedb = MakeNodeDB(state.range(0), rng);
+    // the same seed hands out the keys that went in, in the same order
+    std::mt19937_64 replay{1};
+    std::vector<llarp::RouterID> keys(state.range(0));
+    for (auto& key : keys)
+      RandomKey(replay, key);
+    size_t idx = 0;
+    for (auto _ : state)
+    {
+      benchmark::DoNotOptimize(nodedb->Get(keys[idx]));
+      idx = (idx + 1) % keys.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+}  // namespace
+
+BENCHMARK(BM_NodeDBFindClosestTo)->Arg(2000)->Arg(10000)->Arg(50000);
+BENCHMARK(BM_NodeDBFindManyClosestTo)->Arg(2000)->Arg(10000)->Arg(50000);
+BENCHMARK(BM_NodeDBGet)->Arg(2000)->Arg(10000)->Arg(50000);
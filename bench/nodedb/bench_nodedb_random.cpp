@@ -0,0 +1,99 @@
+#include <nodedb.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  constexpr size_t NumHops = 4;
+
+  /// an in memory nodedb holding `num` routers with random keys
+  std::unique_ptr<llarp::NodeDB>
+  MakeNodeDB(size_t num)
+  {
+    std::mt19937_64 rng{1};
+    auto nodedb = std::make_unique<llarp::NodeDB>();
+    for (size_t idx = 0; idx < num; ++idx)
+    {
+      llarp::RouterContact rc;
+      for (auto& b : rc.pubkey)
+        b = rng();
+      nodedb->Put(rc);
+    }
+    return nodedb;
+  }
+
+  /// roughly what path::Builder checks for each hop: not already in the path and not one of the
+  /// ~10% of routers profiling says are bad for paths
+  bool
+  AcceptableHop(const llarp::RouterContact& rc, const std::vector<llarp::RouterContact>& hops)
+  {
+    if (rc.pubkey[0] < 26)
+      return false;
+    return std::none_of(
+        hops.begin(), hops.end(), [&rc](const auto& hop) { return hop.pubkey == rc.pubkey; });
+  }
+
+  /// pick the hops for one path through NodeDB::GetRandom
+  void
+  BM_NodeDBPathHopSelection(benchmark::State& state)
+  {
+    const auto nodedb = MakeNodeDB(state.range(0));
+    std::vector<llarp::RouterContact> hops;
+    for (auto _ : state)
+    {
+      hops.clear();
+      while (hops.size() < NumHops)
+      {
+        const auto maybe =
+            nodedb->GetRandom([&hops](const auto& rc) { return AcceptableHop(rc, hops); });
+        if (not maybe)
+        {
+          state.SkipWithError("no hop found");
+          return;
+        }
+        hops.push_back(*maybe);
+      }
+      benchmark::DoNotOptimize(hops.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  /// the same picking the way GetRandom used to: gather every entry and shuffle all of them for
+  /// each hop
+  void
+  BM_ShuffleAllPathHopSelection(benchmark::State& state)
+  {
+    const auto nodedb = MakeNodeDB(state.range(0));
+    llarp::CSRNG rng{};
+    std::vector<llarp::RouterContact> hops;
+    for (auto _ : state)
+    {
+      hops.clear();
+      while (hops.size() < NumHops)
+      {
+        std::vector<const llarp::RouterContact*> entries;
+        nodedb->VisitAll([&entries](const auto& rc) { entries.push_back(&rc); });
+        std::shuffle(entries.begin(), entries.end(), rng);
+        for (const auto* rc : entries)
+        {
+          if (AcceptableHop(*rc, hops))
+          {
+            hops.push_back(*rc);
+            break;
+          }
+        }
+      }
+      benchmark::DoNotOptimize(hops.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+}  // namespace
+
+BENCHMARK(BM_NodeDBPathHopSelection)->Arg(2000)->Arg(10000)->Arg(50000);
+BENCHMARK(BM_ShuffleAllPathHopSelection)->Arg(2000)->Arg(10000)->Arg(50000);
@@ -0,0 +1,115 @@
+#include <service/convo_index.hpp>
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  using llarp::service::Address;
+  using llarp::service::ConvoIndex;
+  using llarp::service::ConvoMap;
+  using llarp::service::ConvoTag;
+
+  constexpr uint32_t NumSessions = 10000;
+  /// a few remotes have more than one convo with us
+  constexpr uint32_t NumRemotes = NumSessions / 2;
+
+  template <typename Buf_t>
+  Buf_t
+  Make(uint32_t n)
+  {
+    Buf_t buf;
+    std::copy_n(reinterpret_cast<const byte_t*>(&n), sizeof(n), buf.data());
+    return buf;
+  }
+
+  /// a hidden service with NumSessions convos with NumRemotes remotes
+  struct Service
+  {
+    ConvoMap sessions;
+    ConvoIndex index;
+    std::vector<Address> remotes;
+
+    Service()
+    {
+      for (uint32_t n = 0; n < NumRemotes; ++n)
+        remotes.emplace_back(Make<Address>(n + 1));
+      for (uint32_t n = 0; n < NumSessions; ++n)
+      {
+        const auto tag = Make<ConvoTag>(n + 1);
+        const auto& remote = remotes[n % NumRemotes];
+        auto& session = sessions[tag];
+        session.remote.Update(remote.data(), remote.data());
+        session.inbound = true;
+        index.Put(remote, tag);
+      }
+    }
+  };
+
+  Service&
+  TheService()
+  {
+    static Service service;
+    return service;
+  }
+
+  /// what GetBestConvoTagFor did before the index: look at every convo for each packet
+  void
+  BM_ScanAllConvos(benchmark::State& state)
+  {
+    auto& service = TheService();
+    uint32_t n = 0;
+    for (auto _ : state)
+    {
+      const auto& remote = service.remotes[n++ % NumRemotes];
+      std::optional<ConvoTag> best;
+      for (const auto& [tag, session] : service.sessions)
+      {
+        if (session.Addr() == remote)
+          best = tag;
+      }
+      benchmark::DoNotOptimize(best);
+    }
+  }
+  BENCHMARK(BM_ScanAllConvos);
+
+  /// picking again after an invalidation, walking only the remote's convos
+  void
+  BM_IndexPick(benchmark::State& state)
+  {
+    auto& service = TheService();
+    uint32_t n = 0;
+    for (auto _ : state)
+    {
+      const auto& remote = service.remotes[n++ % NumRemotes];
+      std::optional<ConvoTag> best;
+      service.index.ForEach(remote, service.sessions, [&best](const auto& tag, const auto&) {
+        best = tag;
+      });
+      benchmark::DoNotOptimize(best);
+    }
+  }
+  BENCHMARK(BM_IndexPick);
+
+  /// the usual send, the picked tag is still good
+  void
+  BM_IndexCachedBest(benchmark::State& state)
+  {
+    auto& service = TheService();
+    const llarp_time_t now = 1s;
+    for (const auto& remote : service.remotes)
+    {
+      service.index.ForEach(remote, service.sessions, [&](const auto& tag, const auto&) {
+        service.index.SetBest(remote, tag, now);
+      });
+    }
+    uint32_t n = 0;
+    for (auto _ : state)
+    {
+      const auto& remote = service.remotes[n++ % NumRemotes];
+      benchmark::DoNotOptimize(service.index.Best(remote, service.sessions, now));
+    }
+  }
+  BENCHMARK(BM_IndexCachedBest);
+}  // namespace
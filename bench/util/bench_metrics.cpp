@@ -0,0 +1,32 @@
+#include <util/metrics.hpp>
+
+#include <atomic>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  /// every thread bumping one shared atomic, what a naive global counter costs on a busy relay
+  void
+  BM_CounterSharedAtomic(benchmark::State& state)
+  {
+    static std::atomic<uint64_t> counter{0};
+    for (auto _ : state)
+      counter.fetch_add(1, std::memory_order_relaxed);
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  /// every thread bumping the same metrics::Counter, which lands in each thread's own shard
+  void
+  BM_CounterSharded(benchmark::State& state)
+  {
+    static const auto counter =
+        llarp::metrics::Registry::Instance().GetCounter("bench_counter_total", "bench counter");
+    for (auto _ : state)
+      counter.Add();
+    state.SetItemsProcessed(state.iterations());
+  }
+}  // namespace
+
+BENCHMARK(BM_CounterSharedAtomic)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_CounterSharded)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,101 @@
+#include <util/thread/job.hpp>
+#include <util/thread/mpsc_queue.hpp>
+#include <util/thread/queue.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  // what the event loop queue is created with, see constants/evloop.hpp
+  constexpr size_t QueueSize = 1024;
+  constexpr size_t JobsPerProducer = 20000;
+
+  /// what a crypto completion looks like when it hops back onto the event loop
+  struct Completion
+  {
+    std::shared_ptr<int> owner;
+    uint64_t id;
+    std::atomic<uint64_t>* done;
+
+    void
+    operator()() const
+    {
+      done->fetch_add(id != 0 ? 1 : 0, std::memory_order_relaxed);
+    }
+  };
+
+  /// `state.range(0)` producer threads each hand JobsPerProducer jobs to one consumer that runs
+  /// them, through the mutex and semaphore backed queue the event loop used to have
+  void
+  BM_CallSoonLockingQueue(benchmark::State& state)
+  {
+    const size_t producers = state.range(0);
+    const auto owner = std::make_shared<int>(0);
+    for (auto _ : state)
+    {
+      llarp::thread::Queue<std::function<void(void)>> queue{QueueSize};
+      std::atomic<uint64_t> done{0};
+      std::vector<std::thread> threads;
+      for (size_t p = 0; p < producers; ++p)
+      {
+        threads.emplace_back([&] {
+          for (size_t n = 0; n < JobsPerProducer; ++n)
+            queue.pushBack(Completion{owner, n + 1, &done});
+        });
+      }
+      for (size_t n = 0; n < producers * JobsPerProducer; ++n)
+        queue.popFront()();
+      for (auto& thread : threads)
+        thread.join();
+      benchmark::DoNotOptimize(done.load());
+    }
+    state.SetItemsProcessed(state.iterations() * producers * JobsPerProducer);
+  }
+
+  /// the same through the lock free queue with inline jobs and batched draining
+  void
+  BM_CallSoonMPSCQueue(benchmark::State& state)
+  {
+    const size_t producers = state.range(0);
+    const auto owner = std::make_shared<int>(0);
+    for (auto _ : state)
+    {
+      llarp::thread::MPSCQueue<llarp::thread::Job> queue{QueueSize};
+      std::atomic<uint64_t> done{0};
+      std::vector<std::thread> threads;
+      for (size_t p = 0; p < producers; ++p)
+      {
+        threads.emplace_back([&] {
+          for (size_t n = 0; n < JobsPerProducer; ++n)
+          {
+            llarp::thread::Job job{Completion{owner, n + 1, &done}};
+            while (not queue.tryPushBack(std::move(job)))
+              std::this_thread::yield();
+          }
+        });
+      }
+      size_t ran = 0;
+      while (ran < producers * JobsPerProducer)
+      {
+        const auto num = queue.drain([](auto& job) { job(); }, queue.capacity());
+        // the event loop would go back to sleep until the next wakeup here
+        if (num == 0)
+          std::this_thread::yield();
+        ran += num;
+      }
+      for (auto& thread : threads)
+        thread.join();
+      benchmark::DoNotOptimize(done.load());
+    }
+    state.SetItemsProcessed(state.iterations() * producers * JobsPerProducer);
+  }
+}  // namespace
+
+BENCHMARK(BM_CallSoonLockingQueue)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+BENCHMARK(BM_CallSoonMPSCQueue)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
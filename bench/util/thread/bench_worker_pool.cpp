@@ -0,0 +1,72 @@
+#include <crypto/crypto_libsodium.hpp>
+#include <crypto/types.hpp>
+#include <util/thread/worker_pool.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  // roughly what a busy relay sees: many transit hops each flushing a batch of relayed messages
+  constexpr size_t NumHops = 64;
+  constexpr size_t MessagesPerFlush = 16;
+  constexpr size_t MessageSize = 1024;
+
+  struct FakeHop
+  {
+    llarp::SharedSecret pathKey;
+    llarp::TunnelNonce nonce;
+    std::vector<std::vector<byte_t>> messages;
+
+    FakeHop() : messages(MessagesPerFlush, std::vector<byte_t>(MessageSize))
+    {
+      pathKey.Randomize();
+      nonce.Randomize();
+    }
+
+    void
+    Work()
+    {
+      for (auto& msg : messages)
+      {
+        const llarp_buffer_t buf{msg};
+        llarp::CryptoManager::instance()->xchacha20(buf, pathKey, nonce);
+      }
+    }
+  };
+
+  /// relayed messages per second through the crypto pool as the number of worker threads grows
+  void
+  BM_WorkerPoolRelayThroughput(benchmark::State& state)
+  {
+    llarp::sodium::CryptoLibSodium crypto;
+    llarp::CryptoManager manager{&crypto};
+
+    std::vector<FakeHop> hops(NumHops);
+    llarp::thread::WorkerPool pool{static_cast<size_t>(state.range(0))};
+    pool.Start();
+
+    std::atomic<size_t> done{0};
+    for (auto _ : state)
+    {
+      done = 0;
+      for (auto& hop : hops)
+      {
+        pool.QueueOrderedJob(&hop, [&hop, &done] {
+          hop.Work();
+          ++done;
+        });
+      }
+      while (done.load() < hops.size())
+        std::this_thread::yield();
+    }
+    pool.Stop();
+    state.SetItemsProcessed(state.iterations() * NumHops * MessagesPerFlush);
+    state.SetBytesProcessed(state.iterations() * NumHops * MessagesPerFlush * MessageSize);
+  }
+}  // namespace
+
+BENCHMARK(BM_WorkerPoolRelayThroughput)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
@@ -2,6 +2,9 @@
 
 #include "lokinet_context.h"
 
+#include <sys/types.h>
+#include <time.h>
+
 #ifdef _WIN32
 extern "C"
 {
@@ -38,8 +41,10 @@ extern "C"
   /// establish an outbound udp flow
   /// remoteHost is the remote .loki or .snode address conneting to
   /// remotePort is either a string integer or an srv record name to lookup, e.g. thingservice in
-  /// which we do a srv lookup for _udp.thingservice.remotehost.tld and use the "best" port provided
-  /// localAddr is the local ip:port to bind our socket to, if localAddr is NULL then
+  /// which we do a srv lookup for _thingservice._udp.remotehost.tld and use the "best" port
+  /// provided, failing with EHOSTUNREACH if the remote publishes none
+  /// localAddr is the local ip:port to bind our socket to, datagrams sent there go to the remote
+  /// and the remote's replies go to whoever last sent one. if localAddr is NULL then
   /// lokinet_udp_sendmmsg MUST be used to send packets return 0 on success return nonzero on fail,
   /// containing an errno value
   int EXPORT
@@ -60,9 +65,11 @@ extern "C"
   /// inbound listen udp socket
   /// expose udp port exposePort to the void
   /// if srv is not NULL add an srv record for this port, the format being "thingservice" in which
-  /// will add a srv record "_udp.thingservice.ouraddress.tld" that advertises this port provide
+  /// will add a srv record "_thingservice._udp.ouraddress.tld" that advertises this port provide
   /// localAddr to forward inbound udp packets to "ip:port" if localAddr is NULL then the resulting
   /// socket MUST be drained by lokinet_udp_recvmmsg
+  /// each remote ip:port is forwarded from a udp socket of its own on localAddr's ip, replies to it
+  /// from localAddr go back to that remote, and it is closed after 2 minutes without traffic
   ///
   /// returns 0 on success
   /// returns nonzero on error in which it is an errno value
@@ -71,13 +78,16 @@ extern "C"
       int exposedPort,
       char* srv,
       char* localAddr,
-      struct lokinet_udp_listen_result* result,
+      struct lokinet_udp_bind_result* result,
       struct lokinet_context* ctx);
 
   /// poll many udp sockets for activity
-  /// returns 0 on sucess
+  /// blocks until at least one of them has packets to read or timeout passes, a NULL timeout
+  /// waits forever
+  /// returns 0 when one of them is readable
   ///
-  /// returns non zero errno on error
+  /// returns ETIMEDOUT if none became readable in time, EBADF if a socket id is not open,
+  /// EHOSTDOWN if the context was stopped while waiting, or another non zero errno on error
   int EXPORT
   lokinet_udp_poll(
       const int* socket_ids,
@@ -93,12 +103,39 @@ extern "C"
   };
 
   /// analog to recvmmsg
+  /// reads up to max_events packets without blocking, copying each payload into the pkt.iov_base
+  /// the caller provides and setting pkt.iov_len to how much of it was written, anything past the
+  /// caller's iov_len is dropped.
+  /// a socket should be polled and read from by one thread at a time.
+  /// returns the number of packets read, or -errno on error
   ssize_t EXPORT
   lokinet_udp_recvmmsg(
       int socket_id,
       struct lokinet_udp_pkt* events,
       size_t max_events,
-      struct lokient_context* ctx);
+      struct lokinet_context* ctx);
+
+  /// analog to sendmmsg
+  /// queues up to num packets to go out on a socket without blocking, each packet's pkt is
+  /// the payload to send. an established flow sends to its remote and ignores remote_addr and
+  /// remote_port, a bound socket sends to them.
+  /// returns the number of packets queued, which is less than num when the send queue is full, or
+  /// -errno on error: -EINVAL if the first packet's remote_addr is not a nul terminated address,
+  /// -EHOSTDOWN if the context is not running.
+  /// packets to a remote we have no path to wait until one is built; if that fails they are
+  /// dropped and the next call returns -EHOSTUNREACH once without queueing anything, or -ENOBUFS
+  /// if too many were already waiting.
+  ssize_t EXPORT
+  lokinet_udp_sendmmsg(
+      int socket_id,
+      const struct lokinet_udp_pkt* pkts,
+      size_t num,
+      struct lokinet_context* ctx);
+
+  /// close a udp socket made with lokinet_udp_establish or lokinet_udp_bind, dropping anything
+  /// still queued on it
+  void EXPORT
+  lokinet_udp_close(int socket_id, struct lokinet_context* ctx);
 
 #ifdef __cplusplus
 }
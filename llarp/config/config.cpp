@@ -39,6 +39,7 @@ namespace llarp
   {
     constexpr Default DefaultJobQueueSize{1024 * 8};
     constexpr Default DefaultWorkerThreads{0};
+    constexpr Default DefaultCryptoThreads{0};
     constexpr Default DefaultBlockBogons{true};
 
     conf.defineOption<int>(
@@ -187,6 +188,23 @@ namespace llarp
           m_workerThreads = arg;
         });
 
+    conf.defineOption<int>(
+        "router",
+        "crypto-threads",
+        RelayOnly,
+        DefaultCryptoThreads,
+        Comment{
+            "The number of threads a relay uses to encrypt and decrypt the traffic it carries.",
+            "Relay throughput scales with this up to the number of logical CPU cores.",
+            "0 means use the number of logical CPU cores detected at startup.",
+        },
+        [this](int arg) {
+          if (arg < 0)
+            throw std::invalid_argument("crypto-threads must be >= 0");
+
+          m_cryptoThreads = arg;
+        });
+
     // Hidden option because this isn't something that should ever be turned off occasionally when
     // doing dev/testing work.
     conf.defineOption<bool>(
@@ -540,6 +558,31 @@ namespace llarp
         },
         AssignmentAcceptor(m_ifname));
 
+    conf.defineOption<int>(
+        "network",
+        "tun-queues",
+        Default{1},
+        Comment{
+            "Number of queues to open on the tun interface (linux only). With more than one the",
+            "interface is opened multi-queue and every queue is read on a thread of its own,",
+            "which helps exits and endpoints that move a lot of traffic.",
+        },
+        [this](int arg) {
+          if (arg < 1)
+            throw std::invalid_argument("[network]:tun-queues must be at least 1");
+          m_tunQueues = arg;
+        });
+
+    conf.defineOption<bool>(
+        "network",
+        "tun-offload",
+        Default{false},
+        AssignmentAcceptor(m_tunOffload),
+        Comment{
+            "Merge back to back tcp segments of a flow into one segmentation offload write to the",
+            "tun interface (linux only). Cuts down on syscalls when downloading a lot.",
+        });
+
     conf.defineOption<std::string>(
         "network",
         "ifaddr",
@@ -57,6 +57,7 @@ namespace llarp
 
     int m_workerThreads = -1;
     int m_numNetThreads = -1;
+    int m_cryptoThreads = 0;
 
     size_t m_JobQueueSize = 0;
 
@@ -97,6 +98,8 @@ namespace llarp
     std::set<RouterID> m_strictConnect;
     std::string m_ifname;
     IPRange m_ifaddr;
+    int m_tunQueues = 1;
+    bool m_tunOffload = false;
 
     std::optional<fs::path> m_keyfile;
     std::string m_endpointType;
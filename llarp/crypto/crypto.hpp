@@ -2,10 +2,12 @@
 
 #include "constants.hpp"
 #include "types.hpp"
+#include "xchacha20_batch.hpp"
 
 #include <llarp/util/buffer.hpp>
 
 #include <functional>
+#include <vector>
 
 #include <cstdint>
 
@@ -18,6 +20,17 @@
 
 namespace llarp
 {
+  /// one ed25519 signature to check as part of a batch
+  struct VerifyJob
+  {
+    const PubKey* pub;
+    const byte_t* data;
+    size_t size;
+    const Signature* sig;
+    /// set by verify_batch
+    bool valid = false;
+  };
+
   /// library crypto configuration
   struct Crypto
   {
@@ -36,6 +49,16 @@ namespace llarp
     xchacha20_alt(
         const llarp_buffer_t&, const llarp_buffer_t&, const SharedSecret&, const byte_t*) = 0;
 
+    /// xchacha symmetric cipher over many buffers at once
+    virtual bool
+    xchacha20_batch(const std::vector<XChaCha20Job>& jobs)
+    {
+      bool good = true;
+      for (const auto& job : jobs)
+        good = xchacha20(llarp_buffer_t{job.data, job.size}, *job.key, job.nonce) and good;
+      return good;
+    }
+
     /// path dh creator's side
     virtual bool
     dh_client(SharedSecret&, const PubKey&, const SecretKey&, const TunnelNonce&) = 0;
@@ -64,6 +87,20 @@ namespace llarp
     virtual bool
     verify(const PubKey&, const llarp_buffer_t&, const Signature&) = 0;
 
+    /// ed25519 verify over many signatures at once, sets each job's valid and returns true if
+    /// all of them are
+    virtual bool
+    verify_batch(std::vector<VerifyJob>& jobs)
+    {
+      bool good = true;
+      for (auto& job : jobs)
+      {
+        job.valid = verify(*job.pub, llarp_buffer_t{job.data, job.size}, *job.sig);
+        good = job.valid and good;
+      }
+      return good;
+    }
+
     /// derive sub keys for public keys
     virtual bool
     derive_subkey(PubKey&, const PubKey&, uint64_t, const AlignedBuffer<32>* = nullptr) = 0;
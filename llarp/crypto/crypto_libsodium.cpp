@@ -144,6 +144,14 @@ namespace llarp
       return crypto_stream_xchacha20_xor(out.base, in.base, in.sz, n, k.data()) == 0;
     }
 
+    bool
+    CryptoLibSodium::xchacha20_batch(const std::vector<XChaCha20Job>& jobs)
+    {
+      if (crypto::xchacha20_batch(jobs))
+        return true;
+      return Crypto::xchacha20_batch(jobs);
+    }
+
     bool
     CryptoLibSodium::dh_client(
         llarp::SharedSecret& shared, const PubKey& pk, const SecretKey& sk, const TunnelNonce& n)
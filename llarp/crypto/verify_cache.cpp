@@ -0,0 +1,126 @@
+#include "verify_cache.hpp"
+
+#include <sodium/crypto_generichash.h>
+
+#include <unordered_map>
+
+namespace llarp
+{
+  namespace crypto
+  {
+    VerifyCache&
+    VerifyCache::Instance()
+    {
+      static VerifyCache cache;
+      return cache;
+    }
+
+    ShortHash
+    VerifyCache::KeyOf(const PubKey& pub, const byte_t* data, size_t size, const Signature& sig)
+    {
+      ShortHash key;
+      crypto_generichash_state state;
+      crypto_generichash_init(&state, nullptr, 0, key.size());
+      crypto_generichash_update(&state, pub.data(), pub.size());
+      crypto_generichash_update(&state, sig.data(), sig.size());
+      crypto_generichash_update(&state, data, size);
+      crypto_generichash_final(&state, key.data(), key.size());
+      return key;
+    }
+
+    bool
+    VerifyCache::Verify(const PubKey& pub, const llarp_buffer_t& buf, const Signature& sig)
+    {
+      const auto key = KeyOf(pub, buf.base, buf.sz, sig);
+      if (Contains(key))
+        return true;
+      if (not CryptoManager::instance()->verify(pub, buf, sig))
+        return false;
+      std::lock_guard<std::mutex> lock{m_Access};
+      Insert(key);
+      return true;
+    }
+
+    bool
+    VerifyCache::VerifyBatch(std::vector<VerifyJob>& jobs)
+    {
+      std::vector<ShortHash> keys;
+      keys.reserve(jobs.size());
+      for (const auto& job : jobs)
+        keys.emplace_back(KeyOf(*job.pub, job.data, job.size, *job.sig));
+
+      // the jobs we have to check, one per key, and which of them each job goes with
+      std::unordered_map<ShortHash, size_t> pending;
+      std::vector<VerifyJob> unchecked;
+      std::vector<size_t> which(jobs.size(), 0);
+      {
+        std::lock_guard<std::mutex> lock{m_Access};
+        for (size_t idx = 0; idx < jobs.size(); ++idx)
+        {
+          jobs[idx].valid = m_Verified.count(keys[idx]) > 0;
+          if (jobs[idx].valid)
+            continue;
+          const auto [itr, inserted] = pending.emplace(keys[idx], unchecked.size());
+          if (inserted)
+            unchecked.push_back(jobs[idx]);
+          which[idx] = itr->second;
+        }
+      }
+      if (not unchecked.empty())
+        CryptoManager::instance()->verify_batch(unchecked);
+
+      bool good = true;
+      std::lock_guard<std::mutex> lock{m_Access};
+      for (size_t idx = 0; idx < jobs.size(); ++idx)
+      {
+        auto& job = jobs[idx];
+        if (not job.valid)
+        {
+          job.valid = unchecked[which[idx]].valid;
+          if (job.valid)
+            Insert(keys[idx]);
+        }
+        good = job.valid and good;
+      }
+      return good;
+    }
+
+    size_t
+    VerifyCache::size() const
+    {
+      std::lock_guard<std::mutex> lock{m_Access};
+      return m_Verified.size();
+    }
+
+    void
+    VerifyCache::Clear()
+    {
+      std::lock_guard<std::mutex> lock{m_Access};
+      m_Verified.clear();
+      m_Order.clear();
+      m_Oldest = 0;
+    }
+
+    bool
+    VerifyCache::Contains(const ShortHash& key) const
+    {
+      std::lock_guard<std::mutex> lock{m_Access};
+      return m_Verified.count(key) > 0;
+    }
+
+    void
+    VerifyCache::Insert(const ShortHash& key)
+    {
+      if (not m_Verified.insert(key).second)
+        return;
+      if (m_Order.size() < MaxEntries)
+      {
+        m_Order.push_back(key);
+        return;
+      }
+      m_Verified.erase(m_Order[m_Oldest]);
+      m_Order[m_Oldest] = key;
+      m_Oldest = (m_Oldest + 1) % MaxEntries;
+    }
+  }  // namespace crypto
+}  // namespace llarp
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "crypto.hpp"
+#include "types.hpp"
+
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace llarp
+{
+  namespace crypto
+  {
+    /// the signed blobs we already checked, so gossip handing us the same rc or introset over and
+    /// over costs a hash instead of an ed25519 verify each time.
+    ///
+    /// only good signatures are remembered, keyed on blake2b of the key, the signature and the
+    /// signed bytes; once full the oldest is forgotten first.  thread safe.
+    class VerifyCache
+    {
+     public:
+      static constexpr size_t MaxEntries = 16384;
+
+      /// the one shared by everything verifying rcs and introsets
+      static VerifyCache&
+      Instance();
+
+      /// true if sig is pub's signature of buf, skipping the verify if we checked it before
+      bool
+      Verify(const PubKey& pub, const llarp_buffer_t& buf, const Signature& sig);
+
+      /// verify jobs with one call to the crypto's verify_batch, leaving out what we checked
+      /// before and what is in the batch twice.  sets each job's valid and returns true if all
+      /// of them are.
+      bool
+      VerifyBatch(std::vector<VerifyJob>& jobs);
+
+      size_t
+      size() const;
+
+      void
+      Clear();
+
+     private:
+      static ShortHash
+      KeyOf(const PubKey& pub, const byte_t* data, size_t size, const Signature& sig);
+
+      bool
+      Contains(const ShortHash& key) const;
+
+      /// call with m_Access held
+      void
+      Insert(const ShortHash& key);
+
+      mutable std::mutex m_Access;
+      std::unordered_set<ShortHash> m_Verified;
+      /// m_Verified in the order they went in, a ring once full with m_Oldest next to go
+      std::vector<ShortHash> m_Order;
+      size_t m_Oldest = 0;
+    };
+  }  // namespace crypto
+}  // namespace llarp
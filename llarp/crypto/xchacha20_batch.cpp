@@ -0,0 +1,263 @@
+#include "xchacha20_batch.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace llarp::crypto
+{
+#if defined(__GNUC__)
+
+#define LLARP_ALWAYS_INLINE inline __attribute__((always_inline))
+
+  namespace
+  {
+    constexpr uint32_t Sigma[4] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+
+    /// little endian u32 from bytes
+    LLARP_ALWAYS_INLINE uint32_t
+    LoadLE(const byte_t* ptr)
+    {
+      return uint32_t{ptr[0]} | (uint32_t{ptr[1]} << 8) | (uint32_t{ptr[2]} << 16)
+          | (uint32_t{ptr[3]} << 24);
+    }
+
+    template <size_t Lanes>
+    struct LaneVector;
+
+    template <>
+    struct LaneVector<4>
+    {
+      typedef uint32_t type __attribute__((vector_size(16)));
+    };
+
+    template <>
+    struct LaneVector<8>
+    {
+      typedef uint32_t type __attribute__((vector_size(32)));
+    };
+
+    template <>
+    struct LaneVector<16>
+    {
+      typedef uint32_t type __attribute__((vector_size(64)));
+    };
+
+    LLARP_ALWAYS_INLINE void
+    StoreLE(byte_t* ptr, uint32_t val)
+    {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+      std::memcpy(ptr, &val, 4);
+#else
+      ptr[0] = val;
+      ptr[1] = val >> 8;
+      ptr[2] = val >> 16;
+      ptr[3] = val >> 24;
+#endif
+    }
+
+    /// `Lanes` chacha states side by side, lane n of every word vector belongs to job n
+    template <size_t Lanes>
+    struct Kernel
+    {
+      using V = typename LaneVector<Lanes>::type;
+
+      // everything here takes vectors by reference, passing them by value warns about the
+      // vector abi differing between the targets we build this for
+
+      static LLARP_ALWAYS_INLINE void
+      XorRotate(V& x, const V& y, int n)
+      {
+        x ^= y;
+        x = (x << n) | (x >> (32 - n));
+      }
+
+      static LLARP_ALWAYS_INLINE void
+      QuarterRound(V& a, V& b, V& c, V& d)
+      {
+        a += b;
+        XorRotate(d, a, 16);
+        c += d;
+        XorRotate(b, c, 12);
+        a += b;
+        XorRotate(d, a, 8);
+        c += d;
+        XorRotate(b, c, 7);
+      }
+
+      static LLARP_ALWAYS_INLINE void
+      Rounds(V (&x)[16])
+      {
+        for (int i = 0; i < 10; ++i)
+        {
+          QuarterRound(x[0], x[4], x[8], x[12]);
+          QuarterRound(x[1], x[5], x[9], x[13]);
+          QuarterRound(x[2], x[6], x[10], x[14]);
+          QuarterRound(x[3], x[7], x[11], x[15]);
+          QuarterRound(x[0], x[5], x[10], x[15]);
+          QuarterRound(x[1], x[6], x[11], x[12]);
+          QuarterRound(x[2], x[7], x[8], x[13]);
+          QuarterRound(x[3], x[4], x[9], x[14]);
+        }
+      }
+
+      static LLARP_ALWAYS_INLINE void
+      Splat(V& v, uint32_t val)
+      {
+        for (size_t l = 0; l < Lanes; ++l)
+          v[l] = val;
+      }
+
+      /// xor up to Lanes jobs with their key streams
+      static LLARP_ALWAYS_INLINE void
+      Group(const XChaCha20Job* jobs, size_t num)
+      {
+        V x[16];
+        // hchacha20 of every job's key and first 16 bytes of nonce gives the chacha20 key
+        for (size_t w = 0; w < 4; ++w)
+          Splat(x[w], Sigma[w]);
+        for (size_t w = 0; w < 12; ++w)
+          Splat(x[4 + w], 0);
+        size_t blocks = 0;
+        for (size_t l = 0; l < num; ++l)
+        {
+          const byte_t* key = jobs[l].key->data();
+          const byte_t* nonce = jobs[l].nonce.data();
+          for (size_t w = 0; w < 8; ++w)
+            x[4 + w][l] = LoadLE(key + (w * 4));
+          for (size_t w = 0; w < 4; ++w)
+            x[12 + w][l] = LoadLE(nonce + (w * 4));
+          blocks = std::max(blocks, (jobs[l].size + 63) / 64);
+        }
+        Rounds(x);
+
+        V state[16];
+        for (size_t w = 0; w < 4; ++w)
+        {
+          Splat(state[w], Sigma[w]);
+          state[4 + w] = x[w];
+          state[8 + w] = x[12 + w];
+        }
+        // the last 8 nonce bytes go into the chacha20 state after the 64 bit block counter
+        Splat(state[14], 0);
+        Splat(state[15], 0);
+        for (size_t l = 0; l < num; ++l)
+        {
+          state[14][l] = LoadLE(jobs[l].nonce.data() + 16);
+          state[15][l] = LoadLE(jobs[l].nonce.data() + 20);
+        }
+
+        for (size_t block = 0; block < blocks; ++block)
+        {
+          Splat(state[12], static_cast<uint32_t>(block));
+          Splat(state[13], static_cast<uint32_t>(uint64_t{block} >> 32));
+          for (size_t w = 0; w < 16; ++w)
+            x[w] = state[w];
+          Rounds(x);
+          for (size_t w = 0; w < 16; ++w)
+            x[w] += state[w];
+
+          // pull each lane's block back out of the word vectors and xor it in
+          alignas(64) uint32_t words[16][Lanes];
+          std::memcpy(words, x, sizeof(words));
+          const size_t offset = block * 64;
+          for (size_t l = 0; l < num; ++l)
+          {
+            const auto& job = jobs[l];
+            if (offset >= job.size)
+              continue;
+            alignas(8) byte_t stream[64];
+            for (size_t w = 0; w < 16; ++w)
+              StoreLE(stream + (w * 4), words[w][l]);
+            byte_t* ptr = job.data + offset;
+            const size_t len = std::min<size_t>(64, job.size - offset);
+            if (len == 64)
+            {
+              for (size_t i = 0; i < 64; i += 8)
+              {
+                uint64_t a, b;
+                std::memcpy(&a, ptr + i, 8);
+                std::memcpy(&b, stream + i, 8);
+                a ^= b;
+                std::memcpy(ptr + i, &a, 8);
+              }
+            }
+            else
+            {
+              for (size_t i = 0; i < len; ++i)
+                ptr[i] ^= stream[i];
+            }
+          }
+        }
+      }
+
+      static LLARP_ALWAYS_INLINE void
+      Run(const std::vector<XChaCha20Job>& jobs)
+      {
+        for (size_t idx = 0; idx < jobs.size(); idx += Lanes)
+          Group(jobs.data() + idx, std::min(Lanes, jobs.size() - idx));
+      }
+    };
+
+#if defined(__x86_64__) || defined(__i386__)
+    __attribute__((target("avx512f"))) void
+    RunAVX512(const std::vector<XChaCha20Job>& jobs)
+    {
+      Kernel<16>::Run(jobs);
+    }
+
+    __attribute__((target("avx2"))) void
+    RunAVX2(const std::vector<XChaCha20Job>& jobs)
+    {
+      Kernel<8>::Run(jobs);
+    }
+#endif
+
+    /// sse2 on x86, neon on arm, plain scalar code everywhere else
+    void
+    RunGeneric(const std::vector<XChaCha20Job>& jobs)
+    {
+      Kernel<4>::Run(jobs);
+    }
+  }  // namespace
+
+  std::vector<XChaCha20Kernel>
+  xchacha20_batch_kernels()
+  {
+    std::vector<XChaCha20Kernel> kernels;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+      kernels.push_back({"avx512", &RunAVX512});
+    if (__builtin_cpu_supports("avx2"))
+      kernels.push_back({"avx2", &RunAVX2});
+#endif
+    kernels.push_back({"generic", &RunGeneric});
+    return kernels;
+  }
+
+  bool
+  xchacha20_batch(const std::vector<XChaCha20Job>& jobs)
+  {
+    static const auto run = xchacha20_batch_kernels().front().run;
+    run(jobs);
+    return true;
+  }
+
+#undef LLARP_ALWAYS_INLINE
+
+#else
+
+  std::vector<XChaCha20Kernel>
+  xchacha20_batch_kernels()
+  {
+    return {};
+  }
+
+  bool
+  xchacha20_batch(const std::vector<XChaCha20Job>&)
+  {
+    return false;
+  }
+
+#endif
+}  // namespace llarp::crypto
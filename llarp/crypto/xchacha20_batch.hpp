@@ -0,0 +1,39 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <vector>
+
+namespace llarp
+{
+  /// one buffer to xor with its own xchacha20 key stream as part of a batch
+  struct XChaCha20Job
+  {
+    byte_t* data;
+    size_t size;
+    const SharedSecret* key;
+    TunnelNonce nonce;
+  };
+
+  namespace crypto
+  {
+    /// run every job's buffer through xchacha20, several jobs at once in the lanes of a simd
+    /// chacha kernel (avx-512, avx2 or 128 bit vectors, picked at runtime).  produces exactly the
+    /// same output as calling crypto_stream_xchacha20_xor on each job.  jobs may share buffers.
+    /// returns false if this platform has no batched kernel, in which case nothing was done.
+    bool
+    xchacha20_batch(const std::vector<XChaCha20Job>& jobs);
+
+    /// one of the batched kernels, for checking each of them against libsodium
+    struct XChaCha20Kernel
+    {
+      const char* name;
+      void (*run)(const std::vector<XChaCha20Job>& jobs);
+    };
+
+    /// every batched kernel this build has that the cpu we are on can run, fastest first.
+    /// xchacha20_batch uses the first; empty when there is no batched kernel.
+    std::vector<XChaCha20Kernel>
+    xchacha20_batch_kernels();
+  }  // namespace crypto
+}  // namespace llarp
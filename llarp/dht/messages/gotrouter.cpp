@@ -118,6 +118,7 @@ namespace llarp
         return true;
       }
       // store if valid
+      RouterContact::VerifySignatures(foundRCs.begin(), foundRCs.end());
       for (const auto& rc : foundRCs)
       {
         if (not dht.GetRouter()->rcLookupHandler().CheckRC(rc))
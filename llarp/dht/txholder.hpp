@@ -3,6 +3,7 @@
 
 #include "tx.hpp"
 #include "txowner.hpp"
+#include <llarp/util/metrics.hpp>
 #include <llarp/util/time.hpp>
 #include <llarp/util/status.hpp>
 
@@ -13,6 +14,14 @@ namespace llarp
 {
   namespace dht
   {
+    /// dht lookups we started or that timed out, by `event`
+    inline metrics::Counter
+    LookupCounter(std::string event)
+    {
+      return metrics::Registry::Instance().GetCounter(
+          "lokinet_dht_lookups_total", "dht lookups started and timed out", {{"event", std::move(event)}});
+    }
+
     template <typename K, typename V>
     struct TXHolder
     {
@@ -140,6 +149,8 @@ namespace llarp
       }
       if (count == 0)
       {
+        static const auto started = LookupCounter("started");
+        started.Add();
         t->Start(askpeer);
       }
     }
@@ -201,6 +212,8 @@ namespace llarp
       {
         if (now >= itr->second)
         {
+          static const auto timedOut = LookupCounter("timeout");
+          timedOut.Add();
           Inform(TXOwner{}, itr->first, {}, true, false);
           itr = timeouts.erase(itr);
         }
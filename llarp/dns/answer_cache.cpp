@@ -0,0 +1,162 @@
+#include "answer_cache.hpp"
+#include "dns.hpp"
+
+#include <llarp/net/ip.hpp>
+#include <llarp/util/endian.hpp>
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace dns
+  {
+    namespace
+    {
+      std::string
+      CacheKey(const Question& question)
+      {
+        std::string key{question.qname};
+        key.push_back('\0');
+        key.push_back(static_cast<char>(question.qtype >> 8));
+        key.push_back(static_cast<char>(question.qtype & 0xff));
+        return key;
+      }
+
+      bool
+      OneQuestion(const Message& msg)
+      {
+        return msg.questions.size() == 1 and msg.questions[0].qclass == qClassIN;
+      }
+
+      /// names answered differently each time or from state that changes under them
+      bool
+      Volatile(const Question& question)
+      {
+        return question.qtype == qTypePTR or question.IsLocalhost()
+            or question.IsName("random.snode");
+      }
+    }  // namespace
+
+    bool
+    AnswerCache::Cacheable(const Message& query)
+    {
+      // queries carrying answers are rewrites of replies from upstream, not questions
+      return OneQuestion(query) and query.answers.empty() and not Volatile(query.questions[0]);
+    }
+
+    std::optional<AnswerCache::Answer>
+    AnswerCache::Get(const Message& query, llarp_time_t now)
+    {
+      if (not Cacheable(query))
+        return std::nullopt;
+      auto itr = m_Entries.find(CacheKey(query.questions[0]));
+      if (itr == m_Entries.end())
+        return std::nullopt;
+      auto& entry = itr->second;
+      if (now >= entry.expiresAt)
+      {
+        m_Entries.erase(itr);
+        return std::nullopt;
+      }
+      Answer answer{entry.wire, entry.negative, false};
+      htobe16buf(answer.wire.data(), query.hdr_id);
+      if (now >= entry.prefetchAt and not entry.prefetching)
+      {
+        entry.prefetching = true;
+        answer.prefetch = true;
+      }
+      return answer;
+    }
+
+    void
+    AnswerCache::Put(const Message& reply, std::vector<byte_t> wire, llarp_time_t now)
+    {
+      if (not OneQuestion(reply) or Volatile(reply.questions[0])
+          or wire.size() < MessageHeader::Size)
+        return;
+      if (reply.hdr_fields & flags_TC)
+        return;
+      auto key = CacheKey(reply.questions[0]);
+      llarp_time_t lifetime;
+      bool negative = false;
+      switch (reply.hdr_fields & 0xf)
+      {
+        case flags_RCODENoError:
+          if (reply.answers.empty())
+          {
+            lifetime = NoDataLifetime;
+            negative = true;
+            break;
+          }
+          lifetime = MaxLifetime;
+          for (const auto& rr : reply.answers)
+            lifetime = std::min<llarp_time_t>(lifetime, std::chrono::seconds{rr.ttl});
+          break;
+        case flags_RCODENameError:
+          lifetime = NegativeLifetime;
+          negative = true;
+          break;
+        default:
+          // servfail and friends are worth asking again right away
+          lifetime = 0s;
+          break;
+      }
+      if (lifetime <= 0s)
+      {
+        m_Entries.erase(key);
+        return;
+      }
+      if (m_Entries.size() >= MaxEntries and m_Entries.count(key) == 0)
+        MakeRoom(now);
+      // refresh over the last fifth of its life
+      auto& entry = m_Entries[std::move(key)] =
+          Entry{std::move(wire), now + lifetime, now + lifetime - lifetime / 5, negative, false};
+      for (const auto& rr : reply.answers)
+      {
+        if (rr.rr_type == qTypeA and rr.rData.size() == 4)
+          entry.v4.push_back(huint32_t{bufbe32toh(rr.rData.data())});
+        else if (rr.rr_type == qTypeAAAA and rr.rData.size() == 16)
+        {
+          in6_addr addr;
+          std::copy_n(rr.rData.data(), 16, addr.s6_addr);
+          entry.v6.push_back(net::In6ToHUInt(addr));
+        }
+      }
+    }
+
+    void
+    AnswerCache::Forget(huint128_t ip)
+    {
+      const auto v4 = net::TruncateV6(ip);
+      auto itr = m_Entries.begin();
+      while (itr != m_Entries.end())
+      {
+        const auto& entry = itr->second;
+        if (std::find(entry.v4.begin(), entry.v4.end(), v4) != entry.v4.end()
+            or std::find(entry.v6.begin(), entry.v6.end(), ip) != entry.v6.end())
+          itr = m_Entries.erase(itr);
+        else
+          ++itr;
+      }
+    }
+
+    void
+    AnswerCache::MakeRoom(llarp_time_t now)
+    {
+      auto itr = m_Entries.begin();
+      while (itr != m_Entries.end())
+      {
+        if (now >= itr->second.expiresAt)
+          itr = m_Entries.erase(itr);
+        else
+          ++itr;
+      }
+      if (m_Entries.size() < MaxEntries)
+        return;
+      m_Entries.erase(std::min_element(
+          m_Entries.begin(), m_Entries.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.second.expiresAt < rhs.second.expiresAt;
+          }));
+    }
+  }  // namespace dns
+}  // namespace llarp
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "message.hpp"
+#include <llarp/net/net_int.hpp>
+#include <llarp/util/time.hpp>
+#include <llarp/util/types.hpp>
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp
+{
+  namespace dns
+  {
+    /// encoded replies to the queries we answer ourselves keyed on (qname, qtype), so a local
+    /// resolver or browser asking for the same name over and over does not redo the lookups
+    /// behind it each time. a hit costs a copy and patching in the query's id.
+    ///
+    /// answers live no longer than their records' ttl.  names whose answer changes from one
+    /// query to the next (random.snode, *.localhost.loki, reverse lookups) are never cached, and
+    /// whoever hands out addresses must Forget them when they are mapped to something else.
+    class AnswerCache
+    {
+     public:
+      /// most replies we keep
+      static constexpr size_t MaxEntries = 2048;
+      static constexpr llarp_time_t MaxLifetime = 5min;
+      /// how long to remember a name does not exist
+      static constexpr llarp_time_t NegativeLifetime = 10s;
+      /// how long to remember a name exists but has no records of the type asked for
+      static constexpr llarp_time_t NoDataLifetime = 2s;
+
+      struct Answer
+      {
+        /// the encoded reply with the query's id
+        std::vector<byte_t> wire;
+        bool negative;
+        /// it is close to expiring and the caller should look it up again to refresh it, only
+        /// set for one hit until it is put again
+        bool prefetch;
+      };
+
+      /// true if we could cache replies to `query`
+      static bool
+      Cacheable(const Message& query);
+
+      /// the cached reply to `query` if we have one that is fresh
+      std::optional<Answer>
+      Get(const Message& query, llarp_time_t now);
+
+      /// remember the encoded reply `wire` to `reply`'s question, if it is cacheable
+      void
+      Put(const Message& reply, std::vector<byte_t> wire, llarp_time_t now);
+
+      /// drop every answer that hands out `ip`
+      void
+      Forget(huint128_t ip);
+
+      void
+      Clear()
+      {
+        m_Entries.clear();
+      }
+
+      size_t
+      size() const
+      {
+        return m_Entries.size();
+      }
+
+     private:
+      struct Entry
+      {
+        std::vector<byte_t> wire;
+        llarp_time_t expiresAt;
+        llarp_time_t prefetchAt;
+        bool negative;
+        bool prefetching;
+        /// the addresses in its A and AAAA records
+        std::vector<huint32_t> v4;
+        std::vector<huint128_t> v6;
+      };
+
+      /// drop whatever expired and, if that was not enough, what expires first
+      void
+      MakeRoom(llarp_time_t now);
+
+      std::unordered_map<std::string, Entry> m_Entries;
+    };
+  }  // namespace dns
+}  // namespace llarp
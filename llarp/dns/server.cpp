@@ -1,12 +1,51 @@
 #include "server.hpp"
 #include "dns.hpp"
 #include <llarp/crypto/crypto.hpp>
+#include <llarp/util/metrics.hpp>
 #include <array>
 #include <utility>
 #include <llarp/ev/udp_handle.hpp>
 
 namespace llarp::dns
 {
+  namespace
+  {
+    struct CacheMetrics
+    {
+      metrics::Counter hits;
+      metrics::Counter negativeHits;
+      metrics::Counter misses;
+      metrics::Counter prefetches;
+      metrics::Histogram latency;
+    };
+
+    const CacheMetrics&
+    Metrics()
+    {
+      static const CacheMetrics m = [] {
+        auto& registry = metrics::Registry::Instance();
+        const std::string lookups{"lokinet_dns_cache_lookups_total"};
+        const std::string help{"hooked dns queries by how the answer cache did"};
+        return CacheMetrics{
+            registry.GetCounter(lookups, help, {{"result", "hit"}}),
+            registry.GetCounter(lookups, help, {{"result", "negative_hit"}}),
+            registry.GetCounter(lookups, help, {{"result", "miss"}}),
+            registry.GetCounter(lookups, help, {{"result", "prefetch"}}),
+            registry.GetHistogram(
+                "lokinet_dns_lookup_milliseconds",
+                "how long hooked dns queries the cache missed took to answer",
+                {1, 10, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000})};
+      }();
+      return m;
+    }
+
+    std::vector<byte_t>
+    CopyWire(const OwnedBuffer& buf)
+    {
+      return std::vector<byte_t>(buf.buf.get(), buf.buf.get() + buf.sz);
+    }
+  }  // namespace
+
   PacketHandler::PacketHandler(EventLoop_ptr loop, IQueryHandler* h)
       : m_QueryHandler{h}, m_Loop{std::move(loop)}
   {}
@@ -15,7 +54,9 @@ namespace llarp::dns
       : PacketHandler{loop, h}, m_Loop(std::move(loop))
   {
     m_Server = m_Loop->make_udp(
-        [this](UDPHandle&, SockAddr a, OwnedBuffer buf) { HandlePacket(a, a, buf); });
+        [this](UDPHandle&, SockAddr a, const llarp_buffer_t& buf) {
+          HandlePacket(a, a, llarp_buffer_t{buf.base, buf.sz});
+        });
   }
 
   void
@@ -134,6 +175,18 @@ namespace llarp::dns
     return !IsUpstreamResolver(to, from);
   }
 
+  void
+  PacketHandler::ForgetCachedAnswers(huint128_t ip)
+  {
+    m_AnswerCache.Forget(ip);
+  }
+
+  void
+  PacketHandler::ClearCachedAnswers()
+  {
+    m_AnswerCache.Clear();
+  }
+
   void
   PacketHandler::HandlePacket(const SockAddr& resolver, const SockAddr& from, llarp_buffer_t buf)
   {
@@ -171,13 +224,7 @@ namespace llarp::dns
 
     if (m_QueryHandler && m_QueryHandler->ShouldHookDNSMessage(msg))
     {
-      auto reply = [self = shared_from_this(), to = from, resolver](dns::Message msg) {
-        self->SendServerMessageBufferTo(to, resolver, msg.ToBuffer());
-      };
-      if (!m_QueryHandler->HandleHookedDNSMessage(std::move(msg), reply))
-      {
-        llarp::LogWarn("failed to handle hooked dns");
-      }
+      HandleHookedQuery(resolver, from, std::move(msg));
     }
     else if (not m_UnboundResolver)
     {
@@ -191,4 +238,44 @@ namespace llarp::dns
       m_UnboundResolver->Lookup(resolver, from, std::move(msg));
     }
   }
+
+  void
+  PacketHandler::HandleHookedQuery(const SockAddr& resolver, const SockAddr& from, Message msg)
+  {
+    const auto& metrics = Metrics();
+    const auto now = m_Loop->time_now();
+    if (auto cached = m_AnswerCache.Get(msg, now))
+    {
+      (cached->negative ? metrics.negativeHits : metrics.hits).Add();
+      SendServerMessageBufferTo(from, resolver, llarp_buffer_t{cached->wire});
+      if (cached->prefetch)
+        Prefetch(std::move(msg));
+      return;
+    }
+    metrics.misses.Add();
+    auto reply = [self = shared_from_this(), to = from, resolver, started = now](
+                     dns::Message msg) {
+      auto buf = msg.ToBuffer();
+      const auto now = self->m_Loop->time_now();
+      if (now >= started)
+        Metrics().latency.Observe(ToMS(now - started));
+      self->m_AnswerCache.Put(msg, CopyWire(buf), now);
+      self->SendServerMessageBufferTo(to, resolver, buf);
+    };
+    if (!m_QueryHandler->HandleHookedDNSMessage(std::move(msg), reply))
+    {
+      llarp::LogWarn("failed to handle hooked dns");
+    }
+  }
+
+  void
+  PacketHandler::Prefetch(Message msg)
+  {
+    Metrics().prefetches.Add();
+    auto refresh = [self = shared_from_this()](dns::Message msg) {
+      self->m_AnswerCache.Put(msg, CopyWire(msg.ToBuffer()), self->m_Loop->time_now());
+    };
+    if (not m_QueryHandler->HandleHookedDNSMessage(std::move(msg), refresh))
+      LogDebug("failed to prefetch hooked dns");
+  }
 }  // namespace llarp::dns
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "answer_cache.hpp"
 #include "message.hpp"
 #include <llarp/ev/ev.hpp>
 #include <llarp/net/net.hpp>
@@ -52,6 +53,14 @@ namespace llarp
       bool
       ShouldHandlePacket(const SockAddr& to, const SockAddr& from, llarp_buffer_t buf) const;
 
+      /// drop cached answers handing out `ip`, for when it is mapped to something else
+      void
+      ForgetCachedAnswers(huint128_t ip);
+
+      /// drop every cached answer
+      void
+      ClearCachedAnswers();
+
      protected:
       virtual void
       SendServerMessageBufferTo(const SockAddr& to, const SockAddr& from, llarp_buffer_t buf) = 0;
@@ -68,7 +77,16 @@ namespace llarp
       bool
       SetupUnboundResolver(std::vector<SockAddr> resolvers, std::vector<fs::path> hostfiles);
 
+      /// answer a hooked query from the cache or hand it to the query handler
+      void
+      HandleHookedQuery(const SockAddr& resolver, const SockAddr& from, Message msg);
+
+      /// look up a cached answer again before it expires
+      void
+      Prefetch(Message msg);
+
       IQueryHandler* const m_QueryHandler;
+      AnswerCache m_AnswerCache;
       std::set<SockAddr> m_Resolvers;
       std::shared_ptr<UnboundResolver> m_UnboundResolver;
       EventLoop_ptr m_Loop;
@@ -2,6 +2,7 @@
 
 #include <llarp/util/buffer.hpp>
 #include <llarp/util/time.hpp>
+#include <llarp/util/thread/job.hpp>
 #include <llarp/util/thread/threading.hpp>
 #include <llarp/constants/evloop.hpp>
 
@@ -108,7 +109,7 @@ namespace llarp
     // job even if called from the event loop thread itself and so you *usually* want to use
     // `call()` instead.
     virtual void
-    call_soon(std::function<void(void)> f) = 0;
+    call_soon(thread::Job f) = 0;
 
     // Adds a timer to the event loop to invoke the given callback after a delay.
     virtual void
@@ -190,7 +191,9 @@ namespace llarp
 
     virtual ~EventLoop() = default;
 
-    using UDPReceiveFunc = std::function<void(UDPHandle&, SockAddr src, llarp::OwnedBuffer buf)>;
+    /// called with each datagram received, `buf` points into the handle's own receive buffers
+    /// and is only valid for the duration of the call
+    using UDPReceiveFunc = std::function<void(UDPHandle&, SockAddr src, const llarp_buffer_t& buf)>;
 
     // Constructs a UDP socket that can be used for sending and/or receiving
     virtual std::shared_ptr<UDPHandle>
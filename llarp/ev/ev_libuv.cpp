@@ -1,5 +1,7 @@
 #include "ev_libuv.hpp"
 #include "vpn.hpp"
+#include <algorithm>
+#include <array>
 #include <memory>
 #include <thread>
 #include <type_traits>
@@ -10,6 +12,12 @@
 
 #include <uvw.hpp>
 
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <cerrno>
+#endif
+
 namespace llarp::uv
 {
   std::shared_ptr<uvw::Loop>
@@ -72,6 +80,11 @@ namespace llarp::uv
     bool
     send(const SockAddr& dest, const llarp_buffer_t& buf) override;
 
+#ifdef __linux__
+    size_t
+    send_batch(const SockAddr& dest, const std::vector<llarp_buffer_t>& bufs) override;
+#endif
+
     std::optional<int>
     file_descriptor() override
     {
@@ -92,17 +105,48 @@ namespace llarp::uv
 
     void
     reset_handle(uvw::Loop& loop);
+
+#ifdef __linux__
+    /// the most datagrams we pull out of the kernel per recvmmsg() call
+    static constexpr size_t RecvBatchSize = 32;
+    /// largest possible udp payload, anything bigger than what we expect still has to fit so
+    /// that we never silently truncate a datagram
+    static constexpr size_t RecvBufferSize = 64 * 1024;
+    /// most datagrams we hand to a single sendmmsg() call
+    static constexpr size_t SendBatchSize = 64;
+
+    /// preallocated buffers recvmmsg() fills in.  a socket starts out reading one datagram per
+    /// call and doubles that each time a call fills every slot, so busy link sockets get the whole
+    /// batch while quiet ones like dns keep a single RecvBufferSize buffer.
+    struct RecvBatch
+    {
+      std::array<mmsghdr, RecvBatchSize> msgs;
+      std::array<iovec, RecvBatchSize> iovs;
+      std::array<sockaddr_storage, RecvBatchSize> addrs;
+      size_t slots = 1;
+      std::vector<byte_t> data = std::vector<byte_t>(RecvBufferSize);
+    };
+    std::unique_ptr<RecvBatch> recv_batch;
+    /// polls the udp handle's socket; we read it ourselves instead of letting libuv do one
+    /// recvmsg() per datagram
+    std::shared_ptr<uvw::PollHandle> poller;
+
+    void
+    start_batch_recv();
+
+    void
+    drain_batch_recv();
+#endif
   };
 
   void
   Loop::FlushLogic()
   {
     llarp::LogTrace("Loop::FlushLogic() start");
-    while (not m_LogicCalls.empty())
-    {
-      auto f = m_LogicCalls.popFront();
-      f();
-    }
+    // at most one queue's worth per tick so jobs that queue more jobs can't starve the loop
+    m_LogicCalls.drain([](auto& f) { f(); }, m_LogicCalls.capacity());
+    if (not m_LogicCalls.empty())
+      m_WakeUp->send();
     llarp::LogTrace("Loop::FlushLogic() end");
   }
 
@@ -274,20 +318,26 @@ namespace llarp::uv
   }
 
   void
-  Loop::call_soon(std::function<void(void)> f)
+  Loop::call_soon(thread::Job f)
   {
     if (not m_EventLoopThreadID.has_value())
     {
-      m_LogicCalls.tryPushBack(f);
+      m_LogicCalls.tryPushBack(std::move(f));
       m_WakeUp->send();
       return;
     }
 
-    if (inEventLoop() and m_LogicCalls.full())
+    while (not m_LogicCalls.tryPushBack(std::move(f)))
     {
-      FlushLogic();
+      // full; if we are the loop make room ourselves, otherwise give the loop a chance to
+      if (inEventLoop())
+        FlushLogic();
+      else
+      {
+        m_WakeUp->send();
+        std::this_thread::yield();
+      }
     }
-    m_LogicCalls.pushBack(f);
     m_WakeUp->send();
   }
 
@@ -296,6 +346,13 @@ namespace llarp::uv
   void
   UDPHandle::reset_handle(uvw::Loop& loop)
   {
+#ifdef __linux__
+    if (poller)
+    {
+      poller->close();
+      poller.reset();
+    }
+#endif
     if (handle)
       handle->close();
     handle = loop.resource<uvw::UDPHandle>();
@@ -303,7 +360,7 @@ namespace llarp::uv
       on_recv(
           *this,
           SockAddr{event.sender.ip, huint16_t{static_cast<uint16_t>(event.sender.port)}},
-          OwnedBuffer{std::move(event.data), event.length});
+          llarp_buffer_t{event.data.get(), event.length});
     });
   }
 
@@ -315,7 +372,11 @@ namespace llarp::uv
   bool
   UDPHandle::listen(const SockAddr& addr)
   {
-    if (handle->active())
+    bool bound = handle->active();
+#ifdef __linux__
+    bound = bound or poller;
+#endif
+    if (bound)
       reset_handle(handle->loop());
 
     bool good = true;
@@ -325,11 +386,128 @@ namespace llarp::uv
     });
     handle->bind(*static_cast<const sockaddr*>(addr));
     if (good)
+    {
+#ifdef __linux__
+      start_batch_recv();
+#else
       handle->recv();
+#endif
+    }
     handle->erase(err);
     return good;
   }
 
+#ifdef __linux__
+  // Polls the bound socket for readability and drains it with recvmmsg() rather than having libuv
+  // read it.  libuv never starts its own io watcher on the fd because we never call recv() on the
+  // udp handle and only ever use trySend(), which does not queue.
+  void
+  UDPHandle::start_batch_recv()
+  {
+    if (not recv_batch)
+      recv_batch = std::make_unique<RecvBatch>();
+    poller = handle->loop().resource<uvw::PollHandle>(handle->fd());
+    poller->on<uvw::PollEvent>([this](auto&, auto&) { drain_batch_recv(); });
+    poller->start(uvw::PollHandle::Event::READABLE);
+  }
+
+  void
+  UDPHandle::drain_batch_recv()
+  {
+    auto& batch = *recv_batch;
+    for (;;)
+    {
+      if (not handle)
+        return;
+      const int fd = handle->fd();
+      const size_t slots = batch.slots;
+      for (size_t idx = 0; idx < slots; ++idx)
+      {
+        batch.iovs[idx].iov_base = batch.data.data() + (idx * RecvBufferSize);
+        batch.iovs[idx].iov_len = RecvBufferSize;
+        auto& hdr = batch.msgs[idx].msg_hdr;
+        hdr = msghdr{};
+        hdr.msg_name = &batch.addrs[idx];
+        hdr.msg_namelen = sizeof(sockaddr_storage);
+        hdr.msg_iov = &batch.iovs[idx];
+        hdr.msg_iovlen = 1;
+      }
+      const int got = ::recvmmsg(fd, batch.msgs.data(), slots, MSG_DONTWAIT, nullptr);
+      if (got <= 0)
+      {
+        if (got < 0 and errno != EAGAIN and errno != EWOULDBLOCK and errno != EINTR)
+          LogWarn("recvmmsg failed: ", strerror(errno));
+        return;
+      }
+      for (int idx = 0; idx < got; ++idx)
+      {
+        const auto& msg = batch.msgs[idx];
+        if (msg.msg_hdr.msg_flags & MSG_TRUNC)
+        {
+          LogWarn("dropping truncated udp datagram");
+          continue;
+        }
+        const auto* from = reinterpret_cast<const sockaddr*>(&batch.addrs[idx]);
+        if (from->sa_family != AF_INET and from->sa_family != AF_INET6)
+          continue;
+        // handed over straight out of the batch buffer, whoever needs to keep it copies it
+        on_recv(
+            *this,
+            SockAddr{*from},
+            llarp_buffer_t{static_cast<byte_t*>(batch.iovs[idx].iov_base), msg.msg_len});
+        // the receive handler is allowed to close us
+        if (not handle)
+          return;
+      }
+      if (static_cast<size_t>(got) < slots)
+        return;
+      // every slot filled so more is likely waiting, take more at once from now on
+      if (slots < RecvBatchSize)
+      {
+        batch.slots = std::min(slots * 2, RecvBatchSize);
+        batch.data.resize(batch.slots * RecvBufferSize);
+      }
+    }
+  }
+
+  size_t
+  UDPHandle::send_batch(const SockAddr& to, const std::vector<llarp_buffer_t>& bufs)
+  {
+    if (not handle)
+      return 0;
+    const int fd = handle->fd();
+    if (fd < 0)
+      return llarp::UDPHandle::send_batch(to, bufs);
+    // this can be called from several worker threads at once so everything lives on the stack
+    std::array<mmsghdr, SendBatchSize> msgs;
+    std::array<iovec, SendBatchSize> iovs;
+    size_t sent = 0;
+    while (sent < bufs.size())
+    {
+      const size_t num = std::min(bufs.size() - sent, SendBatchSize);
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        const auto& buf = bufs[sent + idx];
+        iovs[idx].iov_base = buf.base;
+        iovs[idx].iov_len = buf.sz;
+        auto& hdr = msgs[idx].msg_hdr;
+        hdr = msghdr{};
+        hdr.msg_name = const_cast<sockaddr*>(static_cast<const sockaddr*>(to));
+        hdr.msg_namelen = to.sockaddr_len();
+        hdr.msg_iov = &iovs[idx];
+        hdr.msg_iovlen = 1;
+      }
+      const int n = ::sendmmsg(fd, msgs.data(), num, MSG_DONTWAIT);
+      if (n <= 0)
+        break;
+      sent += n;
+      if (static_cast<size_t>(n) < num)
+        break;
+    }
+    return sent;
+  }
+#endif
+
   bool
   UDPHandle::send(const SockAddr& to, const llarp_buffer_t& buf)
   {
@@ -343,6 +521,15 @@ namespace llarp::uv
   void
   UDPHandle::close()
   {
+#ifdef __linux__
+    if (poller)
+    {
+      poller->close();
+      poller.reset();
+    }
+#endif
+    if (not handle)
+      return;
     handle->close();
     handle.reset();
   }
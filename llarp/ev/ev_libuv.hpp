@@ -1,7 +1,7 @@
 #pragma once
 #include "ev.hpp"
 #include "udp_handle.hpp"
-#include <llarp/util/thread/queue.hpp>
+#include <llarp/util/thread/mpsc_queue.hpp>
 #include <llarp/util/meta/memfn.hpp>
 
 #include <uvw/loop.h>
@@ -52,7 +52,7 @@ namespace llarp::uv
         std::function<void(llarp::net::IPPacket)> handler) override;
 
     void
-    call_soon(std::function<void(void)> f) override;
+    call_soon(thread::Job f) override;
 
     void
     set_pump_function(std::function<void(void)> pumpll) override;
@@ -81,7 +81,7 @@ namespace llarp::uv
     std::shared_ptr<uvw::Loop> m_Impl;
     std::shared_ptr<uvw::AsyncHandle> m_WakeUp;
     std::atomic<bool> m_Run;
-    using AtomicQueue_t = llarp::thread::Queue<std::function<void(void)>>;
+    using AtomicQueue_t = llarp::thread::MPSCQueue<thread::Job>;
     AtomicQueue_t m_LogicCalls;
 
 #ifdef LOKINET_DEBUG
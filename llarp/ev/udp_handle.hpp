@@ -1,6 +1,10 @@
+#pragma once
+
 #include "ev.hpp"
 #include "../util/buffer.hpp"
 
+#include <vector>
+
 namespace llarp
 {
   // Base type for UDP handling; constructed via EventLoop::make_udp().
@@ -20,6 +24,23 @@ namespace llarp
     virtual bool
     send(const SockAddr& dest, const llarp_buffer_t& buf) = 0;
 
+    // Sends a batch of packets to the same recipient, in order.  Returns how many of the packets
+    // were sent; the send stops at the first packet that fails (or would block).  The default
+    // just calls send() for each packet, implementations that can should override this to hand the
+    // whole batch to the kernel with as few syscalls as possible.
+    virtual size_t
+    send_batch(const SockAddr& dest, const std::vector<llarp_buffer_t>& bufs)
+    {
+      size_t sent = 0;
+      for (const auto& buf : bufs)
+      {
+        if (not send(dest, buf))
+          break;
+        ++sent;
+      }
+      return sent;
+    }
+
     // Closes the listening UDP socket (if opened); this is typically called (automatically) during
     // destruction.  Does nothing if the UDP socket is already closed.
     virtual void
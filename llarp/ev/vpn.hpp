@@ -3,6 +3,7 @@
 #include <llarp/net/ip_range.hpp>
 #include <llarp/net/ip_packet.hpp>
 #include <set>
+#include <vector>
 
 #include <oxenmq/variant.h>
 
@@ -31,6 +32,10 @@ namespace llarp::vpn
     std::string ifname;
     huint32_t dnsaddr;
     std::set<InterfaceAddress> addrs;
+    /// how many tun queues to open, platforms that can't do multiple queues ignore this
+    size_t queues = 1;
+    /// merge tcp segments into segmentation offload writes, platforms that can't ignore this
+    bool offload = false;
   };
 
   /// a vpn network interface
@@ -59,6 +64,18 @@ namespace llarp::vpn
     /// returns false if we dropped it
     virtual bool
     WritePacket(net::IPPacket pkt) = 0;
+
+    /// write a batch of packets to the interface in order, leaves pkts empty
+    /// returns how many we wrote
+    virtual size_t
+    WritePackets(std::vector<net::IPPacket>& pkts)
+    {
+      size_t num = 0;
+      for (auto& pkt : pkts)
+        num += WritePacket(std::move(pkt));
+      pkts.clear();
+      return num;
+    }
   };
 
   class IRouteManager
@@ -5,6 +5,8 @@
 #include <llarp/router/abstractrouter.hpp>
 #include <llarp/quic/tunnel.hpp>
 
+#include <algorithm>
+
 namespace llarp
 {
   namespace exit
@@ -152,7 +154,8 @@ namespace llarp
       {
         return false;
       }
-      m_UpstreamQueue.emplace(pkt, counter);
+      m_UpstreamQueue.emplace_back(std::move(pkt), counter);
+      std::push_heap(m_UpstreamQueue.begin(), m_UpstreamQueue.end());
       m_TxRate += buf.underlying.sz;
       m_LastActive = m_Parent->Now();
       return true;
@@ -164,7 +167,7 @@ namespace llarp
       llarp::net::IPPacket pkt{};
       if (type == service::ProtocolType::QUIC)
       {
-        pkt.sz = std::min(buf.underlying.sz, sizeof(pkt.buf));
+        pkt.sz = std::min(buf.underlying.sz, net::IPPacket::MaxSize);
         std::copy_n(buf.underlying.base, pkt.sz, pkt.buf);
       }
       else
@@ -209,11 +212,14 @@ namespace llarp
     bool
     Endpoint::Flush()
     {
-      // flush upstream queue
-      while (m_UpstreamQueue.size())
+      // flush upstream queue, once the interface queue is full the rest wait here for the next
+      // flush so our own queue fills up and the transit hop sees its writes fail
+      bool upstream = true;
+      while (upstream and m_UpstreamQueue.size())
       {
-        m_Parent->QueueOutboundTraffic(m_UpstreamQueue.top().pkt);
-        m_UpstreamQueue.pop();
+        std::pop_heap(m_UpstreamQueue.begin(), m_UpstreamQueue.end());
+        upstream = m_Parent->QueueOutboundTraffic(std::move(m_UpstreamQueue.back().pkt));
+        m_UpstreamQueue.pop_back();
       }
       // flush downstream queue
       auto path = GetCurrentPath();
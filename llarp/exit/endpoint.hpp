@@ -8,6 +8,7 @@
 #include <llarp/util/time.hpp>
 
 #include <queue>
+#include <vector>
 
 namespace llarp
 {
@@ -122,7 +123,7 @@ namespace llarp
 
       struct UpstreamBuffer
       {
-        UpstreamBuffer(const llarp::net::IPPacket& p, uint64_t c) : pkt(p), counter(c)
+        UpstreamBuffer(llarp::net::IPPacket p, uint64_t c) : pkt(std::move(p)), counter(c)
         {}
 
         llarp::net::IPPacket pkt;
@@ -131,11 +132,12 @@ namespace llarp
         bool
         operator<(const UpstreamBuffer& other) const
         {
-          return counter < other.counter;
+          return other.counter < counter;
         }
       };
 
-      using UpstreamQueue_t = std::priority_queue<UpstreamBuffer>;
+      /// a heap with the oldest packet on top
+      using UpstreamQueue_t = std::vector<UpstreamBuffer>;
       UpstreamQueue_t m_UpstreamQueue;
       uint64_t m_Counter;
     };
@@ -0,0 +1,463 @@
+#include "embedded_udp.hpp"
+
+#include <llarp/service/name.hpp>
+#include <llarp/util/endian.hpp>
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace handlers
+  {
+    namespace
+    {
+      constexpr uint8_t IPProtoUDP = 0x11;
+
+      size_t
+      UDPPayloadOffset(const net::IPPacket& pkt)
+      {
+        return size_t{pkt.Header()->ihl} * 4 + 8;
+      }
+
+      uint16_t
+      UDPSrcPort(const net::IPPacket& pkt)
+      {
+        return bufbe16toh(pkt.buf + pkt.Header()->ihl * 4);
+      }
+
+      /// an empty packet if payload does not fit
+      net::IPPacket
+      UDPPacket(uint16_t src, uint16_t dst, const llarp_buffer_t& payload)
+      {
+        return net::IPPacket::UDP(
+            nuint32_t{0}, ToNet(huint16_t{src}), nuint32_t{0}, ToNet(huint16_t{dst}), payload);
+      }
+
+      std::optional<uint16_t>
+      ParsePort(const std::string& str)
+      {
+        if (str.size() > 5)
+          return std::nullopt;
+        const auto num = std::stoi(str);
+        if (num <= 0 or num > 65535)
+          return std::nullopt;
+        return num;
+      }
+
+      /// the record to use out of an srv answer: the lowest priority, then the highest weight,
+      /// skipping ones that say the service is not there
+      const dns::SRVData*
+      BestSRV(const std::vector<dns::SRVData>& records)
+      {
+        const dns::SRVData* best = nullptr;
+        for (const auto& srv : records)
+        {
+          if (srv.target == "." or srv.port == 0)
+            continue;
+          if (best == nullptr or srv.priority < best->priority
+              or (srv.priority == best->priority and srv.weight > best->weight))
+            best = &srv;
+        }
+        return best;
+      }
+    }  // namespace
+
+    int
+    EmbeddedUDP::Socket::Queue(
+        std::optional<Address_t> to, uint16_t port, const llarp_buffer_t& payload)
+    {
+      if (remote)
+      {
+        to = remote;
+        port = remotePort;
+      }
+      if (not to or port == 0)
+        return EINVAL;
+      auto pkt = UDPPacket(localPort, port, payload);
+      if (pkt.sz == 0)
+        return EMSGSIZE;
+      if (not tx.tryPushBack(Datagram{*to, std::move(pkt)}))
+        return EAGAIN;
+      return 0;
+    }
+
+    EmbeddedUDP::EmbeddedUDP(std::shared_ptr<EndpointBase> ep, std::function<void()> onReadable)
+        : m_Endpoint{std::move(ep)}, m_OnReadable{std::move(onReadable)}
+    {}
+
+    bool
+    EmbeddedUDP::HandleTraffic(service::ConvoTag tag, net::IPPacket pkt)
+    {
+      if (not pkt.IsV4() or pkt.Header()->protocol != IPProtoUDP)
+        return false;
+      if (pkt.sz < UDPPayloadOffset(pkt))
+        return false;
+      const auto dstport = pkt.DstPort();
+      if (not dstport)
+        return false;
+      auto itr = m_Ports.find(ToHost(*dstport).h);
+      if (itr == m_Ports.end())
+        return false;
+      auto& sock = itr->second;
+      auto from = m_Endpoint->GetEndpointWithConvoTag(tag);
+      if (not from)
+        return false;
+      if (sock->remote and (*sock->remote != *from or UDPSrcPort(pkt) != sock->remotePort))
+        return false;
+      if (sock->local)
+      {
+        RelayToLocal(sock, *from, std::move(pkt));
+        return true;
+      }
+      if (not sock->rx.tryPushBack(Datagram{*from, std::move(pkt)}))
+        return false;
+      m_OnReadable();
+      return true;
+    }
+
+    void
+    EmbeddedUDP::Establish(
+        std::string host,
+        std::string service,
+        std::optional<SockAddr> local,
+        std::function<void(int, Socket_ptr)> done)
+    {
+      std::optional<uint16_t> port;
+      if (service.empty())
+      {
+        done(EINVAL, nullptr);
+        return;
+      }
+      const bool numeric = std::all_of(
+          service.begin(), service.end(), [](char ch) { return ch >= '0' and ch <= '9'; });
+      if (numeric)
+      {
+        port = ParsePort(service);
+        if (not port)
+        {
+          done(EINVAL, nullptr);
+          return;
+        }
+      }
+
+      const auto localPort = EphemeralPort();
+      if (not localPort)
+      {
+        done(EADDRNOTAVAIL, nullptr);
+        return;
+      }
+      auto sock = std::make_shared<Socket>();
+      sock->localPort = *localPort;
+      sock->local = local;
+      // taken now so flows opening at the same time get different ports
+      m_Ports[*localPort] = sock;
+      if (local)
+      {
+        sock->listener = m_Endpoint->Loop()->make_udp(
+            [self = weak_from_this(), weak = std::weak_ptr<Socket>{sock}](
+                auto&, SockAddr src, const llarp_buffer_t& buf) {
+              auto ptr = self.lock();
+              auto strong = weak.lock();
+              if (not ptr or not strong or not strong->remote)
+                return;
+              strong->app = src;
+              ptr->SendFromLocal(strong, *strong->remote, strong->remotePort, buf);
+            });
+        if (not sock->listener->listen(*local))
+        {
+          Close(sock);
+          done(EADDRINUSE, nullptr);
+          return;
+        }
+      }
+
+      auto fail = [self = shared_from_this(), sock, done](int err) {
+        self->Close(sock);
+        done(err, nullptr);
+      };
+      auto open = [ep = m_Endpoint, sock, done, fail](Address_t remote) {
+        sock->remote = remote;
+        if (ep->GetBestConvoTagFor(remote))
+        {
+          done(0, sock);
+          return;
+        }
+        ep->MarkAddressOutbound(remote);
+        const bool started = ep->EnsurePathTo(
+            remote,
+            [sock, done, fail](auto maybe_tag) {
+              if (maybe_tag)
+                done(0, sock);
+              else
+                fail(EHOSTUNREACH);
+            },
+            OpenTimeout);
+        if (not started)
+          fail(EHOSTUNREACH);
+      };
+      auto resolve = [ep = m_Endpoint, open, fail](std::string name) {
+        if (auto maybe = service::ParseAddress(name))
+          open(*maybe);
+        else if (service::NameIsValid(name))
+        {
+          ep->LookupNameAsync(name, [open, fail](auto maybe) {
+            if (maybe)
+              open(*maybe);
+            else
+              fail(EHOSTUNREACH);
+          });
+        }
+        else
+          fail(EINVAL);
+      };
+
+      if (port)
+      {
+        sock->remotePort = *port;
+        resolve(std::move(host));
+        return;
+      }
+      m_Endpoint->LookupServiceAsync(
+          host, "_" + service + "._udp", [sock, host, resolve, fail](auto records) {
+            const auto* best = BestSRV(records);
+            if (best == nullptr)
+            {
+              fail(EHOSTUNREACH);
+              return;
+            }
+            sock->remotePort = best->port;
+            // an empty target is the host we asked about
+            resolve(best->target.empty() ? host : best->target);
+          });
+    }
+
+    std::pair<int, EmbeddedUDP::Socket_ptr>
+    EmbeddedUDP::Bind(uint16_t port, std::string srv, std::optional<SockAddr> local)
+    {
+      if (port == 0)
+        return {EINVAL, nullptr};
+      auto sock = std::make_shared<Socket>();
+      sock->localPort = port;
+      sock->local = local;
+      if (not m_Ports.emplace(port, sock).second)
+        return {EADDRINUSE, nullptr};
+      if (not srv.empty())
+      {
+        sock->srv = "_" + srv + "._udp";
+        m_Endpoint->PutSRVRecord(dns::SRVData{sock->srv, 0, 1, port, ""});
+      }
+      return {0, sock};
+    }
+
+    void
+    EmbeddedUDP::Flush(const Socket_ptr& sock)
+    {
+      // clear first so a send racing with us queues another flush rather than being left behind
+      sock->flushQueued.clear();
+      sock->tx.drain([this, &sock](auto& dgram) { Send(sock, std::move(dgram)); }, RingSize);
+    }
+
+    void
+    EmbeddedUDP::Send(const Socket_ptr& sock, Datagram dgram)
+    {
+      if (auto tag = m_Endpoint->GetBestConvoTagFor(dgram.remote))
+      {
+        m_Endpoint->SendToOrQueue(
+            *tag, llarp_buffer_t{dgram.pkt.buf, dgram.pkt.sz}, service::ProtocolType::TrafficV4);
+      }
+      else
+        SendWhenReady(sock, std::move(dgram));
+    }
+
+    void
+    EmbeddedUDP::SendWhenReady(const Socket_ptr& sock, Datagram dgram)
+    {
+      const auto remote = dgram.remote;
+      auto [itr, isNew] = m_Pending.try_emplace(remote);
+      if (itr->second.size() >= RingSize)
+      {
+        sock->error = ENOBUFS;
+        return;
+      }
+      itr->second.emplace_back(sock, std::move(dgram));
+      if (not isNew)
+        return;
+      // the convo we had expired or never was, so get a path up again
+      m_Endpoint->MarkAddressOutbound(remote);
+      const bool started = m_Endpoint->EnsurePathTo(
+          remote,
+          [self = weak_from_this(), remote](auto maybe_tag) {
+            if (auto ptr = self.lock())
+              ptr->PathReady(remote, maybe_tag);
+          },
+          OpenTimeout);
+      if (not started)
+        PathReady(remote, std::nullopt);
+    }
+
+    void
+    EmbeddedUDP::PathReady(const Address_t& remote, std::optional<service::ConvoTag> maybe_tag)
+    {
+      auto itr = m_Pending.find(remote);
+      if (itr == m_Pending.end())
+        return;
+      auto pending = std::move(itr->second);
+      m_Pending.erase(itr);
+      for (auto& [sock, dgram] : pending)
+      {
+        if (maybe_tag)
+        {
+          m_Endpoint->SendToOrQueue(
+              *maybe_tag,
+              llarp_buffer_t{dgram.pkt.buf, dgram.pkt.sz},
+              service::ProtocolType::TrafficV4);
+        }
+        else
+          sock->error = EHOSTUNREACH;
+      }
+    }
+
+    void
+    EmbeddedUDP::SendFromLocal(
+        const Socket_ptr& sock, Address_t remote, uint16_t port, const llarp_buffer_t& payload)
+    {
+      auto pkt = UDPPacket(sock->localPort, port, payload);
+      if (pkt.sz == 0)
+        return;
+      Send(sock, Datagram{std::move(remote), std::move(pkt)});
+    }
+
+    void
+    EmbeddedUDP::RelayToLocal(const Socket_ptr& sock, Address_t from, net::IPPacket pkt)
+    {
+      const auto offset = UDPPayloadOffset(pkt);
+      const llarp_buffer_t payload{pkt.buf + offset, pkt.sz - offset};
+      if (sock->listener)
+      {
+        // nobody to give it to until the app sends us something
+        if (sock->app)
+          sock->listener->send(*sock->app, payload);
+        return;
+      }
+      const auto port = UDPSrcPort(pkt);
+      auto& relay = sock->relays[from][port];
+      if (relay.udp == nullptr)
+      {
+        relay.udp = m_Endpoint->Loop()->make_udp(
+            [self = weak_from_this(), weak = std::weak_ptr<Socket>{sock}, from, port](
+                auto&, SockAddr src, const llarp_buffer_t& buf) {
+              auto ptr = self.lock();
+              auto strong = weak.lock();
+              // only what local says back goes out
+              if (not ptr or not strong or not (src == *strong->local))
+                return;
+              if (auto itr = strong->relays.find(from); itr != strong->relays.end())
+              {
+                if (auto relay = itr->second.find(port); relay != itr->second.end())
+                  relay->second.lastActive = ptr->m_Endpoint->Loop()->time_now();
+              }
+              ptr->SendFromLocal(strong, from, port, buf);
+            });
+        SockAddr addr = *sock->local;
+        addr.setPort(0);
+        if (not relay.udp->listen(addr))
+        {
+          sock->relays[from].erase(port);
+          return;
+        }
+        if (not m_ExpiringRelays)
+        {
+          m_ExpiringRelays = true;
+          ExpireRelaysLater();
+        }
+      }
+      relay.lastActive = m_Endpoint->Loop()->time_now();
+      relay.udp->send(*sock->local, payload);
+    }
+
+    void
+    EmbeddedUDP::ExpireRelays()
+    {
+      const auto now = m_Endpoint->Loop()->time_now();
+      bool any = false;
+      for (auto& [port, sock] : m_Ports)
+      {
+        for (auto itr = sock->relays.begin(); itr != sock->relays.end();)
+        {
+          auto& byPort = itr->second;
+          for (auto relay = byPort.begin(); relay != byPort.end();)
+          {
+            if (now - relay->second.lastActive >= RelayTimeout)
+            {
+              relay->second.udp->close();
+              relay = byPort.erase(relay);
+            }
+            else
+              ++relay;
+          }
+          if (byPort.empty())
+            itr = sock->relays.erase(itr);
+          else
+            ++itr;
+        }
+        if (not sock->relays.empty())
+          any = true;
+      }
+      m_ExpiringRelays = any;
+      if (any)
+        ExpireRelaysLater();
+    }
+
+    void
+    EmbeddedUDP::ExpireRelaysLater()
+    {
+      m_Endpoint->Loop()->call_later(RelayTimeout / 4, [self = weak_from_this()]() {
+        if (auto ptr = self.lock())
+          ptr->ExpireRelays();
+      });
+    }
+
+    void
+    EmbeddedUDP::Close(const Socket_ptr& sock)
+    {
+      if (auto itr = m_Ports.find(sock->localPort); itr != m_Ports.end() and itr->second == sock)
+        m_Ports.erase(itr);
+      // the remote stays in m_Pending so we don't ask for a path again while one is coming
+      for (auto& [remote, pending] : m_Pending)
+      {
+        pending.erase(
+            std::remove_if(
+                pending.begin(),
+                pending.end(),
+                [&sock](const auto& item) { return item.first == sock; }),
+            pending.end());
+      }
+      if (sock->listener)
+        sock->listener->close();
+      for (auto& [remote, byPort] : sock->relays)
+      {
+        for (auto& [port, relay] : byPort)
+          relay.udp->close();
+      }
+      sock->relays.clear();
+      if (sock->srv.empty())
+        return;
+      m_Endpoint->DelSRVRecordIf([sock](const auto& srv) {
+        return srv.service_proto == sock->srv and srv.port == sock->localPort;
+      });
+    }
+
+    std::optional<uint16_t>
+    EmbeddedUDP::EphemeralPort()
+    {
+      constexpr uint16_t range = 65535 - EphemeralPorts + 1;
+      for (uint16_t tries = 0; tries < range; ++tries)
+      {
+        const uint16_t port = EphemeralPorts + (m_NextPort++ % range);
+        if (m_Ports.count(port) == 0)
+          return port;
+      }
+      return std::nullopt;
+    }
+  }  // namespace handlers
+}  // namespace llarp
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <llarp/endpoint_base.hpp>
+#include <llarp/ev/udp_handle.hpp>
+#include <llarp/net/ip_packet.hpp>
+#include <llarp/net/sock_addr.hpp>
+#include <llarp/util/thread/mpsc_queue.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace handlers
+  {
+    /// the udp sockets behind the embedded lokinet_udp_* api.  datagrams go over an endpoint as
+    /// TrafficV4 ipv4/udp packets with zeroed addresses, the same as a tun endpoint on the other
+    /// side sends and expects.
+    ///
+    /// everything here runs on the endpoint's event loop except the constructor and what is
+    /// marked otherwise on Socket.
+    class EmbeddedUDP : public std::enable_shared_from_this<EmbeddedUDP>
+    {
+     public:
+      using Address_t = EndpointBase::AddressVariant_t;
+
+      static constexpr size_t RingSize = 1024;
+      static constexpr llarp_time_t OpenTimeout = 10s;
+      /// where the ports for established flows come from
+      static constexpr uint16_t EphemeralPorts = 49152;
+      /// how long a bound socket keeps relaying for a remote that went quiet
+      static constexpr llarp_time_t RelayTimeout = 2min;
+
+      struct Datagram
+      {
+        Address_t remote;
+        net::IPPacket pkt;
+      };
+
+      /// one socket.  rx is filled on the event loop and drained by the one caller thread reading
+      /// the socket, tx is filled by any caller thread and drained on the event loop, so neither
+      /// side takes a lock per packet.
+      struct Socket
+      {
+        /// set for an established flow, we only talk to this remote on remotePort.  set before
+        /// the socket is handed out and never changed after.
+        std::optional<Address_t> remote;
+        uint16_t localPort = 0;
+        uint16_t remotePort = 0;
+        /// the srv record we put up for a bound socket, if any
+        std::string srv;
+        /// when set, datagrams are relayed to and from this local udp address instead of going
+        /// through rx and tx.  set before the socket is handed out and never changed after.
+        std::optional<SockAddr> local;
+
+        thread::MPSCQueue<Datagram> rx{RingSize};
+        thread::MPSCQueue<Datagram> tx{RingSize};
+
+        /// any thread: queue a datagram with payload to port on remote, or to our remote for an
+        /// established flow.  returns 0 or an errno.
+        int
+        Queue(std::optional<Address_t> to, uint16_t port, const llarp_buffer_t& payload);
+
+        /// any thread: true if the caller must have Flush run on the event loop for what it
+        /// queued, false if a flush is already on its way
+        bool
+        WantFlush()
+        {
+          return not flushQueued.test_and_set();
+        }
+
+        /// any thread: for when the flush the caller wanted can not be run after all
+        void
+        CancelFlush()
+        {
+          flushQueued.clear();
+        }
+
+        /// any thread: the errno of datagrams sent earlier that could not go out, or 0, and clear
+        /// it
+        int
+        TakeError()
+        {
+          return error.exchange(0);
+        }
+
+       private:
+        friend class EmbeddedUDP;
+
+        /// set while a call to flush tx is queued on the event loop
+        std::atomic_flag flushQueued = ATOMIC_FLAG_INIT;
+        std::atomic<int> error{0};
+
+        struct Relay
+        {
+          std::shared_ptr<UDPHandle> udp;
+          llarp_time_t lastActive = 0s;
+        };
+
+        /// the rest is only touched on the event loop.
+        /// an established flow listens on local and replies to whoever last sent to it there
+        std::shared_ptr<UDPHandle> listener;
+        std::optional<SockAddr> app;
+        /// a bound socket talks to local from a handle of its own for each remote and port, so
+        /// local can tell them apart and its replies go back to the right one
+        std::unordered_map<Address_t, std::unordered_map<uint16_t, Relay>> relays;
+      };
+
+      using Socket_ptr = std::shared_ptr<Socket>;
+
+      /// onReadable is called after datagrams are put on a socket's rx ring
+      EmbeddedUDP(std::shared_ptr<EndpointBase> ep, std::function<void()> onReadable);
+
+      /// handle inbound TrafficV4 from the endpoint, false if no socket wants it
+      bool
+      HandleTraffic(service::ConvoTag tag, net::IPPacket pkt);
+
+      /// open a flow to host, a .loki or .snode address or an ons name.  service is a port
+      /// number, or a name we look up the `_service._udp` srv records of on host for the port
+      /// (and target) to use.  with local set we listen there and relay what is sent to it.
+      /// calls done with 0 and the socket or an errno and nullptr.
+      void
+      Establish(
+          std::string host,
+          std::string service,
+          std::optional<SockAddr> local,
+          std::function<void(int, Socket_ptr)> done);
+
+      /// take port for inbound datagrams, and if srv is not empty put up an srv record
+      /// `_srv._udp` for it.  with local set inbound datagrams are relayed there.  returns 0 and
+      /// the socket or an errno and nullptr.
+      std::pair<int, Socket_ptr>
+      Bind(uint16_t port, std::string srv, std::optional<SockAddr> local);
+
+      /// send what was queued on sock.  datagrams to a remote we have no convo with wait for a
+      /// path to it; if none comes up they are dropped and the socket's error is set.
+      void
+      Flush(const Socket_ptr& sock);
+
+      /// give up sock's port, srv record and local handles, and drop what it has waiting for a
+      /// path
+      void
+      Close(const Socket_ptr& sock);
+
+     private:
+      void
+      Send(const Socket_ptr& sock, Datagram dgram);
+
+      void
+      SendWhenReady(const Socket_ptr& sock, Datagram dgram);
+
+      /// send payload that came in on sock's local side to port on remote
+      void
+      SendFromLocal(
+          const Socket_ptr& sock, Address_t remote, uint16_t port, const llarp_buffer_t& payload);
+
+      /// hand an inbound datagram for sock to its local address
+      void
+      RelayToLocal(const Socket_ptr& sock, Address_t from, net::IPPacket pkt);
+
+      /// close relays that went quiet, and check again later while there are any left
+      void
+      ExpireRelays();
+
+      void
+      ExpireRelaysLater();
+
+      void
+      PathReady(const Address_t& remote, std::optional<service::ConvoTag> maybe_tag);
+
+      /// a port no other socket has
+      std::optional<uint16_t>
+      EphemeralPort();
+
+      const std::shared_ptr<EndpointBase> m_Endpoint;
+      const std::function<void()> m_OnReadable;
+      std::unordered_map<uint16_t, Socket_ptr> m_Ports;
+      /// datagrams waiting on a path to their remote, a remote is in here while we wait for it
+      std::unordered_map<Address_t, std::vector<std::pair<Socket_ptr, Datagram>>> m_Pending;
+      uint16_t m_NextPort = 0;
+      /// set while an ExpireRelays is queued
+      bool m_ExpiringRelays = false;
+    };
+  }  // namespace handlers
+}  // namespace llarp
@@ -234,10 +234,10 @@ namespace llarp
         }
         else
         {
-          auto itr = m_IPToKey.find(ip);
-          if (itr != m_IPToKey.end() && m_SNodeKeys.find(itr->second) != m_SNodeKeys.end())
+          const auto* flow = m_Flows.FindByIP(ip);
+          if (flow && m_SNodeKeys.find(flow->remote) != m_SNodeKeys.end())
           {
-            RouterID them = itr->second;
+            RouterID them = flow->remote;
             msg.AddAReply(them.ToString());
           }
           else
@@ -303,9 +303,10 @@ namespace llarp
                 r,
                 [&, msg = std::make_shared<dns::Message>(msg), reply](
                     std::shared_ptr<exit::BaseSession> session) {
-                  if (session && session->IsReady())
+                  const auto* flow = m_Flows.FindByRemote(pubKey);
+                  if (session && session->IsReady() && flow)
                   {
-                    msg->AddINReply(m_KeyToIP[pubKey], isV6);
+                    msg->AddINReply(flow->ip, isV6);
                   }
                   else
                   {
@@ -318,10 +319,9 @@ namespace llarp
           else
           {
             // we have it mapped already as a service node
-            auto itr = m_KeyToIP.find(pubKey);
-            if (itr != m_KeyToIP.end())
+            if (const auto* flow = m_Flows.FindByRemote(pubKey))
             {
-              ip = itr->second;
+              ip = flow->ip;
               msg.AddINReply(ip, isV6);
             }
             else  // fallback case that should never happen (probably)
@@ -375,14 +375,14 @@ namespace llarp
       m_InetToNetwork.Process([&](Pkt_t& pkt) {
         PubKey pk;
         {
-          auto itr = m_IPToKey.find(pkt.dstv6());
-          if (itr == m_IPToKey.end())
+          const auto* flow = m_Flows.FindByIP(pkt.dstv6());
+          if (flow == nullptr)
           {
             // drop
             LogWarn(Name(), " dropping packet, has no session at ", pkt.dstv6());
             return;
           }
-          pk = itr->second;
+          pk = flow->remote;
         }
         // check if this key is a service node
         if (m_SNodeKeys.count(pk))
@@ -442,6 +442,8 @@ namespace llarp
           ++itr;
         }
       }
+      if (m_NetIf and not m_NetworkToInet.empty())
+        m_NetIf->WritePackets(m_NetworkToInet);
       m_Router->PumpLL();
     }
 
@@ -451,14 +453,15 @@ namespace llarp
       // map our address
       const PubKey us(m_Router->pubkey());
       const huint128_t ip = GetIfAddr();
-      m_KeyToIP[us] = ip;
-      m_IPToKey[ip] = us;
-      m_IPActivity[ip] = std::numeric_limits<llarp_time_t>::max();
+      m_Flows.Map(ip, us, true, GetRouter()->Now());
+      m_Flows.Pin(ip);
       m_SNodeKeys.insert(us);
       if (m_ShouldInitTun)
       {
         vpn::InterfaceInfo info;
         info.ifname = m_ifname;
+        info.queues = m_tunQueues;
+        info.offload = m_tunOffload;
         info.addrs.emplace(m_OurRange);
 
         m_NetIf = GetRouter()->GetVPNPlatform()->ObtainInterface(std::move(info));
@@ -514,37 +517,24 @@ namespace llarp
     bool
     ExitEndpoint::HasLocalMappedAddrFor(const PubKey& pk) const
     {
-      return m_KeyToIP.find(pk) != m_KeyToIP.end();
+      return m_Flows.FindByRemote(pk) != nullptr;
     }
 
     huint128_t
     ExitEndpoint::GetIPForIdent(const PubKey pk)
     {
       huint128_t found{};
-      if (!HasLocalMappedAddrFor(pk))
+      if (const auto* flow = m_Flows.FindByRemote(pk))
+        found = flow->ip;
+      else
       {
         // allocate and map
         found = AllocateNewAddress();
-        if (!m_KeyToIP.emplace(pk, found).second)
-        {
-          LogError(Name(), "failed to map ", pk, " to ", found);
-          return found;
-        }
-        if (!m_IPToKey.emplace(found, pk).second)
-        {
-          LogError(Name(), "failed to map ", found, " to ", pk);
-          return found;
-        }
-        if (HasLocalMappedAddrFor(pk))
-          LogInfo(Name(), " mapping ", pk, " to ", found);
-        else
-          LogError(Name(), "failed to map ", pk, " to ", found);
+        m_Flows.Map(found, pk, false, GetRouter()->Now());
+        LogInfo(Name(), " mapping ", pk, " to ", found);
       }
-      else
-        found = m_KeyToIP[pk];
 
       MarkIPActive(found);
-      m_KeyToIP.rehash(0);
       assert(HasLocalMappedAddrFor(pk));
       return found;
     }
@@ -556,21 +546,16 @@ namespace llarp
         return ++m_NextAddr;
 
       // find oldest activity ip address
-      huint128_t found = {0};
-      llarp_time_t min = std::numeric_limits<llarp_time_t>::max();
-      auto itr = m_IPActivity.begin();
-      while (itr != m_IPActivity.end())
+      const auto* oldest = m_Flows.Oldest();
+      if (oldest == nullptr)
       {
-        if (itr->second < min)
-        {
-          found.h = itr->first.h;
-          min = itr->second;
-        }
-        ++itr;
+        LogError(Name(), " has no address left to reclaim");
+        return huint128_t{0};
       }
+      const huint128_t found = oldest->ip;
       // kick old ident off exit
       // TODO: DoS
-      PubKey pk = m_IPToKey[found];
+      const PubKey pk = oldest->remote;
       KickIdentOffExit(pk);
 
       return found;
@@ -630,16 +615,23 @@ namespace llarp
     bool
     ExitEndpoint::QueueOutboundTraffic(net::IPPacket pkt)
     {
-      return m_NetIf && m_NetIf->WritePacket(std::move(pkt));
+      if (not m_NetIf)
+        return false;
+      // the interface is not keeping up, drop it here so the transit hop sees the failed write
+      if (m_NetworkToInet.size() >= MaxNetworkToInet)
+        return false;
+      m_NetworkToInet.emplace_back(std::move(pkt));
+      return true;
     }
 
     void
     ExitEndpoint::KickIdentOffExit(const PubKey& pk)
     {
       LogInfo(Name(), " kicking ", pk, " off exit");
-      huint128_t ip = m_KeyToIP[pk];
-      m_KeyToIP.erase(pk);
-      m_IPToKey.erase(ip);
+      // the address is free to be handed to someone else now
+      if (const auto* flow = m_Flows.FindByRemote(pk))
+        m_Resolver->ForgetCachedAnswers(flow->ip);
+      m_Flows.EraseRemote(pk);
       auto range = m_ActiveExits.equal_range(pk);
       auto exit_itr = range.first;
       while (exit_itr != range.second)
@@ -649,7 +641,7 @@ namespace llarp
     void
     ExitEndpoint::MarkIPActive(huint128_t ip)
     {
-      m_IPActivity[ip] = GetRouter()->Now();
+      m_Flows.Touch(ip, GetRouter()->Now());
     }
 
     void
@@ -669,7 +661,7 @@ namespace llarp
         pkt.UpdateIPv6Address(from, m_IfAddr);
       else
         pkt.UpdateIPv4Address(xhtonl(net::TruncateV6(from)), xhtonl(net::TruncateV6(m_IfAddr)));
-      return m_NetIf and m_NetIf->WritePacket(std::move(pkt));
+      return QueueOutboundTraffic(std::move(pkt));
     }
 
     exit::Endpoint*
@@ -748,6 +740,8 @@ namespace llarp
       m_UseV6 = not m_OurRange.IsV4();
 
       m_ifname = networkConfig.m_ifname;
+      m_tunQueues = networkConfig.m_tunQueues;
+      m_tunOffload = networkConfig.m_tunOffload;
       if (m_ifname.empty())
       {
         const auto maybe = llarp::FindFreeTun();
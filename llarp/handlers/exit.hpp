@@ -3,6 +3,7 @@
 #include <llarp/exit/endpoint.hpp>
 #include "tun.hpp"
 #include <llarp/dns/server.hpp>
+#include <llarp/net/flow_table.hpp>
 #include <unordered_map>
 
 namespace llarp
@@ -120,6 +121,7 @@ namespace llarp
       void
       RemoveExit(const exit::Endpoint* ep);
 
+      /// queue a packet for the interface, it goes out on the next Flush
       bool
       QueueOutboundTraffic(net::IPPacket pkt);
 
@@ -186,10 +188,6 @@ namespace llarp
 
       std::unordered_multimap<PubKey, std::unique_ptr<exit::Endpoint>> m_ActiveExits;
 
-      using KeyMap_t = std::unordered_map<PubKey, huint128_t>;
-
-      KeyMap_t m_KeyToIP;
-
       using SNodes_t = std::set<PubKey>;
       /// set of pubkeys we treat as snodes
       SNodes_t m_SNodeKeys;
@@ -198,7 +196,8 @@ namespace llarp
       /// snode sessions we are talking to directly
       SNodeSessions_t m_SNodeSessions;
 
-      std::unordered_map<huint128_t, PubKey> m_IPToKey;
+      /// the ips we handed out to keys and when they were last active
+      net::FlowTable<PubKey> m_Flows;
 
       huint128_t m_IfAddr;
       huint128_t m_HigestAddr;
@@ -206,8 +205,8 @@ namespace llarp
       huint128_t m_NextAddr;
       IPRange m_OurRange;
       std::string m_ifname;
-
-      std::unordered_map<huint128_t, llarp_time_t> m_IPActivity;
+      size_t m_tunQueues = 1;
+      bool m_tunOffload = false;
 
       std::shared_ptr<vpn::NetworkInterface> m_NetIf;
 
@@ -228,6 +227,11 @@ namespace llarp
 
       /// internet to llarp packet queue
       PacketQueue_t m_InetToNetwork;
+      /// llarp to internet packets, written to the interface at once on Flush
+      std::vector<net::IPPacket> m_NetworkToInet;
+      /// how many packets m_NetworkToInet holds before QueueOutboundTraffic drops them, as many as
+      /// m_InetToNetwork holds going the other way
+      static constexpr size_t MaxNetworkToInet = 1024;
       bool m_UseV6;
     };
   }  // namespace handlers
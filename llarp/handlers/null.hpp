@@ -5,6 +5,9 @@
 #include <llarp/quic/tunnel.hpp>
 #include <llarp/router/abstractrouter.hpp>
 #include <llarp/ev/ev.hpp>
+#include <llarp/net/ip_packet.hpp>
+
+#include <functional>
 
 namespace llarp
 {
@@ -31,6 +34,13 @@ namespace llarp
         {
           return true;
         }
+        if (t == service::ProtocolType::TrafficV4 and m_TrafficHandler)
+        {
+          net::IPPacket pkt;
+          if (not pkt.Load(buf))
+            return false;
+          return m_TrafficHandler(tag, std::move(pkt));
+        }
         if (t != service::ProtocolType::QUIC)
           return false;
 
@@ -49,6 +59,14 @@ namespace llarp
         return true;
       }
 
+      /// hand inbound ipv4 traffic to handler instead of dropping it, for the embedded udp api.
+      /// called on the event loop.
+      void
+      SetTrafficHandler(std::function<bool(service::ConvoTag, net::IPPacket)> handler)
+      {
+        m_TrafficHandler = std::move(handler);
+      }
+
       std::string
       GetIfName() const override
       {
@@ -86,6 +104,9 @@ namespace llarp
       {
         return std::nullopt;
       }
+
+     private:
+      std::function<bool(service::ConvoTag, net::IPPacket)> m_TrafficHandler;
     };
   }  // namespace handlers
 }  // namespace llarp
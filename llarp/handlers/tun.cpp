@@ -130,19 +130,17 @@ namespace llarp
       obj["ustreamResolvers"] = resolvers;
       obj["localResolver"] = m_LocalResolverAddr.toString();
       util::StatusObject ips{};
-      for (const auto& item : m_IPActivity)
-      {
-        util::StatusObject ipObj{{"lastActive", to_json(item.second)}};
+      m_Flows.ForEach([&ips](const auto& flow) {
+        util::StatusObject ipObj{{"lastActive", to_json(flow.lastActive)}};
         std::string remoteStr;
-        AlignedBuffer<32> addr = m_IPToAddr.at(item.first);
-        if (m_SNodes.at(addr))
-          remoteStr = RouterID(addr.as_array()).ToString();
+        if (flow.snode)
+          remoteStr = RouterID(flow.remote.as_array()).ToString();
         else
-          remoteStr = service::Address(addr.as_array()).ToString();
+          remoteStr = service::Address(flow.remote.as_array()).ToString();
         ipObj["remote"] = remoteStr;
-        std::string ipaddr = item.first.ToString();
+        std::string ipaddr = flow.ip.ToString();
         ips[ipaddr] = ipObj;
-      }
+      });
       obj["addrs"] = ips;
       obj["ourIP"] = m_OurIP.ToString();
       obj["nextIP"] = m_NextIP.ToString();
@@ -197,6 +195,8 @@ namespace llarp
       }
 
       m_TrafficPolicy = conf.m_TrafficPolicy;
+      if (m_TrafficPolicy)
+        m_CompiledTrafficPolicy.emplace(*m_TrafficPolicy);
       m_OwnedRanges = conf.m_OwnedRanges;
 
       m_LocalResolverAddr = dnsConf.m_bind;
@@ -219,6 +219,8 @@ namespace llarp
       }
 
       m_IfName = conf.m_ifname;
+      m_TunQueues = conf.m_tunQueues;
+      m_TunOffload = conf.m_tunOffload;
       if (m_IfName.empty())
       {
         const auto maybe = llarp::FindFreeTun();
@@ -319,16 +321,12 @@ namespace llarp
               }
               if (const auto* loki = std::get_if<service::Address>(&addr))
               {
-                m_IPToAddr.emplace(ip, loki->data());
-                m_AddrToIP.emplace(loki->data(), ip);
-                m_SNodes[*loki] = false;
+                m_Flows.Map(ip, *loki, false, Now());
                 LogInfo(Name(), " remapped ", ip, " to ", *loki);
               }
               if (const auto* snode = std::get_if<RouterID>(&addr))
               {
-                m_IPToAddr.emplace(ip, snode->data());
-                m_AddrToIP.emplace(snode->data(), ip);
-                m_SNodes[*snode] = true;
+                m_Flows.Map(ip, *snode, true, Now());
                 LogInfo(Name(), " remapped ", ip, " to ", *snode);
               }
               if (m_NextIP < ip)
@@ -358,7 +356,7 @@ namespace llarp
     bool
     TunEndpoint::HasLocalIP(const huint128_t& ip) const
     {
-      return m_IPToAddr.find(ip) != m_IPToAddr.end();
+      return m_Flows.FindByIP(ip) != nullptr;
     }
 
     void
@@ -375,9 +373,12 @@ namespace llarp
       // flush network to user
       while (not m_NetworkToUserPktQueue.empty())
       {
-        m_NetIf->WritePacket(m_NetworkToUserPktQueue.top().pkt);
-        m_NetworkToUserPktQueue.pop();
+        std::pop_heap(m_NetworkToUserPktQueue.begin(), m_NetworkToUserPktQueue.end());
+        m_WriteBatch.emplace_back(std::move(m_NetworkToUserPktQueue.back().pkt));
+        m_NetworkToUserPktQueue.pop_back();
       }
+      if (not m_WriteBatch.empty())
+        m_NetIf->WritePackets(m_WriteBatch);
     }
 
     static bool
@@ -405,13 +406,13 @@ namespace llarp
     std::optional<std::variant<service::Address, RouterID>>
     TunEndpoint::ObtainAddrForIP(huint128_t ip) const
     {
-      auto itr = m_IPToAddr.find(ip);
-      if (itr == m_IPToAddr.end())
+      const auto* flow = m_Flows.FindByIP(ip);
+      if (flow == nullptr)
         return std::nullopt;
-      if (m_SNodes.at(itr->second))
-        return RouterID{itr->second.as_array()};
+      if (flow->snode)
+        return RouterID{flow->remote.as_array()};
       else
-        return service::Address{itr->second.as_array()};
+        return service::Address{flow->remote.as_array()};
     }
 
     bool
@@ -842,18 +843,16 @@ namespace llarp
     bool
     TunEndpoint::MapAddress(const service::Address& addr, huint128_t ip, bool SNode)
     {
-      auto itr = m_IPToAddr.find(ip);
-      if (itr != m_IPToAddr.end())
+      if (const auto* flow = m_Flows.FindByIP(ip))
       {
         llarp::LogWarn(
-            ip, " already mapped to ", service::Address(itr->second.as_array()).ToString());
+            ip, " already mapped to ", service::Address(flow->remote.as_array()).ToString());
         return false;
       }
       llarp::LogInfo(Name() + " map ", addr.ToString(), " to ", ip);
 
-      m_IPToAddr[ip] = addr;
-      m_AddrToIP[addr] = ip;
-      m_SNodes[addr] = SNode;
+      m_Flows.Map(ip, addr, SNode, Now());
+      ForgetCachedAnswers(ip);
       MarkIPActiveForever(ip);
       MarkAddressOutbound(addr);
       return true;
@@ -914,6 +913,8 @@ namespace llarp
       }
 
       info.ifname = m_IfName;
+      info.queues = m_TunQueues;
+      info.offload = m_TunOffload;
       info.dnsaddr.FromString(m_LocalResolverAddr.toHost());
 
       LogInfo(Name(), " setting up network...");
@@ -1017,15 +1018,14 @@ namespace llarp
         if (auto maybe = util::OpenFileStream<fs::ofstream>(file, std::ios_base::binary))
         {
           std::map<std::string, std::string> addrmap;
-          for (const auto& [ip, addr] : m_IPToAddr)
-          {
-            if (not m_SNodes.at(addr))
+          m_Flows.ForEach([&](const auto& flow) {
+            if (not flow.snode)
             {
-              const service::Address a{addr.as_array()};
+              const service::Address a{flow.remote.as_array()};
               if (HasInboundConvo(a))
-                addrmap[ip.ToString()] = a.ToString();
+                addrmap[flow.ip.ToString()] = a.ToString();
             }
-          }
+          });
           const auto data = oxenmq::bt_serialize(addrmap);
           maybe->write(data.data(), data.size());
         }
@@ -1060,12 +1060,12 @@ namespace llarp
         if (dst == ipv6_multicast_all_nodes and m_state->m_ExitEnabled)
         {
           // send ipv6 multicast
-          for (const auto& [ip, addr] : m_IPToAddr)
-          {
-            (void)ip;
+          m_Flows.ForEach([&](const auto& flow) {
             SendToOrQueue(
-                service::Address{addr.as_array()}, pkt.ConstBuffer(), service::ProtocolType::Exit);
-          }
+                service::Address{flow.remote.as_array()},
+                pkt.ConstBuffer(),
+                service::ProtocolType::Exit);
+          });
           return;
         }
 
@@ -1074,8 +1074,8 @@ namespace llarp
         {
           dst = net::ExpandV4(net::TruncateV6(dst));
         }
-        auto itr = m_IPToAddr.find(dst);
-        if (itr == m_IPToAddr.end())
+        const auto* flow = m_Flows.FindByIP(dst);
+        if (flow == nullptr)
         {
           // find all ranges that match the destination ip
           const auto exitEntries = m_ExitMap.FindAllEntries(dst);
@@ -1122,14 +1122,14 @@ namespace llarp
         }
         std::variant<service::Address, RouterID> to;
         service::ProtocolType type;
-        if (m_SNodes.at(itr->second))
+        if (flow->snode)
         {
-          to = RouterID{itr->second.as_array()};
+          to = RouterID{flow->remote.as_array()};
           type = service::ProtocolType::TrafficV4;
         }
         else
         {
-          to = service::Address{itr->second.as_array()};
+          to = service::Address{flow->remote.as_array()};
           type = m_state->m_ExitEnabled and src != m_OurIP ? service::ProtocolType::Exit
                                                            : pkt.ServiceProtocol();
         }
@@ -1187,12 +1187,8 @@ namespace llarp
     bool
     TunEndpoint::ShouldAllowTraffic(const net::IPPacket& pkt) const
     {
-      if (const auto exitPolicy = GetExitPolicy())
-      {
-        if (not exitPolicy->AllowsTraffic(pkt))
-          return false;
-      }
-
+      if (m_CompiledTrafficPolicy)
+        return m_CompiledTrafficPolicy->AllowsTraffic(pkt);
       return true;
     }
 
@@ -1334,7 +1330,8 @@ namespace llarp
       {
         pkt.UpdateIPv6Address(src, dst);
       }
-      m_NetworkToUserPktQueue.push(std::move(write));
+      m_NetworkToUserPktQueue.push_back(std::move(write));
+      std::push_heap(m_NetworkToUserPktQueue.begin(), m_NetworkToUserPktQueue.end());
       // wake up packet flushing event so we ensure that all packets are written to user
       m_PacketSendWaker->Trigger();
       return true;
@@ -1361,15 +1358,13 @@ namespace llarp
         snode = true;
       }
 
+      // previously allocated address
+      if (const auto* flow = m_Flows.FindByRemote(ident))
       {
-        // previously allocated address
-        auto itr = m_AddrToIP.find(ident);
-        if (itr != m_AddrToIP.end())
-        {
-          // mark ip active
-          MarkIPActive(itr->second);
-          return itr->second;
-        }
+        // mark ip active
+        const auto ip = flow->ip;
+        MarkIPActive(ip);
+        return ip;
       }
       // allocate new address
       if (m_NextIP < m_MaxIP)
@@ -1377,12 +1372,10 @@ namespace llarp
         do
         {
           nextIP = ++m_NextIP;
-        } while (m_IPToAddr.find(nextIP) != m_IPToAddr.end() && m_NextIP < m_MaxIP);
+        } while (m_Flows.FindByIP(nextIP) != nullptr && m_NextIP < m_MaxIP);
         if (nextIP < m_MaxIP)
         {
-          m_AddrToIP[ident] = nextIP;
-          m_IPToAddr[nextIP] = ident;
-          m_SNodes[ident] = snode;
+          m_Flows.Map(nextIP, ident, snode, now);
           var::visit(
               [&](auto&& remote) { llarp::LogInfo(Name(), " mapped ", remote, " to ", nextIP); },
               addr);
@@ -1394,51 +1387,50 @@ namespace llarp
       // we are full
       // expire least active ip
       // TODO: prevent DoS
-      std::pair<huint128_t, llarp_time_t> oldest = {huint128_t{0}, 0s};
-
-      // find oldest entry
-      auto itr = m_IPActivity.begin();
-      while (itr != m_IPActivity.end())
+      const auto* oldest = m_Flows.Oldest();
+      if (oldest == nullptr)
       {
-        if (itr->second <= now)
-        {
-          if ((now - itr->second) > oldest.second)
-          {
-            oldest.first = itr->first;
-            oldest.second = itr->second;
-          }
-        }
-        ++itr;
+        LogError(Name(), " has no address left to reclaim");
+        return nextIP;
       }
-      // remap address
-      m_IPToAddr[oldest.first] = ident;
-      m_AddrToIP[ident] = oldest.first;
-      m_SNodes[ident] = snode;
-      nextIP = oldest.first;
+      // remap address, which marks it active
+      nextIP = oldest->ip;
+      m_Flows.Map(nextIP, ident, snode, now);
+      ForgetCachedAnswers(nextIP);
+      return nextIP;
+    }
 
-      // mark ip active
-      m_IPActivity[nextIP] = std::max(m_IPActivity[nextIP], now);
+    void
+    TunEndpoint::ForgetCachedAnswers(huint128_t ip)
+    {
+      if (m_Resolver)
+        m_Resolver->ForgetCachedAnswers(ip);
+    }
 
-      return nextIP;
+    void
+    TunEndpoint::ExitMapChanged()
+    {
+      if (m_Resolver)
+        m_Resolver->ClearCachedAnswers();
     }
 
     bool
     TunEndpoint::HasRemoteForIP(huint128_t ip) const
     {
-      return m_IPToAddr.find(ip) != m_IPToAddr.end();
+      return m_Flows.FindByIP(ip) != nullptr;
     }
 
     void
     TunEndpoint::MarkIPActive(huint128_t ip)
     {
       llarp::LogDebug(Name(), " address ", ip, " is active");
-      m_IPActivity[ip] = std::max(Now(), m_IPActivity[ip]);
+      m_Flows.Touch(ip, Now());
     }
 
     void
     TunEndpoint::MarkIPActiveForever(huint128_t ip)
     {
-      m_IPActivity[ip] = std::numeric_limits<llarp_time_t>::max();
+      m_Flows.Pin(ip);
     }
 
     void
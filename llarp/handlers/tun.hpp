@@ -3,6 +3,7 @@
 #include <llarp/dns/server.hpp>
 #include <llarp/ev/ev.hpp>
 #include <llarp/ev/vpn.hpp>
+#include <llarp/net/flow_table.hpp>
 #include <llarp/net/ip.hpp>
 #include <llarp/net/ip_packet.hpp>
 #include <llarp/net/net.hpp>
@@ -165,7 +166,7 @@ namespace llarp
       bool
       HasAddress(const AlignedBuffer<32>& addr) const
       {
-        return m_AddrToIP.find(addr) != m_AddrToIP.end();
+        return m_Flows.FindByRemote(addr) != nullptr;
       }
 
       /// get ip address for key unconditionally
@@ -202,8 +203,10 @@ namespace llarp
         }
       };
 
-      /// queue for sending packets to user from network
-      std::priority_queue<WritePacket> m_NetworkToUserPktQueue;
+      /// queue for sending packets to user from network, a heap with the oldest on top
+      std::vector<WritePacket> m_NetworkToUserPktQueue;
+      /// the packets FlushWrite hands to the interface at once
+      std::vector<net::IPPacket> m_WriteBatch;
       /// return true if we have a remote loki address for this ip address
       bool
       HasRemoteForIP(huint128_t ipv4) const;
@@ -216,6 +219,13 @@ namespace llarp
       void
       MarkIPActiveForever(huint128_t ip);
 
+      /// drop cached dns answers handing out ip, which now maps to something else
+      void
+      ForgetCachedAnswers(huint128_t ip);
+
+      void
+      ExitMapChanged() override;
+
       /// flush ip packets
       virtual void
       FlushSend();
@@ -224,14 +234,9 @@ namespace llarp
       void
       FlushWrite();
 
-      /// maps ip to key (host byte order)
-      std::unordered_map<huint128_t, AlignedBuffer<32>> m_IPToAddr;
-      /// maps key to ip (host byte order)
-      std::unordered_map<AlignedBuffer<32>, huint128_t> m_AddrToIP;
-
-      /// maps key to true if key is a service node, maps key to false if key is
-      /// a hidden service
-      std::unordered_map<AlignedBuffer<32>, bool> m_SNodes;
+      /// the ips (host byte order) we mapped to remote keys, with whether the key is a service
+      /// node or a hidden service and when the ip was last active
+      net::FlowTable<AlignedBuffer<32>> m_Flows;
 
      private:
       template <typename Addr_t, typename Endpoint_t>
@@ -256,8 +261,6 @@ namespace llarp
       /// our dns resolver
       std::shared_ptr<dns::PacketHandler> m_Resolver;
 
-      /// maps ip address to timestamp last active
-      std::unordered_map<huint128_t, llarp_time_t> m_IPActivity;
       /// our ip address (host byte order)
       huint128_t m_OurIP;
       /// our network interface's ipv6 address
@@ -280,6 +283,10 @@ namespace llarp
       /// use v6?
       bool m_UseV6;
       std::string m_IfName;
+      /// how many tun queues to read from
+      size_t m_TunQueues = 1;
+      /// merge tcp segments when writing to the tun
+      bool m_TunOffload = false;
 
       std::optional<huint128_t> m_BaseV6Address;
 
@@ -288,6 +295,8 @@ namespace llarp
       std::unique_ptr<vpn::PacketRouter> m_PacketRouter;
 
       std::optional<net::TrafficPolicy> m_TrafficPolicy;
+      /// m_TrafficPolicy as lookup tables, what every packet is checked against
+      std::optional<net::CompiledTrafficPolicy> m_CompiledTrafficPolicy;
       /// ranges we advetise as reachable
       std::set<IPRange> m_OwnedRanges;
       /// how long to wait for path alignment
@@ -51,6 +51,12 @@ namespace llarp
       return now - m_LastFlush >= TXFlushInterval;
     }
 
+    llarp_time_t
+    OutboundMessage::NextFlushAt() const
+    {
+      return m_LastFlush + TXFlushInterval;
+    }
+
     void
     OutboundMessage::Ack(byte_t bitmask)
     {
@@ -61,6 +67,14 @@ namespace llarp
     OutboundMessage::FlushUnAcked(
         std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now)
     {
+      // everything but what the XMIT carries is acked, or there never was anything else: the
+      // remote has it all and only its ack got lost, send the XMIT again to get acked
+      if (IsTransmitted())
+      {
+        sendpkt(XMIT());
+        m_LastFlush = now;
+        return;
+      }
       /// overhead for a data packet in plaintext
       static constexpr size_t Overhead = 10;
       uint16_t idx = 0;
@@ -165,6 +179,12 @@ namespace llarp
       return now > m_LastACKSent + ACKResendInterval;
     }
 
+    llarp_time_t
+    InboundMessage::NextACKSAt() const
+    {
+      return m_LastACKSent + ACKResendInterval + 1ms;
+    }
+
     bool
     InboundMessage::IsTimedOut(const llarp_time_t now) const
     {
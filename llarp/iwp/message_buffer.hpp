@@ -62,6 +62,10 @@ namespace llarp
       bool
       ShouldFlush(llarp_time_t now) const;
 
+      /// when ShouldFlush comes true
+      llarp_time_t
+      NextFlushAt() const;
+
       void
       Completed();
 
@@ -80,7 +84,7 @@ namespace llarp
       InboundMessage() = default;
       InboundMessage(uint64_t msgid, uint16_t sz, ShortHash h, llarp_time_t now);
 
-      ILinkSession::Message_t m_Data;
+      std::vector<byte_t> m_Data;
       ShortHash m_Digset;
       uint64_t m_MsgID = 0;
       llarp_time_t m_LastACKSent = 0s;
@@ -105,6 +109,10 @@ namespace llarp
       bool
       ShouldSendACKS(llarp_time_t now) const;
 
+      /// when ShouldSendACKS comes true
+      llarp_time_t
+      NextACKSAt() const;
+
       void
       SendACKS(std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now);
 
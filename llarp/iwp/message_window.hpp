@@ -0,0 +1,240 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    /// table of the messages in flight on a session keyed by message id. ids go up one at a
+    /// time so the live ones sit in a window of ids, kept in a ring indexed by id modulo its size
+    /// which doubles when the window outgrows it, up to `maxSpan` ids apart.
+    /// nothing allocates once the ring has grown to fit the session's traffic.
+    template <typename Msg_t>
+    class MessageWindow
+    {
+     public:
+      explicit MessageWindow(size_t maxSpan) : m_MaxSpan{maxSpan}
+      {}
+
+      size_t
+      size() const
+      {
+        return m_Count;
+      }
+
+      bool
+      empty() const
+      {
+        return m_Count == 0;
+      }
+
+      Msg_t*
+      Find(uint64_t id)
+      {
+        if (m_Count == 0 or id < m_Lo or id > m_Hi)
+          return nullptr;
+        auto& slot = m_Slots[id & (m_Slots.size() - 1)];
+        if (slot.msg and slot.id == id)
+          return &*slot.msg;
+        return nullptr;
+      }
+
+      /// put a message in for `id` unless there already is one.
+      /// returns the message and if it is new, or nullptr when `id` is too far from the
+      /// messages we already have to fit the window.
+      template <typename... Args_t>
+      std::pair<Msg_t*, bool>
+      Emplace(uint64_t id, Args_t&&... args)
+      {
+        if (auto* msg = Find(id))
+          return {msg, false};
+        const uint64_t lo = m_Count ? std::min(m_Lo, id) : id;
+        const uint64_t hi = m_Count ? std::max(m_Hi, id) : id;
+        if (hi - lo >= m_MaxSpan)
+          return {nullptr, false};
+        if (hi - lo >= m_Slots.size())
+          Grow(hi - lo + 1);
+        auto& slot = m_Slots[id & (m_Slots.size() - 1)];
+        slot.id = id;
+        slot.msg.emplace(std::forward<Args_t>(args)...);
+        m_Lo = lo;
+        m_Hi = hi;
+        ++m_Count;
+        return {&*slot.msg, true};
+      }
+
+      /// take the message for `id` out of the table, for when handling it might call back into
+      /// whoever owns the table
+      std::optional<Msg_t>
+      Take(uint64_t id)
+      {
+        std::optional<Msg_t> taken;
+        if (Find(id) == nullptr)
+          return taken;
+        auto& slot = m_Slots[id & (m_Slots.size() - 1)];
+        taken = std::move(slot.msg);
+        slot.msg.reset();
+        Removed(id);
+        return taken;
+      }
+
+      void
+      Erase(uint64_t id)
+      {
+        if (Find(id) == nullptr)
+          return;
+        m_Slots[id & (m_Slots.size() - 1)].msg.reset();
+        Removed(id);
+      }
+
+      /// call visit(id, msg) for every message, lowest id first
+      template <typename Visit_t>
+      void
+      ForEach(Visit_t&& visit)
+      {
+        if (m_Count == 0)
+          return;
+        for (uint64_t id = m_Lo, hi = m_Hi; id <= hi; ++id)
+        {
+          if (auto* msg = Find(id))
+            visit(id, *msg);
+        }
+      }
+
+      /// take out every message pred(msg) is true for and hand it to removed(msg), which is free
+      /// to put new messages in
+      template <typename Pred_t, typename Removed_t>
+      void
+      TakeIf(Pred_t&& pred, Removed_t&& removed)
+      {
+        if (m_Count == 0)
+          return;
+        for (uint64_t id = m_Lo, hi = m_Hi; id <= hi; ++id)
+        {
+          auto* msg = Find(id);
+          if (msg == nullptr or not pred(*msg))
+            continue;
+          auto taken = Take(id);
+          removed(*taken);
+        }
+      }
+
+     private:
+      struct Slot
+      {
+        uint64_t id = 0;
+        std::optional<Msg_t> msg;
+      };
+
+      void
+      Grow(uint64_t span)
+      {
+        size_t sz = m_Slots.empty() ? InitialSize : m_Slots.size();
+        while (sz < span)
+          sz *= 2;
+        std::vector<Slot> slots(sz);
+        for (auto& slot : m_Slots)
+        {
+          if (slot.msg)
+            slots[slot.id & (sz - 1)] = std::move(slot);
+        }
+        m_Slots = std::move(slots);
+      }
+
+      /// shrink the window past `id` if it was on either end
+      void
+      Removed(uint64_t id)
+      {
+        if (--m_Count == 0)
+          return;
+        if (id == m_Lo)
+        {
+          while (Find(++m_Lo) == nullptr)
+            ;
+        }
+        else if (id == m_Hi)
+        {
+          while (Find(--m_Hi) == nullptr)
+            ;
+        }
+      }
+
+      static constexpr size_t InitialSize = 8;
+
+      size_t m_MaxSpan;
+      std::vector<Slot> m_Slots;
+      size_t m_Count = 0;
+      uint64_t m_Lo = 0;
+      uint64_t m_Hi = 0;
+    };
+
+    /// the ids of the messages we are done with, a bitmap sliding along behind the highest one
+    /// like the anti replay window of ipsec and wireguard. ids more than `Bits` behind the
+    /// highest can no longer be told apart and count as replays.
+    template <size_t Bits>
+    class ReplayWindow
+    {
+     public:
+      /// true if `id` is too far behind to tell if we had it
+      bool
+      Behind(uint64_t id) const
+      {
+        return m_Any and m_Top >= Bits and id <= m_Top - Bits;
+      }
+
+      bool
+      Contains(uint64_t id) const
+      {
+        if (not m_Any or id > m_Top)
+          return false;
+        return Behind(id) or m_Bits.test(id % Bits);
+      }
+
+      /// mark `id` as done with, returns false if it already was or is behind the window
+      bool
+      Insert(uint64_t id)
+      {
+        if (Behind(id))
+          return false;
+        if (not m_Any)
+        {
+          m_Any = true;
+          m_Top = id;
+        }
+        else if (id > m_Top)
+        {
+          // forget whatever was in the slots we slide over
+          if (id - m_Top >= Bits)
+            m_Bits.reset();
+          else
+          {
+            for (uint64_t idx = m_Top + 1; idx <= id; ++idx)
+              m_Bits.reset(idx % Bits);
+          }
+          m_Top = id;
+        }
+        if (m_Bits.test(id % Bits))
+          return false;
+        m_Bits.set(id % Bits);
+        return true;
+      }
+
+      /// how many ids in the window are marked
+      size_t
+      size() const
+      {
+        return m_Bits.count();
+      }
+
+     private:
+      bool m_Any = false;
+      uint64_t m_Top = 0;
+      std::bitset<Bits> m_Bits;
+    };
+  }  // namespace iwp
+}  // namespace llarp
@@ -3,11 +3,45 @@
 #include <llarp/messages/link_intro.hpp>
 #include <llarp/messages/discard.hpp>
 #include <llarp/util/meta/memfn.hpp>
+#include <llarp/util/metrics.hpp>
 
 namespace llarp
 {
   namespace iwp
   {
+    namespace
+    {
+      struct SessionMetrics
+      {
+        metrics::Counter encrypted;
+        metrics::Counter decrypted;
+        metrics::Counter decryptFailed;
+        metrics::Counter droppedQueueFull;
+        metrics::Counter droppedTimeout;
+      };
+
+      const SessionMetrics&
+      Metrics()
+      {
+        static const SessionMetrics m = [] {
+          auto& registry = metrics::Registry::Instance();
+          const std::string crypto{"lokinet_iwp_crypto_ops_total"};
+          const std::string cryptoHelp{"iwp session packets encrypted or decrypted"};
+          const std::string dropped{"lokinet_iwp_messages_dropped_total"};
+          const std::string droppedHelp{"iwp link messages dropped before delivery"};
+          return SessionMetrics{
+              registry.GetCounter(crypto, cryptoHelp, {{"op", "encrypt"}}),
+              registry.GetCounter(crypto, cryptoHelp, {{"op", "decrypt"}}),
+              registry.GetCounter(
+                  "lokinet_iwp_decrypt_failures_total",
+                  "iwp session packets that failed to authenticate or decrypt"),
+              registry.GetCounter(dropped, droppedHelp, {{"reason", "queue_full"}}),
+              registry.GetCounter(dropped, droppedHelp, {{"reason", "timeout"}})};
+        }();
+        return m;
+      }
+    }  // namespace
+
     ILinkSession::Packet_t
     CreatePacket(Command cmd, size_t plainsize, size_t minpad, size_t variance)
     {
@@ -119,7 +153,7 @@ namespace llarp
         LogError("failed to sign our RC for ", m_RemoteAddr);
         return;
       }
-      ILinkSession::Message_t data(LinkIntroMessage::MaxSize + PacketOverhead);
+      std::vector<byte_t> data(LinkIntroMessage::MaxSize + PacketOverhead);
       llarp_buffer_t buf(data);
       if (not msg.BEncode(&buf))
       {
@@ -141,12 +175,36 @@ namespace llarp
         EncryptWorker(std::move(m_EncryptNext));
         m_EncryptNext = CryptoQueue_t{};
       }
+      else
+        Wakeup();
+    }
+
+    void
+    Session::Wakeup()
+    {
+      if (m_Woken)
+        return;
+      m_Woken = true;
+      m_Parent->WakeSession(weak_from_this());
+    }
+
+    void
+    Session::SchedulePump(llarp_time_t at, llarp_time_t now)
+    {
+      // a pump already scheduled before `at` reschedules this one when it happens
+      if (m_NextPumpAt > now and m_NextPumpAt <= at)
+        return;
+      m_NextPumpAt = at;
+      m_Parent->ScheduleSession(weak_from_this(), at);
     }
 
     void
     Session::EncryptWorker(CryptoQueue_t msgs)
     {
       LogTrace("encrypt worker ", msgs.size(), " messages");
+      std::vector<llarp_buffer_t> batch;
+      batch.reserve(msgs.size());
+      size_t batchSize = 0;
       for (auto& pkt : msgs)
       {
         llarp_buffer_t pktbuf{pkt};
@@ -158,8 +216,17 @@ namespace llarp
         pktbuf.base = pkt.data() + HMACSIZE;
         pktbuf.sz = pkt.size() - HMACSIZE;
         CryptoManager::instance()->hmac(pkt.data(), pktbuf, m_SessionKey);
-        Send_LL(pkt.data(), pkt.size());
+        batch.emplace_back(pkt.data(), pkt.size());
+        batchSize += pkt.size();
       }
+      if (batch.empty())
+        return;
+      Metrics().encrypted.Add(batch.size());
+      // everything this pump queued for the remote goes out in one go
+      LogTrace("send ", batch.size(), " packets (", batchSize, " bytes) to ", m_RemoteAddr);
+      m_Parent->SendBatchTo_LL(m_RemoteAddr, batch);
+      m_LastTX = time_now_ms();
+      m_TXRate += batchSize;
     }
 
     void
@@ -181,21 +248,32 @@ namespace llarp
     {
       if (m_TXMsgs.size() >= MaxSendQueueSize)
       {
+        Metrics().droppedQueueFull.Add();
         if (completed)
           completed(ILinkSession::DeliveryStatus::eDeliveryDropped);
         return false;
       }
       const auto now = m_Parent->Now();
-      const auto msgid = m_TXID++;
+      const auto msgid = m_TXID;
       const auto bufsz = buf.size();
-      auto& msg = m_TXMsgs.emplace(msgid, OutboundMessage{msgid, std::move(buf), now, completed})
-                      .first->second;
-      EncryptAndSend(msg.XMIT());
+      auto* msg = m_TXMsgs.Emplace(msgid, msgid, std::move(buf), now, completed).first;
+      if (msg == nullptr)
+      {
+        // the oldest message still in flight is too far behind
+        Metrics().droppedQueueFull.Add();
+        if (completed)
+          completed(ILinkSession::DeliveryStatus::eDeliveryDropped);
+        return false;
+      }
+      m_TXID++;
+      EncryptAndSend(msg->XMIT());
       if (bufsz > FragmentSize)
       {
-        msg.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
+        msg->FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
       }
       m_Stats.totalInFlightTX++;
+      // for its flush deadline
+      Wakeup();
       LogDebug("send message ", msgid, " to ", m_RemoteAddr);
       return true;
     }
@@ -204,64 +282,84 @@ namespace llarp
     Session::SendMACK()
     {
       // send multi acks
-      while (not m_SendMACKs.empty())
+      auto itr = m_SendMACKs.begin();
+      while (itr != m_SendMACKs.end())
       {
-        const auto sz = m_SendMACKs.size();
+        const size_t sz = m_SendMACKs.end() - itr;
         const auto max = Session::MaxACKSInMACK;
         auto numAcks = std::min(sz, max);
         auto mack = CreatePacket(Command::eMACK, 1 + (numAcks * sizeof(uint64_t)));
         mack[PacketOverhead + CommandOverhead] = byte_t{static_cast<byte_t>(numAcks)};
         byte_t* ptr = mack.data() + 3 + PacketOverhead;
         LogTrace("send ", numAcks, " macks to ", m_RemoteAddr);
-        const auto& itr = m_SendMACKs.top();
         while (numAcks > 0)
         {
-          htobe64buf(ptr, itr);
-          m_SendMACKs.pop();
+          htobe64buf(ptr, *itr);
+          ++itr;
           numAcks--;
           ptr += sizeof(uint64_t);
         }
         EncryptAndSend(std::move(mack));
       }
+      m_SendMACKs.clear();
     }
 
     void
     Session::Pump()
     {
       const auto now = m_Parent->Now();
+      // whatever gets queued while we pump is dispatched at the end, no need for a wakeup
+      m_Woken = true;
       if (m_State == State::Ready || m_State == State::LinkIntro)
       {
+        // the link layer only pumps us again when we queue more work or at the earliest of
+        // these deadlines
+        auto nextPumpAt = llarp_time_t::max();
         if (ShouldPing())
-          SendKeepAlive();
-        for (auto& item : m_RXMsgs)
         {
-          if (item.second.ShouldSendACKS(now))
+          SendKeepAlive();
+          // m_LastTX moves once the ping is encrypted off on a worker
+          nextPumpAt = now + PingInterval + 1ms;
+        }
+        else if (m_State == State::Ready)
+          nextPumpAt = m_LastTX + PingInterval + 1ms;
+        m_RXMsgs.ForEach([&](uint64_t, InboundMessage& msg) {
+          if (msg.ShouldSendACKS(now))
           {
-            item.second.SendACKS(util::memFn(&Session::EncryptAndSend, this), now);
+            msg.SendACKS(util::memFn(&Session::EncryptAndSend, this), now);
           }
-        }
-        for (auto& item : m_TXMsgs)
-        {
-          if (item.second.ShouldFlush(now))
+          nextPumpAt = std::min(nextPumpAt, msg.NextACKSAt());
+        });
+        m_TXMsgs.ForEach([&](uint64_t, OutboundMessage& msg) {
+          if (msg.ShouldFlush(now))
           {
-            item.second.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
+            msg.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
           }
-        }
+          nextPumpAt = std::min(nextPumpAt, msg.NextFlushAt());
+        });
+        if (nextPumpAt != llarp_time_t::max())
+          SchedulePump(nextPumpAt, now);
       }
       auto self = shared_from_this();
       assert(self.use_count() > 1);
       if (not m_EncryptNext.empty())
       {
-        m_Parent->QueueWork([self, data = m_EncryptNext] { self->EncryptWorker(data); });
+        m_Parent->QueueWork(this, [self, data = std::move(m_EncryptNext)]() mutable {
+          self->EncryptWorker(std::move(data));
+        });
         m_EncryptNext.clear();
       }
 
       if (not m_DecryptNext.empty())
       {
         m_Parent->AddWakeup(weak_from_this());
-        m_Parent->QueueWork([self, data = m_DecryptNext] { self->DecryptWorker(data); });
+        // moved rather than copied so the packets keep their pooled buffers
+        m_Parent->QueueWork(this, [self, data = std::move(m_DecryptNext)]() mutable {
+          self->DecryptWorker(std::move(data));
+        });
         m_DecryptNext.clear();
       }
+      m_Woken = false;
     }
 
     bool
@@ -363,49 +461,19 @@ namespace llarp
       }
       // remove pending outbound messsages that timed out
       // inform waiters
-      {
-        auto itr = m_TXMsgs.begin();
-        while (itr != m_TXMsgs.end())
-        {
-          if (itr->second.IsTimedOut(now))
-          {
+      m_TXMsgs.TakeIf(
+          [now](const OutboundMessage& msg) { return msg.IsTimedOut(now); },
+          [this](OutboundMessage& msg) {
             m_Stats.totalDroppedTX++;
             m_Stats.totalInFlightTX--;
+            Metrics().droppedTimeout.Add();
             LogTrace("Dropped unacked packet to ", m_RemoteAddr);
-            itr->second.InformTimeout();
-            itr = m_TXMsgs.erase(itr);
-          }
-          else
-            ++itr;
-        }
-      }
-      {
-        // remove pending inbound messages that timed out
-        auto itr = m_RXMsgs.begin();
-        while (itr != m_RXMsgs.end())
-        {
-          if (itr->second.IsTimedOut(now))
-          {
-            m_ReplayFilter.emplace(itr->first, now);
-            itr = m_RXMsgs.erase(itr);
-          }
-          else
-            ++itr;
-        }
-      }
-      {
-        // decay replay window
-        auto itr = m_ReplayFilter.begin();
-        while (itr != m_ReplayFilter.end())
-        {
-          if (itr->second + ReplayWindow <= now)
-          {
-            itr = m_ReplayFilter.erase(itr);
-          }
-          else
-            ++itr;
-        }
-      }
+            msg.InformTimeout();
+          });
+      // remove pending inbound messages that timed out
+      m_RXMsgs.TakeIf(
+          [now](const InboundMessage& msg) { return msg.IsTimedOut(now); },
+          [this](const InboundMessage& msg) { m_ReplayFilter.Insert(msg.m_MsgID); });
     }
 
     using Introduction =
@@ -613,11 +681,14 @@ namespace llarp
     Session::HandleSessionData(Packet_t pkt)
     {
       m_DecryptNext.emplace_back(std::move(pkt));
+      Wakeup();
     }
 
     void
     Session::DecryptWorker(CryptoQueue_t msgs)
     {
+      const auto& metrics = Metrics();
+      metrics.decrypted.Add(msgs.size());
       auto itr = msgs.begin();
       while (itr != msgs.end())
       {
@@ -625,6 +696,7 @@ namespace llarp
         if (not DecryptMessageInPlace(pkt))
         {
           itr = msgs.erase(itr);
+          metrics.decryptFailed.Add();
           LogError("failed to decrypt session data from ", m_RemoteAddr);
           continue;
         }
@@ -653,29 +725,30 @@ namespace llarp
           switch (result[PacketOverhead + 1])
           {
             case Command::eXMIT:
-              HandleXMIT(std::move(result));
+              HandleXMIT(result);
               break;
             case Command::eDATA:
-              HandleDATA(std::move(result));
+              HandleDATA(result);
               break;
             case Command::eACKS:
-              HandleACKS(std::move(result));
+              HandleACKS(result);
               break;
             case Command::ePING:
-              HandlePING(std::move(result));
+              HandlePING(result);
               break;
             case Command::eNACK:
-              HandleNACK(std::move(result));
+              HandleNACK(result);
               break;
             case Command::eCLOS:
-              HandleCLOS(std::move(result));
+              HandleCLOS(result);
               break;
             case Command::eMACK:
-              HandleMACK(std::move(result));
+              HandleMACK(result);
               break;
             default:
               LogError("invalid command ", int(result[PacketOverhead + 1]), " from ", m_RemoteAddr);
           }
+          m_Parent->RecyclePacket(std::move(result));
         }
       }
       SendMACK();
@@ -683,7 +756,7 @@ namespace llarp
     }
 
     void
-    Session::HandleMACK(Packet_t data)
+    Session::HandleMACK(const Packet_t& data)
     {
       if (data.size() < (3 + PacketOverhead))
       {
@@ -697,18 +770,16 @@ namespace llarp
         return;
       }
       LogTrace("got ", int(numAcks), " mack from ", m_RemoteAddr);
-      byte_t* ptr = data.data() + CommandOverhead + PacketOverhead + 1;
+      const byte_t* ptr = data.data() + CommandOverhead + PacketOverhead + 1;
       while (numAcks > 0)
       {
         uint64_t acked = bufbe64toh(ptr);
         LogTrace("mack containing txid=", acked, " from ", m_RemoteAddr);
-        auto itr = m_TXMsgs.find(acked);
-        if (itr != m_TXMsgs.end())
+        if (auto msg = m_TXMsgs.Take(acked))
         {
           m_Stats.totalAckedTX++;
           m_Stats.totalInFlightTX--;
-          itr->second.Completed();
-          m_TXMsgs.erase(itr);
+          msg->Completed();
         }
         else
         {
@@ -720,7 +791,7 @@ namespace llarp
     }
 
     void
-    Session::HandleNACK(Packet_t data)
+    Session::HandleNACK(const Packet_t& data)
     {
       if (data.size() < (CommandOverhead + sizeof(uint64_t) + PacketOverhead))
       {
@@ -729,16 +800,15 @@ namespace llarp
       }
       uint64_t txid = bufbe64toh(data.data() + CommandOverhead + PacketOverhead);
       LogTrace("got nack on ", txid, " from ", m_RemoteAddr);
-      auto itr = m_TXMsgs.find(txid);
-      if (itr != m_TXMsgs.end())
+      if (auto* msg = m_TXMsgs.Find(txid))
       {
-        EncryptAndSend(itr->second.XMIT());
+        EncryptAndSend(msg->XMIT());
       }
       m_LastRX = m_Parent->Now();
     }
 
     void
-    Session::HandleXMIT(Packet_t data)
+    Session::HandleXMIT(const Packet_t& data)
     {
       static constexpr size_t XMITOverhead =
           (CommandOverhead + PacketOverhead + sizeof(uint16_t) + sizeof(uint64_t)
@@ -757,41 +827,47 @@ namespace llarp
       assert(p2 == data.data() + XMITOverhead);
       LogTrace("rxid=", rxid, " sz=", sz, " h=", oxenmq::to_hex(pos, p2), " from ", m_RemoteAddr);
       m_LastRX = m_Parent->Now();
+      if (m_ReplayFilter.Behind(rxid))
       {
-        // check for replay
-        auto itr = m_ReplayFilter.find(rxid);
-        if (itr != m_ReplayFilter.end())
-        {
-          m_SendMACKs.emplace(rxid);
-          LogTrace("duplicate rxid=", rxid, " from ", m_RemoteAddr);
-          return;
-        }
+        // too old to tell, but we must have been done with it, ack it so they stop sending it
+        m_SendMACKs.emplace_back(rxid);
+        LogTrace("rxid=", rxid, " too far behind from ", m_RemoteAddr);
+        return;
+      }
+      if (m_ReplayFilter.Contains(rxid))
+      {
+        m_SendMACKs.emplace_back(rxid);
+        LogTrace("duplicate rxid=", rxid, " from ", m_RemoteAddr);
+        return;
       }
       {
         const auto now = m_Parent->Now();
-        auto itr = m_RXMsgs.find(rxid);
-        if (itr == m_RXMsgs.end())
+        const auto [msg, inserted] = m_RXMsgs.Emplace(rxid, rxid, sz, ShortHash{pos}, now);
+        if (msg == nullptr)
+        {
+          LogWarn("rxid=", rxid, " too far ahead from ", m_RemoteAddr);
+          return;
+        }
+        if (inserted)
         {
-          itr = m_RXMsgs.emplace(rxid, InboundMessage{rxid, sz, ShortHash{pos}, m_Parent->Now()})
-                    .first;
           sz = std::min(sz, uint16_t{FragmentSize});
           if ((data.size() - XMITOverhead) == sz)
           {
             {
               const llarp_buffer_t buf(data.data() + (data.size() - sz), sz);
-              itr->second.HandleData(0, buf, now);
-              if (not itr->second.IsCompleted())
+              msg->HandleData(0, buf, now);
+              if (not msg->IsCompleted())
               {
                 return;
               }
 
-              if (not itr->second.Verify())
+              if (not msg->Verify())
               {
                 LogError("bad short xmit hash from ", m_RemoteAddr);
                 return;
               }
             }
-            HandleRecvMsgCompleted(itr->second);
+            HandleRecvMsgCompleted(rxid);
           }
         }
         else
@@ -800,7 +876,7 @@ namespace llarp
     }
 
     void
-    Session::HandleDATA(Packet_t data)
+    Session::HandleDATA(const Packet_t& data)
     {
       if (data.size() < (CommandOverhead + sizeof(uint16_t) + sizeof(uint64_t) + PacketOverhead))
       {
@@ -810,10 +886,15 @@ namespace llarp
       m_LastRX = m_Parent->Now();
       uint16_t sz = bufbe16toh(data.data() + CommandOverhead + PacketOverhead);
       uint64_t rxid = bufbe64toh(data.data() + CommandOverhead + sizeof(uint16_t) + PacketOverhead);
-      auto itr = m_RXMsgs.find(rxid);
-      if (itr == m_RXMsgs.end())
+      auto* msg = m_RXMsgs.Find(rxid);
+      if (msg == nullptr)
       {
-        if (m_ReplayFilter.find(rxid) == m_ReplayFilter.end())
+        if (m_ReplayFilter.Behind(rxid))
+        {
+          m_SendMACKs.emplace_back(rxid);
+          LogTrace("rxid=", rxid, " too far behind for ", m_RemoteAddr);
+        }
+        else if (not m_ReplayFilter.Contains(rxid))
         {
           LogTrace("no rxid=", rxid, " for ", m_RemoteAddr);
           auto nack = CreatePacket(Command::eNACK, 8);
@@ -823,7 +904,7 @@ namespace llarp
         else
         {
           LogTrace("replay hit for rxid=", rxid, " for ", m_RemoteAddr);
-          m_SendMACKs.emplace(rxid);
+          m_SendMACKs.emplace_back(rxid);
         }
         return;
       }
@@ -831,37 +912,37 @@ namespace llarp
       {
         const llarp_buffer_t buf(
             data.data() + PacketOverhead + 12, data.size() - (PacketOverhead + 12));
-        itr->second.HandleData(sz, buf, m_Parent->Now());
+        msg->HandleData(sz, buf, m_Parent->Now());
       }
 
-      if (itr->second.IsCompleted())
+      if (msg->IsCompleted())
       {
-        if (itr->second.Verify())
+        if (msg->Verify())
         {
-          HandleRecvMsgCompleted(itr->second);
+          HandleRecvMsgCompleted(rxid);
         }
         else
         {
-          LogError("hash mismatch for message ", itr->first);
+          LogError("hash mismatch for message ", rxid);
         }
       }
     }
 
     void
-    Session::HandleRecvMsgCompleted(const InboundMessage& msg)
+    Session::HandleRecvMsgCompleted(uint64_t rxid)
     {
-      const auto rxid = msg.m_MsgID;
-      if (m_ReplayFilter.emplace(rxid, m_Parent->Now()).second)
+      // out of the table before the upper layers see it
+      auto msg = m_RXMsgs.Take(rxid);
+      if (m_ReplayFilter.Insert(rxid))
       {
-        m_Parent->HandleMessage(this, msg.m_Data);
-        EncryptAndSend(msg.ACKS());
+        m_Parent->HandleMessage(this, msg->m_Data);
+        EncryptAndSend(msg->ACKS());
         LogDebug("recv'd message ", rxid, " from ", m_RemoteAddr);
       }
-      m_RXMsgs.erase(rxid);
     }
 
     void
-    Session::HandleACKS(Packet_t data)
+    Session::HandleACKS(const Packet_t& data)
     {
       if (data.size() < (11 + PacketOverhead))
       {
@@ -871,33 +952,33 @@ namespace llarp
       const auto now = m_Parent->Now();
       m_LastRX = now;
       uint64_t txid = bufbe64toh(data.data() + 2 + PacketOverhead);
-      auto itr = m_TXMsgs.find(txid);
-      if (itr == m_TXMsgs.end())
+      auto* msg = m_TXMsgs.Find(txid);
+      if (msg == nullptr)
       {
         LogTrace("no txid=", txid, " for ", m_RemoteAddr);
         return;
       }
-      itr->second.Ack(data[10 + PacketOverhead]);
+      msg->Ack(data[10 + PacketOverhead]);
 
-      if (itr->second.IsTransmitted())
+      if (msg->IsTransmitted())
       {
-        LogDebug("sent message ", itr->first, " to ", m_RemoteAddr);
-        itr->second.Completed();
-        itr = m_TXMsgs.erase(itr);
+        LogDebug("sent message ", txid, " to ", m_RemoteAddr);
+        // the completion handler is free to send more
+        m_TXMsgs.Take(txid)->Completed();
       }
       else
       {
-        itr->second.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
+        msg->FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
       }
     }
 
-    void Session::HandleCLOS(Packet_t)
+    void Session::HandleCLOS(const Packet_t&)
     {
       LogInfo("remote closed by ", m_RemoteAddr);
       Close();
     }
 
-    void Session::HandlePING(Packet_t)
+    void Session::HandlePING(const Packet_t&)
     {
       m_LastRX = m_Parent->Now();
     }
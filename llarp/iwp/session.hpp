@@ -3,6 +3,7 @@
 #include <llarp/link/session.hpp>
 #include "linklayer.hpp"
 #include "message_buffer.hpp"
+#include "message_window.hpp"
 #include <llarp/net/ip_address.hpp>
 
 #include <map>
@@ -25,8 +26,9 @@ namespace llarp
     static constexpr std::chrono::milliseconds DeliveryTimeout = 500ms;
     /// Time how long we wait to recieve a message
     static constexpr auto ReceivalTimeout = (DeliveryTimeout * 8) / 5;
-    /// How long to keep a replay window for
-    static constexpr auto ReplayWindow = (ReceivalTimeout * 3) / 2;
+    /// How many message ids back we remember receiving, at least as many as a peer can have in
+    /// flight so none of theirs are ever too far ahead or behind for us to ack
+    static constexpr size_t ReplayWindowSize = MaxSendQueueSize;
     /// How often to acks RX messages
     static constexpr auto ACKResendInterval = DeliveryTimeout / 2;
     /// How often to retransmit TX fragments
@@ -93,7 +95,7 @@ namespace llarp
         return m_RemoteAddr;
       }
 
-      RouterContact
+      const RouterContact&
       GetRemoteRC() const override
       {
         return m_RemoteRC;
@@ -171,6 +173,11 @@ namespace llarp
       llarp_time_t m_LastTX = 0s;
       llarp_time_t m_LastRX = 0s;
 
+      /// set while we are on the link layer's woken list
+      bool m_Woken = false;
+      /// the earliest pump we have scheduled on the link layer
+      llarp_time_t m_NextPumpAt = 0s;
+
       // accumulate for periodic rate calculation
       uint64_t m_TXRate = 0;
       uint64_t m_RXRate = 0;
@@ -185,13 +192,13 @@ namespace llarp
       void
       ResetRates();
 
-      std::map<uint64_t, InboundMessage> m_RXMsgs;
-      std::map<uint64_t, OutboundMessage> m_TXMsgs;
+      MessageWindow<InboundMessage> m_RXMsgs{ReplayWindowSize};
+      MessageWindow<OutboundMessage> m_TXMsgs{MaxSendQueueSize};
 
-      /// maps rxid to time recieved
-      std::unordered_map<uint64_t, llarp_time_t> m_ReplayFilter;
+      /// rxids we are done with
+      ReplayWindow<ReplayWindowSize> m_ReplayFilter;
       /// rx messages to send in next round of multiacks
-      std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> m_SendMACKs;
+      std::vector<uint64_t> m_SendMACKs;
 
       using CryptoQueue_t = std::vector<Packet_t>;
 
@@ -200,6 +207,14 @@ namespace llarp
 
       llarp::thread::Queue<CryptoQueue_t> m_PlaintextRecv;
 
+      /// get pumped on the link layer's next Pump
+      void
+      Wakeup();
+
+      /// get pumped once `at` comes, unless we already are by then
+      void
+      SchedulePump(llarp_time_t at, llarp_time_t now);
+
       void
       EncryptWorker(CryptoQueue_t msgs);
 
@@ -228,7 +243,7 @@ namespace llarp
       SendMACK();
 
       void
-      HandleRecvMsgCompleted(const InboundMessage& msg);
+      HandleRecvMsgCompleted(uint64_t rxid);
 
       void
       GenerateAndSendIntro();
@@ -246,25 +261,25 @@ namespace llarp
       SendOurLIM(ILinkSession::CompletionHandler h = nullptr);
 
       void
-      HandleXMIT(Packet_t msg);
+      HandleXMIT(const Packet_t& msg);
 
       void
-      HandleDATA(Packet_t msg);
+      HandleDATA(const Packet_t& msg);
 
       void
-      HandleACKS(Packet_t msg);
+      HandleACKS(const Packet_t& msg);
 
       void
-      HandleNACK(Packet_t msg);
+      HandleNACK(const Packet_t& msg);
 
       void
-      HandlePING(Packet_t msg);
+      HandlePING(const Packet_t& msg);
 
       void
-      HandleCLOS(Packet_t msg);
+      HandleCLOS(const Packet_t& msg);
 
       void
-      HandleMACK(Packet_t msg);
+      HandleMACK(const Packet_t& msg);
     };
   }  // namespace iwp
 }  // namespace llarp
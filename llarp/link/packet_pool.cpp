@@ -0,0 +1,47 @@
+#include "packet_pool.hpp"
+
+#include <algorithm>
+
+namespace llarp
+{
+  ILinkSession::Packet_t
+  PacketPool::Get(const llarp_buffer_t& buf)
+  {
+    ILinkSession::Packet_t pkt;
+    if (not m_Free.empty() and buf.sz <= PacketCapacity)
+    {
+      pkt = std::move(m_Free.back());
+      m_Free.pop_back();
+      ++m_Hits;
+    }
+    else
+    {
+      pkt.reserve(std::max(buf.sz, PacketCapacity));
+      ++m_Misses;
+    }
+    pkt.assign(buf.base, buf.base + buf.sz);
+    return pkt;
+  }
+
+  void
+  PacketPool::Put(ILinkSession::Packet_t pkt)
+  {
+    if (pkt.capacity() < PacketCapacity or m_Free.size() >= MaxPooled)
+      return;
+    pkt.clear();
+    m_Free.emplace_back(std::move(pkt));
+    ++m_Returned;
+  }
+
+  util::StatusObject
+  PacketPool::ExtractStatus() const
+  {
+    const auto total = m_Hits + m_Misses;
+    return {
+        {"hits", m_Hits},
+        {"allocations", m_Misses},
+        {"hitRate", total ? double(m_Hits) / total : 0.0},
+        {"returned", m_Returned},
+        {"pooled", m_Free.size()}};
+  }
+}  // namespace llarp
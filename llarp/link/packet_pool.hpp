@@ -0,0 +1,50 @@
+#pragma once
+
+#include "session.hpp"
+#include <llarp/util/status.hpp>
+
+#include <vector>
+
+namespace llarp
+{
+  /// recycles the buffers a link layer copies received packets into, so once it has warmed up the
+  /// receive path does not allocate. not thread safe, only used from the event loop thread.
+  struct PacketPool
+  {
+    /// room every pooled packet has, enough for anything a link layer sends
+    static constexpr size_t PacketCapacity = 1500;
+    /// most packets we keep around for reuse
+    static constexpr size_t MaxPooled = 1024;
+
+    /// a packet holding a copy of buf
+    ILinkSession::Packet_t
+    Get(const llarp_buffer_t& buf);
+
+    /// give back a packet we are done with
+    void
+    Put(ILinkSession::Packet_t pkt);
+
+    /// packets handed out from the pool
+    uint64_t
+    Hits() const
+    {
+      return m_Hits;
+    }
+
+    /// packets we had to allocate
+    uint64_t
+    Misses() const
+    {
+      return m_Misses;
+    }
+
+    util::StatusObject
+    ExtractStatus() const;
+
+   private:
+    std::vector<ILinkSession::Packet_t> m_Free;
+    uint64_t m_Hits = 0;
+    uint64_t m_Misses = 0;
+    uint64_t m_Returned = 0;
+  };
+}  // namespace llarp
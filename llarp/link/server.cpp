@@ -5,6 +5,7 @@
 #include <llarp/config/key_manager.hpp>
 #include <memory>
 #include <llarp/util/fs.hpp>
+#include <llarp/util/metrics.hpp>
 #include <utility>
 #include <unordered_set>
 
@@ -127,12 +128,21 @@ namespace llarp
   ILinkLayer::Configure(EventLoop_ptr loop, const std::string& ifname, int af, uint16_t port)
   {
     m_Loop = std::move(loop);
+    auto& metrics = metrics::Registry::Instance();
+    const metrics::Labels labels{{"link", Name()}};
+    m_RXPackets = metrics.GetCounter(
+        "lokinet_link_rx_packets_total", "udp packets received by a link layer", labels);
+    m_RXBytes = metrics.GetCounter(
+        "lokinet_link_rx_bytes_total", "udp payload bytes received by a link layer", labels);
+    m_TXPackets = metrics.GetCounter(
+        "lokinet_link_tx_packets_total", "udp packets sent by a link layer", labels);
+    m_TXBytes = metrics.GetCounter(
+        "lokinet_link_tx_bytes_total", "udp payload bytes sent by a link layer", labels);
     m_udp = m_Loop->make_udp(
-        [this]([[maybe_unused]] UDPHandle& udp, const SockAddr& from, llarp_buffer_t buf) {
-          ILinkSession::Packet_t pkt;
-          pkt.resize(buf.sz);
-          std::copy_n(buf.base, buf.sz, pkt.data());
-          RecvFrom(from, std::move(pkt));
+        [this]([[maybe_unused]] UDPHandle& udp, const SockAddr& from, const llarp_buffer_t& buf) {
+          m_RXPackets.Add();
+          m_RXBytes.Add(buf.sz);
+          RecvFrom(from, m_RecvPool.Get(buf));
         });
 
     if (ifname == "*")
@@ -170,64 +180,31 @@ namespace llarp
   void
   ILinkLayer::Pump()
   {
-    std::unordered_set<RouterID> closedSessions;
-    std::vector<std::shared_ptr<ILinkSession>> closedPending;
-    auto _now = Now();
+    // only the sessions that queued work or have a deadline come up need a pump, idle ones
+    // cost nothing here
+    std::swap(m_WokenSessions, m_PumpingSessions);
+    for (const auto& weak : m_PumpingSessions)
     {
-      Lock_t l(m_AuthedLinksMutex);
-      auto itr = m_AuthedLinks.begin();
-      while (itr != m_AuthedLinks.end())
-      {
-        if (not itr->second->TimedOut(_now))
-        {
-          itr->second->Pump();
-          ++itr;
-        }
-        else
-        {
-          llarp::LogInfo("session to ", RouterID(itr->second->GetPubKey()), " timed out");
-          itr->second->Close();
-          closedSessions.emplace(itr->first);
-          itr = m_AuthedLinks.erase(itr);
-        }
-      }
+      if (auto session = weak.lock())
+        session->Pump();
     }
-    {
-      Lock_t l(m_PendingMutex);
+    m_PumpingSessions.clear();
+    m_SessionTimers.Advance(Now(), [](const auto& weak) {
+      if (auto session = weak.lock())
+        session->Pump();
+    });
+  }
 
-      auto itr = m_Pending.begin();
-      while (itr != m_Pending.end())
-      {
-        if (not itr->second->TimedOut(_now))
-        {
-          itr->second->Pump();
-          ++itr;
-        }
-        else
-        {
-          LogInfo("pending session at ", itr->first, " timed out");
-          // defer call so we can acquire mutexes later
-          closedPending.emplace_back(std::move(itr->second));
-          itr = m_Pending.erase(itr);
-        }
-      }
-    }
-    {
-      Lock_t l(m_AuthedLinksMutex);
-      for (const auto& r : closedSessions)
-      {
-        if (m_AuthedLinks.count(r) == 0)
-        {
-          SessionClosed(r);
-        }
-      }
-    }
-    for (const auto& pending : closedPending)
-    {
-      if (pending->IsInbound())
-        continue;
-      HandleTimeout(pending.get());
-    }
+  void
+  ILinkLayer::WakeSession(std::weak_ptr<ILinkSession> session)
+  {
+    m_WokenSessions.emplace_back(std::move(session));
+  }
+
+  void
+  ILinkLayer::ScheduleSession(std::weak_ptr<ILinkSession> session, llarp_time_t at)
+  {
+    m_SessionTimers.Schedule(at, std::move(session));
   }
 
   bool
@@ -293,6 +270,7 @@ namespace llarp
         {"name", Name()},
         {"rank", uint64_t(Rank())},
         {"addr", m_ourAddr.toString()},
+        {"recvPool", m_RecvPool.ExtractStatus()},
         {"sessions", util::StatusObject{{"pending", pending}, {"established", established}}}};
   }
 
@@ -352,16 +330,62 @@ namespace llarp
   void
   ILinkLayer::Tick(const llarp_time_t now)
   {
+    std::unordered_set<RouterID> closedSessions;
+    std::vector<std::shared_ptr<ILinkSession>> closedPending;
     {
       Lock_t l(m_AuthedLinksMutex);
-      for (const auto& [routerid, link] : m_AuthedLinks)
-        link->Tick(now);
+      auto itr = m_AuthedLinks.begin();
+      while (itr != m_AuthedLinks.end())
+      {
+        if (not itr->second->TimedOut(now))
+        {
+          itr->second->Tick(now);
+          ++itr;
+        }
+        else
+        {
+          llarp::LogInfo("session to ", RouterID(itr->second->GetPubKey()), " timed out");
+          itr->second->Close();
+          closedSessions.emplace(itr->first);
+          itr = m_AuthedLinks.erase(itr);
+        }
+      }
     }
-
     {
       Lock_t l(m_PendingMutex);
-      for (const auto& [addr, link] : m_Pending)
-        link->Tick(now);
+
+      auto itr = m_Pending.begin();
+      while (itr != m_Pending.end())
+      {
+        if (not itr->second->TimedOut(now))
+        {
+          itr->second->Tick(now);
+          ++itr;
+        }
+        else
+        {
+          LogInfo("pending session at ", itr->first, " timed out");
+          // defer call so we can acquire mutexes later
+          closedPending.emplace_back(std::move(itr->second));
+          itr = m_Pending.erase(itr);
+        }
+      }
+    }
+    {
+      Lock_t l(m_AuthedLinksMutex);
+      for (const auto& r : closedSessions)
+      {
+        if (m_AuthedLinks.count(r) == 0)
+        {
+          SessionClosed(r);
+        }
+      }
+    }
+    for (const auto& pending : closedPending)
+    {
+      if (pending->IsInbound())
+        continue;
+      HandleTimeout(pending.get());
     }
 
     {
@@ -430,9 +454,23 @@ namespace llarp
   void
   ILinkLayer::SendTo_LL(const SockAddr& to, const llarp_buffer_t& pkt)
   {
+    m_TXPackets.Add();
+    m_TXBytes.Add(pkt.sz);
     m_udp->send(to, pkt);
   }
 
+  size_t
+  ILinkLayer::SendBatchTo_LL(const SockAddr& to, const std::vector<llarp_buffer_t>& pkts)
+  {
+    const size_t sent = m_udp->send_batch(to, pkts);
+    size_t bytes = 0;
+    for (size_t idx = 0; idx < sent; ++idx)
+      bytes += pkts[idx].sz;
+    m_TXPackets.Add(sent);
+    m_TXBytes.Add(bytes);
+    return sent;
+  }
+
   bool
   ILinkLayer::SendTo(
       const RouterID& remote, const llarp_buffer_t& buf, ILinkSession::CompletionHandler completed)
@@ -452,9 +490,7 @@ namespace llarp
         }
       }
     }
-    ILinkSession::Message_t pkt(buf.sz);
-    std::copy_n(buf.base, buf.sz, pkt.begin());
-    return s && s->SendMessageBuffer(std::move(pkt), completed);
+    return s && s->SendMessageBuffer(ILinkSession::Message_t::copy_from(buf), completed);
   }
 
   bool
@@ -2,11 +2,14 @@
 
 #include <llarp/crypto/types.hpp>
 #include <llarp/ev/ev.hpp>
+#include "packet_pool.hpp"
 #include "session.hpp"
 #include <llarp/net/sock_addr.hpp>
 #include <llarp/router_contact.hpp>
+#include <llarp/util/metrics.hpp>
 #include <llarp/util/status.hpp>
 #include <llarp/util/thread/threading.hpp>
+#include <llarp/util/timer_wheel.hpp>
 #include <llarp/config/key_manager.hpp>
 
 #include <list>
@@ -28,7 +31,7 @@ namespace llarp
 
   /// handle connection timeout
   ///
-  /// currently called from ILinkLayer::Pump() when an unestablished session times out
+  /// currently called from ILinkLayer::Tick() when an unestablished session times out
   using TimeoutHandler = std::function<void(ILinkSession*)>;
 
   /// get our RC
@@ -65,8 +68,8 @@ namespace llarp
   using PumpDoneHandler = std::function<void(void)>;
 
   using Work_t = std::function<void(void)>;
-  /// queue work to worker thread
-  using WorkerFunc_t = std::function<void(Work_t)>;
+  /// queue work to worker thread, work queued with the same owner runs in the order it was queued
+  using WorkerFunc_t = std::function<void(const void*, Work_t)>;
 
   /// before connection hook, called before we try connecting via outbound link
   using BeforeConnectFunc_t = std::function<void(llarp::RouterContact)>;
@@ -107,6 +110,11 @@ namespace llarp
     void
     SendTo_LL(const SockAddr& to, const llarp_buffer_t& pkt);
 
+    /// send several packets to the same remote with as few syscalls as the platform allows,
+    /// returns how many were sent
+    size_t
+    SendBatchTo_LL(const SockAddr& to, const std::vector<llarp_buffer_t>& pkts);
+
     virtual bool
     Configure(EventLoop_ptr loop, const std::string& ifname, int af, uint16_t port);
 
@@ -117,12 +125,29 @@ namespace llarp
     std::shared_ptr<ILinkSession>
     FindSessionByPubkey(RouterID pk);
 
+    /// pump the sessions that were woken up or whose scheduled deadline came up
     virtual void
     Pump();
 
+    /// pump a session on the next Pump, for when it queued work
+    void
+    WakeSession(std::weak_ptr<ILinkSession> session);
+
+    /// pump a session on the first Pump at or after `at`, for its ack, retransmit and keepalive
+    /// deadlines
+    void
+    ScheduleSession(std::weak_ptr<ILinkSession> session, llarp_time_t at);
+
     virtual void
     RecvFrom(const SockAddr& from, ILinkSession::Packet_t pkt) = 0;
 
+    /// give back a received packet once it has been handled so the next one can reuse it
+    void
+    RecyclePacket(ILinkSession::Packet_t pkt)
+    {
+      m_RecvPool.Put(std::move(pkt));
+    }
+
     bool
     PickAddress(const RouterContact& rc, AddressInfo& picked) const;
 
@@ -188,6 +213,7 @@ namespace llarp
     virtual bool
     MapAddr(const RouterID& pk, ILinkSession* s);
 
+    /// tick every session and close the ones that timed out
     void
     Tick(llarp_time_t now);
 
@@ -253,8 +279,21 @@ namespace llarp
 
     std::unordered_map<SockAddr, llarp_time_t> m_RecentlyClosed;
 
+    /// what received packets are copied into
+    PacketPool m_RecvPool;
+
    private:
     std::shared_ptr<int> m_repeater_keepalive;
+
+    /// sessions to pump on the next Pump
+    std::vector<std::weak_ptr<ILinkSession>> m_WokenSessions;
+    std::vector<std::weak_ptr<ILinkSession>> m_PumpingSessions;
+    util::TimerWheel<std::weak_ptr<ILinkSession>> m_SessionTimers;
+
+    metrics::Counter m_RXPackets;
+    metrics::Counter m_RXBytes;
+    metrics::Counter m_TXPackets;
+    metrics::Counter m_TXBytes;
   };
 
   using LinkLayer_ptr = std::shared_ptr<ILinkLayer>;
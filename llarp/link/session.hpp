@@ -53,7 +53,9 @@ namespace llarp
     using CompletionHandler = std::function<void(DeliveryStatus)>;
 
     using Packet_t = std::vector<byte_t>;
-    using Message_t = std::vector<byte_t>;
+    /// messages are never changed once they are handed to a session, so one message sent to
+    /// many sessions shares its bytes between all of them
+    using Message_t = SharedBuffer;
 
     /// send a message buffer to the remote endpoint
     virtual bool
@@ -98,7 +100,7 @@ namespace llarp
     GetRemoteEndpoint() const = 0;
 
     // get remote rc
-    virtual RouterContact
+    virtual const RouterContact&
     GetRemoteRC() const = 0;
 
     /// is this session a session to a relay?
@@ -7,9 +7,15 @@
 
 #include <llarp/router/abstractrouter.hpp>
 #include <llarp/service/context.hpp>
+#include <llarp/service/name.hpp>
+#include <llarp/handlers/embedded_udp.hpp>
+#include <llarp/handlers/null.hpp>
 #include <llarp/quic/tunnel.hpp>
 #include <llarp/nodedb.hpp>
 
+#include <atomic>
+#include <condition_variable>
+#include <future>
 #include <mutex>
 
 #ifdef _WIN32
@@ -28,6 +34,8 @@ namespace
       return std::make_shared<llarp::NodeDB>();
     }
   };
+
+  using UDPSocket_ptr = llarp::handlers::EmbeddedUDP::Socket_ptr;
 }  // namespace
 
 struct lokinet_context
@@ -74,6 +82,29 @@ struct lokinet_context
   {
     streams[id] = false;
   }
+
+  /// the udp sockets on our endpoint, made on first use, and the open ones by id.  guarded by
+  /// m_access
+  std::shared_ptr<llarp::handlers::EmbeddedUDP> udp;
+  std::unordered_map<int, UDPSocket_ptr> udp_sockets;
+  int next_udp_id = 0;
+
+  /// wakes lokinet_udp_poll callers when packets arrive, notified only when someone is waiting
+  std::mutex udp_wake_access;
+  std::condition_variable udp_wake;
+  std::atomic<int> udp_sleepers{0};
+  /// set by lokinet_context_stop so pollers give up, guarded by udp_wake_access
+  bool udp_stopped = false;
+
+  [[nodiscard]] UDPSocket_ptr
+  udp_socket(int id)
+  {
+    auto lock = acquire();
+    auto itr = udp_sockets.find(id);
+    if (itr == udp_sockets.end())
+      return nullptr;
+    return itr->second;
+  }
 };
 
 namespace
@@ -130,6 +161,117 @@ namespace
     return -1;
   }
 
+  /// wake up pollers after pushing to an rx queue, called on the event loop
+  void
+  udp_wake(lokinet_context* ctx)
+  {
+    // pairs with the fence in lokinet_udp_poll so either we see the sleeper or it sees the packet
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (ctx->udp_sleepers.load(std::memory_order_relaxed) == 0)
+      return;
+    {
+      std::lock_guard<std::mutex> lock{ctx->udp_wake_access};
+    }
+    ctx->udp_wake.notify_all();
+  }
+
+  /// our udp sockets, made and hooked up to inbound traffic on first use.  called with m_access
+  /// held on a running context.
+  std::shared_ptr<llarp::handlers::EmbeddedUDP>
+  udp_get(lokinet_context* ctx)
+  {
+    if (ctx->udp)
+      return ctx->udp;
+    auto ep = std::dynamic_pointer_cast<llarp::handlers::NullEndpoint>(ctx->endpoint());
+    if (ep == nullptr)
+      return nullptr;
+    ctx->udp = std::make_shared<llarp::handlers::EmbeddedUDP>(ep, [ctx]() { udp_wake(ctx); });
+    ctx->impl->CallSafe([ep, weak = std::weak_ptr{ctx->udp}]() {
+      ep->SetTrafficHandler([weak](auto tag, auto pkt) {
+        auto udp = weak.lock();
+        return udp and udp->HandleTraffic(tag, std::move(pkt));
+      });
+    });
+    return ctx->udp;
+  }
+
+  /// parse the "ip:port" a socket relays to into local, false if it is not one
+  bool
+  udp_local_addr(const char* str, std::optional<llarp::SockAddr>& local)
+  {
+    if (str == nullptr)
+      return true;
+    try
+    {
+      local = llarp::SockAddr{std::string_view{str}};
+    }
+    catch (std::exception&)
+    {
+      return false;
+    }
+    return not local->isEmpty() and local->getPort() != 0;
+  }
+
+  /// a socket being opened on the event loop for a caller that waits on it.  the socket may open
+  /// after the caller gave up waiting, or the job may never run at all when the loop is stopping,
+  /// so this is shared between the two and the event loop closes what nobody is left to take.
+  struct udp_opening
+  {
+    std::mutex access;
+    bool abandoned = false;
+    std::promise<std::pair<int, UDPSocket_ptr>> promise;
+
+    /// on the event loop
+    void
+    done(llarp::handlers::EmbeddedUDP& udp, int err, UDPSocket_ptr sock)
+    {
+      std::lock_guard<std::mutex> lock{access};
+      if (not abandoned)
+        promise.set_value({err, sock});
+      else if (sock)
+        udp.Close(sock);
+    }
+
+    /// wait up to timeout for the socket, an errno and nullptr if it failed or did not come
+    template <typename Duration_t>
+    std::pair<int, UDPSocket_ptr>
+    wait(Duration_t timeout)
+    {
+      auto future = promise.get_future();
+      if (future.wait_for(timeout) != std::future_status::ready)
+      {
+        std::lock_guard<std::mutex> lock{access};
+        if (future.wait_for(0s) != std::future_status::ready)
+        {
+          abandoned = true;
+          return {ETIMEDOUT, nullptr};
+        }
+      }
+      return future.get();
+    }
+  };
+
+  std::string
+  udp_addr_string(const llarp::EndpointBase::AddressVariant_t& addr)
+  {
+    return std::visit([](const auto& addr) { return addr.ToString(); }, addr);
+  }
+
+  uint16_t
+  udp_src_port(const llarp::net::IPPacket& pkt)
+  {
+    return bufbe16toh(pkt.buf + pkt.Header()->ihl * 4);
+  }
+
+  template <size_t N>
+  void
+  copy_cstr(char (&dst)[N], const std::string& src)
+  {
+    const auto len = std::min(src.size(), N - 1);
+    std::copy_n(src.c_str(), len, dst);
+    dst[len] = 0;
+  }
+
   std::optional<lokinet_srv_record>
   SRVFromData(const llarp::dns::SRVData& data, std::string name)
   {
@@ -266,6 +408,10 @@ extern "C"
     auto lock = ctx->acquire();
     ctx->config->router.m_netId = lokinet_get_netid();
     ctx->config->logging.m_logLevel = llarp::GetLogLevel();
+    {
+      std::lock_guard<std::mutex> lock{ctx->udp_wake_access};
+      ctx->udp_stopped = false;
+    }
     ctx->runner = std::make_unique<std::thread>([ctx]() {
       llarp::util::SetThreadName("llarp-mainloop");
       ctx->impl->Configure(ctx->config);
@@ -333,6 +479,12 @@ extern "C"
     if (not ctx)
       return;
     auto lock = ctx->acquire();
+    // anyone polling our udp sockets gives up now rather than after we are done stopping
+    {
+      std::lock_guard<std::mutex> wakeLock{ctx->udp_wake_access};
+      ctx->udp_stopped = true;
+    }
+    ctx->udp_wake.notify_all();
 
     if (not ctx->impl->IsStopping())
     {
@@ -344,6 +496,9 @@ extern "C"
       ctx->runner->join();
 
     ctx->runner.reset();
+    // the sockets were on the endpoint that just went away
+    ctx->udp_sockets.clear();
+    ctx->udp.reset();
   }
 
   void EXPORT
@@ -594,4 +749,253 @@ extern "C"
     delete result->internal;
     result->internal = nullptr;
   }
+
+  int EXPORT
+  lokinet_udp_establish(
+      char* remoteHost,
+      char* remotePort,
+      char* localAddr,
+      struct lokinet_udp_flow* flow,
+      struct lokinet_context* ctx)
+  {
+    if (remoteHost == nullptr or remotePort == nullptr or flow == nullptr or ctx == nullptr)
+      return EINVAL;
+    std::optional<llarp::SockAddr> local;
+    if (not udp_local_addr(localAddr, local))
+      return EINVAL;
+
+    auto opening = std::make_shared<udp_opening>();
+    {
+      auto lock = ctx->acquire();
+      if (not ctx->impl->IsUp())
+        return EHOSTDOWN;
+      auto udp = udp_get(ctx);
+      if (udp == nullptr)
+        return ENOTSUP;
+      ctx->impl->CallSafe(
+          [udp, opening, local, host = std::string{remoteHost}, port = std::string{remotePort}]() {
+            udp->Establish(host, port, local, [udp, opening](int err, auto sock) {
+              opening->done(*udp, err, std::move(sock));
+            });
+          });
+    }
+
+    // an srv lookup waits on a path to the remote's introset (30s by default) before the flow
+    // gets its own
+    constexpr auto establish_timeout = 30s + llarp::handlers::EmbeddedUDP::OpenTimeout + 5s;
+    const auto [err, sock] = opening->wait(establish_timeout);
+    if (err)
+      return err;
+
+    auto lock = ctx->acquire();
+    const int id = ctx->next_udp_id++;
+    ctx->udp_sockets[id] = sock;
+
+    std::memset(flow, 0, sizeof(lokinet_udp_flow));
+    flow->socket_id = id;
+    copy_cstr(flow->remote_addr, udp_addr_string(*sock->remote));
+    copy_cstr(flow->local_addr, ctx->endpoint()->GetIdentity().pub.Addr().ToString());
+    flow->remote_port = sock->remotePort;
+    flow->local_port = sock->localPort;
+    return 0;
+  }
+
+  int EXPORT
+  lokinet_udp_bind(
+      int exposedPort,
+      char* srv,
+      char* localAddr,
+      struct lokinet_udp_bind_result* result,
+      struct lokinet_context* ctx)
+  {
+    if (result == nullptr or ctx == nullptr or exposedPort <= 0 or exposedPort > 65535)
+      return EINVAL;
+    std::optional<llarp::SockAddr> local;
+    if (not udp_local_addr(localAddr, local))
+      return EINVAL;
+
+    auto opening = std::make_shared<udp_opening>();
+    {
+      auto lock = ctx->acquire();
+      if (not ctx->impl->IsUp())
+        return EHOSTDOWN;
+      auto udp = udp_get(ctx);
+      if (udp == nullptr)
+        return ENOTSUP;
+      ctx->impl->CallSafe(
+          [udp, opening, local, port = exposedPort, srv = std::string{srv ? srv : ""}]() {
+            auto [err, sock] = udp->Bind(port, srv, local);
+            opening->done(*udp, err, std::move(sock));
+          });
+    }
+    // binding happens right away on the event loop, unless it is stopping and never gets to it
+    const auto [err, sock] = opening->wait(10s);
+    if (err)
+      return err;
+
+    auto lock = ctx->acquire();
+    result->socket_id = ctx->next_udp_id++;
+    ctx->udp_sockets[result->socket_id] = sock;
+    return 0;
+  }
+
+  int EXPORT
+  lokinet_udp_poll(
+      const int* socket_ids,
+      size_t numsockets,
+      const struct timespec* timeout,
+      struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr or (socket_ids == nullptr and numsockets > 0))
+      return EINVAL;
+
+    std::vector<UDPSocket_ptr> socks;
+    socks.reserve(numsockets);
+    {
+      auto lock = ctx->acquire();
+      for (size_t idx = 0; idx < numsockets; ++idx)
+      {
+        auto itr = ctx->udp_sockets.find(socket_ids[idx]);
+        if (itr == ctx->udp_sockets.end())
+          return EBADF;
+        socks.emplace_back(itr->second);
+      }
+    }
+    const auto readable = [&socks]() {
+      return std::any_of(
+          socks.begin(), socks.end(), [](const auto& sock) { return not sock->rx.empty(); });
+    };
+    if (readable())
+      return 0;
+
+    ctx->udp_sleepers.fetch_add(1);
+    // pairs with the fence in udp_wake
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool ready = true;
+    bool stopped = false;
+    {
+      std::unique_lock<std::mutex> lock{ctx->udp_wake_access};
+      const auto woken = [ctx, &readable]() { return ctx->udp_stopped or readable(); };
+      if (timeout)
+      {
+        const auto wait = std::chrono::seconds{timeout->tv_sec}
+            + std::chrono::nanoseconds{timeout->tv_nsec};
+        ready = ctx->udp_wake.wait_for(lock, wait, woken);
+      }
+      else
+        ctx->udp_wake.wait(lock, woken);
+      stopped = ctx->udp_stopped;
+    }
+    ctx->udp_sleepers.fetch_sub(1);
+    if (stopped)
+      return EHOSTDOWN;
+    return ready ? 0 : ETIMEDOUT;
+  }
+
+  ssize_t EXPORT
+  lokinet_udp_recvmmsg(
+      int socket_id,
+      struct lokinet_udp_pkt* events,
+      size_t max_events,
+      struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr or (events == nullptr and max_events > 0))
+      return -EINVAL;
+    auto sock = ctx->udp_socket(socket_id);
+    if (sock == nullptr)
+      return -EBADF;
+
+    size_t num = 0;
+    sock->rx.drain(
+        [events, &num](auto& dgram) {
+          auto& event = events[num++];
+          const auto& pkt = dgram.pkt;
+          const size_t offset = size_t{pkt.Header()->ihl} * 4 + 8;
+          copy_cstr(event.remote_addr, udp_addr_string(dgram.remote));
+          event.remote_port = udp_src_port(pkt);
+          const size_t len = std::min(pkt.sz - offset, event.pkt.iov_base ? event.pkt.iov_len : 0);
+          std::copy_n(pkt.buf + offset, len, static_cast<byte_t*>(event.pkt.iov_base));
+          event.pkt.iov_len = len;
+        },
+        max_events);
+    return num;
+  }
+
+  ssize_t EXPORT
+  lokinet_udp_sendmmsg(
+      int socket_id,
+      const struct lokinet_udp_pkt* pkts,
+      size_t num,
+      struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr or (pkts == nullptr and num > 0))
+      return -EINVAL;
+    std::shared_ptr<llarp::handlers::EmbeddedUDP> udp;
+    UDPSocket_ptr sock;
+    {
+      auto lock = ctx->acquire();
+      if (not ctx->impl->IsUp())
+        return -EHOSTDOWN;
+      if (auto itr = ctx->udp_sockets.find(socket_id); itr != ctx->udp_sockets.end())
+        sock = itr->second;
+      udp = ctx->udp;
+    }
+    if (sock == nullptr)
+      return -EBADF;
+    if (const int err = sock->TakeError())
+      return -err;
+
+    size_t sent = 0;
+    for (; sent < num; ++sent)
+    {
+      const auto& pkt = pkts[sent];
+      std::optional<llarp::EndpointBase::AddressVariant_t> remote;
+      uint16_t port = 0;
+      if (not sock->remote)
+      {
+        const auto len = strnlen(pkt.remote_addr, sizeof(pkt.remote_addr));
+        if (len < sizeof(pkt.remote_addr))
+          remote = llarp::service::ParseAddress(std::string_view{pkt.remote_addr, len});
+        if (pkt.remote_port > 0 and pkt.remote_port <= 65535)
+          port = pkt.remote_port;
+      }
+      const auto err = sock->Queue(
+          remote,
+          port,
+          llarp_buffer_t{static_cast<const byte_t*>(pkt.pkt.iov_base), pkt.pkt.iov_len});
+      if (err)
+      {
+        if (sent == 0)
+          return -err;
+        break;
+      }
+    }
+    if (sent > 0 and sock->WantFlush())
+    {
+      auto lock = ctx->acquire();
+      if (not ctx->impl->IsUp())
+      {
+        // nobody will flush it, let the next send try again
+        sock->CancelFlush();
+        return -EHOSTDOWN;
+      }
+      ctx->impl->CallSafe([udp, sock]() { udp->Flush(sock); });
+    }
+    return sent;
+  }
+
+  void EXPORT
+  lokinet_udp_close(int socket_id, struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr)
+      return;
+    auto lock = ctx->acquire();
+    auto itr = ctx->udp_sockets.find(socket_id);
+    if (itr == ctx->udp_sockets.end())
+      return;
+    auto sock = itr->second;
+    ctx->udp_sockets.erase(itr);
+    if (ctx->impl->IsUp() and ctx->udp)
+      ctx->impl->CallSafe([udp = ctx->udp, sock]() { udp->Close(sock); });
+  }
 }
@@ -0,0 +1,315 @@
+#pragma once
+
+#include "net_int.hpp"
+#include <llarp/util/time.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace llarp
+{
+  namespace net
+  {
+    /// the ip addresses we handed out to remotes, what they map to and when they were last
+    /// active.
+    ///
+    /// Flows sit packed in one vector with two open addressing indexes of flow numbers over it,
+    /// one keyed by ip and one by remote, so a lookup either way is a probe or two into a small
+    /// array of uint32s and one flow.  Flows are threaded on an intrusive list from least to most
+    /// recently active, which makes finding the one to reclaim when the range runs out O(1).
+    /// Pinned flows are kept off the list and are never reclaimed.
+    template <typename Remote_t>
+    class FlowTable
+    {
+     public:
+      struct Flow
+      {
+        huint128_t ip;
+        Remote_t remote;
+        bool snode;
+        llarp_time_t lastActive;
+      };
+
+      size_t
+      size() const
+      {
+        return m_Nodes.size();
+      }
+
+      bool
+      empty() const
+      {
+        return m_Nodes.empty();
+      }
+
+      const Flow*
+      FindByIP(const huint128_t& ip) const
+      {
+        const auto slot = FindSlot(m_ByIP, ip);
+        return slot == NoIndex ? nullptr : &m_Nodes[m_ByIP[slot] - 1].flow;
+      }
+
+      const Flow*
+      FindByRemote(const Remote_t& remote) const
+      {
+        const auto slot = FindSlot(m_ByRemote, remote);
+        return slot == NoIndex ? nullptr : &m_Nodes[m_ByRemote[slot] - 1].flow;
+      }
+
+      /// map ip to remote as of now, dropping whatever either was mapped to before.
+      /// takes them by value as they are often out of the flow about to be dropped.
+      const Flow&
+      Map(huint128_t ip, Remote_t remote, bool snode, llarp_time_t now)
+      {
+        EraseIP(ip);
+        EraseRemote(remote);
+        if ((m_Nodes.size() + 1) * 2 > m_ByIP.size())
+          Rehash(std::max<size_t>(InitialSlots, m_ByIP.size() * 2));
+        const auto idx = static_cast<uint32_t>(m_Nodes.size());
+        m_Nodes.push_back(Node{Flow{ip, remote, snode, now}, NoIndex, NoIndex});
+        Insert(m_ByIP, ip, idx);
+        Insert(m_ByRemote, remote, idx);
+        LinkBack(idx);
+        return m_Nodes[idx].flow;
+      }
+
+      /// mark ip active at now, making it the last to be reclaimed
+      void
+      Touch(const huint128_t& ip, llarp_time_t now)
+      {
+        const auto slot = FindSlot(m_ByIP, ip);
+        if (slot == NoIndex)
+          return;
+        const auto idx = m_ByIP[slot] - 1;
+        auto& flow = m_Nodes[idx].flow;
+        if (flow.lastActive == Forever)
+          return;
+        flow.lastActive = std::max(flow.lastActive, now);
+        Unlink(idx);
+        LinkBack(idx);
+      }
+
+      /// never reclaim ip
+      void
+      Pin(const huint128_t& ip)
+      {
+        const auto slot = FindSlot(m_ByIP, ip);
+        if (slot == NoIndex)
+          return;
+        const auto idx = m_ByIP[slot] - 1;
+        auto& flow = m_Nodes[idx].flow;
+        if (flow.lastActive == Forever)
+          return;
+        Unlink(idx);
+        flow.lastActive = Forever;
+      }
+
+      /// the least recently active flow that is not pinned, the one to reclaim first
+      const Flow*
+      Oldest() const
+      {
+        return m_Head == NoIndex ? nullptr : &m_Nodes[m_Head].flow;
+      }
+
+      bool
+      EraseIP(const huint128_t& ip)
+      {
+        const auto slot = FindSlot(m_ByIP, ip);
+        if (slot == NoIndex)
+          return false;
+        Remove(m_ByIP[slot] - 1);
+        return true;
+      }
+
+      bool
+      EraseRemote(const Remote_t& remote)
+      {
+        const auto slot = FindSlot(m_ByRemote, remote);
+        if (slot == NoIndex)
+          return false;
+        Remove(m_ByRemote[slot] - 1);
+        return true;
+      }
+
+      /// call visit(flow) for every flow in no particular order
+      template <typename Visit_t>
+      void
+      ForEach(Visit_t&& visit) const
+      {
+        for (const auto& node : m_Nodes)
+          visit(node.flow);
+      }
+
+     private:
+      static constexpr uint32_t NoIndex = std::numeric_limits<uint32_t>::max();
+      static constexpr size_t InitialSlots = 16;
+      static constexpr llarp_time_t Forever = llarp_time_t::max();
+
+      struct Node
+      {
+        Flow flow;
+        uint32_t prev;
+        uint32_t next;
+      };
+
+      /// index slots hold flow number + 1, 0 is empty
+      using Index_t = std::vector<uint32_t>;
+
+      static const huint128_t&
+      KeyOf(const Flow& flow, const huint128_t&)
+      {
+        return flow.ip;
+      }
+
+      static const Remote_t&
+      KeyOf(const Flow& flow, const Remote_t&)
+      {
+        return flow.remote;
+      }
+
+      /// where key would like to sit in an index, fibonacci hashing so runs of sequential ips and
+      /// weak hashes spread out over the whole index
+      template <typename Key_t>
+      size_t
+      Home(const Key_t& key) const
+      {
+        const uint64_t h = std::hash<Key_t>{}(key);
+        return (h * 0x9E3779B97F4A7C15ULL) >> m_Shift;
+      }
+
+      template <typename Key_t>
+      uint32_t
+      FindSlot(const Index_t& index, const Key_t& key) const
+      {
+        if (m_Nodes.empty())
+          return NoIndex;
+        const size_t mask = index.size() - 1;
+        for (size_t slot = Home(key); index[slot]; slot = (slot + 1) & mask)
+        {
+          if (KeyOf(m_Nodes[index[slot] - 1].flow, key) == key)
+            return slot;
+        }
+        return NoIndex;
+      }
+
+      template <typename Key_t>
+      void
+      Insert(Index_t& index, const Key_t& key, uint32_t idx)
+      {
+        const size_t mask = index.size() - 1;
+        size_t slot = Home(key);
+        while (index[slot])
+          slot = (slot + 1) & mask;
+        index[slot] = idx + 1;
+      }
+
+      /// empty slot, shifting back whatever probed past it so no lookup runs into the hole
+      template <typename Key_t>
+      void
+      EraseSlot(Index_t& index, size_t slot, const Key_t& tag)
+      {
+        const size_t mask = index.size() - 1;
+        size_t hole = slot;
+        for (size_t next = (hole + 1) & mask; index[next]; next = (next + 1) & mask)
+        {
+          const size_t home = Home(KeyOf(m_Nodes[index[next] - 1].flow, tag));
+          // can the entry at next move back into the hole without ending up before its home
+          if (((next - home) & mask) >= ((next - hole) & mask))
+          {
+            index[hole] = index[next];
+            hole = next;
+          }
+        }
+        index[hole] = 0;
+      }
+
+      /// point the index slot holding flow from at flow to
+      template <typename Key_t>
+      void
+      Renumber(Index_t& index, const Key_t& key, uint32_t from, uint32_t to)
+      {
+        const size_t mask = index.size() - 1;
+        size_t slot = Home(key);
+        while (index[slot] != from + 1)
+          slot = (slot + 1) & mask;
+        index[slot] = to + 1;
+      }
+
+      void
+      Rehash(size_t slots)
+      {
+        m_Shift = 64;
+        for (size_t n = slots; n > 1; n /= 2)
+          --m_Shift;
+        m_ByIP.assign(slots, 0);
+        m_ByRemote.assign(slots, 0);
+        for (uint32_t idx = 0; idx < m_Nodes.size(); ++idx)
+        {
+          Insert(m_ByIP, m_Nodes[idx].flow.ip, idx);
+          Insert(m_ByRemote, m_Nodes[idx].flow.remote, idx);
+        }
+      }
+
+      void
+      LinkBack(uint32_t idx)
+      {
+        auto& node = m_Nodes[idx];
+        node.prev = m_Tail;
+        node.next = NoIndex;
+        if (m_Tail == NoIndex)
+          m_Head = idx;
+        else
+          m_Nodes[m_Tail].next = idx;
+        m_Tail = idx;
+      }
+
+      void
+      Unlink(uint32_t idx)
+      {
+        auto& node = m_Nodes[idx];
+        if (node.flow.lastActive == Forever)
+          return;
+        (node.prev == NoIndex ? m_Head : m_Nodes[node.prev].next) = node.next;
+        (node.next == NoIndex ? m_Tail : m_Nodes[node.next].prev) = node.prev;
+        node.prev = node.next = NoIndex;
+      }
+
+      /// drop flow idx, moving the last flow into its place to keep them packed
+      void
+      Remove(uint32_t idx)
+      {
+        Unlink(idx);
+        {
+          const auto& flow = m_Nodes[idx].flow;
+          EraseSlot(m_ByIP, FindSlot(m_ByIP, flow.ip), flow.ip);
+          EraseSlot(m_ByRemote, FindSlot(m_ByRemote, flow.remote), flow.remote);
+        }
+        const auto last = static_cast<uint32_t>(m_Nodes.size() - 1);
+        if (idx != last)
+        {
+          auto& moved = m_Nodes[idx];
+          moved = std::move(m_Nodes[last]);
+          Renumber(m_ByIP, moved.flow.ip, last, idx);
+          Renumber(m_ByRemote, moved.flow.remote, last, idx);
+          if (moved.flow.lastActive != Forever)
+          {
+            (moved.prev == NoIndex ? m_Head : m_Nodes[moved.prev].next) = idx;
+            (moved.next == NoIndex ? m_Tail : m_Nodes[moved.next].prev) = idx;
+          }
+        }
+        m_Nodes.pop_back();
+      }
+
+      std::vector<Node> m_Nodes;
+      Index_t m_ByIP;
+      Index_t m_ByRemote;
+      uint32_t m_Head = NoIndex;
+      uint32_t m_Tail = NoIndex;
+      /// 64 - log2 of the index size
+      unsigned m_Shift = 64;
+    };
+  }  // namespace net
+}  // namespace llarp
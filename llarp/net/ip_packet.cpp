@@ -92,7 +92,7 @@ namespace llarp
     bool
     IPPacket::Load(const llarp_buffer_t& pkt)
     {
-      if (pkt.sz > sizeof(buf) or pkt.sz == 0)
+      if (pkt.sz > MaxSize or pkt.sz == 0)
         return false;
       sz = pkt.sz;
       std::copy_n(pkt.base, sz, buf);
@@ -526,6 +526,8 @@ namespace llarp
         constexpr auto icmp_Header_size = 8;
         constexpr auto ip_Header_size = 20;
         net::IPPacket pkt{};
+        // pooled packet buffers are not zeroed for us
+        std::fill_n(pkt.buf, ip_Header_size + icmp_Header_size, 0);
         auto* pkt_Header = pkt.Header();
 
         pkt_Header->version = 4;
@@ -581,7 +583,7 @@ namespace llarp
     {
       net::IPPacket pkt;
 
-      if (buf.sz + 28 > sizeof(pkt.buf))
+      if (buf.sz + 28 > IPPacket::MaxSize)
       {
         pkt.sz = 0;
         return pkt;
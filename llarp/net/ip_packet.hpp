@@ -2,6 +2,7 @@
 
 #include <llarp/ev/ev.hpp>
 #include "net.hpp"
+#include <llarp/util/block_pool.hpp>
 #include <llarp/util/buffer.hpp>
 #include <llarp/util/time.hpp>
 
@@ -104,6 +105,7 @@ struct ipv6_header
   FlowLabel(llarp::nuint32_t flowlabel);
 };
 
+#include <algorithm>
 #include <memory>
 #include <llarp/service/protocol_type.hpp>
 #include <utility>
@@ -138,12 +140,65 @@ namespace llarp
     ParseIPProtocol(std::string data);
 
     /// an Packet
+    ///
+    /// the packet data lives in a block taken from a pool rather than inline, moving a packet
+    /// (tun read -> packet router -> send queue) just hands over the block.  copying a packet
+    /// copies only the sz bytes that are in use.  a moved from packet has no buffer and must be
+    /// assigned to before it is used again.
     struct IPPacket
     {
       static constexpr size_t MaxSize = 1500;
-      llarp_time_t timestamp;
-      size_t sz;
-      byte_t buf[MaxSize];
+      using Pool_t = util::BlockPool<MaxSize>;
+
+      llarp_time_t timestamp = 0s;
+      size_t sz = 0;
+      /// MaxSize bytes of packet data
+      byte_t* buf;
+
+      IPPacket() : buf{static_cast<byte_t*>(Pool_t::Alloc())}
+      {}
+
+      IPPacket(const IPPacket& other)
+          : timestamp{other.timestamp}, sz{other.sz}, buf{static_cast<byte_t*>(Pool_t::Alloc())}
+      {
+        std::copy_n(other.buf, sz, buf);
+      }
+
+      IPPacket(IPPacket&& other) noexcept
+          : timestamp{other.timestamp}, sz{std::exchange(other.sz, 0)}, buf{other.buf}
+      {
+        other.buf = nullptr;
+      }
+
+      IPPacket&
+      operator=(const IPPacket& other)
+      {
+        if (this == &other)
+          return *this;
+        if (buf == nullptr)
+          buf = static_cast<byte_t*>(Pool_t::Alloc());
+        timestamp = other.timestamp;
+        sz = other.sz;
+        std::copy_n(other.buf, sz, buf);
+        return *this;
+      }
+
+      IPPacket&
+      operator=(IPPacket&& other) noexcept
+      {
+        if (this == &other)
+          return *this;
+        Pool_t::Free(buf);
+        timestamp = other.timestamp;
+        sz = std::exchange(other.sz, 0);
+        buf = std::exchange(other.buf, nullptr);
+        return *this;
+      }
+
+      ~IPPacket()
+      {
+        Pool_t::Free(buf);
+      }
 
       static IPPacket
       UDP(nuint32_t srcaddr,
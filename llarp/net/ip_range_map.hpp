@@ -1,7 +1,11 @@
 #pragma once
 
 #include "ip_range.hpp"
+#include "ip_range_trie.hpp"
 #include <llarp/util/status.hpp>
+#include <functional>
+#include <optional>
+#include <set>
 #include <vector>
 
 namespace llarp
@@ -10,8 +14,10 @@ namespace llarp
   {
     /// a container that maps an ip range to a value that allows you to lookup
     /// key by range hit
-    /// TODO: do some kind of magic shit to ensure near constant time for
-    /// lookups
+    ///
+    /// entries are kept in insertion order for iterating, lookups by address go through a prefix
+    /// trie over the ranges so they cost one step per prefix length on the way down no matter how
+    /// many ranges there are
     template <typename Value_t>
     struct IPRangeMap
     {
@@ -81,10 +87,13 @@ namespace llarp
       std::optional<Value_t>
       GetExact(Range_t range) const
       {
-        for (const auto& [r, value] : m_Entries)
+        if (const auto* ids = m_Trie.Exact(range))
         {
-          if (r == range)
-            return value;
+          for (const auto id : *ids)
+          {
+            if (m_Entries[id].first == range)
+              return m_Entries[id].second;
+          }
         }
         return std::nullopt;
       }
@@ -94,11 +103,7 @@ namespace llarp
       FindAllEntries(const IP_t& addr) const
       {
         std::set<Entry_t> found;
-        for (const auto& entry : m_Entries)
-        {
-          if (entry.first.Contains(addr))
-            found.insert(entry);
-        }
+        m_Trie.VisitMatching(addr, [&](auto id) { found.insert(m_Entries[id]); });
         return found;
       }
 
@@ -114,6 +119,7 @@ namespace llarp
       void
       Insert(const Range_t& addr, const Value_t& val)
       {
+        m_Trie.Insert(addr, m_Entries.size());
         m_Entries.emplace_back(addr, val);
       }
 
@@ -121,6 +127,7 @@ namespace llarp
       void
       RemoveIf(Visit_t visit)
       {
+        const auto before = m_Entries.size();
         auto itr = m_Entries.begin();
         while (itr != m_Entries.end())
         {
@@ -129,6 +136,13 @@ namespace llarp
           else
             ++itr;
         }
+        // the trie refers to entries by position, which just moved
+        if (m_Entries.size() != before)
+        {
+          m_Trie.Clear();
+          for (size_t idx = 0; idx < m_Entries.size(); ++idx)
+            m_Trie.Insert(m_Entries[idx].first, idx);
+        }
       }
 
       util::StatusObject
@@ -144,6 +158,7 @@ namespace llarp
 
      private:
       Container_t m_Entries;
+      IPRangeTrie m_Trie;
     };
   }  // namespace net
 }  // namespace llarp
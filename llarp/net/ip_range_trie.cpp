@@ -0,0 +1,185 @@
+#include "ip_range_trie.hpp"
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace net
+  {
+    namespace
+    {
+      uint8_t
+      LeadingZeros(uint64_t x)
+      {
+#ifdef __GNUC__
+        return x == 0 ? 64 : __builtin_clzll(x);
+#else
+        uint8_t n = 0;
+        for (uint64_t bit = uint64_t{1} << 63; bit and not(x & bit); bit >>= 1)
+          ++n;
+        return n;
+#endif
+      }
+    }  // namespace
+
+    IPRangeTrie::IPRangeTrie()
+    {
+      Clear();
+    }
+
+    void
+    IPRangeTrie::Clear()
+    {
+      m_Nodes.clear();
+      m_Ids.clear();
+      m_NumRanges = 0;
+      // the root is ::/0 and always there so lookups never have to check for an empty trie
+      AddNode(uint128_t{0}, 0);
+    }
+
+    uint128_t
+    IPRangeTrie::Mask(const uint128_t& a, uint8_t len)
+    {
+      const uint64_t hi = len >= 64 ? ~uint64_t{0} : len == 0 ? 0 : ~uint64_t{0} << (64 - len);
+      const uint64_t lo = len <= 64 ? 0 : ~uint64_t{0} << (128 - len);
+      return uint128_t{a.upper & hi, a.lower & lo};
+    }
+
+    uint8_t
+    IPRangeTrie::CommonPrefix(const uint128_t& a, const uint128_t& b, uint8_t max)
+    {
+      const uint64_t hi = a.upper ^ b.upper;
+      const uint8_t common = hi ? LeadingZeros(hi) : 64 + LeadingZeros(a.lower ^ b.lower);
+      return std::min(common, max);
+    }
+
+    uint32_t
+    IPRangeTrie::AddNode(const uint128_t& prefix, uint8_t len)
+    {
+      m_Nodes.emplace_back();
+      m_Nodes.back().prefix = prefix;
+      m_Nodes.back().len = len;
+      return m_Nodes.size() - 1;
+    }
+
+    void
+    IPRangeTrie::Insert(const IPRange& range, Id_t id)
+    {
+      const uint8_t len = bits::count_bits(range.netmask_bits);
+      const auto prefix = Mask(range.addr.h, len);
+
+      // m_Nodes may grow below so nodes are only ever referred to by index here
+      uint32_t idx = 0;
+      uint32_t target = NoNode;
+      while (target == NoNode)
+      {
+        if (m_Nodes[idx].len == len)
+        {
+          target = idx;
+          break;
+        }
+        const auto bit = BitAt(prefix, m_Nodes[idx].len);
+        const auto childIdx = m_Nodes[idx].child[bit];
+        if (childIdx == NoNode)
+        {
+          target = AddNode(prefix, len);
+          m_Nodes[idx].child[bit] = target;
+          break;
+        }
+        const auto childPrefix = m_Nodes[childIdx].prefix;
+        const auto childLen = m_Nodes[childIdx].len;
+        const auto common = CommonPrefix(childPrefix, prefix, std::min(childLen, len));
+        if (common == childLen)
+        {
+          idx = childIdx;
+          continue;
+        }
+        // the child's prefix goes past where it and ours part ways, put a node in between
+        if (common == len)
+        {
+          // ours ends on the way to the child
+          target = AddNode(prefix, len);
+          m_Nodes[target].child[BitAt(childPrefix, len)] = childIdx;
+          m_Nodes[idx].child[bit] = target;
+        }
+        else
+        {
+          const auto split = AddNode(Mask(prefix, common), common);
+          target = AddNode(prefix, len);
+          m_Nodes[split].child[BitAt(childPrefix, common)] = childIdx;
+          m_Nodes[split].child[BitAt(prefix, common)] = target;
+          m_Nodes[idx].child[bit] = split;
+        }
+      }
+
+      auto& node = m_Nodes[target];
+      if (node.ids == NoIds)
+      {
+        node.ids = m_Ids.size();
+        m_Ids.emplace_back();
+        ++m_NumRanges;
+      }
+      m_Ids[node.ids].push_back(id);
+    }
+
+    uint32_t
+    IPRangeTrie::Find(const uint128_t& prefix, uint8_t len) const
+    {
+      for (uint32_t idx = 0; idx != NoNode;)
+      {
+        const auto& node = m_Nodes[idx];
+        if (node.len > len or not PrefixMatches(node.prefix, prefix, node.len))
+          return NoNode;
+        if (node.len == len)
+          return idx;
+        idx = node.child[BitAt(prefix, node.len)];
+      }
+      return NoNode;
+    }
+
+    bool
+    IPRangeTrie::Contains(const huint128_t& addr) const
+    {
+      bool found = false;
+      for (uint32_t idx = 0; idx != NoNode and not found;)
+      {
+        const auto& node = m_Nodes[idx];
+        if (not PrefixMatches(node.prefix, addr.h, node.len))
+          break;
+        found = node.ids != NoIds;
+        if (node.len == 128)
+          break;
+        idx = node.child[BitAt(addr.h, node.len)];
+      }
+      return found;
+    }
+
+    const std::vector<IPRangeTrie::Id_t>*
+    IPRangeTrie::LongestMatch(const huint128_t& addr) const
+    {
+      const std::vector<Id_t>* found = nullptr;
+      for (uint32_t idx = 0; idx != NoNode;)
+      {
+        const auto& node = m_Nodes[idx];
+        if (not PrefixMatches(node.prefix, addr.h, node.len))
+          break;
+        if (node.ids != NoIds)
+          found = &m_Ids[node.ids];
+        if (node.len == 128)
+          break;
+        idx = node.child[BitAt(addr.h, node.len)];
+      }
+      return found;
+    }
+
+    const std::vector<IPRangeTrie::Id_t>*
+    IPRangeTrie::Exact(const IPRange& range) const
+    {
+      const uint8_t len = bits::count_bits(range.netmask_bits);
+      const auto idx = Find(Mask(range.addr.h, len), len);
+      if (idx == NoNode or m_Nodes[idx].ids == NoIds)
+        return nullptr;
+      return &m_Ids[m_Nodes[idx].ids];
+    }
+  }  // namespace net
+}  // namespace llarp
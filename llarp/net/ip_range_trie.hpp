@@ -0,0 +1,129 @@
+#pragma once
+
+#include "ip_range.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace llarp
+{
+  namespace net
+  {
+    /// A path compressed binary trie of ip ranges for longest prefix match lookups.
+    ///
+    /// Ranges are keyed on their masked address and prefix length, v4 ranges live in the v4
+    /// mapped part of the v6 space like everywhere else.  Every node stores the full prefix
+    /// leading up to it, so a lookup is one masked compare and one bit test per node on the way
+    /// down and never backtracks; with path compression that is at most one node per distinct
+    /// prefix length on the path rather than one per bit.  Each range carries the ids it was
+    /// inserted with, the caller keeps whatever they refer to.
+    class IPRangeTrie
+    {
+     public:
+      using Id_t = uint32_t;
+
+      IPRangeTrie();
+
+      void
+      Insert(const IPRange& range, Id_t id);
+
+      void
+      Clear();
+
+      bool
+      Empty() const
+      {
+        return m_NumRanges == 0;
+      }
+
+      /// number of distinct ranges
+      size_t
+      Size() const
+      {
+        return m_NumRanges;
+      }
+
+      /// call visit(id) for every range that contains addr, shortest prefix first
+      template <typename Visit>
+      void
+      VisitMatching(const huint128_t& addr, Visit&& visit) const
+      {
+        for (uint32_t idx = 0; idx != NoNode;)
+        {
+          const auto& node = m_Nodes[idx];
+          if (not PrefixMatches(node.prefix, addr.h, node.len))
+            return;
+          if (node.ids != NoIds)
+          {
+            for (const auto id : m_Ids[node.ids])
+              visit(id);
+          }
+          if (node.len == 128)
+            return;
+          idx = node.child[BitAt(addr.h, node.len)];
+        }
+      }
+
+      /// true if any range contains addr
+      bool
+      Contains(const huint128_t& addr) const;
+
+      /// the ids of the longest range that contains addr, nullptr if there is none
+      const std::vector<Id_t>*
+      LongestMatch(const huint128_t& addr) const;
+
+      /// the ids inserted with exactly this range, nullptr if there are none
+      const std::vector<Id_t>*
+      Exact(const IPRange& range) const;
+
+     private:
+      static constexpr uint32_t NoNode = ~uint32_t{0};
+      static constexpr uint32_t NoIds = ~uint32_t{0};
+
+      struct Node
+      {
+        /// masked to len bits
+        uint128_t prefix;
+        uint8_t len;
+        /// index into m_Nodes by the bit after the prefix
+        uint32_t child[2] = {NoNode, NoNode};
+        /// index into m_Ids if a range ends here
+        uint32_t ids = NoIds;
+      };
+
+      /// bit `idx` of a counting from the most significant one
+      static uint32_t
+      BitAt(const uint128_t& a, uint8_t idx)
+      {
+        return idx < 64 ? (a.upper >> (63 - idx)) & 1 : (a.lower >> (127 - idx)) & 1;
+      }
+
+      /// do a and b agree on their first len bits
+      static bool
+      PrefixMatches(const uint128_t& a, const uint128_t& b, uint8_t len)
+      {
+        const uint64_t hi = len >= 64 ? ~uint64_t{0} : len == 0 ? 0 : ~uint64_t{0} << (64 - len);
+        const uint64_t lo = len <= 64 ? 0 : ~uint64_t{0} << (128 - len);
+        return (((a.upper ^ b.upper) & hi) | ((a.lower ^ b.lower) & lo)) == 0;
+      }
+
+      static uint128_t
+      Mask(const uint128_t& a, uint8_t len);
+
+      /// number of leading bits a and b agree on, at most `max`
+      static uint8_t
+      CommonPrefix(const uint128_t& a, const uint128_t& b, uint8_t max);
+
+      uint32_t
+      AddNode(const uint128_t& prefix, uint8_t len);
+
+      /// the node for exactly this prefix, NoNode if there isn't one
+      uint32_t
+      Find(const uint128_t& prefix, uint8_t len) const;
+
+      std::vector<Node> m_Nodes;
+      std::vector<std::vector<Id_t>> m_Ids;
+      size_t m_NumRanges = 0;
+    };
+  }  // namespace net
+}  // namespace llarp
@@ -0,0 +1,193 @@
+#include "tcp_coalesce.hpp"
+
+#include <llarp/util/endian.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace llarp
+{
+  namespace net
+  {
+    namespace
+    {
+      constexpr uint8_t ProtoTCP = 6;
+      constexpr uint8_t TCPFlagPSH = 0x08;
+      constexpr uint8_t TCPFlagACK = 0x10;
+      constexpr size_t TCPChecksumOffset = 16;
+    }  // namespace
+
+    bool
+    CompleteChecksum(const VNetHeader& hdr, byte_t* data, size_t sz)
+    {
+      if (not(hdr.flags & VNetHeader::NeedsChecksum))
+        return true;
+      const size_t field = size_t{hdr.csumStart} + hdr.csumOffset;
+      if (field + sizeof(uint16_t) > sz)
+        return false;
+      // the field already holds the pseudo header sum, summing over it finishes the job
+      const uint16_t sum = ipchksum(data + hdr.csumStart, sz - hdr.csumStart);
+      std::memcpy(data + field, &sum, sizeof(sum));
+      return true;
+    }
+
+    bool
+    TCPCoalescer::Parse(const IPPacket& pkt, Segment& seg)
+    {
+      seg.pkt = &pkt;
+      if (pkt.sz < 20)
+        return false;
+      if (pkt.IsV4())
+      {
+        // no ip options and no fragments
+        const auto* hdr = pkt.Header();
+        if (hdr->ihl != 5 or hdr->protocol != ProtoTCP or ntohs(hdr->tot_len) != pkt.sz
+            or (ntohs(hdr->frag_off) & 0x3fff))
+          return false;
+        seg.ipLen = 20;
+      }
+      else if (pkt.IsV6())
+      {
+        // no extension headers
+        if (pkt.sz < 40 or pkt.HeaderV6()->proto != ProtoTCP
+            or ntohs(pkt.HeaderV6()->payload_len) + size_t{40} != pkt.sz)
+          return false;
+        seg.ipLen = 40;
+      }
+      else
+        return false;
+
+      if (pkt.sz < seg.ipLen + size_t{20})
+        return false;
+      const byte_t* tcp = pkt.buf + seg.ipLen;
+      seg.tcpLen = (tcp[12] >> 4) * 4;
+      // segments without a payload are acks that should go out right away as they are
+      if (seg.tcpLen < 20 or seg.ipLen + seg.tcpLen >= pkt.sz)
+        return false;
+      seg.flags = tcp[13];
+      if ((seg.flags & ~TCPFlagPSH) != TCPFlagACK)
+        return false;
+      seg.payload = pkt.sz - seg.ipLen - seg.tcpLen;
+      seg.seq = bufbe32toh(tcp + 4);
+      return true;
+    }
+
+    bool
+    TCPCoalescer::Continues(const Segment& next) const
+    {
+      const auto& first = m_Run.front();
+      const auto& last = m_Run.back();
+      if (m_Run.size() >= MaxSegments or m_RunSize + next.payload > MaxSize)
+        return false;
+      // the kernel cuts every segment but the last one to the size of the first and only the
+      // last one keeps PSH, so a short or pushed segment ends a run
+      if (last.payload != first.payload or (last.flags & TCPFlagPSH) or next.payload > first.payload)
+        return false;
+      if (next.ipLen != first.ipLen or next.tcpLen != first.tcpLen
+          or next.seq != last.seq + last.payload)
+        return false;
+
+      const byte_t* a = first.pkt->buf;
+      const byte_t* b = next.pkt->buf;
+      if (first.ipLen == 20)
+      {
+        // all but the length, id and checksum match and the ids count up one per segment
+        if (not std::equal(a, a + 2, b) or not std::equal(a + 6, a + 10, b + 6)
+            or not std::equal(a + 12, a + 20, b + 12))
+          return false;
+        const uint16_t id = ntohs(first.pkt->Header()->id) + m_Run.size();
+        if (ntohs(next.pkt->Header()->id) != id)
+          return false;
+      }
+      else if (not std::equal(a, a + 4, b) or not std::equal(a + 6, a + 40, b + 6))
+        return false;
+
+      // ports, ack, header length, window and options match
+      a += first.ipLen;
+      b += first.ipLen;
+      return std::equal(a, a + 4, b) and std::equal(a + 8, a + 13, b + 8)
+          and std::equal(a + 14, a + 16, b + 14) and std::equal(a + 20, a + first.tcpLen, b + 20);
+    }
+
+    void
+    TCPCoalescer::FlushRun()
+    {
+      if (m_Run.empty())
+        return;
+      const auto& first = m_Run.front();
+      if (m_Run.size() == 1)
+      {
+        m_Writes.push_back(Write{VNetHeader{}, first.pkt->buf, first.pkt->sz, first.pkt, 1});
+        m_Run.clear();
+        return;
+      }
+
+      if (m_BuffersUsed == m_Buffers.size())
+        m_Buffers.emplace_back();
+      auto& buf = m_Buffers[m_BuffersUsed++];
+      buf.resize(m_RunSize);
+      const size_t hdrLen = first.ipLen + first.tcpLen;
+      auto* out = std::copy_n(first.pkt->buf, hdrLen, buf.data());
+      for (const auto& seg : m_Run)
+        out = std::copy_n(seg.pkt->buf + hdrLen, seg.payload, out);
+
+      byte_t* ip = buf.data();
+      // every segment gets these headers with its length, id, seq and checksums fixed up, only
+      // the last one keeps the flags as they are here
+      ip[first.ipLen + 13] = m_Run.back().flags;
+      const uint16_t tcpLen = m_RunSize - first.ipLen;
+      uint16_t pseudo;
+      VNetHeader hdr{};
+      if (first.ipLen == 20)
+      {
+        auto* hdr4 = reinterpret_cast<ip_header*>(ip);
+        hdr4->tot_len = htons(m_RunSize);
+        hdr4->check = 0;
+        hdr4->check = ipchksum(ip, 20);
+        pseudo = ipchksum(ip + 12, 8, htons(ProtoTCP) + htons(tcpLen));
+        hdr.gsoType = VNetHeader::GSOTCPv4;
+      }
+      else
+      {
+        reinterpret_cast<ipv6_header*>(ip)->payload_len = htons(tcpLen);
+        pseudo = ipchksum(ip + 8, 32, htons(ProtoTCP) + htons(tcpLen));
+        hdr.gsoType = VNetHeader::GSOTCPv6;
+      }
+      // the checksum field gets the pseudo header sum, the kernel adds the rest per segment
+      pseudo = ~pseudo;
+      std::memcpy(ip + first.ipLen + TCPChecksumOffset, &pseudo, sizeof(pseudo));
+
+      hdr.flags = VNetHeader::NeedsChecksum;
+      hdr.hdrLen = hdrLen;
+      hdr.gsoSize = first.payload;
+      hdr.csumStart = first.ipLen;
+      hdr.csumOffset = TCPChecksumOffset;
+      m_Writes.push_back(Write{hdr, buf.data(), m_RunSize, first.pkt, m_Run.size()});
+      m_Run.clear();
+    }
+
+    const std::vector<TCPCoalescer::Write>&
+    TCPCoalescer::Coalesce(const std::vector<IPPacket>& pkts)
+    {
+      m_Writes.clear();
+      m_Run.clear();
+      m_BuffersUsed = 0;
+      for (const auto& pkt : pkts)
+      {
+        Segment seg;
+        if (not Parse(pkt, seg))
+        {
+          FlushRun();
+          m_Writes.push_back(Write{VNetHeader{}, pkt.buf, pkt.sz, &pkt, 1});
+          continue;
+        }
+        if (not m_Run.empty() and not Continues(seg))
+          FlushRun();
+        m_RunSize = m_Run.empty() ? pkt.sz : m_RunSize + seg.payload;
+        m_Run.push_back(seg);
+      }
+      FlushRun();
+      return m_Writes;
+    }
+  }  // namespace net
+}  // namespace llarp
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "ip_packet.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace llarp
+{
+  namespace net
+  {
+    /// the header a tun device opened with IFF_VNET_HDR puts in front of every packet, laid out
+    /// like linux's struct virtio_net_hdr in host byte order
+    struct VNetHeader
+    {
+      static constexpr uint8_t NeedsChecksum = 1;
+
+      static constexpr uint8_t GSONone = 0;
+      static constexpr uint8_t GSOTCPv4 = 1;
+      static constexpr uint8_t GSOTCPv6 = 4;
+
+      uint8_t flags = 0;
+      uint8_t gsoType = GSONone;
+      /// length of the ip and tcp headers
+      uint16_t hdrLen = 0;
+      /// payload bytes per segment
+      uint16_t gsoSize = 0;
+      /// where the checksum covered by NeedsChecksum starts and where in that the field is
+      uint16_t csumStart = 0;
+      uint16_t csumOffset = 0;
+    };
+    static_assert(sizeof(VNetHeader) == 10);
+
+    /// finish a checksum the kernel left partial, `data` is the packet after the header.
+    /// returns false if the header points outside of the packet.
+    bool
+    CompleteChecksum(const VNetHeader& hdr, byte_t* data, size_t sz);
+
+    /// Turns a batch of packets bound for a tun device into as few writes as it can.
+    ///
+    /// Back to back tcp segments of one flow that continue each other, carry nothing but an ack
+    /// and share their headers otherwise are merged into one segmentation offload packet the
+    /// kernel cuts back up into exactly the segments that went in.  Everything else is written
+    /// as it is behind an empty header.
+    class TCPCoalescer
+    {
+     public:
+      /// the most segments merged into one write
+      static constexpr size_t MaxSegments = 64;
+      /// the most bytes in one merged packet, ip header included
+      static constexpr size_t MaxSize = 65535;
+
+      struct Write
+      {
+        VNetHeader hdr;
+        const byte_t* data;
+        size_t sz;
+        /// the first packet that went into it
+        const IPPacket* first;
+        /// how many packets went into it
+        size_t num;
+      };
+
+      /// the writes that put pkts on a tun device in order.  they point into pkts and into the
+      /// coalescer so are only good until pkts changes or the next call.
+      const std::vector<Write>&
+      Coalesce(const std::vector<IPPacket>& pkts);
+
+     private:
+      struct Segment
+      {
+        const IPPacket* pkt;
+        uint16_t ipLen;
+        uint16_t tcpLen;
+        uint16_t payload;
+        uint32_t seq;
+        uint8_t flags;
+      };
+
+      static bool
+      Parse(const IPPacket& pkt, Segment& seg);
+
+      /// can next go after the segments in m_Run
+      bool
+      Continues(const Segment& next) const;
+
+      /// emit m_Run as one write and start over
+      void
+      FlushRun();
+
+      std::vector<Write> m_Writes;
+      std::vector<Segment> m_Run;
+      size_t m_RunSize = 0;
+      /// merged packets, kept between calls so their memory is reused
+      std::vector<std::vector<byte_t>> m_Buffers;
+      size_t m_BuffersUsed = 0;
+    };
+  }  // namespace net
+}  // namespace llarp
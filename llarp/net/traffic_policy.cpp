@@ -1,6 +1,8 @@
 #include "traffic_policy.hpp"
 #include "llarp/util/str.hpp"
 
+#include <algorithm>
+
 namespace llarp::net
 {
   ProtocolInfo::ProtocolInfo(std::string_view data)
@@ -70,6 +72,53 @@ namespace llarp::net
     return false;
   }
 
+  CompiledTrafficPolicy::CompiledTrafficPolicy(const TrafficPolicy& policy)
+      : m_AllowAll{policy.protocols.empty() and policy.ranges.empty()}
+  {
+    for (const auto& proto : policy.protocols)
+    {
+      const auto num = static_cast<std::underlying_type_t<IPProtocol>>(proto.protocol);
+      if (not proto.port)
+      {
+        m_AnyPort.set(num);
+        continue;
+      }
+      m_SomePorts.set(num);
+      m_Ports.push_back((uint32_t{num} << 16) | proto.port->n);
+    }
+    std::sort(m_Ports.begin(), m_Ports.end());
+    for (const auto& range : policy.ranges)
+      m_Ranges.Insert(range, 0);
+  }
+
+  bool
+  CompiledTrafficPolicy::AllowsTraffic(const IPPacket& pkt) const
+  {
+    if (m_AllowAll)
+      return true;
+
+    const auto proto = pkt.Header()->protocol;
+    if (m_AnyPort.test(proto))
+      return true;
+    if (m_SomePorts.test(proto))
+    {
+      const auto maybe = pkt.DstPort();
+      // we can't tell what the port is but the protocol matches and that's good enough
+      if (not maybe)
+        return true;
+      if (std::binary_search(m_Ports.begin(), m_Ports.end(), (uint32_t{proto} << 16) | maybe->n))
+        return true;
+    }
+
+    if (m_Ranges.Empty())
+      return false;
+    if (pkt.IsV6())
+      return m_Ranges.Contains(pkt.dstv6());
+    if (pkt.IsV4())
+      return m_Ranges.Contains(pkt.dst4to6());
+    return false;
+  }
+
   bool
   ProtocolInfo::BDecode(llarp_buffer_t* buf)
   {
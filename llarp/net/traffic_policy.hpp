@@ -1,10 +1,13 @@
 #pragma once
 
 #include "ip_range.hpp"
+#include "ip_range_trie.hpp"
 #include "ip_packet.hpp"
 #include "llarp/util/status.hpp"
 
+#include <bitset>
 #include <set>
+#include <vector>
 
 namespace llarp::net
 {
@@ -67,4 +70,25 @@ namespace llarp::net
     bool
     AllowsTraffic(const IPPacket& pkt) const;
   };
+
+  /// a TrafficPolicy turned into lookup tables for checking every packet against
+  class CompiledTrafficPolicy
+  {
+   public:
+    explicit CompiledTrafficPolicy(const TrafficPolicy& policy);
+
+    /// same answer as TrafficPolicy::AllowsTraffic without walking the policy's sets
+    bool
+    AllowsTraffic(const IPPacket& pkt) const;
+
+   private:
+    bool m_AllowAll;
+    /// protocols allowed on any port, by protocol number
+    std::bitset<256> m_AnyPort;
+    /// protocols allowed on some ports only
+    std::bitset<256> m_SomePorts;
+    /// (protocol << 16) | port in network order for m_SomePorts, sorted
+    std::vector<uint32_t> m_Ports;
+    IPRangeTrie m_Ranges;
+  };
 }  // namespace llarp::net
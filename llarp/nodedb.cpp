@@ -11,12 +11,15 @@
 #include "dht/kademlia.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 
 static const char skiplist_subdirs[] = "0123456789abcdef";
 static const std::string RC_FILE_EXT = ".signed";
+static const std::string RC_STORE_FILE = "rcs.dat";
 
 namespace llarp
 {
@@ -24,7 +27,7 @@ namespace llarp
   {}
 
   static void
-  EnsureSkiplist(fs::path nodedbDir)
+  EnsureNodeDBDir(fs::path nodedbDir)
   {
     if (not fs::exists(nodedbDir))
     {
@@ -39,33 +42,87 @@ namespace llarp
 
     if (not fs::is_directory(nodedbDir))
       throw std::runtime_error(llarp::stringify("nodedb ", nodedbDir, " is not a directory"));
+  }
 
+  /// rc files left over from when every rc was its own file in a skiplist subdirectory
+  static std::vector<fs::path>
+  FindSkiplistRCs(const fs::path& nodedbDir)
+  {
+    std::vector<fs::path> files;
     for (const char& ch : skiplist_subdirs)
     {
-      // this seems to be a problem on all targets
-      // perhaps cpp17::fs is just as screwed-up
-      // attempting to create a folder with no name
-      // what does this mean...?
       if (!ch)
         continue;
+      llarp::util::IterDir(nodedbDir / std::string(&ch, 1), [&](const fs::path& f) -> bool {
+        if (fs::is_regular_file(f) and f.extension() == RC_FILE_EXT)
+          files.push_back(f);
+        return true;
+      });
+    }
+    return files;
+  }
 
-      fs::path sub = nodedbDir / std::string(&ch, 1);
-      fs::create_directory(sub);
+  static void
+  RemoveSkiplist(const fs::path& nodedbDir, const std::vector<fs::path>& files)
+  {
+    std::error_code ec;
+    for (const auto& f : files)
+      fs::remove(f, ec);
+    for (const char& ch : skiplist_subdirs)
+    {
+      // only goes if it is empty, anything we didn't put there stays
+      if (ch)
+        fs::remove(nodedbDir / std::string(&ch, 1), ec);
     }
   }
 
+  /// call func(0) ... func(num - 1) spread over one thread per core
+  template <typename Func>
+  static void
+  ParallelFor(size_t num, Func&& func)
+  {
+    // an rc costs a signature check, a thread for fewer than this costs more than it saves
+    constexpr size_t MinPerThread = 64;
+    const size_t threads = std::clamp<size_t>(
+        num / MinPerThread, 1, std::max(1u, std::thread::hardware_concurrency()));
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+      for (size_t idx = next++; idx < num; idx = next++)
+        func(idx);
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    while (workers.size() + 1 < threads)
+      workers.emplace_back(work);
+    work();
+    for (auto& worker : workers)
+      worker.join();
+  }
+
   constexpr auto FlushInterval = 5min;
 
   NodeDB::NodeDB(fs::path root, std::function<void(std::function<void()>)> diskCaller)
       : m_Root{std::move(root)}
+      , m_Store{std::make_shared<RCStore>(m_Root / RC_STORE_FILE)}
       , disk(std::move(diskCaller))
       , m_NextFlushAt{time_now_ms() + FlushInterval}
   {
-    EnsureSkiplist(m_Root);
+    EnsureNodeDBDir(m_Root);
   }
   NodeDB::NodeDB() : m_Root{}, disk{[](auto) {}}, m_NextFlushAt{0s}
   {}
 
+  std::vector<RouterContact>
+  NodeDB::TakeDirty()
+  {
+    std::vector<RouterContact> dirty;
+    dirty.reserve(m_Dirty.size());
+    for (const auto& pk : m_Dirty)
+      dirty.push_back(m_Entries.at(pk).rc);
+    m_Dirty.clear();
+    return dirty;
+  }
+
   void
   NodeDB::Tick(llarp_time_t now)
   {
@@ -75,71 +132,91 @@ namespace llarp
     if (now > m_NextFlushAt)
     {
       m_NextFlushAt += FlushInterval;
-      // make copy of all rcs
-      std::vector<RouterContact> copy;
-      for (const auto& item : m_Entries)
-        copy.push_back(item.second.rc);
-      // flush them to disk in one big job
-      // TODO: split this up? idk maybe some day...
-      disk([this, data = std::move(copy)]() {
-        for (const auto& rc : data)
-        {
-          rc.Write(GetPathForPubkey(rc.pubkey));
-        }
-      });
+      util::NullLock lock{m_Access};
+      if (m_Dirty.empty())
+        return;
+      // only what changed since the last flush, the rest is in the store already
+      disk([store = m_Store, rcs = TakeDirty()]() { store->Append(rcs); });
     }
   }
 
-  fs::path
-  NodeDB::GetPathForPubkey(RouterID pubkey) const
-  {
-    std::string hexString = oxenmq::to_hex(pubkey.begin(), pubkey.end());
-    std::string skiplistDir;
-
-    const llarp::RouterID r{pubkey};
-    std::string fname = r.ToString();
-
-    skiplistDir += hexString[0];
-    fname += RC_FILE_EXT;
-    return m_Root / skiplistDir / fname;
-  }
-
   void
   NodeDB::LoadFromDisk()
   {
-    if (m_Root.empty())
+    if (not m_Store)
       return;
 
-    for (const char& ch : skiplist_subdirs)
+    const auto started = time_now_ms();
+    std::vector<byte_t> data;
+    const auto records = m_Store->Load(data);
+    const auto legacy = FindSkiplistRCs(m_Root);
+
+    // decoding is cheap, verifying the signatures is not, so do both on every core
+    const auto now = time_now_ms();
+    std::vector<std::optional<RouterContact>> loaded(records.size() + legacy.size());
+    ParallelFor(loaded.size(), [&](size_t idx) {
+      RouterContact rc{};
+      bool ok;
+      if (idx < records.size())
+      {
+        const auto& record = records[idx];
+        llarp_buffer_t buf{data.data() + record.offset, record.size};
+        ok = rc.BDecode(&buf) and rc.pubkey == record.pubkey;
+      }
+      else
+        ok = rc.Read(legacy[idx - records.size()]);
+      if (ok and rc.Verify(now))
+        loaded[idx] = std::move(rc);
+    });
+
+    util::NullLock lock{m_Access};
+    std::unordered_set<RouterID> invalid;
+    for (size_t idx = 0; idx < records.size(); ++idx)
     {
-      if (!ch)
+      if (not loaded[idx])
+      {
+        invalid.insert(records[idx].pubkey);
+        continue;
+      }
+      PutEntry(std::move(*loaded[idx]));
+      // it came from the store, no need to write it back
+      m_Dirty.erase(records[idx].pubkey);
+    }
+    for (size_t idx = records.size(); idx < loaded.size(); ++idx)
+    {
+      if (not loaded[idx])
         continue;
-      std::string p;
-      p += ch;
-      fs::path sub = m_Root / p;
+      const auto itr = m_Entries.find(loaded[idx]->pubkey);
+      if (itr == m_Entries.end() or itr->second.rc.OtherIsNewer(*loaded[idx]))
+        PutEntry(std::move(*loaded[idx]));
+    }
+    if (not invalid.empty())
+      m_Store->Erase(invalid);
 
-      llarp::util::IterDir(sub, [&](const fs::path& f) -> bool {
-        if (fs::is_regular_file(f) and f.extension() == RC_FILE_EXT)
-        {
-          RouterContact rc{};
-          if (rc.Read(f) and rc.Verify(time_now_ms()))
-            m_Entries.emplace(rc.pubkey, rc);
-        }
-        return true;
-      });
+    if (not legacy.empty())
+    {
+      LogInfo("moving ", legacy.size(), " rc files in ", m_Root, " into ", m_Store->File());
+      if (m_Store->Append(TakeDirty()))
+        RemoveSkiplist(m_Root, legacy);
     }
+    LogInfo(
+        "loaded ",
+        m_Entries.size(),
+        " RCs from ",
+        m_Store->File(),
+        " in ",
+        (time_now_ms() - started).count(),
+        "ms");
   }
 
   void
-  NodeDB::SaveToDisk() const
+  NodeDB::SaveToDisk()
   {
-    if (m_Root.empty())
+    if (not m_Store)
       return;
-
-    for (const auto& item : m_Entries)
-    {
-      item.second.rc.Write(GetPathForPubkey(item.first));
-    }
+    util::NullLock lock{m_Access};
+    // behind the appends and tombstones already queued, so they land in the order they were made
+    disk([store = m_Store, rcs = TakeDirty()]() { store->Append(rcs); });
   }
 
   bool
@@ -163,7 +240,8 @@ namespace llarp
   NodeDB::Remove(RouterID pk)
   {
     util::NullLock lock{m_Access};
-    m_Entries.erase(pk);
+    if (auto itr = m_Entries.find(pk); itr != m_Entries.end())
+      EraseEntry(itr);
     AsyncRemoveManyFromDisk({pk});
   }
 
@@ -178,7 +256,7 @@ namespace llarp
       if (itr->second.insertedAt < cutoff and keep.count(itr->second.rc.pubkey) == 0)
       {
         removed.insert(itr->second.rc.pubkey);
-        itr = m_Entries.erase(itr);
+        itr = EraseEntry(itr);
       }
       else
         ++itr;
@@ -187,12 +265,37 @@ namespace llarp
       AsyncRemoveManyFromDisk(std::move(removed));
   }
 
+  void
+  NodeDB::PutEntry(RouterContact rc)
+  {
+    const RouterID pk{rc.pubkey};
+    if (auto itr = m_Entries.find(pk); itr != m_Entries.end())
+      EraseEntry(itr);
+    auto& entry = *m_Entries.emplace(pk, std::move(rc)).first;
+    entry.second.denseIndex = m_Dense.size();
+    m_Dense.push_back(&entry);
+    m_Index.insert(pk);
+    if (m_Store)
+      m_Dirty.insert(pk);
+  }
+
+  NodeDB::NodeMap::iterator
+  NodeDB::EraseEntry(NodeMap::iterator itr)
+  {
+    m_Index.erase(itr->first);
+    m_Dirty.erase(itr->first);
+    const auto idx = itr->second.denseIndex;
+    m_Dense[idx] = m_Dense.back();
+    m_Dense[idx]->second.denseIndex = idx;
+    m_Dense.pop_back();
+    return m_Entries.erase(itr);
+  }
+
   void
   NodeDB::Put(RouterContact rc)
   {
     util::NullLock lock{m_Access};
-    m_Entries.erase(rc.pubkey);
-    m_Entries.emplace(rc.pubkey, rc);
+    PutEntry(std::move(rc));
   }
 
   size_t
@@ -208,78 +311,111 @@ namespace llarp
     util::NullLock lock{m_Access};
     auto itr = m_Entries.find(rc.pubkey);
     if (itr == m_Entries.end() or itr->second.rc.OtherIsNewer(rc))
-    {
-      // delete if existing
-      if (itr != m_Entries.end())
-        m_Entries.erase(itr);
-      // add new entry
-      m_Entries.emplace(rc.pubkey, rc);
-    }
+      PutEntry(std::move(rc));
   }
 
   void
   NodeDB::AsyncRemoveManyFromDisk(std::unordered_set<RouterID> remove) const
   {
-    if (m_Root.empty())
+    if (not m_Store)
       return;
-    // build file list
-    std::set<fs::path> files;
-    for (auto id : remove)
+    // tombstone them in the store via the diskio thread
+    disk([store = m_Store, remove = std::move(remove)]() { store->Erase(remove); });
+  }
+
+  namespace
+  {
+    /// is bit `depth` (counting from the most significant bit of the first byte) set
+    bool
+    KeyBit(const byte_t* key, size_t depth)
     {
-      files.emplace(GetPathForPubkey(std::move(id)));
+      return key[depth / 8] & (0x80 >> (depth % 8));
     }
-    // remove them from the disk via the diskio thread
-    disk([files]() {
-      for (auto fpath : files)
-        fs::remove(fpath);
-    });
+
+    /// append the closest keys by xor to `target` in [begin, end) to `out`, closest first, until
+    /// `out` holds `want` keys.
+    ///
+    /// every key in [begin, end) agrees on its first `depth` bits, so the range is a subtree of a
+    /// binary trie over the sorted keys.  its keys that agree with the target on bit `depth` are
+    /// all closer by xor than the ones that don't, so visiting that half first hands out keys in
+    /// increasing distance and we can stop as soon as we have enough.
+    void
+    ClosestInRange(
+        const std::set<RouterID>& keys,
+        std::set<RouterID>::const_iterator begin,
+        std::set<RouterID>::const_iterator end,
+        size_t depth,
+        const dht::Key_t& target,
+        size_t want,
+        std::vector<RouterID>& out)
+    {
+      if (begin == end or out.size() >= want)
+        return;
+      const size_t need = want - out.size();
+      // small enough to take whole, sort it by distance and be done
+      auto itr = begin;
+      size_t num = 0;
+      while (itr != end and num <= need)
+      {
+        ++itr;
+        ++num;
+      }
+      if (itr == end and num <= need)
+      {
+        const auto first = out.size();
+        out.insert(out.end(), begin, end);
+        std::sort(
+            out.begin() + first, out.end(), [compare = dht::XorMetric{target}](auto& a, auto& b) {
+              return compare(dht::Key_t{a}, dht::Key_t{b});
+            });
+        return;
+      }
+      // split the range on bit `depth`: the first key with that bit set, under the same prefix
+      RouterID split{*begin};
+      split[depth / 8] |= (0x80 >> (depth % 8));
+      split[depth / 8] &= ~(0xff >> ((depth % 8) + 1));
+      std::fill(split.begin() + (depth / 8) + 1, split.end(), 0);
+      const auto mid = keys.lower_bound(split);
+      if (KeyBit(target.data(), depth))
+      {
+        ClosestInRange(keys, mid, end, depth + 1, target, want, out);
+        ClosestInRange(keys, begin, mid, depth + 1, target, want, out);
+      }
+      else
+      {
+        ClosestInRange(keys, begin, mid, depth + 1, target, want, out);
+        ClosestInRange(keys, mid, end, depth + 1, target, want, out);
+      }
+    }
+  }  // namespace
+
+  std::vector<RouterID>
+  NodeDB::FindManyClosestKeys(const dht::Key_t& location, size_t numRouters) const
+  {
+    std::vector<RouterID> closest;
+    closest.reserve(std::min(numRouters, m_Index.size()));
+    ClosestInRange(m_Index, m_Index.begin(), m_Index.end(), 0, location, numRouters, closest);
+    return closest;
   }
 
   llarp::RouterContact
   NodeDB::FindClosestTo(llarp::dht::Key_t location) const
   {
     util::NullLock lock{m_Access};
-    llarp::RouterContact rc;
-    const llarp::dht::XorMetric compare(location);
-    VisitAll([&rc, compare](const auto& otherRC) {
-      if (rc.pubkey.IsZero())
-      {
-        rc = otherRC;
-        return;
-      }
-      if (compare(
-              llarp::dht::Key_t{otherRC.pubkey.as_array()},
-              llarp::dht::Key_t{rc.pubkey.as_array()}))
-        rc = otherRC;
-    });
-    return rc;
+    const auto closest = FindManyClosestKeys(location, 1);
+    if (closest.empty())
+      return {};
+    return m_Entries.at(closest.front()).rc;
   }
 
   std::vector<RouterContact>
   NodeDB::FindManyClosestTo(llarp::dht::Key_t location, uint32_t numRouters) const
   {
     util::NullLock lock{m_Access};
-    std::vector<const RouterContact*> all;
-
-    const auto& entries = m_Entries;
-
-    all.reserve(entries.size());
-    for (auto& entry : entries)
-    {
-      all.push_back(&entry.second.rc);
-    }
-
-    auto it_mid = numRouters < all.size() ? all.begin() + numRouters : all.end();
-    std::partial_sort(
-        all.begin(), it_mid, all.end(), [compare = dht::XorMetric{location}](auto* a, auto* b) {
-          return compare(*a, *b);
-        });
-
     std::vector<RouterContact> closest;
     closest.reserve(numRouters);
-    for (auto it = all.begin(); it != it_mid; ++it)
-      closest.push_back(**it);
-
+    for (const auto& pk : FindManyClosestKeys(location, numRouters))
+      closest.push_back(m_Entries.at(pk).rc);
     return closest;
   }
 }  // namespace llarp
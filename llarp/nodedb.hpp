@@ -1,5 +1,6 @@
 #pragma once
 
+#include "rc_store.hpp"
 #include "router_contact.hpp"
 #include "router_id.hpp"
 #include "util/common.hpp"
@@ -11,11 +12,13 @@
 
 #include <set>
 #include <optional>
+#include <random>
 #include <unordered_set>
 #include <unordered_map>
 #include <utility>
 #include <atomic>
 #include <algorithm>
+#include <vector>
 
 namespace llarp
 {
@@ -25,27 +28,55 @@ namespace llarp
     {
       const RouterContact rc;
       llarp_time_t insertedAt;
+      /// where this entry sits in m_Dense
+      size_t denseIndex = 0;
       explicit Entry(RouterContact rc);
     };
     using NodeMap = std::unordered_map<RouterID, Entry>;
 
     NodeMap m_Entries;
+    /// every entry of m_Entries packed together in no particular order so one can be picked at
+    /// random in O(1); removal swaps the last one into the hole
+    std::vector<NodeMap::value_type*> m_Dense;
+    /// every key in m_Entries in sorted order, walked as a binary trie for xor distance lookups
+    std::set<RouterID> m_Index;
+
+    /// put an entry and keep the index in sync, replaces any existing entry for that key
+    void
+    PutEntry(RouterContact rc);
+
+    /// remove an entry and keep the index in sync
+    NodeMap::iterator
+    EraseEntry(NodeMap::iterator itr);
+
+    /// keys of the up to `numRouters` closest routers to location, closest first
+    std::vector<RouterID>
+    FindManyClosestKeys(const dht::Key_t& location, size_t numRouters) const;
 
     const fs::path m_Root;
 
+    /// the on disk copy of m_Entries, null for an in memory nodedb
+    const std::shared_ptr<RCStore> m_Store;
+
+    /// rcs put since they were last written to m_Store
+    std::unordered_set<RouterID> m_Dirty;
+
     const std::function<void(std::function<void()>)> disk;
 
     llarp_time_t m_NextFlushAt;
 
     mutable util::NullMutex m_Access;
 
-    /// asynchronously remove the files for a set of rcs on disk given their public ident key
+    /// how many random picks GetRandom tries before it falls back to going through everything
+    static constexpr size_t RandomPickTries = 32;
+
+    /// asynchronously remove a set of rcs from disk given their public ident key
     void
     AsyncRemoveManyFromDisk(std::unordered_set<RouterID> idents) const;
 
-    /// get filename of an RC file given its public ident key
-    fs::path
-    GetPathForPubkey(RouterID pk) const;
+    /// take the rcs in m_Dirty for writing out, clears m_Dirty
+    std::vector<RouterContact>
+    TakeDirty();
 
    public:
     explicit NodeDB(fs::path rootdir, std::function<void(std::function<void()>)> diskCaller);
@@ -53,13 +84,15 @@ namespace llarp
     /// in memory nodedb
     NodeDB();
 
-    /// load all entries from disk syncrhonously
+    /// load all entries from disk syncrhonously, verifying them on as many threads as we have
+    /// cores.  rcs left in the old one file per rc layout are moved into the rc store.
     void
     LoadFromDisk();
 
-    /// explicit save all RCs to disk synchronously
+    /// explicit save of all RCs changed since the last save, queued on the disk thread after
+    /// everything else the nodedb sent there
     void
-    SaveToDisk() const;
+    SaveToDisk();
 
     /// the number of RCs that are loaded from disk
     size_t
@@ -85,22 +118,34 @@ namespace llarp
     std::optional<RouterContact>
     Get(RouterID pk) const;
 
+    /// get a random rc that passes the filter, every rc that passes is equally likely
     template <typename Filter>
     std::optional<RouterContact>
     GetRandom(Filter visit) const
     {
       util::NullLock lock{m_Access};
+      if (m_Dense.empty())
+        return std::nullopt;
 
-      std::vector<const decltype(m_Entries)::value_type*> entries;
-      for (const auto& entry : m_Entries)
-        entries.push_back(&entry);
-
-      std::shuffle(entries.begin(), entries.end(), llarp::CSRNG{});
+      llarp::CSRNG rng{};
+      // almost every filter we use passes almost every router, so a few picks will find one
+      for (size_t tries = 0; tries < RandomPickTries; ++tries)
+      {
+        const auto& rc = m_Dense[std::uniform_int_distribution<size_t>{0, m_Dense.size() - 1}(rng)]
+                             ->second.rc;
+        if (visit(rc))
+          return rc;
+      }
 
-      for (const auto entry : entries)
+      // this one rejects most of them, try each of them once in a random order
+      std::vector<const NodeMap::value_type*> entries{m_Dense.begin(), m_Dense.end()};
+      for (size_t idx = 0; idx < entries.size(); ++idx)
       {
-        if (visit(entry->second.rc))
-          return entry->second.rc;
+        std::swap(
+            entries[idx],
+            entries[std::uniform_int_distribution<size_t>{idx, entries.size() - 1}(rng)]);
+        if (visit(entries[idx]->second.rc))
+          return entries[idx]->second.rc;
       }
 
       return std::nullopt;
@@ -148,7 +193,7 @@ namespace llarp
         if (visit(itr->second.rc))
         {
           removed.insert(itr->second.rc.pubkey);
-          itr = m_Entries.erase(itr);
+          itr = EraseEntry(itr);
         }
         else
           ++itr;
@@ -10,12 +10,11 @@ namespace llarp
     IHopHandler::HandleUpstream(const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter* r)
     {
       if (m_UpstreamQueue == nullptr)
-        m_UpstreamQueue = std::make_shared<TrafficQueue_t>();
-      m_UpstreamQueue->emplace_back();
-      auto& pkt = m_UpstreamQueue->back();
-      pkt.first.resize(X.sz);
-      std::copy_n(X.base, X.sz, pkt.first.begin());
-      pkt.second = Y;
+        m_UpstreamQueue = TrafficBatch::Acquire();
+      m_UpstreamQueue->Push(X, Y);
+      // hand off full batches right away, the rest go on the next flush
+      if (m_UpstreamQueue->full())
+        FlushUpstream(r);
       r->loop()->wakeup();
       return true;
     }
@@ -25,12 +24,11 @@ namespace llarp
     IHopHandler::HandleDownstream(const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter* r)
     {
       if (m_DownstreamQueue == nullptr)
-        m_DownstreamQueue = std::make_shared<TrafficQueue_t>();
-      m_DownstreamQueue->emplace_back();
-      auto& pkt = m_DownstreamQueue->back();
-      pkt.first.resize(X.sz);
-      std::copy_n(X.base, X.sz, pkt.first.begin());
-      pkt.second = Y;
+        m_DownstreamQueue = TrafficBatch::Acquire();
+      m_DownstreamQueue->Push(X, Y);
+      // hand off full batches right away, the rest go on the next flush
+      if (m_DownstreamQueue->full())
+        FlushDownstream(r);
       r->loop()->wakeup();
       return true;
     }
@@ -5,6 +5,7 @@
 #include <llarp/crypto/encrypted_frame.hpp>
 #include <llarp/util/decaying_hashset.hpp>
 #include <llarp/messages/relay.hpp>
+#include "traffic_batch.hpp"
 #include <vector>
 
 #include <memory>
@@ -24,9 +25,9 @@ namespace llarp
   {
     struct IHopHandler
     {
-      using TrafficEvent_t = std::pair<std::vector<byte_t>, TunnelNonce>;
-      using TrafficQueue_t = std::list<TrafficEvent_t>;
-      using TrafficQueue_ptr = std::shared_ptr<TrafficQueue_t>;
+      using TrafficEvent_t = TrafficBatch::Message;
+      using TrafficQueue_t = TrafficBatch;
+      using TrafficQueue_ptr = TrafficBatch::Ptr_t;
 
       virtual ~IHopHandler() = default;
 
@@ -495,19 +495,27 @@ namespace llarp
     Path::UpstreamWork(TrafficQueue_ptr msgs, AbstractRouter* r)
     {
       std::vector<RelayUpstreamMessage> sendmsgs(msgs->size());
+      // each hop's layer goes over the whole batch at once, the nonce for a hop is the message
+      // nonce xor'd with the nonce xors of every hop before it
+      std::vector<XChaCha20Job> jobs;
+      jobs.reserve(msgs->size());
+      for (const auto& ev : *msgs)
+        jobs.push_back(XChaCha20Job{msgs->Data(ev), ev.size, nullptr, ev.nonce});
+      for (const auto& hop : hops)
+      {
+        for (auto& job : jobs)
+          job.key = &hop.shared;
+        CryptoManager::instance()->xchacha20_batch(jobs);
+        for (auto& job : jobs)
+          job.nonce ^= hop.nonceXOR;
+      }
       size_t idx = 0;
-      for (auto& ev : *msgs)
+      for (const auto& ev : *msgs)
       {
-        const llarp_buffer_t buf(ev.first);
-        TunnelNonce n = ev.second;
-        for (const auto& hop : hops)
-        {
-          CryptoManager::instance()->xchacha20(buf, hop.shared, n);
-          n ^= hop.nonceXOR;
-        }
+        const llarp_buffer_t buf = msgs->Buffer(ev);
         auto& msg = sendmsgs[idx];
         msg.X = buf;
-        msg.Y = ev.second;
+        msg.Y = ev.nonce;
         msg.pathid = TXID();
         ++idx;
       }
@@ -523,8 +531,9 @@ namespace llarp
       {
         TrafficQueue_ptr data = nullptr;
         std::swap(m_UpstreamQueue, data);
-        r->QueueWork(
-            [self = shared_from_this(), data, r]() { self->UpstreamWork(std::move(data), r); });
+        r->QueueOrderedWork(this, [self = shared_from_this(), data, r]() {
+          self->UpstreamWork(std::move(data), r);
+        });
       }
     }
 
@@ -535,8 +544,9 @@ namespace llarp
       {
         TrafficQueue_ptr data = nullptr;
         std::swap(m_DownstreamQueue, data);
-        r->QueueWork(
-            [self = shared_from_this(), data, r]() { self->DownstreamWork(std::move(data), r); });
+        r->QueueOrderedWork(this, [self = shared_from_this(), data, r]() {
+          self->DownstreamWork(std::move(data), r);
+        });
       }
     }
 
@@ -573,16 +583,24 @@ namespace llarp
     Path::DownstreamWork(TrafficQueue_ptr msgs, AbstractRouter* r)
     {
       std::vector<RelayDownstreamMessage> sendMsgs(msgs->size());
-      size_t idx = 0;
-      for (auto& ev : *msgs)
+      std::vector<XChaCha20Job> jobs;
+      jobs.reserve(msgs->size());
+      for (const auto& ev : *msgs)
+        jobs.push_back(XChaCha20Job{msgs->Data(ev), ev.size, nullptr, ev.nonce});
+      for (const auto& hop : hops)
       {
-        const llarp_buffer_t buf(ev.first);
-        sendMsgs[idx].Y = ev.second;
-        for (const auto& hop : hops)
+        for (auto& job : jobs)
         {
-          sendMsgs[idx].Y ^= hop.nonceXOR;
-          CryptoManager::instance()->xchacha20(buf, hop.shared, sendMsgs[idx].Y);
+          job.key = &hop.shared;
+          job.nonce ^= hop.nonceXOR;
         }
+        CryptoManager::instance()->xchacha20_batch(jobs);
+      }
+      size_t idx = 0;
+      for (const auto& ev : *msgs)
+      {
+        const llarp_buffer_t buf = msgs->Buffer(ev);
+        sendMsgs[idx].Y = jobs[idx].nonce;
         sendMsgs[idx].X = buf;
         ++idx;
       }
@@ -8,6 +8,7 @@
 #include <llarp/router/abstractrouter.hpp>
 #include <llarp/router/i_rc_lookup_handler.hpp>
 #include <llarp/util/buffer.hpp>
+#include <llarp/util/metrics.hpp>
 #include <llarp/tooling/path_event.hpp>
 #include <llarp/link/link_manager.hpp>
 
@@ -15,6 +16,38 @@
 
 namespace llarp
 {
+  namespace
+  {
+    struct BuildMetrics
+    {
+      metrics::Counter started;
+      metrics::Counter built;
+      metrics::Counter failed;
+      metrics::Counter timedOut;
+      metrics::Histogram latency;
+    };
+
+    const BuildMetrics&
+    Metrics()
+    {
+      static const BuildMetrics m = [] {
+        auto& registry = metrics::Registry::Instance();
+        const std::string builds{"lokinet_path_builds_total"};
+        const std::string help{"path builds by how they ended up"};
+        return BuildMetrics{
+            registry.GetCounter(builds, help, {{"result", "started"}}),
+            registry.GetCounter(builds, help, {{"result", "built"}}),
+            registry.GetCounter(builds, help, {{"result", "failed"}}),
+            registry.GetCounter(builds, help, {{"result", "timeout"}}),
+            registry.GetHistogram(
+                "lokinet_path_build_milliseconds",
+                "how long successful path builds took",
+                {100, 250, 500, 1000, 2500, 5000, 10000, 30000})};
+      }();
+      return m;
+    }
+  }  // namespace
+
   struct AsyncPathKeyExchangeContext : std::enable_shared_from_this<AsyncPathKeyExchangeContext>
   {
     using WorkFunc_t = std::function<void(void)>;
@@ -440,6 +473,7 @@ namespace llarp
       LogInfo(Name(), " build ", path->ShortName(), ": ", path->HopsString());
 
       path->SetBuildResultHook([self](Path_ptr p) { self->HandlePathBuilt(p); });
+      Metrics().started.Add();
       ctx->AsyncGenerateKeys(
           path,
           m_router->loop(),
@@ -455,12 +489,17 @@ namespace llarp
 
       LogInfo(p->Name(), " built latency=", p->intro.latency);
       m_BuildStats.success++;
+      const auto& metrics = Metrics();
+      metrics.built.Add();
+      if (const auto now = Now(); now >= p->buildStarted)
+        metrics.latency.Observe(ToMS(now - p->buildStarted));
     }
 
     void
     Builder::HandlePathBuildFailedAt(Path_ptr p, RouterID edge)
     {
       PathSet::HandlePathBuildFailedAt(p, edge);
+      Metrics().failed.Add();
       DoPathBuildBackoff();
     }
 
@@ -478,6 +517,7 @@ namespace llarp
     {
       m_router->routerProfiling().MarkPathTimeout(p.get());
       PathSet::HandlePathBuildTimeout(p);
+      Metrics().timedOut.Add();
       DoPathBuildBackoff();
       for (const auto& hop : p->hops)
       {
@@ -0,0 +1,130 @@
+#include "traffic_batch.hpp"
+
+#include <mutex>
+
+namespace llarp
+{
+  namespace path
+  {
+    namespace
+    {
+      /// batches a thread keeps for itself before handing them to the shared list
+      constexpr size_t ThreadCacheSize = 32;
+      /// batches kept on the shared list, anything past this is freed
+      constexpr size_t SharedCacheSize = 1024;
+      /// never keep a batch around that grew this big, a burst of huge messages should not pin
+      /// that memory forever
+      constexpr size_t MaxRetainedBytes = 256 * 1024;
+
+      struct SharedCache
+      {
+        std::mutex mutex;
+        std::vector<TrafficBatch*> batches;
+      };
+
+      SharedCache&
+      Shared()
+      {
+        // leaked, thread caches give their batches back to it on thread exit
+        static auto* cache = new SharedCache{};
+        return *cache;
+      }
+
+      struct ThreadCache
+      {
+        std::vector<TrafficBatch*> batches;
+
+        ~ThreadCache()
+        {
+          auto& shared = Shared();
+          std::lock_guard lock{shared.mutex};
+          for (auto* batch : batches)
+          {
+            if (shared.batches.size() < SharedCacheSize)
+              shared.batches.push_back(batch);
+            else
+              delete batch;
+          }
+        }
+      };
+
+      ThreadCache&
+      LocalCache()
+      {
+        static thread_local ThreadCache cache;
+        return cache;
+      }
+    }  // namespace
+
+    TrafficBatch::Ptr_t
+    TrafficBatch::Acquire()
+    {
+      auto& local = LocalCache();
+      TrafficBatch* batch = nullptr;
+      if (not local.batches.empty())
+      {
+        batch = local.batches.back();
+        local.batches.pop_back();
+      }
+      else
+      {
+        auto& shared = Shared();
+        std::lock_guard lock{shared.mutex};
+        // take a handful at a time so we don't come back for every batch
+        while (not shared.batches.empty() and local.batches.size() < ThreadCacheSize / 2)
+        {
+          local.batches.push_back(shared.batches.back());
+          shared.batches.pop_back();
+        }
+        if (not local.batches.empty())
+        {
+          batch = local.batches.back();
+          local.batches.pop_back();
+        }
+      }
+      if (batch == nullptr)
+      {
+        batch = new TrafficBatch{};
+        batch->m_Messages.reserve(MaxMessages);
+      }
+      batch->m_Refs.store(1, std::memory_order_relaxed);
+      return Ptr_t{batch};
+    }
+
+    void
+    TrafficBatch::Release(TrafficBatch* batch)
+    {
+      if (batch->m_Data.capacity() > MaxRetainedBytes)
+      {
+        delete batch;
+        return;
+      }
+      batch->m_Data.clear();
+      batch->m_Messages.clear();
+      auto& local = LocalCache();
+      local.batches.push_back(batch);
+      if (local.batches.size() <= ThreadCacheSize)
+        return;
+      // this thread frees more than it takes (a crypto worker), pass half on
+      auto& shared = Shared();
+      std::lock_guard lock{shared.mutex};
+      while (local.batches.size() > ThreadCacheSize / 2)
+      {
+        auto* spill = local.batches.back();
+        local.batches.pop_back();
+        if (shared.batches.size() < SharedCacheSize)
+          shared.batches.push_back(spill);
+        else
+          delete spill;
+      }
+    }
+
+    void
+    TrafficBatch::Push(const llarp_buffer_t& X, const TunnelNonce& Y)
+    {
+      const size_t offset = m_Data.size();
+      m_Data.insert(m_Data.end(), X.base, X.base + X.sz);
+      m_Messages.push_back(Message{offset, X.sz, Y});
+    }
+  }  // namespace path
+}  // namespace llarp
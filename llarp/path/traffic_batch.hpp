@@ -0,0 +1,181 @@
+#pragma once
+
+#include <llarp/crypto/types.hpp>
+#include <llarp/util/buffer.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace path
+  {
+    /// a batch of relayed messages on their way through a hop.
+    ///
+    /// the messages are packed back to back in one buffer with their nonces kept alongside in a
+    /// flat array, so queueing a message costs a copy and no allocation once the batch has grown
+    /// to fit the traffic it sees.  batches are recycled through a per thread free list instead of
+    /// being freed, keeping the buffers they grew.  a batch counts its own references so sharing
+    /// one never allocates either.
+    class TrafficBatch
+    {
+     public:
+      /// how many messages go in one batch before it is handed off for crypto
+      static constexpr size_t MaxMessages = 64;
+
+      struct Message
+      {
+        size_t offset;
+        size_t size;
+        TunnelNonce nonce;
+      };
+
+      /// a reference to a batch, copyable so it fits in a std::function job.  the last one to let
+      /// go gives the batch back to the free list.
+      class Ptr_t
+      {
+       public:
+        Ptr_t() = default;
+
+        Ptr_t(std::nullptr_t)
+        {}
+
+        Ptr_t(const Ptr_t& other) : m_Batch{other.m_Batch}
+        {
+          if (m_Batch)
+            m_Batch->m_Refs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Ptr_t(Ptr_t&& other) noexcept : m_Batch{std::exchange(other.m_Batch, nullptr)}
+        {}
+
+        Ptr_t&
+        operator=(Ptr_t other) noexcept
+        {
+          std::swap(m_Batch, other.m_Batch);
+          return *this;
+        }
+
+        ~Ptr_t()
+        {
+          reset();
+        }
+
+        void
+        reset()
+        {
+          if (m_Batch and m_Batch->m_Refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            Release(m_Batch);
+          m_Batch = nullptr;
+        }
+
+        TrafficBatch*
+        get() const
+        {
+          return m_Batch;
+        }
+
+        TrafficBatch*
+        operator->() const
+        {
+          return m_Batch;
+        }
+
+        TrafficBatch&
+        operator*() const
+        {
+          return *m_Batch;
+        }
+
+        explicit operator bool() const
+        {
+          return m_Batch != nullptr;
+        }
+
+        bool
+        operator==(std::nullptr_t) const
+        {
+          return m_Batch == nullptr;
+        }
+
+        bool
+        operator!=(std::nullptr_t) const
+        {
+          return m_Batch != nullptr;
+        }
+
+       private:
+        friend class TrafficBatch;
+
+        explicit Ptr_t(TrafficBatch* batch) : m_Batch{batch}
+        {}
+
+        TrafficBatch* m_Batch = nullptr;
+      };
+
+      /// get an empty batch, from the free list if there is one
+      static Ptr_t
+      Acquire();
+
+      /// copy a message into the batch, the batch must not be full
+      void
+      Push(const llarp_buffer_t& X, const TunnelNonce& Y);
+
+      /// the data of a message in this batch, stays valid until the next Push()
+      byte_t*
+      Data(const Message& msg)
+      {
+        return m_Data.data() + msg.offset;
+      }
+
+      llarp_buffer_t
+      Buffer(const Message& msg)
+      {
+        return llarp_buffer_t{Data(msg), msg.size};
+      }
+
+      bool
+      empty() const
+      {
+        return m_Messages.empty();
+      }
+
+      bool
+      full() const
+      {
+        return m_Messages.size() >= MaxMessages;
+      }
+
+      size_t
+      size() const
+      {
+        return m_Messages.size();
+      }
+
+      std::vector<Message>::const_iterator
+      begin() const
+      {
+        return m_Messages.begin();
+      }
+
+      std::vector<Message>::const_iterator
+      end() const
+      {
+        return m_Messages.end();
+      }
+
+     private:
+      TrafficBatch() = default;
+
+      /// give a batch back to the free list of the calling thread
+      static void
+      Release(TrafficBatch* batch);
+
+      std::vector<byte_t> m_Data;
+      std::vector<Message> m_Messages;
+      std::atomic<size_t> m_Refs{0};
+    };
+  }  // namespace path
+}  // namespace llarp
@@ -103,6 +103,16 @@ namespace llarp
       return HandleDownstream(buf, N, r);
     }
 
+    void
+    TransitHop::EncryptBatch(TrafficQueue_t& msgs) const
+    {
+      std::vector<XChaCha20Job> jobs;
+      jobs.reserve(msgs.size());
+      for (const auto& ev : msgs)
+        jobs.push_back(XChaCha20Job{msgs.Data(ev), ev.size, &pathKey, ev.nonce});
+      CryptoManager::instance()->xchacha20_batch(jobs);
+    }
+
     void
     TransitHop::DownstreamWork(TrafficQueue_ptr msgs, AbstractRouter* r)
     {
@@ -114,13 +124,13 @@ namespace llarp
         }
         self->HandleAllDownstream(std::move(msgs), r);
       };
-      for (auto& ev : *msgs)
+      EncryptBatch(*msgs);
+      for (const auto& ev : *msgs)
       {
         RelayDownstreamMessage msg;
-        const llarp_buffer_t buf(ev.first);
+        const llarp_buffer_t buf = msgs->Buffer(ev);
         msg.pathid = info.rxID;
-        msg.Y = ev.second ^ nonceXOR;
-        CryptoManager::instance()->xchacha20(buf, pathKey, ev.second);
+        msg.Y = ev.nonce ^ nonceXOR;
         msg.X = buf;
         llarp::LogDebug(
             "relay ",
@@ -150,13 +160,13 @@ namespace llarp
         }
         self->HandleAllUpstream(std::move(msgs), r);
       };
-      for (auto& ev : *msgs)
+      EncryptBatch(*msgs);
+      for (const auto& ev : *msgs)
       {
-        const llarp_buffer_t buf(ev.first);
+        const llarp_buffer_t buf = msgs->Buffer(ev);
         RelayUpstreamMessage msg;
-        CryptoManager::instance()->xchacha20(buf, pathKey, ev.second);
         msg.pathid = info.txID;
-        msg.Y = ev.second ^ nonceXOR;
+        msg.Y = ev.nonce ^ nonceXOR;
         msg.X = buf;
         if (m_UpstreamGather.full())
         {
@@ -229,9 +239,10 @@ namespace llarp
     {
       if (m_UpstreamQueue && not m_UpstreamQueue->empty())
       {
-        r->QueueWork([self = shared_from_this(), data = std::move(m_UpstreamQueue), r]() mutable {
-          self->UpstreamWork(std::move(data), r);
-        });
+        r->QueueOrderedWork(
+            this, [self = shared_from_this(), data = std::move(m_UpstreamQueue), r]() mutable {
+              self->UpstreamWork(std::move(data), r);
+            });
       }
       m_UpstreamQueue = nullptr;
     }
@@ -241,9 +252,10 @@ namespace llarp
     {
       if (m_DownstreamQueue && not m_DownstreamQueue->empty())
       {
-        r->QueueWork([self = shared_from_this(), data = std::move(m_DownstreamQueue), r]() mutable {
-          self->DownstreamWork(std::move(data), r);
-        });
+        r->QueueOrderedWork(
+            this, [self = shared_from_this(), data = std::move(m_DownstreamQueue), r]() mutable {
+              self->DownstreamWork(std::move(data), r);
+            });
       }
       m_DownstreamQueue = nullptr;
     }
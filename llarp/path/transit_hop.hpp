@@ -189,6 +189,10 @@ namespace llarp
       QueueDestroySelf(AbstractRouter* r);
 
      protected:
+      /// xor every message in the queue with our layer of the onion
+      void
+      EncryptBatch(TrafficQueue_t& msgs) const;
+
       void
       UpstreamWork(TrafficQueue_ptr queue, AbstractRouter* r) override;
 
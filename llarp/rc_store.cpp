@@ -0,0 +1,348 @@
+#include "rc_store.hpp"
+
+#include "util/buffer.hpp"
+#include "util/endian.hpp"
+#include "util/logging/logger.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+namespace llarp
+{
+  namespace
+  {
+    /// first bytes of every store, bump the version if the record layout ever changes
+    constexpr std::string_view Magic{"LLRCDB01"};
+
+    enum RecordKind : uint8_t
+    {
+      eRecordPut = 1,
+      eRecordTombstone = 2,
+    };
+
+    /// body size (u32 little endian), kind (u8), pubkey
+    constexpr size_t HeaderSize = 4 + 1 + RouterID::SIZE;
+
+    /// don't bother compacting until at least this much of the file is dead
+    constexpr size_t CompactMinDeadBytes = 64 * 1024;
+
+    void
+    PutHeader(std::vector<byte_t>& out, uint32_t size, RecordKind kind, const RouterID& pubkey)
+    {
+      const auto pos = out.size();
+      out.resize(pos + HeaderSize);
+      htole32buf(out.data() + pos, size);
+      out[pos + 4] = kind;
+      std::copy_n(pubkey.data(), RouterID::SIZE, out.data() + pos + 5);
+    }
+
+    bool
+    ReadFile(const fs::path& file, std::vector<byte_t>& data)
+    {
+      std::ifstream f{file.string(), std::ios::binary | std::ios::ate};
+      if (not f.is_open())
+        return false;
+      data.resize(f.tellg());
+      f.seekg(0);
+      f.read(reinterpret_cast<char*>(data.data()), data.size());
+      return f.good();
+    }
+  }  // namespace
+
+  RCStore::RCStore(fs::path file) : m_File{std::move(file)}
+  {}
+
+  std::vector<RCStore::Record>
+  RCStore::Load(std::vector<byte_t>& data)
+  {
+    std::lock_guard lock{m_Access};
+    LoadLocked(data);
+    std::vector<Record> records;
+    records.reserve(m_Index.size());
+    for (const auto& [pubkey, loc] : m_Index)
+      records.push_back({pubkey, loc.offset, loc.size});
+    // in file order so the decode pass walks the buffer front to back
+    std::sort(records.begin(), records.end(), [](const auto& a, const auto& b) {
+      return a.offset < b.offset;
+    });
+    return records;
+  }
+
+  void
+  RCStore::LoadLocked(std::vector<byte_t>& data)
+  {
+    m_Loaded = true;
+    m_Index.clear();
+    m_FileSize = 0;
+    m_DeadBytes = 0;
+    data.clear();
+
+    if (not fs::exists(m_File))
+      return;
+    if (not ReadFile(m_File, data))
+    {
+      LogError("failed to read rc store ", m_File);
+      // don't let an append start the file over on top of records we couldn't read
+      m_Loaded = false;
+      data.clear();
+      return;
+    }
+    if (data.size() < Magic.size()
+        or std::string_view{reinterpret_cast<const char*>(data.data()), Magic.size()} != Magic)
+    {
+      // keep it around for whoever wants to look at it, we'll start a fresh one
+      fs::path bad{m_File};
+      bad += ".bad";
+      LogError("rc store ", m_File, " is not an rc store, moving it to ", bad);
+      std::error_code ec;
+      fs::rename(m_File, bad, ec);
+      data.clear();
+      return;
+    }
+
+    size_t pos = Magic.size();
+    while (pos + HeaderSize <= data.size())
+    {
+      const byte_t* hdr = data.data() + pos;
+      const size_t size = le32toh(buf32toh(hdr));
+      const auto kind = hdr[4];
+      const RouterID pubkey{hdr + 5};
+      if (size > data.size() - pos - HeaderSize)
+        break;
+      if (kind != eRecordPut and kind != eRecordTombstone)
+        break;
+      if (auto itr = m_Index.find(pubkey); itr != m_Index.end())
+      {
+        m_DeadBytes += HeaderSize + itr->second.size;
+        m_Index.erase(itr);
+      }
+      if (kind == eRecordPut)
+        m_Index.emplace(pubkey, Location{pos + HeaderSize, size});
+      else
+        m_DeadBytes += HeaderSize + size;
+      pos += HeaderSize + size;
+    }
+    if (pos != data.size())
+    {
+      LogWarn("rc store ", m_File, " has ", data.size() - pos, " bytes of junk at the end");
+      std::error_code ec;
+      fs::resize_file(m_File, pos, ec);
+      if (ec)
+        LogError("failed to truncate rc store ", m_File, ": ", ec.message());
+      data.resize(pos);
+    }
+    m_FileSize = pos;
+  }
+
+  bool
+  RCStore::Append(const std::vector<RouterContact>& rcs)
+  {
+    std::vector<byte_t> out;
+    std::vector<std::pair<RouterID, Location>> added;
+    added.reserve(rcs.size());
+    std::array<byte_t, MAX_RC_SIZE> tmp;
+    for (const auto& rc : rcs)
+    {
+      llarp_buffer_t buf{tmp};
+      if (not rc.BEncode(&buf))
+      {
+        LogError("failed to encode rc for ", RouterID{rc.pubkey});
+        continue;
+      }
+      const size_t size = buf.cur - buf.base;
+      PutHeader(out, size, eRecordPut, rc.pubkey);
+      // relative to the start of this batch until we know where it lands in the file
+      added.emplace_back(rc.pubkey, Location{out.size(), size});
+      out.insert(out.end(), tmp.begin(), tmp.begin() + size);
+    }
+    if (out.empty())
+      return true;
+
+    std::lock_guard lock{m_Access};
+    if (not EnsureLoaded())
+      return false;
+    const size_t base = m_FileSize == 0 ? Magic.size() : m_FileSize;
+    if (not AppendRaw(out))
+      return false;
+    for (auto& [pubkey, loc] : added)
+    {
+      loc.offset += base;
+      if (auto itr = m_Index.find(pubkey); itr != m_Index.end())
+      {
+        m_DeadBytes += HeaderSize + itr->second.size;
+        itr->second = loc;
+      }
+      else
+        m_Index.emplace(pubkey, loc);
+    }
+    MaybeCompact();
+    return true;
+  }
+
+  bool
+  RCStore::Erase(const std::unordered_set<RouterID>& pubkeys)
+  {
+    std::lock_guard lock{m_Access};
+    if (not EnsureLoaded())
+      return false;
+    std::vector<byte_t> out;
+    std::vector<RouterID> erased;
+    for (const auto& pubkey : pubkeys)
+    {
+      if (m_Index.count(pubkey) == 0)
+        continue;
+      PutHeader(out, 0, eRecordTombstone, pubkey);
+      erased.push_back(pubkey);
+    }
+    if (out.empty())
+      return true;
+    if (not AppendRaw(out))
+      return false;
+    for (const auto& pubkey : erased)
+    {
+      auto itr = m_Index.find(pubkey);
+      // the record it kills and the tombstone itself are both gone after a compaction
+      m_DeadBytes += (2 * HeaderSize) + itr->second.size;
+      m_Index.erase(itr);
+    }
+    MaybeCompact();
+    return true;
+  }
+
+  bool
+  RCStore::EnsureLoaded()
+  {
+    if (not m_Loaded)
+    {
+      std::vector<byte_t> discard;
+      LoadLocked(discard);
+    }
+    return m_Loaded;
+  }
+
+  bool
+  RCStore::AppendRaw(const std::vector<byte_t>& data)
+  {
+    const bool fresh = m_FileSize == 0;
+    auto f = util::OpenFileStream<std::ofstream>(
+        m_File, std::ios::binary | (fresh ? std::ios::trunc : std::ios::app));
+    if (not f or not f->is_open())
+    {
+      LogError("failed to open rc store ", m_File);
+      return false;
+    }
+    if (fresh)
+      f->write(Magic.data(), Magic.size());
+    f->write(reinterpret_cast<const char*>(data.data()), data.size());
+    f->flush();
+    if (not f->good())
+    {
+      LogError("failed to write to rc store ", m_File);
+      // we no longer know what the end of the file looks like, find out again next time
+      m_Loaded = false;
+      return false;
+    }
+    m_FileSize = (fresh ? Magic.size() : m_FileSize) + data.size();
+    return true;
+  }
+
+  void
+  RCStore::MaybeCompact()
+  {
+    if (m_DeadBytes >= CompactMinDeadBytes and m_DeadBytes > m_FileSize / 2)
+      CompactLocked();
+  }
+
+  bool
+  RCStore::Compact()
+  {
+    std::lock_guard lock{m_Access};
+    return CompactLocked();
+  }
+
+  bool
+  RCStore::CompactLocked()
+  {
+    std::vector<byte_t> old;
+    if (m_Loaded)
+    {
+      if (m_FileSize > 0 and not ReadFile(m_File, old))
+      {
+        LogError("failed to read rc store ", m_File, " for compaction");
+        return false;
+      }
+    }
+    else
+    {
+      LoadLocked(old);
+      if (not m_Loaded)
+        return false;
+    }
+
+    std::vector<byte_t> out;
+    out.reserve(Magic.size() + (m_FileSize - std::min(m_FileSize, m_DeadBytes)));
+    out.insert(out.end(), Magic.begin(), Magic.end());
+    for (auto& [pubkey, loc] : m_Index)
+    {
+      if (loc.offset + loc.size > old.size())
+      {
+        LogError("rc store ", m_File, " changed under us, not compacting");
+        m_Loaded = false;
+        return false;
+      }
+      PutHeader(out, loc.size, eRecordPut, pubkey);
+      const size_t offset = out.size();
+      out.insert(out.end(), old.begin() + loc.offset, old.begin() + loc.offset + loc.size);
+      loc.offset = offset;
+    }
+
+    fs::path tmp{m_File};
+    tmp += ".tmp";
+    {
+      auto f = util::OpenFileStream<std::ofstream>(tmp, std::ios::binary | std::ios::trunc);
+      if (not f or not f->is_open())
+      {
+        LogError("failed to open ", tmp);
+        m_Loaded = false;
+        return false;
+      }
+      f->write(reinterpret_cast<const char*>(out.data()), out.size());
+      f->flush();
+      if (not f->good())
+      {
+        LogError("failed to write ", tmp);
+        m_Loaded = false;
+        return false;
+      }
+    }
+    std::error_code ec;
+    fs::rename(tmp, m_File, ec);
+    if (ec)
+    {
+      LogError("failed to replace rc store ", m_File, ": ", ec.message());
+      m_Loaded = false;
+      return false;
+    }
+    LogDebug("compacted rc store ", m_File, " from ", m_FileSize, " to ", out.size(), " bytes");
+    m_FileSize = out.size();
+    m_DeadBytes = 0;
+    return true;
+  }
+
+  size_t
+  RCStore::NumRecords() const
+  {
+    std::lock_guard lock{m_Access};
+    return m_Index.size();
+  }
+
+  size_t
+  RCStore::DeadBytes() const
+  {
+    std::lock_guard lock{m_Access};
+    return m_DeadBytes;
+  }
+}  // namespace llarp
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "router_contact.hpp"
+#include "router_id.hpp"
+#include "util/fs.hpp"
+#include "util/types.hpp"
+
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace llarp
+{
+  /// A single append only file of bencoded router contacts, the on disk half of the NodeDB.
+  ///
+  /// Every put appends the whole rc and every remove appends a small tombstone, so saving only
+  /// ever writes what changed.  Superseded records are left in place until they make up more than
+  /// half of the file, at which point it is rewritten with only the live records.  A record is a
+  /// fixed size header (body size, kind, pubkey) followed by the body, so loading is one read of
+  /// the file and a hop from header to header; where each live record sits is kept in memory.
+  class RCStore
+  {
+   public:
+    /// where a live rc sits in the buffer returned by Load()
+    struct Record
+    {
+      RouterID pubkey;
+      size_t offset;
+      size_t size;
+    };
+
+    explicit RCStore(fs::path file);
+
+    /// read the whole store into `data` and return its live records, which point into `data`.
+    /// a record cut short by a crash at the end of the file is truncated away.
+    std::vector<Record>
+    Load(std::vector<byte_t>& data);
+
+    /// append these rcs, superseding any older records for the same pubkeys
+    bool
+    Append(const std::vector<RouterContact>& rcs);
+
+    /// append tombstones for any of these pubkeys that have a live record
+    bool
+    Erase(const std::unordered_set<RouterID>& pubkeys);
+
+    /// rewrite the file with only the live records in it
+    bool
+    Compact();
+
+    /// number of live records
+    size_t
+    NumRecords() const;
+
+    /// bytes of the file taken up by superseded records and tombstones
+    size_t
+    DeadBytes() const;
+
+    const fs::path&
+    File() const
+    {
+      return m_File;
+    }
+
+   private:
+    struct Location
+    {
+      size_t offset;
+      size_t size;
+    };
+
+    /// the parts of the public calls that run with m_Access held
+    void
+    LoadLocked(std::vector<byte_t>& data);
+
+    bool
+    CompactLocked();
+
+    /// index the file if nothing has been read from it yet, so appends know where they land.
+    /// returns false if it can't be read.
+    bool
+    EnsureLoaded();
+
+    /// write raw records to the end of the file, starting it off if it is empty
+    bool
+    AppendRaw(const std::vector<byte_t>& data);
+
+    void
+    MaybeCompact();
+
+    const fs::path m_File;
+    mutable std::mutex m_Access;
+    std::unordered_map<RouterID, Location> m_Index;
+    bool m_Loaded = false;
+    size_t m_FileSize = 0;
+    size_t m_DeadBytes = 0;
+  };
+}  // namespace llarp
@@ -144,6 +144,10 @@ namespace llarp
     /// call function in crypto worker
     virtual void QueueWork(std::function<void(void)>) = 0;
 
+    /// call function in crypto worker after all work previously queued for the same owner
+    virtual void
+    QueueOrderedWork(const void* owner, std::function<void(void)> func) = 0;
+
     /// call function in disk io thread
     virtual void QueueDiskIO(std::function<void(void)>) = 0;
 
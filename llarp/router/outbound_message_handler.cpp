@@ -6,6 +6,7 @@
 #include <llarp/link/i_link_manager.hpp>
 #include <llarp/constants/link_layer.hpp>
 #include <llarp/util/meta/memfn.hpp>
+#include <llarp/util/metrics.hpp>
 #include <llarp/util/status.hpp>
 
 #include <algorithm>
@@ -17,6 +18,19 @@ namespace llarp
 
   using namespace std::chrono_literals;
 
+  namespace
+  {
+    /// messages dropped for congestion, `queue` is the one that was full
+    metrics::Counter
+    CongestionDrops(std::string queue)
+    {
+      return metrics::Registry::Instance().GetCounter(
+          "lokinet_outbound_congestion_drops_total",
+          "outbound link messages dropped because a queue was full",
+          {{"queue", std::move(queue)}});
+    }
+  }  // namespace
+
   OutboundMessageHandler::OutboundMessageHandler(size_t maxQueueSize)
       : outboundQueue(maxQueueSize), recentlyRemovedPaths(5s), removedSomePaths(false)
   {}
@@ -233,6 +247,8 @@ namespace llarp
     entry.priority = priority;
     if (outboundQueue.tryPushBack(std::move(entry)) != llarp::thread::QueueReturn::Success)
     {
+      static const auto dropped = CongestionDrops("outbound");
+      dropped.Add();
       m_queueStats.dropped++;
       DoCallback(callback_copy, SendStatus::Congestion);
     }
@@ -276,6 +292,8 @@ namespace llarp
       }
       else
       {
+        static const auto dropped = CongestionDrops("path");
+        dropped.Add();
         DoCallback(entry.message.second, SendStatus::Congestion);
         m_queueStats.dropped++;
       }
@@ -72,9 +72,15 @@ namespace llarp
       m_LastGossipedOurRC = now;
     }
 
-    // send a GRCM as gossip method
+    // send a GRCM as gossip method, encoded once and shared by every peer we send it to
     DHTImmediateMessage gossip;
     gossip.msgs.emplace_back(new dht::GotRouterMessage(dht::Key_t{}, 0, {rc}, false));
+    std::vector<byte_t> encoded(MAX_LINK_MSG_SIZE / 2);
+    llarp_buffer_t buf(encoded);
+    if (not gossip.BEncode(&buf))
+      return false;
+    encoded.resize(buf.cur - buf.base);
+    const ILinkSession::Message_t msg{std::move(encoded)};
 
     std::vector<RouterID> gossipTo;
 
@@ -85,10 +91,9 @@ namespace llarp
           if (not(peerSession && peerSession->IsEstablished()))
             return;
           // check if public router
-          const auto other_rc = peerSession->GetRemoteRC();
-          if (not other_rc.IsPublicRouter())
+          if (not peerSession->IsRelay())
             return;
-          gossipTo.emplace_back(other_rc.pubkey);
+          gossipTo.emplace_back(peerSession->GetPubKey());
         },
         true);
 
@@ -105,18 +110,10 @@ namespace llarp
       if (keys.count(peerSession->GetPubKey()) == 0)
         return;
 
-      // encode message
-      ILinkSession::Message_t msg{};
-      msg.resize(MAX_LINK_MSG_SIZE / 2);
-      llarp_buffer_t buf(msg);
-      if (not gossip.BEncode(&buf))
-        return;
-      msg.resize(buf.cur - buf.base);
-
       m_router->NotifyRouterEvent<tooling::RCGossipSentEvent>(m_router->pubkey(), rc);
 
       // send message
-      peerSession->SendMessageBuffer(std::move(msg), nullptr);
+      peerSession->SendMessageBuffer(msg, nullptr);
     });
     return true;
   }
@@ -25,7 +25,9 @@
 #include <llarp/tooling/router_event.hpp>
 #include <llarp/util/status.hpp>
 
+#include <algorithm>
 #include <fstream>
+#include <future>
 #include <cstdlib>
 #include <iterator>
 #include <unordered_map>
@@ -374,6 +376,14 @@ namespace llarp
 
     m_isServiceNode = conf.router.m_isRelay;
 
+    // clients need it as well, their path and link crypto queued for one owner must run in order.
+    // crypto-threads is relay only, a client sizes it like the rest of its workers.
+    const int cryptoThreads =
+        m_isServiceNode ? conf.router.m_cryptoThreads : conf.router.m_workerThreads;
+    m_CryptoWorkers =
+        std::make_unique<thread::WorkerPool>(std::max(cryptoThreads, 0), "llarp-crypto");
+    m_CryptoWorkers->Start();
+
     if (whitelistRouters)
     {
       m_lokidRpcClient->ConnectAsync(lokidRPCAddr);
@@ -629,6 +639,7 @@ namespace llarp
       b_list.emplace(rc);
     }
 
+    RouterContact::VerifySignatures(b_list.begin(), b_list.end());
     for (auto& rc : b_list)
     {
       if (not rc.Verify(Now()))
@@ -702,7 +713,7 @@ namespace llarp
           util::memFn(&Router::ConnectionTimedOut, this),
           util::memFn(&AbstractRouter::SessionClosed, this),
           util::memFn(&AbstractRouter::PumpLL, this),
-          util::memFn(&AbstractRouter::QueueWork, this));
+          util::memFn(&AbstractRouter::QueueOrderedWork, this));
 
       const std::string& key = serverConfig.interface;
       int af = serverConfig.addressFamily;
@@ -1341,6 +1352,12 @@ namespace llarp
   Router::AfterStopLinks()
   {
     Close();
+    if (m_CryptoWorkers)
+      m_CryptoWorkers->Stop();
+    // the disk thread runs its jobs in order, so once this one runs the nodedb's writes are done
+    std::promise<void> drained;
+    QueueDiskIO([&drained]() { drained.set_value(); });
+    drained.get_future().wait();
     m_lmq.reset();
   }
 
@@ -1464,12 +1481,19 @@ namespace llarp
   void
   Router::QueueWork(std::function<void(void)> func)
   {
-    if (m_isServiceNode)
-      _loop->call_soon(std::move(func));
+    if (m_CryptoWorkers)
+      m_CryptoWorkers->QueueJob(std::move(func));
     else
       m_lmq->job(std::move(func));
   }
 
+  void
+  Router::QueueOrderedWork(const void* owner, std::function<void(void)> func)
+  {
+    // no fallback to the lmq workers here, they would run jobs for one owner out of order
+    m_CryptoWorkers->QueueOrderedJob(owner, std::move(func));
+  }
+
   void
   Router::QueueDiskIO(std::function<void(void)> func)
   {
@@ -1508,7 +1532,7 @@ namespace llarp
         util::memFn(&Router::ConnectionTimedOut, this),
         util::memFn(&AbstractRouter::SessionClosed, this),
         util::memFn(&AbstractRouter::PumpLL, this),
-        util::memFn(&AbstractRouter::QueueWork, this));
+        util::memFn(&AbstractRouter::QueueOrderedWork, this));
 
     if (!link)
       throw std::runtime_error("NewOutboundLink() failed to provide a link");
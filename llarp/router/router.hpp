@@ -35,6 +35,7 @@
 #include <llarp/util/status.hpp>
 #include <llarp/util/str.hpp>
 #include <llarp/util/time.hpp>
+#include <llarp/util/thread/worker_pool.hpp>
 
 #include <functional>
 #include <list>
@@ -188,6 +189,9 @@ namespace llarp
     void
     QueueWork(std::function<void(void)> func) override;
 
+    void
+    QueueOrderedWork(const void* owner, std::function<void(void)> func) override;
+
     void
     QueueDiskIO(std::function<void(void)> func) override;
 
@@ -207,6 +211,8 @@ namespace llarp
     std::shared_ptr<NodeDB> _nodedb;
     llarp_time_t _startedAt;
     const oxenmq::TaggedThreadID m_DiskThread;
+    /// crypto workers for path and link traffic, made in Configure
+    std::unique_ptr<thread::WorkerPool> m_CryptoWorkers;
 
     llarp_time_t
     Uptime() const override;
@@ -2,6 +2,7 @@
 
 #include "constants/version.hpp"
 #include "crypto/crypto.hpp"
+#include "crypto/verify_cache.hpp"
 #include "net/net.hpp"
 #include "util/bencode.hpp"
 #include "util/buffer.hpp"
@@ -517,18 +518,53 @@ namespace llarp
       }
       buf.sz = buf.cur - buf.base;
       buf.cur = buf.base;
-      return CryptoManager::instance()->verify(pubkey, buf, signature);
+      return crypto::VerifyCache::Instance().Verify(pubkey, buf, signature);
     }
     /* else */
     if (version == 1)
     {
       llarp_buffer_t buf{signed_bt_dict};
-      return CryptoManager::instance()->verify(pubkey, buf, signature);
+      return crypto::VerifyCache::Instance().Verify(pubkey, buf, signature);
     }
 
     return false;
   }
 
+  void
+  RouterContact::VerifySignatures(const std::vector<const RouterContact*>& rcs)
+  {
+    // version 0 rcs sign their own encoding with the signature zeroed, keep those encodings
+    // around for the jobs to point into
+    std::vector<std::vector<byte_t>> encoded;
+    std::vector<VerifyJob> jobs;
+    for (const auto* rc : rcs)
+    {
+      if (rc->version == 1)
+      {
+        jobs.push_back(VerifyJob{
+            &rc->pubkey,
+            reinterpret_cast<const byte_t*>(rc->signed_bt_dict.data()),
+            rc->signed_bt_dict.size(),
+            &rc->signature});
+        continue;
+      }
+      if (rc->version != 0)
+        continue;
+      RouterContact copy;
+      copy = *rc;
+      copy.signature.Zero();
+      std::vector<byte_t> tmp(MAX_RC_SIZE);
+      llarp_buffer_t buf(tmp);
+      if (not copy.BEncode(&buf))
+        continue;
+      tmp.resize(buf.cur - buf.base);
+      // moving the vectors around as encoded grows keeps their data where it is
+      const auto& bytes = encoded.emplace_back(std::move(tmp));
+      jobs.push_back(VerifyJob{&rc->pubkey, bytes.data(), bytes.size(), &rc->signature});
+    }
+    crypto::VerifyCache::Instance().VerifyBatch(jobs);
+  }
+
   bool
   RouterContact::Write(const fs::path& fname) const
   {
@@ -221,6 +221,21 @@ namespace llarp
     bool
     VerifySignature() const;
 
+    /// check the signatures of many rcs in one batch, so Verify on each of them afterwards
+    /// finds its signature already checked
+    template <typename Iter_t>
+    static void
+    VerifySignatures(Iter_t begin, Iter_t end)
+    {
+      std::vector<const RouterContact*> rcs;
+      for (; begin != end; ++begin)
+        rcs.push_back(&*begin);
+      VerifySignatures(rcs);
+    }
+
+    static void
+    VerifySignatures(const std::vector<const RouterContact*>& rcs);
+
    private:
     bool
     DecodeVersion_0(llarp_buffer_t* buf);
@@ -11,6 +11,7 @@
 #include <llarp/service/name.hpp>
 #include <llarp/router/abstractrouter.hpp>
 #include <llarp/dns/dns.hpp>
+#include <llarp/util/metrics.hpp>
 
 namespace llarp::rpc
 {
@@ -140,6 +141,13 @@ namespace llarp::rpc
                 defer.reply(CreateJSONResponse(r->ExtractSummaryStatus()));
               });
             })
+        .add_request_command(
+            "metrics",
+            [](oxenmq::Message& msg) {
+              // read straight off the per thread counters from here so scraping never waits on
+              // or holds up the router's loop
+              msg.send_reply(metrics::Registry::Instance().Prometheus());
+            })
         .add_request_command(
             "quic_connect",
             [&](oxenmq::Message& msg) {
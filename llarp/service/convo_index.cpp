@@ -0,0 +1,78 @@
+#include "convo_index.hpp"
+
+#include <algorithm>
+
+namespace llarp::service
+{
+  void
+  ConvoIndex::Put(const Address& remote, const ConvoTag& tag)
+  {
+    auto& entry = m_Entries[remote];
+    if (std::find(entry.tags.begin(), entry.tags.end(), tag) == entry.tags.end())
+      entry.tags.push_back(tag);
+    // the new convo could be better than the one we picked
+    entry.best.reset();
+  }
+
+  std::optional<ConvoTag>
+  ConvoIndex::Best(const Address& remote, const ConvoMap& sessions, llarp_time_t now) const
+  {
+    const auto itr = m_Entries.find(remote);
+    if (itr == m_Entries.end())
+      return std::nullopt;
+    const auto& entry = itr->second;
+    if (not entry.best or entry.generation != m_Generation or now >= entry.bestUntil)
+      return std::nullopt;
+    const auto found = sessions.find(*entry.best);
+    if (found == sessions.end() or found->second.Addr() != remote)
+      return std::nullopt;
+    return entry.best;
+  }
+
+  void
+  ConvoIndex::SetBest(const Address& remote, const ConvoTag& tag, llarp_time_t now)
+  {
+    auto itr = m_Entries.find(remote);
+    if (itr == m_Entries.end())
+      return;
+    itr->second.best = tag;
+    itr->second.bestUntil = now + BestLifetime;
+    itr->second.generation = m_Generation;
+  }
+
+  void
+  ConvoIndex::Invalidate(const Address& remote)
+  {
+    if (auto itr = m_Entries.find(remote); itr != m_Entries.end())
+      itr->second.best.reset();
+  }
+
+  void
+  ConvoIndex::Invalidate()
+  {
+    ++m_Generation;
+  }
+
+  void
+  ConvoIndex::Prune(const ConvoMap& sessions)
+  {
+    auto itr = m_Entries.begin();
+    while (itr != m_Entries.end())
+    {
+      auto& tags = itr->second.tags;
+      tags.erase(
+          std::remove_if(
+              tags.begin(),
+              tags.end(),
+              [&sessions, &remote = itr->first](const auto& tag) {
+                const auto found = sessions.find(tag);
+                return found == sessions.end() or found->second.Addr() != remote;
+              }),
+          tags.end());
+      if (tags.empty())
+        itr = m_Entries.erase(itr);
+      else
+        ++itr;
+    }
+  }
+}  // namespace llarp::service
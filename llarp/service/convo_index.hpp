@@ -0,0 +1,95 @@
+#pragma once
+
+#include "address.hpp"
+#include "convotag.hpp"
+#include "endpoint_types.hpp"
+#include <llarp/util/time.hpp>
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp::service
+{
+  /// the convo tags we have with each remote address and the one we last picked to send to it,
+  /// kept next to the convo map so sending to a remote does not scan every conversation we have.
+  ///
+  /// tags are only ever added here, dropping a convo from the map leaves its tag behind until a
+  /// lookup or Prune notices it is gone. a picked tag is good until BestLifetime passes, the
+  /// remote's intros change or Invalidate() is called for path changes.
+  class ConvoIndex
+  {
+   public:
+    /// rtt estimates drift, pick again at least this often
+    static constexpr llarp_time_t BestLifetime = 1s;
+
+    /// remember we have a convo tagged tag with remote
+    void
+    Put(const Address& remote, const ConvoTag& tag);
+
+    /// call visit(tag, session) for each convo we have with remote, forgetting tags no longer
+    /// in sessions on the way
+    template <typename Visit_t>
+    void
+    ForEach(const Address& remote, const ConvoMap& sessions, Visit_t&& visit)
+    {
+      auto itr = m_Entries.find(remote);
+      if (itr == m_Entries.end())
+        return;
+      auto& tags = itr->second.tags;
+      for (size_t idx = 0; idx < tags.size();)
+      {
+        const auto found = sessions.find(tags[idx]);
+        if (found == sessions.end() or found->second.Addr() != remote)
+        {
+          tags[idx] = tags.back();
+          tags.pop_back();
+          continue;
+        }
+        visit(found->first, found->second);
+        ++idx;
+      }
+      if (tags.empty())
+        m_Entries.erase(itr);
+    }
+
+    /// the tag last picked for remote if it is still good
+    std::optional<ConvoTag>
+    Best(const Address& remote, const ConvoMap& sessions, llarp_time_t now) const;
+
+    void
+    SetBest(const Address& remote, const ConvoTag& tag, llarp_time_t now);
+
+    /// forget the tag picked for remote
+    void
+    Invalidate(const Address& remote);
+
+    /// forget every picked tag
+    void
+    Invalidate();
+
+    /// forget the tags of convos that are gone
+    void
+    Prune(const ConvoMap& sessions);
+
+    /// number of remotes we have convos with
+    size_t
+    size() const
+    {
+      return m_Entries.size();
+    }
+
+   private:
+    struct Entry
+    {
+      std::vector<ConvoTag> tags;
+      std::optional<ConvoTag> best;
+      llarp_time_t bestUntil = 0s;
+      uint64_t generation = 0;
+    };
+
+    std::unordered_map<Address, Entry> m_Entries;
+    /// bumped by Invalidate(), picks from an older generation are stale
+    uint64_t m_Generation = 0;
+  };
+}  // namespace llarp::service
@@ -225,17 +225,33 @@ namespace llarp
     {
       auto fail = [resultHandler]() { resultHandler({}); };
 
-      auto lookupByAddress = [service, fail, resultHandler](auto address) {
-        // TODO: remove me after implementing the rest
-        fail();
-        if (auto* ptr = std::get_if<RouterID>(&address))
-        {}
-        else if (auto* ptr = std::get_if<Address>(&address))
-        {}
-        else
+      auto lookupByAddress = [this, service, fail, resultHandler](auto address) {
+        auto* addr = std::get_if<Address>(&address);
+        if (addr == nullptr)
         {
+          // snodes have no introset to put srv records in
           fail();
+          return;
         }
+        // EnsurePathToService may or may not call the hook when it returns false, answer once
+        auto handler =
+            std::make_shared<std::function<void(std::vector<dns::SRVData>)>>(resultHandler);
+        auto reply = [handler](std::vector<dns::SRVData> records) {
+          if (auto func = std::exchange(*handler, nullptr))
+            func(std::move(records));
+        };
+        MarkAddressOutbound(*addr);
+        const bool started = EnsurePathToService(
+            *addr,
+            [service, reply](auto, OutboundContext* ctx) {
+              if (ctx == nullptr)
+                reply({});
+              else
+                reply(ctx->GetCurrentIntroSet().GetMatchingSRVRecords(service));
+            },
+            PathAlignmentTimeout());
+        if (not started)
+          reply({});
       };
       if (auto maybe = ParseAddress(name))
       {
@@ -308,6 +324,7 @@ namespace llarp
           now, m_state->m_RemoteSessions, m_state->m_DeadSessions, Sessions());
       // expire convotags
       EndpointUtil::ExpireConvoSessions(now, Sessions());
+      m_state->m_ConvoIndex.Prune(Sessions());
 
       if (NumInStatus(path::ePathEstablished) > 1)
       {
@@ -324,7 +341,10 @@ namespace llarp
                   if (auto* addr = std::get_if<service::Address>(&*maybe_addr))
                   {
                     if (maybe_range.has_value())
+                    {
                       m_ExitMap.Insert(*maybe_range, *addr);
+                      ExitMapChanged();
+                    }
                     if (maybe_auth.has_value())
                       SetAuthInfoForEndpoint(*addr, *maybe_auth);
                   }
@@ -398,23 +418,23 @@ namespace llarp
     bool
     Endpoint::HasInboundConvo(const Address& addr) const
     {
-      for (const auto& item : Sessions())
-      {
-        if (item.second.remote.Addr() == addr and item.second.inbound)
-          return true;
-      }
-      return false;
+      bool found = false;
+      m_state->m_ConvoIndex.ForEach(
+          addr, Sessions(), [&found](const auto&, const auto& session) {
+            found = found or session.inbound;
+          });
+      return found;
     }
 
     bool
     Endpoint::HasOutboundConvo(const Address& addr) const
     {
-      for (const auto& item : Sessions())
-      {
-        if (item.second.remote.Addr() == addr && not item.second.inbound)
-          return true;
-      }
-      return false;
+      bool found = false;
+      m_state->m_ConvoIndex.ForEach(
+          addr, Sessions(), [&found](const auto&, const auto& session) {
+            found = found or not session.inbound;
+          });
+      return found;
     }
 
     void
@@ -441,26 +461,20 @@ namespace llarp
         itr = Sessions().emplace(tag, Session{}).first;
         itr->second.inbound = inbound;
         itr->second.remote = info;
+        m_state->m_ConvoIndex.Put(info.Addr(), tag);
       }
     }
 
     size_t
     Endpoint::RemoveAllConvoTagsFor(service::Address remote)
     {
-      size_t removed = 0;
-      auto& sessions = Sessions();
-      auto itr = sessions.begin();
-      while (itr != sessions.end())
-      {
-        if (itr->second.remote.Addr() == remote)
-        {
-          itr = sessions.erase(itr);
-          removed++;
-        }
-        else
-          ++itr;
-      }
-      return removed;
+      std::vector<ConvoTag> tags;
+      m_state->m_ConvoIndex.ForEach(
+          remote, Sessions(), [&tags](const auto& tag, const auto&) { tags.push_back(tag); });
+      for (const auto& tag : tags)
+        Sessions().erase(tag);
+      m_state->m_ConvoIndex.Invalidate(remote);
+      return tags.size();
     }
 
     bool
@@ -479,6 +493,7 @@ namespace llarp
     {
       auto& s = Sessions()[tag];
       s.intro = intro;
+      m_state->m_ConvoIndex.Invalidate(s.Addr());
     }
 
     bool
@@ -500,6 +515,7 @@ namespace llarp
         return;
       }
       itr->second.replyIntro = intro;
+      m_state->m_ConvoIndex.Invalidate(itr->second.Addr());
     }
 
     bool
@@ -515,7 +531,11 @@ namespace llarp
     bool
     Endpoint::GetConvoTagsForService(const Address& addr, std::set<ConvoTag>& tags) const
     {
-      return EndpointUtil::GetConvoTagsForService(Sessions(), addr, tags);
+      bool inserted = false;
+      m_state->m_ConvoIndex.ForEach(addr, Sessions(), [&](const auto& tag, const auto&) {
+        inserted = tags.emplace(tag).second or inserted;
+      });
+      return inserted;
     }
 
     bool
@@ -800,6 +820,7 @@ namespace llarp
       if (remoteSessions.count(addr) < MaxOutboundContextPerRemote)
       {
         remoteSessions.emplace(addr, std::make_shared<OutboundContext>(introset, this));
+        m_state->m_ConvoIndex.Invalidate(addr);
         LogInfo("Created New outbound context for ", addr.ToString());
       }
 
@@ -1060,6 +1081,7 @@ namespace llarp
       p->SetDataHandler(util::memFn(&Endpoint::HandleHiddenServiceFrame, this));
       p->SetDropHandler(util::memFn(&Endpoint::HandleDataDrop, this));
       p->SetDeadChecker(util::memFn(&Endpoint::CheckPathIsDead, this));
+      m_state->m_ConvoIndex.Invalidate();
       path::Builder::HandlePathBuilt(p);
     }
 
@@ -1112,6 +1134,11 @@ namespace llarp
       }
       PutReplyIntroFor(msg->tag, intro);
       ConvoTagRX(msg->tag);
+      if (msg->AcceptsSessionMAC())
+      {
+        if (auto itr = Sessions().find(msg->tag); itr != Sessions().end())
+          itr->second.acceptsSessionMAC = true;
+      }
       return ProcessDataMessage(msg);
     }
 
@@ -1254,7 +1281,11 @@ namespace llarp
     void
     Endpoint::RemoveConvoTag(const ConvoTag& t)
     {
-      Sessions().erase(t);
+      if (auto itr = Sessions().find(t); itr != Sessions().end())
+      {
+        m_state->m_ConvoIndex.Invalidate(itr->second.Addr());
+        Sessions().erase(itr);
+      }
     }
 
     void
@@ -1302,6 +1333,7 @@ namespace llarp
     Endpoint::HandlePathDied(path::Path_ptr p)
     {
       m_router->routerProfiling().MarkPathTimeout(p.get());
+      m_state->m_ConvoIndex.Invalidate();
       ManualRebuild(1);
       path::Builder::HandlePathDied(p);
       RegenAndPublishIntroSet();
@@ -1682,58 +1714,62 @@ namespace llarp
       // get convotag with lowest estimated RTT
       if (auto ptr = std::get_if<Address>(&remote))
       {
+        auto& index = m_state->m_ConvoIndex;
+        const auto now = Now();
+        if (auto best = index.Best(*ptr, Sessions(), now))
+          return best;
         llarp_time_t rtt = 30s;
         std::optional<ConvoTag> ret = std::nullopt;
-        for (const auto& [tag, session] : Sessions())
-        {
-          if (tag.IsZero())
-            continue;
-          if (session.remote.Addr() == *ptr)
+        const bool toSelf = *ptr == m_Identity.pub.Addr();
+        index.ForEach(*ptr, Sessions(), [&](const ConvoTag& tag, const Session& session) {
+          if (tag.IsZero() or (toSelf and ret))
+            return;
+          if (toSelf)
+          {
+            ret = tag;
+            return;
+          }
+          if (session.inbound)
           {
-            if (*ptr == m_Identity.pub.Addr())
+            auto path = GetPathByRouter(session.replyIntro.router);
+            // if we have no path to the remote router that's fine still use it just in case this
+            // is the ONLY one we have
+            if (path == nullptr)
             {
-              return tag;
+              ret = tag;
+              return;
             }
-            if (session.inbound)
+
+            if (path and path->IsReady())
             {
-              auto path = GetPathByRouter(session.replyIntro.router);
-              // if we have no path to the remote router that's fine still use it just in case this
-              // is the ONLY one we have
-              if (path == nullptr)
+              const auto rttEstimate = (session.replyIntro.latency + path->intro.latency) * 2;
+              if (rttEstimate < rtt)
               {
                 ret = tag;
-                continue;
-              }
-
-              if (path and path->IsReady())
-              {
-                const auto rttEstimate = (session.replyIntro.latency + path->intro.latency) * 2;
-                if (rttEstimate < rtt)
-                {
-                  ret = tag;
-                  rtt = rttEstimate;
-                }
+                rtt = rttEstimate;
               }
             }
-            else
+          }
+          else
+          {
+            auto range = m_state->m_RemoteSessions.equal_range(*ptr);
+            auto itr = range.first;
+            while (itr != range.second)
             {
-              auto range = m_state->m_RemoteSessions.equal_range(*ptr);
-              auto itr = range.first;
-              while (itr != range.second)
+              if (itr->second->ReadyToSend() and itr->second->estimatedRTT > 0s)
               {
-                if (itr->second->ReadyToSend() and itr->second->estimatedRTT > 0s)
+                if (itr->second->estimatedRTT < rtt)
                 {
-                  if (itr->second->estimatedRTT < rtt)
-                  {
-                    ret = tag;
-                    rtt = itr->second->estimatedRTT;
-                  }
+                  ret = tag;
+                  rtt = itr->second->estimatedRTT;
                 }
-                itr++;
               }
+              itr++;
             }
           }
-        }
+        });
+        if (ret)
+          index.SetBest(*ptr, *ret, now);
         return ret;
       }
       if (auto* ptr = std::get_if<RouterID>(&remote))
@@ -1878,8 +1914,11 @@ namespace llarp
           f.F = p->intro.pathID;
           transfer->P = replyIntro.pathID;
           auto self = this;
-          Router()->QueueWork([transfer, p, m, K, self]() {
-            if (not transfer->T.EncryptAndSign(*m, K, self->m_Identity))
+          const bool useMAC = ConvoTagAcceptsSessionMAC(tag);
+          Router()->QueueWork([transfer, p, m, K, self, useMAC]() {
+            auto& frame = transfer->T;
+            if (not(useMAC ? frame.EncryptAndMAC(*m, K)
+                           : frame.EncryptAndSign(*m, K, self->m_Identity)))
             {
               LogError("failed to encrypt and sign for sessionn T=", transfer->T.T);
               return;
@@ -1966,6 +2005,15 @@ namespace llarp
       return itr->second.seqno++;
     }
 
+    bool
+    Endpoint::ConvoTagAcceptsSessionMAC(const ConvoTag& tag) const
+    {
+      auto itr = Sessions().find(tag);
+      if (itr == Sessions().end())
+        return false;
+      return itr->second.acceptsSessionMAC;
+    }
+
     bool
     Endpoint::ShouldBuildMore(llarp_time_t now) const
     {
@@ -2038,6 +2086,7 @@ namespace llarp
       if (not exit.IsZero())
         LogInfo(Name(), " map ", range, " to exit at ", exit);
       m_ExitMap.Insert(range, exit);
+      ExitMapChanged();
     }
 
     void
@@ -2050,6 +2099,7 @@ namespace llarp
         LogInfo(Name(), " unmap ", item.first, " exit range mapping");
         return true;
       });
+      ExitMapChanged();
     }
 
     std::optional<AuthInfo>
@@ -391,6 +391,10 @@ namespace llarp
       std::optional<uint64_t>
       GetSeqNoForConvo(const ConvoTag& tag);
 
+      /// return true if the remote end of this convo tag accepts session mac frames from us
+      bool
+      ConvoTagAcceptsSessionMAC(const ConvoTag& tag) const;
+
       bool
       HasExit() const;
 
@@ -408,6 +412,10 @@ namespace llarp
       virtual void
       IntroSetPublished();
 
+      /// called after ranges are mapped to or unmapped from exits
+      virtual void
+      ExitMapChanged(){};
+
       void
       AsyncProcessAuthMessage(
           std::shared_ptr<ProtocolMessage> msg, std::function<void(AuthResult)> hook);
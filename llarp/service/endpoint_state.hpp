@@ -7,6 +7,7 @@
 #include "router_lookup_job.hpp"
 #include "session.hpp"
 #include "endpoint_types.hpp"
+#include "convo_index.hpp"
 #include <llarp/util/compare_ptr.hpp>
 #include <llarp/util/decaying_hashtable.hpp>
 #include <llarp/util/status.hpp>
@@ -64,6 +65,8 @@ namespace llarp
 
       /// conversations
       ConvoMap m_Sessions;
+      /// which conversations we have with whom
+      ConvoIndex m_ConvoIndex;
 
       OutboundSessions_t m_OutboundSessions;
 
@@ -167,25 +167,5 @@ namespace llarp
       }
       return false;
     }
-
-    bool
-    EndpointUtil::GetConvoTagsForService(
-        const ConvoMap& sessions, const Address& info, std::set<ConvoTag>& tags)
-    {
-      bool inserted = false;
-      auto itr = sessions.begin();
-      while (itr != sessions.end())
-      {
-        if (itr->second.remote.Addr() == info)
-        {
-          if (tags.emplace(itr->first).second)
-          {
-            inserted = true;
-          }
-        }
-        ++itr;
-      }
-      return inserted;
-    }
   }  // namespace service
 }  // namespace llarp
@@ -35,10 +35,6 @@ namespace llarp
 
       static bool
       HasPathToService(const Address& addr, const Sessions& remoteSessions);
-
-      static bool
-      GetConvoTagsForService(
-          const ConvoMap& sessions, const Address& addr, std::set<ConvoTag>& tags);
     };
 
     template <typename Endpoint_t>
@@ -1,5 +1,6 @@
 #include "intro_set.hpp"
 #include <llarp/crypto/crypto.hpp>
+#include <llarp/crypto/verify_cache.hpp>
 #include <llarp/path/path.hpp>
 
 #include <oxenmq/bt_serialize.h>
@@ -133,7 +134,7 @@ namespace llarp::service
     LogDebug("verify encrypted introset: ", copy, " sig = ", sig);
     buf.sz = buf.cur - buf.base;
     buf.cur = buf.base;
-    return CryptoManager::instance()->verify(derivedSigningKey, buf, sig);
+    return crypto::VerifyCache::Instance().Verify(derivedSigningKey, buf, sig);
   }
 
   util::StatusObject
@@ -6,6 +6,9 @@
 #include <llarp/util/meta/memfn.hpp>
 #include "endpoint.hpp"
 #include <llarp/router/abstractrouter.hpp>
+#include <sodium/crypto_verify_32.h>
+#include <algorithm>
+#include <string_view>
 #include <utility>
 
 namespace llarp
@@ -227,8 +230,7 @@ namespace llarp
     }
 
     bool
-    ProtocolFrame::EncryptAndSign(
-        const ProtocolMessage& msg, const SharedSecret& sessionKey, const Identity& localIdent)
+    ProtocolFrame::EncryptPayload(const ProtocolMessage& msg, const SharedSecret& sessionKey)
     {
       std::array<byte_t, MAX_PROTOCOL_MESSAGE_SIZE> tmp;
       llarp_buffer_t buf(tmp);
@@ -245,8 +247,58 @@ namespace llarp
       CryptoManager::instance()->xchacha20(buf, sessionKey, N);
       // put encrypted buffer
       D = buf;
+      return true;
+    }
+
+    bool
+    ProtocolFrame::ComputeMAC(byte_t* mac, const SharedSecret& sessionKey) const
+    {
+      auto crypto = CryptoManager::instance();
+      // derive a separate key for frame macs so the session key is only ever used as a cipher key
+      static constexpr std::string_view mac_key_context = "lokinet-session-mac";
+      SharedSecret macKey;
+      if (not crypto->hmac(macKey.data(), llarp_buffer_t{mac_key_context}, sessionKey))
+        return false;
+      ProtocolFrame copy(*this);
+      // zero out mac
+      copy.Z.Zero();
+      std::array<byte_t, MAX_PROTOCOL_MESSAGE_SIZE> tmp;
+      llarp_buffer_t buf(tmp);
+      if (!copy.BEncode(&buf))
+      {
+        LogError("frame too big to encode");
+        return false;
+      }
+      // rewind
+      buf.sz = buf.cur - buf.base;
+      buf.cur = buf.base;
+      return crypto->hmac(mac, buf, macKey);
+    }
+
+    bool
+    ProtocolFrame::EncryptAndMAC(const ProtocolMessage& msg, const SharedSecret& sessionKey)
+    {
+      if (not EncryptPayload(msg, sessionKey))
+        return false;
+      // the mac goes in the first HMACSIZE bytes of Z, the rest stays zero
+      Z.Zero();
+      if (not ComputeMAC(Z.data(), sessionKey))
+      {
+        LogError("failed to compute session mac");
+        return false;
+      }
+      return true;
+    }
+
+    bool
+    ProtocolFrame::EncryptAndSign(
+        const ProtocolMessage& msg, const SharedSecret& sessionKey, const Identity& localIdent)
+    {
+      if (not EncryptPayload(msg, sessionKey))
+        return false;
       // zero out signature
       Z.Zero();
+      std::array<byte_t, MAX_PROTOCOL_MESSAGE_SIZE> tmp;
       llarp_buffer_t buf2(tmp);
       // encode frame
       if (!BEncode(&buf2))
@@ -469,7 +521,16 @@ namespace llarp
               handler->ResetConvoTag(tag, path, from);
             };
 
-            if (not v->frame.Verify(v->si))
+            if (v->frame.IsSessionMAC())
+            {
+              if (not v->frame.VerifyMAC(v->shared))
+              {
+                LogError("Session MAC failure from ", v->si.Addr());
+                handler->Loop()->call_soon(resetTag);
+                return;
+              }
+            }
+            else if (not v->frame.Verify(v->si))
             {
               LogError("Signature failure from ", v->si.Addr());
               handler->Loop()->call_soon(resetTag);
@@ -522,6 +583,27 @@ namespace llarp
       return svc.Verify(buf, Z);
     }
 
+    bool
+    ProtocolFrame::IsSessionMAC() const
+    {
+      // a mac fills the first HMACSIZE bytes of Z and leaves the rest zero, a real signature
+      // practically never ends in HMACSIZE zero bytes
+      const auto macEnd = Z.begin() + HMACSIZE;
+      return std::all_of(macEnd, Z.end(), [](byte_t b) { return b == 0; })
+          and std::any_of(Z.begin(), macEnd, [](byte_t b) { return b != 0; });
+    }
+
+    bool
+    ProtocolFrame::VerifyMAC(const SharedSecret& sessionKey) const
+    {
+      ShortHash mac;
+      if (not ComputeMAC(mac.data(), sessionKey))
+        return false;
+      // constant time, this is the only thing standing between a forged frame and the session
+      static_assert(ShortHash::SIZE == crypto_verify_32_BYTES);
+      return crypto_verify_32(mac.data(), Z.data()) == 0;
+    }
+
     bool
     ProtocolFrame::HandleMessage(routing::IMessageHandler* h, AbstractRouter* /*r*/) const
     {
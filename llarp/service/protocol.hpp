@@ -31,6 +31,13 @@ namespace llarp
 
     constexpr std::size_t MAX_PROTOCOL_MESSAGE_SIZE = 2048 * 2;
 
+    /// first protocol message version whose sender accepts data frames authenticated with a
+    /// session mac instead of a signature
+    constexpr uint64_t SESSION_MAC_MESSAGE_VERSION = 1;
+
+    /// version we put on the protocol messages we send
+    constexpr uint64_t PROTOCOL_MESSAGE_VERSION = SESSION_MAC_MESSAGE_VERSION;
+
     /// inner message
     struct ProtocolMessage
     {
@@ -45,7 +52,14 @@ namespace llarp
       Endpoint* handler = nullptr;
       ConvoTag tag;
       uint64_t seqno = 0;
-      uint64_t version = LLARP_PROTO_VERSION;
+      uint64_t version = PROTOCOL_MESSAGE_VERSION;
+
+      /// return true if the sender of this message accepts session mac frames from us
+      bool
+      AcceptsSessionMAC() const
+      {
+        return version >= SESSION_MAC_MESSAGE_VERSION;
+      }
 
       /// encode metainfo for lmq endpoint auth
       std::vector<char>
@@ -119,6 +133,12 @@ namespace llarp
       EncryptAndSign(
           const ProtocolMessage& msg, const SharedSecret& sharedkey, const Identity& localIdent);
 
+      /// encrypt a message and authenticate the frame with a mac keyed off the session key
+      /// instead of a signature; only for data frames on a convo tag whose remote end has told us
+      /// it accepts them (see ProtocolMessage::AcceptsSessionMAC)
+      bool
+      EncryptAndMAC(const ProtocolMessage& msg, const SharedSecret& sharedkey);
+
       bool
       Sign(const Identity& localIdent);
 
@@ -133,6 +153,15 @@ namespace llarp
       bool
       DecryptPayloadInto(const SharedSecret& sharedkey, ProtocolMessage& into) const;
 
+     private:
+      bool
+      EncryptPayload(const ProtocolMessage& msg, const SharedSecret& sharedkey);
+
+      bool
+      ComputeMAC(byte_t* mac, const SharedSecret& sharedkey) const;
+
+     public:
+
       bool
       DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val) override;
 
@@ -161,6 +190,13 @@ namespace llarp
       bool
       Verify(const ServiceInfo& from) const;
 
+      /// return true if this frame carries a session mac instead of a signature
+      bool
+      IsSessionMAC() const;
+
+      bool
+      VerifyMAC(const SharedSecret& sharedkey) const;
+
       bool
       HandleMessage(routing::IMessageHandler* h, AbstractRouter* r) const override;
     };
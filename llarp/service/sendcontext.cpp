@@ -115,8 +115,10 @@ namespace llarp
       m->sender = m_Endpoint->GetIdentity().pub;
       m->tag = f->T;
       m->PutBuffer(payload);
-      m_Endpoint->Router()->QueueWork([f, m, shared, path, this] {
-        if (not f->EncryptAndSign(*m, shared, m_Endpoint->GetIdentity()))
+      const bool useMAC = m_Endpoint->ConvoTagAcceptsSessionMAC(f->T);
+      m_Endpoint->Router()->QueueWork([f, m, shared, path, useMAC, this] {
+        if (not(useMAC ? f->EncryptAndMAC(*m, shared)
+                       : f->EncryptAndSign(*m, shared, m_Endpoint->GetIdentity())))
         {
           LogError(m_PathSet->Name(), " failed to sign message");
           return;
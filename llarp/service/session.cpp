@@ -15,6 +15,7 @@ namespace llarp
           {"seqno", seqno},
           {"tx", messagesSend},
           {"rx", messagesRecv},
+          {"sessionMAC", acceptsSessionMAC},
           {"intro", intro.ExtractStatus()}};
       return obj;
     }
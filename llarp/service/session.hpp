@@ -32,6 +32,8 @@ namespace llarp
 
       bool inbound = false;
       bool forever = false;
+      /// the remote end told us it accepts data frames authenticated with a session mac
+      bool acceptsSessionMAC = false;
 
       Duration_t lastSend{};
       Duration_t lastRecv{};
@@ -1,32 +1,104 @@
 #include "sim_context.hpp"
+#include "sim_loop.hpp"
 #include <llarp.hpp>
+#include <llarp/router/router.hpp>
+
+#include <algorithm>
 
 namespace llarp
 {
   namespace simulate
   {
-    Simulation::Simulation() : m_CryptoManager(new sodium::CryptoLibSodium())
-    {}
+    namespace
+    {
+      /// a router that does its worker jobs on its own loop instead of on other threads, so the
+      /// network decides when they happen
+      struct SimRouter : public Router
+      {
+        using Router::Router;
 
-    void
-    Simulation::NodeUp(llarp::Context*)
-    {}
+        void
+        QueueWork(std::function<void(void)> func) override
+        {
+          loop()->call_soon(std::move(func));
+        }
+
+        void
+        QueueOrderedWork(const void*, std::function<void(void)> func) override
+        {
+          // the loop runs them in the order they were queued, for every owner at once
+          loop()->call_soon(std::move(func));
+        }
+
+        void
+        QueueDiskIO(std::function<void(void)> func) override
+        {
+          // right here, stopping blocks the loop until the disk jobs are done so they cannot wait
+          // on it
+          func();
+        }
+      };
+
+      struct SimContext : public Context
+      {
+        std::shared_ptr<AbstractRouter>
+        makeRouter(const EventLoop_ptr& loop) override
+        {
+          return std::make_shared<SimRouter>(loop, makeVPNPlatform());
+        }
+      };
+    }  // namespace
+
+    Simulation::Simulation(uint64_t seed, LinkModel link)
+        : m_CryptoManager(new sodium::CryptoLibSodium())
+        , m_Net{std::make_shared<Network>(seed, link)}
+    {
+      m_Net->UseAsTimeSource();
+    }
 
     Node_ptr
-    Simulation::AddNode(const std::string& name)
+    Simulation::AddNode(const std::string& name, std::shared_ptr<Config> conf, bool isRelay)
+    {
+      auto itr = m_Nodes.find(name);
+      if (itr != m_Nodes.end())
+        return itr->second;
+
+      auto node = std::make_shared<SimContext>();
+      node->loop = m_Net->MakeLoop();
+      node->Configure(std::move(conf));
+      RuntimeOptions opts{};
+      opts.isSNode = isRelay;
+      node->Setup(opts);
+      if (not node->router->Run())
+        throw std::runtime_error{"simulated node " + name + " failed to start"};
+      return m_Nodes.emplace(name, std::move(node)).first->second;
+    }
+
+    void
+    Simulation::DelNode(const std::string& name)
     {
       auto itr = m_Nodes.find(name);
       if (itr == m_Nodes.end())
+        return;
+      if (itr->second->router)
       {
-        itr = m_Nodes.emplace(name, std::make_shared<llarp::Context>(shared_from_this())).first;
+        itr->second->router->Stop();
+        m_Stopping.emplace_back(std::move(itr->second));
       }
-      return itr->second;
+      m_Nodes.erase(itr);
     }
 
-    void
-    Simulation::DelNode(const std::string& name)
+    size_t
+    Simulation::RunFor(llarp_time_t duration)
     {
-      m_Nodes.erase(name);
+      const auto ran = m_Net->RunFor(duration);
+      m_Stopping.erase(
+          std::remove_if(
+              m_Stopping.begin(),
+              m_Stopping.end(),
+              [](const auto& node) { return not node->router->IsRunning(); }),
+          m_Stopping.end());
+      return ran;
     }
   }  // namespace simulate
 }  // namespace llarp
@@ -1,32 +1,48 @@
 #pragma once
+#include "sim_network.hpp"
+
 #include <llarp/crypto/crypto_libsodium.hpp>
 #include <llarp/ev/ev.hpp>
 
+#include <string>
+
 namespace llarp
 {
   // forward declair
+  struct Config;
   struct Context;
   using Node_ptr = std::shared_ptr<llarp::Context>;
 
   namespace simulate
   {
+    /// many routers in one process on one virtual network, run faster than real time by jumping
+    /// the shared clock from one event to the next.  the routers do their crypto and disk jobs on
+    /// their loops, so everything happens on the thread running the network.
     struct Simulation : public std::enable_shared_from_this<Simulation>
     {
-      Simulation();
+      explicit Simulation(uint64_t seed = 0, LinkModel link = {});
 
       llarp::CryptoManager m_CryptoManager;
-      EventLoop_ptr m_NetLoop;
+      std::shared_ptr<Network> m_Net;
 
       std::unordered_map<std::string, Node_ptr> m_Nodes;
 
-      void
-      NodeUp(llarp::Context* node);
-
+      /// set up a router on a loop of its own on our network and start it.  its bind addresses
+      /// are addresses on our network, so each node needs its own.
       Node_ptr
-      AddNode(const std::string& name);
+      AddNode(const std::string& name, std::shared_ptr<Config> conf, bool isRelay);
 
+      /// stop a router, it is freed once the network has run its shutdown
       void
       DelNode(const std::string& name);
+
+      /// run the network and let go of the nodes that finished stopping
+      size_t
+      RunFor(llarp_time_t duration);
+
+     private:
+      /// nodes from DelNode that are still shutting down
+      std::vector<Node_ptr> m_Stopping;
     };
 
     using Sim_ptr = std::shared_ptr<Simulation>;
@@ -0,0 +1,246 @@
+#include "sim_loop.hpp"
+
+namespace llarp
+{
+  namespace simulate
+  {
+    namespace
+    {
+      class VirtualWakeup final : public EventLoopWakeup,
+                                  public std::enable_shared_from_this<VirtualWakeup>
+      {
+       public:
+        VirtualWakeup(std::weak_ptr<VirtualLoop> loop, std::function<void()> callback)
+            : m_Loop{std::move(loop)}, m_Callback{std::move(callback)}
+        {}
+
+        void
+        Trigger() override
+        {
+          if (m_Pending.exchange(true))
+            return;
+          if (auto loop = m_Loop.lock())
+          {
+            loop->call_soon([self = weak_from_this()]() {
+              if (auto ptr = self.lock())
+              {
+                ptr->m_Pending = false;
+                ptr->m_Callback();
+              }
+            });
+          }
+        }
+
+       private:
+        std::weak_ptr<VirtualLoop> m_Loop;
+        std::function<void()> m_Callback;
+        std::atomic<bool> m_Pending{false};
+      };
+
+      class VirtualRepeater final : public EventLoopRepeater,
+                                    public std::enable_shared_from_this<VirtualRepeater>
+      {
+       public:
+        explicit VirtualRepeater(std::weak_ptr<VirtualLoop> loop) : m_Loop{std::move(loop)}
+        {}
+
+        void
+        start(llarp_time_t every, std::function<void()> task) override
+        {
+          m_Every = every;
+          m_Task = std::move(task);
+          Arm();
+        }
+
+       private:
+        void
+        Arm()
+        {
+          auto loop = m_Loop.lock();
+          if (loop == nullptr)
+            return;
+          // the task may drop the last reference to us, which ends the repeating
+          loop->call_later(m_Every, [self = weak_from_this()]() {
+            if (auto ptr = self.lock())
+            {
+              ptr->m_Task();
+              ptr->Arm();
+            }
+          });
+        }
+
+        std::weak_ptr<VirtualLoop> m_Loop;
+        llarp_time_t m_Every = 0s;
+        std::function<void()> m_Task;
+      };
+    }  // namespace
+
+    VirtualLoop::VirtualLoop(std::shared_ptr<Network> net) : m_Net{std::move(net)}, m_Pump{[] {}}
+    {}
+
+    void
+    VirtualLoop::run()
+    {
+      m_Running = true;
+    }
+
+    bool
+    VirtualLoop::running() const
+    {
+      return m_Running;
+    }
+
+    llarp_time_t
+    VirtualLoop::time_now() const
+    {
+      return m_Net->Now();
+    }
+
+    void
+    VirtualLoop::wakeup()
+    {
+      if (inEventLoop())
+        m_Net->Wake(shared_from_this());
+      else
+        call_soon([] {});
+    }
+
+    void
+    VirtualLoop::call_soon(thread::Job f)
+    {
+      m_Net->Post(weak_from_this(), std::move(f));
+    }
+
+    void
+    VirtualLoop::call_later(llarp_time_t delay_ms, std::function<void(void)> callback)
+    {
+      if (not inEventLoop())
+      {
+        call_soon([this, delay_ms, callback = std::move(callback)]() mutable {
+          call_later(delay_ms, std::move(callback));
+        });
+        return;
+      }
+      m_Net->Schedule(time_now() + delay_ms, weak_from_this(), std::move(callback));
+    }
+
+    bool
+    VirtualLoop::add_network_interface(
+        std::shared_ptr<vpn::NetworkInterface>, std::function<void(net::IPPacket)>)
+    {
+      return false;
+    }
+
+    bool
+    VirtualLoop::add_ticker(std::function<void(void)> ticker)
+    {
+      m_Tickers.emplace_back(std::move(ticker));
+      return true;
+    }
+
+    void
+    VirtualLoop::stop()
+    {
+      m_Running = false;
+    }
+
+    std::shared_ptr<UDPHandle>
+    VirtualLoop::make_udp(UDPReceiveFunc on_recv)
+    {
+      return std::make_shared<VirtualUDPHandle>(m_Net, weak_from_this(), std::move(on_recv));
+    }
+
+    void
+    VirtualLoop::set_pump_function(std::function<void(void)> pump)
+    {
+      m_Pump = std::move(pump);
+    }
+
+    std::shared_ptr<EventLoopWakeup>
+    VirtualLoop::make_waker(std::function<void()> callback)
+    {
+      return std::make_shared<VirtualWakeup>(weak_from_this(), std::move(callback));
+    }
+
+    std::shared_ptr<EventLoopRepeater>
+    VirtualLoop::make_repeater()
+    {
+      return std::make_shared<VirtualRepeater>(weak_from_this());
+    }
+
+    bool
+    VirtualLoop::inEventLoop() const
+    {
+      return m_Net->InNetworkThread();
+    }
+
+    void
+    VirtualLoop::Pump()
+    {
+      m_Pump();
+      for (const auto& ticker : m_Tickers)
+        ticker();
+    }
+
+    VirtualUDPHandle::VirtualUDPHandle(
+        std::shared_ptr<Network> net, std::weak_ptr<VirtualLoop> loop, ReceiveFunc on_recv)
+        : UDPHandle{std::move(on_recv)}, m_Net{std::move(net)}, m_Loop{std::move(loop)}
+    {}
+
+    VirtualUDPHandle::~VirtualUDPHandle()
+    {
+      close();
+    }
+
+    bool
+    VirtualUDPHandle::listen(const SockAddr& addr)
+    {
+      close();
+      auto bind = addr;
+      if (addr.getPort() == 0)
+      {
+        auto maybe = m_Net->EphemeralAddr(addr);
+        if (not maybe)
+          return false;
+        bind = *maybe;
+      }
+      auto id = m_Net->Bind(bind, this);
+      if (not id)
+        return false;
+      m_Addr = bind;
+      m_ID = *id;
+      return true;
+    }
+
+    bool
+    VirtualUDPHandle::send(const SockAddr& dest, const llarp_buffer_t& buf)
+    {
+      if (not m_Net->InNetworkThread())
+      {
+        // the socket and the network are only touched from the network thread
+        m_Net->Post(
+            m_Loop,
+            [self = weak_from_this(),
+             dest,
+             data = std::vector<byte_t>{buf.base, buf.base + buf.sz}]() {
+              if (auto ptr = self.lock())
+                ptr->send(dest, llarp_buffer_t{data});
+            });
+        return true;
+      }
+      if (not m_Addr and not listen(SockAddr{0, 0, 0, 0}))
+        return false;
+      m_Net->Send(*m_Addr, dest, buf);
+      return true;
+    }
+
+    void
+    VirtualUDPHandle::close()
+    {
+      if (not m_Addr)
+        return;
+      m_Net->Unbind(*m_Addr, m_ID);
+      m_Addr.reset();
+    }
+  }  // namespace simulate
+}  // namespace llarp
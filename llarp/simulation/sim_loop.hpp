@@ -0,0 +1,111 @@
+#pragma once
+
+#include "sim_network.hpp"
+
+#include <llarp/ev/ev.hpp>
+#include <llarp/ev/udp_handle.hpp>
+
+namespace llarp
+{
+  namespace simulate
+  {
+    /// an event loop whose timers run on a Network's virtual clock and whose udp sockets send to
+    /// the other sockets on that network.  there is no thread behind it: the network runs it along
+    /// with every other loop on it, so run() only marks it started and returns.
+    class VirtualLoop final : public EventLoop, public std::enable_shared_from_this<VirtualLoop>
+    {
+     public:
+      explicit VirtualLoop(std::shared_ptr<Network> net);
+
+      void
+      run() override;
+
+      bool
+      running() const override;
+
+      llarp_time_t
+      time_now() const override;
+
+      void
+      wakeup() override;
+
+      void
+      call_soon(thread::Job f) override;
+
+      void
+      call_later(llarp_time_t delay_ms, std::function<void(void)> callback) override;
+
+      /// there are no network interfaces in a simulation
+      bool
+      add_network_interface(
+          std::shared_ptr<vpn::NetworkInterface> netif,
+          std::function<void(net::IPPacket)> packetHandler) override;
+
+      bool
+      add_ticker(std::function<void(void)> ticker) override;
+
+      void
+      stop() override;
+
+      std::shared_ptr<UDPHandle>
+      make_udp(UDPReceiveFunc on_recv) override;
+
+      void
+      set_pump_function(std::function<void(void)> pump) override;
+
+      std::shared_ptr<EventLoopWakeup>
+      make_waker(std::function<void()> callback) override;
+
+      std::shared_ptr<EventLoopRepeater>
+      make_repeater() override;
+
+      bool
+      inEventLoop() const override;
+
+     private:
+      friend class Network;
+
+      /// called by the network after a round of events that included some of ours, the same as
+      /// the libuv loop pumping after handling io
+      void
+      Pump();
+
+      std::shared_ptr<Network> m_Net;
+      bool m_Running = true;
+      /// in the network's list of loops to pump
+      bool m_Woken = false;
+      std::function<void(void)> m_Pump;
+      std::vector<std::function<void(void)>> m_Tickers;
+    };
+
+    /// a udp socket on a Network
+    struct VirtualUDPHandle final : public UDPHandle,
+                                    public std::enable_shared_from_this<VirtualUDPHandle>
+    {
+      VirtualUDPHandle(
+          std::shared_ptr<Network> net, std::weak_ptr<VirtualLoop> loop, ReceiveFunc on_recv);
+
+      ~VirtualUDPHandle() override;
+
+      /// port 0 picks a free one
+      bool
+      listen(const SockAddr& addr) override;
+
+      /// can be called from any thread, like the iwp crypto workers do; sends from other threads
+      /// go out when the network next runs
+      bool
+      send(const SockAddr& dest, const llarp_buffer_t& buf) override;
+
+      void
+      close() override;
+
+     private:
+      friend class Network;
+
+      std::shared_ptr<Network> m_Net;
+      std::weak_ptr<VirtualLoop> m_Loop;
+      std::optional<SockAddr> m_Addr;
+      uint64_t m_ID = 0;
+    };
+  }  // namespace simulate
+}  // namespace llarp
@@ -0,0 +1,224 @@
+#include "sim_network.hpp"
+#include "sim_loop.hpp"
+
+namespace llarp
+{
+  namespace simulate
+  {
+    /// where the ports for sockets that don't pick one come from
+    static constexpr uint16_t EphemeralPorts = 49152;
+    static constexpr uint16_t NumEphemeralPorts = 65535 - EphemeralPorts + 1;
+
+    Network::Network(uint64_t seed, LinkModel link)
+        : m_Now{time_now_ms()}, m_Link{link}, m_Rand{seed}, m_Thread{std::this_thread::get_id()}
+    {}
+
+    Network::~Network()
+    {
+      if (m_TimeSource)
+        set_time_source(nullptr);
+    }
+
+    void
+    Network::UseAsTimeSource()
+    {
+      set_time_source(&m_Now);
+      m_TimeSource = true;
+    }
+
+    std::shared_ptr<VirtualLoop>
+    Network::MakeLoop()
+    {
+      return std::make_shared<VirtualLoop>(shared_from_this());
+    }
+
+    void
+    Network::SetLinkModel(std::function<LinkModel(const SockAddr&, const SockAddr&)> model)
+    {
+      m_LinkModel = std::move(model);
+    }
+
+    size_t
+    Network::RunUntil(llarp_time_t until)
+    {
+      const auto before = m_Stats.events;
+      for (;;)
+      {
+        TakePosted();
+        const bool due = not m_Events.empty() and m_Events.top().at <= until;
+        if (not due and m_Woken.empty())
+          break;
+        Step();
+      }
+      Advance(until);
+      return m_Stats.events - before;
+    }
+
+    bool
+    Network::Step()
+    {
+      m_Thread = std::this_thread::get_id();
+      TakePosted();
+      if (m_Events.empty() and m_Woken.empty())
+        return false;
+
+      if (not m_Events.empty())
+      {
+        Advance(m_Events.top().at);
+        // what this round schedules for now runs in the next one, as jobs queued from jobs do
+        // on the next tick of a libuv loop
+        const auto last = m_NextSeq;
+        const auto now = Now();
+        while (not m_Events.empty() and m_Events.top().at <= now and m_Events.top().seq < last)
+        {
+          // the func is moved out right before the pop so casting away the const is harmless
+          auto event = std::move(const_cast<Event&>(m_Events.top()));
+          m_Events.pop();
+          auto loop = event.loop.lock();
+          if (loop == nullptr or not loop->m_Running)
+            continue;
+          ++m_Stats.events;
+          event.func();
+          Wake(loop);
+        }
+      }
+
+      auto woken = std::move(m_Woken);
+      m_Woken.clear();
+      for (auto& loop : woken)
+      {
+        if (loop->m_Running)
+          loop->Pump();
+        loop->m_Woken = false;
+      }
+      return true;
+    }
+
+    void
+    Network::Advance(llarp_time_t to)
+    {
+      if (to > Now())
+        m_Now.store(to, std::memory_order_relaxed);
+    }
+
+    void
+    Network::Wake(const std::shared_ptr<VirtualLoop>& loop)
+    {
+      if (loop->m_Woken)
+        return;
+      loop->m_Woken = true;
+      m_Woken.push_back(loop);
+    }
+
+    void
+    Network::Schedule(llarp_time_t at, std::weak_ptr<VirtualLoop> loop, thread::Job func)
+    {
+      m_Events.push(Event{std::max(at, Now()), m_NextSeq++, std::move(loop), std::move(func)});
+    }
+
+    void
+    Network::Post(std::weak_ptr<VirtualLoop> loop, thread::Job func)
+    {
+      if (InNetworkThread())
+      {
+        Schedule(Now(), std::move(loop), std::move(func));
+        return;
+      }
+      std::lock_guard<std::mutex> lock{m_PostedAccess};
+      m_Posted.emplace_back(std::move(loop), std::move(func));
+      m_HasPosted.store(true);
+    }
+
+    void
+    Network::TakePosted()
+    {
+      if (not m_HasPosted.exchange(false))
+        return;
+      decltype(m_Posted) posted;
+      {
+        std::lock_guard<std::mutex> lock{m_PostedAccess};
+        posted.swap(m_Posted);
+      }
+      for (auto& [loop, func] : posted)
+        Schedule(Now(), std::move(loop), std::move(func));
+    }
+
+    std::optional<uint64_t>
+    Network::Bind(const SockAddr& addr, VirtualUDPHandle* handle)
+    {
+      const auto id = ++m_NextBindID;
+      if (not m_Sockets.emplace(addr, Binding{handle, id}).second)
+        return std::nullopt;
+      return id;
+    }
+
+    void
+    Network::Unbind(const SockAddr& addr, uint64_t id)
+    {
+      if (auto itr = m_Sockets.find(addr); itr != m_Sockets.end() and itr->second.id == id)
+        m_Sockets.erase(itr);
+    }
+
+    std::optional<SockAddr>
+    Network::EphemeralAddr(SockAddr addr)
+    {
+      for (uint16_t tries = 0; tries < NumEphemeralPorts; ++tries)
+      {
+        addr.setPort(EphemeralPorts + (m_NextEphemeralPort++ % NumEphemeralPorts));
+        if (m_Sockets.count(addr) == 0)
+          return addr;
+      }
+      return std::nullopt;
+    }
+
+    void
+    Network::Send(const SockAddr& from, const SockAddr& to, const llarp_buffer_t& buf)
+    {
+      ++m_Stats.sent;
+      const auto link = m_LinkModel ? m_LinkModel(from, to) : m_Link;
+      if (link.loss > 0. and std::uniform_real_distribution<double>{}(m_Rand) < link.loss)
+      {
+        ++m_Stats.lost;
+        return;
+      }
+      auto itr = m_Sockets.find(to);
+      if (itr == m_Sockets.end())
+      {
+        ++m_Stats.unreachable;
+        return;
+      }
+      auto delay = link.latency;
+      if (link.jitter > 0ms)
+      {
+        delay += llarp_time_t{
+            std::uniform_int_distribution<llarp_time_t::rep>{0, link.jitter.count()}(m_Rand)};
+      }
+      Schedule(
+          Now() + delay,
+          itr->second.handle->m_Loop,
+          [this,
+           from,
+           to,
+           id = itr->second.id,
+           data = std::vector<byte_t>{buf.base, buf.base + buf.sz}]() {
+            Deliver(from, to, id, data);
+          });
+    }
+
+    void
+    Network::Deliver(
+        const SockAddr& from, const SockAddr& to, uint64_t id, const std::vector<byte_t>& data)
+    {
+      // the socket it was sent to could have closed while it was on the way
+      auto itr = m_Sockets.find(to);
+      if (itr == m_Sockets.end() or itr->second.id != id)
+      {
+        ++m_Stats.unreachable;
+        return;
+      }
+      ++m_Stats.delivered;
+      auto& handle = *itr->second.handle;
+      handle.on_recv(handle, from, llarp_buffer_t{data});
+    }
+  }  // namespace simulate
+}  // namespace llarp
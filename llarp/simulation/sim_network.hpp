@@ -0,0 +1,207 @@
+#pragma once
+
+#include <llarp/net/sock_addr.hpp>
+#include <llarp/util/buffer.hpp>
+#include <llarp/util/thread/job.hpp>
+#include <llarp/util/time.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <random>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp
+{
+  namespace simulate
+  {
+    class VirtualLoop;
+    struct VirtualUDPHandle;
+
+    /// how packets between two addresses fare
+    struct LinkModel
+    {
+      llarp_time_t latency = 20ms;
+      /// up to this much more delay picked at random per packet, which can reorder them
+      llarp_time_t jitter = 0ms;
+      /// chance of a packet being dropped, 0 to 1
+      double loss = 0.;
+    };
+
+    /// a whole network in one thread: a virtual clock, the timers and jobs of every VirtualLoop
+    /// made from it and an in memory udp transport between their sockets.
+    ///
+    /// nothing happens until it is run, then events run in virtual time order, those due at the
+    /// same time in the order they were scheduled, and the clock jumps straight to the next one.
+    /// with the same seed and the same calls a run is the same every time.  everything but
+    /// VirtualLoop::call_soon, VirtualUDPHandle::send and reading the clock must be used from the
+    /// thread running it.
+    class Network : public std::enable_shared_from_this<Network>
+    {
+     public:
+      struct Stats
+      {
+        uint64_t sent = 0;
+        uint64_t delivered = 0;
+        /// dropped by the link model
+        uint64_t lost = 0;
+        /// nothing was bound to the destination
+        uint64_t unreachable = 0;
+        uint64_t events = 0;
+      };
+
+      /// the clock starts at the current system time so timestamps in rcs and the like look sane
+      explicit Network(uint64_t seed = 0, LinkModel link = {});
+
+      ~Network();
+
+      Network(const Network&) = delete;
+      Network&
+      operator=(const Network&) = delete;
+
+      llarp_time_t
+      Now() const
+      {
+        return m_Now.load(std::memory_order_relaxed);
+      }
+
+      /// make time_now_ms() return our clock while we are alive, for all the code that does not
+      /// ask its event loop the time
+      void
+      UseAsTimeSource();
+
+      /// a new event loop running on this network
+      std::shared_ptr<VirtualLoop>
+      MakeLoop();
+
+      /// use model to pick the link between two addresses instead of the one we were made with
+      void
+      SetLinkModel(std::function<LinkModel(const SockAddr& from, const SockAddr& to)> model);
+
+      /// run everything due up to and including until, then set the clock to until.
+      /// returns how many events ran.
+      size_t
+      RunUntil(llarp_time_t until);
+
+      size_t
+      RunFor(llarp_time_t duration)
+      {
+        return RunUntil(Now() + duration);
+      }
+
+      /// run everything due at the next time anything is due, false if nothing is scheduled
+      bool
+      Step();
+
+      /// how many events are scheduled
+      size_t
+      Pending() const
+      {
+        return m_Events.size();
+      }
+
+      const Stats&
+      stats() const
+      {
+        return m_Stats;
+      }
+
+     private:
+      friend class VirtualLoop;
+      friend struct VirtualUDPHandle;
+
+      struct Event
+      {
+        llarp_time_t at;
+        uint64_t seq;
+        std::weak_ptr<VirtualLoop> loop;
+        thread::Job func;
+
+        /// reversed so the priority queue pops the earliest first
+        bool
+        operator<(const Event& other) const
+        {
+          return std::tie(at, seq) > std::tie(other.at, other.seq);
+        }
+      };
+
+      struct Binding
+      {
+        VirtualUDPHandle* handle;
+        uint64_t id;
+      };
+
+      void
+      Schedule(llarp_time_t at, std::weak_ptr<VirtualLoop> loop, thread::Job func);
+
+      /// schedule from any thread, picked up when we next run
+      void
+      Post(std::weak_ptr<VirtualLoop> loop, thread::Job func);
+
+      bool
+      InNetworkThread() const
+      {
+        return std::this_thread::get_id() == m_Thread.load();
+      }
+
+      /// move what was posted from other threads into the schedule
+      void
+      TakePosted();
+
+      /// move the clock forward to `to`, never back
+      void
+      Advance(llarp_time_t to);
+
+      /// have loop pumped at the end of this round
+      void
+      Wake(const std::shared_ptr<VirtualLoop>& loop);
+
+      std::optional<uint64_t>
+      Bind(const SockAddr& addr, VirtualUDPHandle* handle);
+
+      void
+      Unbind(const SockAddr& addr, uint64_t id);
+
+      /// addr with a free port, for sockets listening on port 0 or sending before they listen
+      std::optional<SockAddr>
+      EphemeralAddr(SockAddr addr);
+
+      /// network thread only, VirtualUDPHandle::send posts sends from other threads here
+      void
+      Send(const SockAddr& from, const SockAddr& to, const llarp_buffer_t& buf);
+
+      void
+      Deliver(
+          const SockAddr& from, const SockAddr& to, uint64_t id, const std::vector<byte_t>& data);
+
+      /// only advanced by the thread running us, but read by any thread through time_now_ms()
+      std::atomic<llarp_time_t> m_Now;
+      uint64_t m_NextSeq = 0;
+      std::priority_queue<Event> m_Events;
+      /// loops that ran something since their pump function last ran
+      std::vector<std::shared_ptr<VirtualLoop>> m_Woken;
+
+      std::mutex m_PostedAccess;
+      std::vector<std::pair<std::weak_ptr<VirtualLoop>, thread::Job>> m_Posted;
+      std::atomic<bool> m_HasPosted{false};
+
+      std::unordered_map<SockAddr, Binding> m_Sockets;
+      uint64_t m_NextBindID = 0;
+      uint16_t m_NextEphemeralPort = 0;
+
+      LinkModel m_Link;
+      std::function<LinkModel(const SockAddr&, const SockAddr&)> m_LinkModel;
+      std::mt19937_64 m_Rand;
+      /// whoever last ran us, other threads ask it whether they must post
+      std::atomic<std::thread::id> m_Thread;
+      bool m_TimeSource = false;
+      Stats m_Stats;
+    };
+  }  // namespace simulate
+}  // namespace llarp
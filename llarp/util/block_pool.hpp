@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace llarp::util
+{
+  /// A pool of fixed size memory blocks for things we allocate and free at packet rate.
+  ///
+  /// Blocks are carved out of slabs that are never handed back to the system.  Every thread keeps
+  /// a free list of its own so an alloc/free pair on the same thread never takes a lock.  A thread
+  /// that frees more than it allocates (i.e. the one writing packets out to the tun device) hands
+  /// its surplus back to a shared free list in bulk, where other threads pick it up again.
+  template <size_t BlockSize, size_t BlocksPerSlab = 256>
+  class BlockPool
+  {
+   public:
+    /// blocks are padded out to a cache line so two of them never share one
+    static constexpr size_t Stride = ((BlockSize + 63) / 64) * 64;
+
+    /// how many free blocks a thread holds on to before it gives half of them back
+    static constexpr size_t ThreadCacheSize = 512;
+
+    /// get an uninitialized block of BlockSize bytes
+    static void*
+    Alloc()
+    {
+      auto& cache = LocalCache();
+      if (cache.blocks.empty())
+        Refill(cache);
+      void* block = cache.blocks.back();
+      cache.blocks.pop_back();
+      ++cache.allocs;
+      return block;
+    }
+
+    /// give a block back, may be called from any thread; nullptr is ignored
+    static void
+    Free(void* block)
+    {
+      if (block == nullptr)
+        return;
+      auto& cache = LocalCache();
+      cache.blocks.push_back(block);
+      if (cache.blocks.size() > ThreadCacheSize)
+        Spill(cache);
+    }
+
+    /// how many blocks the calling thread has taken from the pool
+    static uint64_t
+    ThreadAllocations()
+    {
+      return LocalCache().allocs;
+    }
+
+    /// how many slabs were allocated from the system so far, by all threads
+    static size_t
+    NumSlabs()
+    {
+      return Shared().slabs.load(std::memory_order_relaxed);
+    }
+
+   private:
+    struct SharedState
+    {
+      std::mutex mutex;
+      std::vector<void*> blocks;
+      std::atomic<size_t> slabs{0};
+    };
+
+    struct ThreadCache
+    {
+      std::vector<void*> blocks;
+      uint64_t allocs = 0;
+
+      ThreadCache()
+      {
+        blocks.reserve(ThreadCacheSize + 1);
+      }
+
+      ~ThreadCache()
+      {
+        if (blocks.empty())
+          return;
+        auto& shared = Shared();
+        std::lock_guard lock{shared.mutex};
+        shared.blocks.insert(shared.blocks.end(), blocks.begin(), blocks.end());
+      }
+    };
+
+    static SharedState&
+    Shared()
+    {
+      // leaked on purpose, thread caches give their blocks back to it when their thread exits
+      // which can be after static destructors have run
+      static auto* state = new SharedState{};
+      return *state;
+    }
+
+    static ThreadCache&
+    LocalCache()
+    {
+      static thread_local ThreadCache cache;
+      return cache;
+    }
+
+    static void
+    Refill(ThreadCache& cache)
+    {
+      auto& shared = Shared();
+      {
+        std::lock_guard lock{shared.mutex};
+        const auto num = std::min(shared.blocks.size(), ThreadCacheSize / 2);
+        const auto itr = shared.blocks.end() - num;
+        cache.blocks.insert(cache.blocks.end(), itr, shared.blocks.end());
+        shared.blocks.erase(itr, shared.blocks.end());
+      }
+      if (not cache.blocks.empty())
+        return;
+      auto* slab = static_cast<std::byte*>(
+          ::operator new(Stride * BlocksPerSlab, std::align_val_t{alignof(std::max_align_t)}));
+      shared.slabs.fetch_add(1, std::memory_order_relaxed);
+      for (size_t idx = 0; idx < BlocksPerSlab; ++idx)
+        cache.blocks.push_back(slab + (idx * Stride));
+    }
+
+    static void
+    Spill(ThreadCache& cache)
+    {
+      auto& shared = Shared();
+      const auto itr = cache.blocks.begin() + (cache.blocks.size() / 2);
+      {
+        std::lock_guard lock{shared.mutex};
+        shared.blocks.insert(shared.blocks.end(), itr, cache.blocks.end());
+      }
+      cache.blocks.erase(itr, cache.blocks.end());
+    }
+  };
+}  // namespace llarp::util
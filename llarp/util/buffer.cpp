@@ -158,4 +158,16 @@ namespace llarp
     return {std::move(buf), sz};
   }
 
+  SharedBuffer
+  SharedBuffer::copy_from(const llarp_buffer_t& b)
+  {
+    return std::vector<byte_t>{b.begin(), b.end()};
+  }
+
+  SharedBuffer
+  SharedBuffer::copy_used(const llarp_buffer_t& b)
+  {
+    return std::vector<byte_t>{b.base, b.cur};
+  }
+
 }  // namespace llarp
@@ -275,4 +275,59 @@ namespace llarp
     copy_used(const llarp_buffer_t& b);
   };
 
+  // An immutable, reference counted byte buffer.  Copies share the same bytes, so one encoded
+  // message can be handed to any number of senders without copying it for each of them.
+  class SharedBuffer
+  {
+   public:
+    SharedBuffer() = default;
+
+    // Takes over the bytes in `data` without copying them.
+    SharedBuffer(std::vector<byte_t> data)
+        : m_Data{std::make_shared<const std::vector<byte_t>>(std::move(data))}
+    {}
+
+    const byte_t*
+    data() const
+    {
+      return m_Data ? m_Data->data() : nullptr;
+    }
+
+    size_t
+    size() const
+    {
+      return m_Data ? m_Data->size() : 0;
+    }
+
+    bool
+    empty() const
+    {
+      return size() == 0;
+    }
+
+    const byte_t*
+    begin() const
+    {
+      return data();
+    }
+
+    const byte_t*
+    end() const
+    {
+      return data() + size();
+    }
+
+    // Creates a shared buffer by copying from a llarp_buffer_t.
+    static SharedBuffer
+    copy_from(const llarp_buffer_t& b);
+
+    // Creates a shared buffer by copying the used portion of a llarp_buffer_t (i.e. from base to
+    // cur), for when a llarp_buffer_t is used in write mode.
+    static SharedBuffer
+    copy_used(const llarp_buffer_t& b);
+
+   private:
+    std::shared_ptr<const std::vector<byte_t>> m_Data;
+  };
+
 }  // namespace llarp
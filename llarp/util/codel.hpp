@@ -9,7 +9,9 @@
 #include <array>
 #include <cmath>
 #include <functional>
+#include <new>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 namespace llarp
@@ -43,6 +45,12 @@ namespace llarp
           , _getNow(std::move(now))
       {}
 
+      ~CoDelQueue()
+      {
+        for (size_t idx = 0; idx < m_QueueIdx; ++idx)
+          Item(idx)->~T();
+      }
+
       size_t
       Size() EXCLUDES(m_QueueMutex)
       {
@@ -57,17 +65,16 @@ namespace llarp
         Lock_t lock(m_QueueMutex);
         if (m_QueueIdx == MaxSize)
           return false;
-        T* t = &m_Queue[m_QueueIdx];
-        new (t) T(std::forward<Args>(args)...);
+        T* t = new (&m_Queue[m_QueueIdx]) T(std::forward<Args>(args)...);
         if (!pred(*t))
         {
           t->~T();
           return false;
         }
 
-        _putTime(m_Queue[m_QueueIdx]);
+        _putTime(*t);
         if (firstPut == 0s)
-          firstPut = _getTime(m_Queue[m_QueueIdx]);
+          firstPut = _getTime(*t);
         ++m_QueueIdx;
 
         return true;
@@ -80,11 +87,10 @@ namespace llarp
         Lock_t lock(m_QueueMutex);
         if (m_QueueIdx == MaxSize)
           return;
-        T* t = &m_Queue[m_QueueIdx];
-        new (t) T(std::forward<Args>(args)...);
-        _putTime(m_Queue[m_QueueIdx]);
+        T* t = new (&m_Queue[m_QueueIdx]) T(std::forward<Args>(args)...);
+        _putTime(*t);
         if (firstPut == 0s)
-          firstPut = _getTime(m_Queue[m_QueueIdx]);
+          firstPut = _getTime(*t);
         ++m_QueueIdx;
       }
 
@@ -108,8 +114,8 @@ namespace llarp
 
         if (m_QueueIdx == 1)
         {
-          visitor(m_Queue[0]);
-          T* t = &m_Queue[0];
+          T* t = Item(0);
+          visitor(*t);
           t->~T();
           m_QueueIdx = 0;
           firstPut = 0s;
@@ -119,7 +125,7 @@ namespace llarp
         while (m_QueueIdx)
         {
           llarp::LogDebug(m_name, " - queue has ", m_QueueIdx);
-          T* item = &m_Queue[idx++];
+          T* item = Item(idx++);
           if (f(*item))
             break;
           --m_QueueIdx;
@@ -157,11 +163,20 @@ namespace llarp
       llarp_time_t nextTickAt = 0s;
       Mutex_t m_QueueMutex;
       size_t m_QueueIdx GUARDED_BY(m_QueueMutex);
-      std::array<T, MaxSize> m_Queue GUARDED_BY(m_QueueMutex);
+      /// raw storage, items are constructed in place on emplace and destroyed once processed
+      std::array<std::aligned_storage_t<sizeof(T), alignof(T)>, MaxSize> m_Queue
+          GUARDED_BY(m_QueueMutex);
       std::string m_name;
       GetTime _getTime;
       PutTime _putTime;
       GetNow _getNow;
+
+     private:
+      T*
+      Item(size_t idx)
+      {
+        return std::launder(reinterpret_cast<T*>(&m_Queue[idx]));
+      }
     };  // namespace util
   }     // namespace util
 }  // namespace llarp
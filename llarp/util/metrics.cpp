@@ -0,0 +1,220 @@
+#include "metrics.hpp"
+
+#include <llarp/util/logging/logger.hpp>
+
+#include <algorithm>
+
+namespace llarp::metrics
+{
+  struct Registry::ShardHolder
+  {
+    detail::Shard* shard;
+
+    ShardHolder() : shard{new detail::Shard{}}
+    {
+      auto& registry = Registry::Instance();
+      std::lock_guard lock{registry.m_Mutex};
+      registry.m_Shards.push_back(shard);
+    }
+
+    ~ShardHolder()
+    {
+      auto& registry = Registry::Instance();
+      {
+        std::lock_guard lock{registry.m_Mutex};
+        for (size_t slot = 0; slot < detail::MaxSlots; ++slot)
+          registry.m_Retired[slot] += shard->values[slot].load(std::memory_order_relaxed);
+        registry.m_Shards.erase(
+            std::find(registry.m_Shards.begin(), registry.m_Shards.end(), shard));
+      }
+      // anything counted after this goes in a new shard
+      detail::t_Shard = nullptr;
+      delete shard;
+    }
+  };
+
+  detail::Shard&
+  detail::LocalShard()
+  {
+    static thread_local Registry::ShardHolder holder;
+    t_Shard = holder.shard;
+    return *holder.shard;
+  }
+
+  Registry&
+  Registry::Instance()
+  {
+    // leaked on purpose, threads hand their counts back to it when they exit which can be after
+    // static destructors have run
+    static auto* registry = new Registry{};
+    return *registry;
+  }
+
+  namespace
+  {
+    std::string
+    FormatLabels(const Labels& labels)
+    {
+      std::string formatted;
+      for (const auto& [name, value] : labels)
+      {
+        if (not formatted.empty())
+          formatted += ',';
+        formatted += name;
+        formatted += "=\"";
+        for (const char ch : value)
+        {
+          if (ch == '\\' or ch == '"')
+            formatted += '\\';
+          if (ch == '\n')
+            formatted += "\\n";
+          else
+            formatted += ch;
+        }
+        formatted += '"';
+      }
+      return formatted;
+    }
+
+    /// name{labels} with an extra label stuck on the end when there is one
+    void
+    PutSeries(
+        std::string& out,
+        std::string_view name,
+        std::string_view suffix,
+        const std::string& labels,
+        std::string_view extra = {})
+    {
+      out += name;
+      out += suffix;
+      if (not labels.empty() or not extra.empty())
+      {
+        out += '{';
+        out += labels;
+        if (not labels.empty() and not extra.empty())
+          out += ',';
+        out += extra;
+        out += '}';
+      }
+      out += ' ';
+    }
+  }  // namespace
+
+  const Registry::Metric*
+  Registry::Register(
+      std::string name, std::string help, Type type, Labels labels, std::vector<uint64_t> bounds)
+  {
+    auto formatted = FormatLabels(labels);
+    std::lock_guard lock{m_Mutex};
+    auto& named = m_ByName[name];
+    for (const auto idx : named)
+    {
+      const auto& metric = m_Metrics[idx];
+      if (metric.labels != formatted)
+        continue;
+      if (metric.type != type or metric.bounds != bounds)
+      {
+        LogError("metric ", name, " registered again as something else");
+        return nullptr;
+      }
+      return &metric;
+    }
+    const size_t slots = type == Type::Histogram ? bounds.size() + 2 : 1;
+    if (m_NextSlot + slots > detail::MaxSlots)
+    {
+      LogError("out of metric slots for ", name);
+      return nullptr;
+    }
+    named.push_back(m_Metrics.size());
+    auto& metric = m_Metrics.emplace_back(Metric{
+        std::move(name),
+        std::move(help),
+        type,
+        std::move(formatted),
+        m_NextSlot,
+        std::move(bounds)});
+    m_NextSlot += slots;
+    return &metric;
+  }
+
+  Counter
+  Registry::GetCounter(std::string name, std::string help, Labels labels)
+  {
+    if (const auto* metric =
+            Register(std::move(name), std::move(help), Type::Counter, std::move(labels), {}))
+      return Counter{metric->slot};
+    return Counter{};
+  }
+
+  Histogram
+  Registry::GetHistogram(
+      std::string name, std::string help, std::vector<uint64_t> bounds, Labels labels)
+  {
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    if (const auto* metric = Register(
+            std::move(name), std::move(help), Type::Histogram, std::move(labels), std::move(bounds)))
+      return Histogram{metric->slot, &metric->bounds};
+    return Histogram{};
+  }
+
+  uint64_t
+  Registry::SumSlot(size_t slot) const
+  {
+    uint64_t sum = m_Retired[slot];
+    for (const auto* shard : m_Shards)
+      sum += shard->values[slot].load(std::memory_order_relaxed);
+    return sum;
+  }
+
+  uint64_t
+  Registry::Value(const Counter& counter) const
+  {
+    if (counter.m_Slot == Counter::NoSlot)
+      return 0;
+    std::lock_guard lock{m_Mutex};
+    return SumSlot(counter.m_Slot);
+  }
+
+  std::string
+  Registry::Prometheus() const
+  {
+    std::string out;
+    std::lock_guard lock{m_Mutex};
+    for (const auto& [name, indexes] : m_ByName)
+    {
+      const auto& first = m_Metrics[indexes.front()];
+      out += "# HELP " + name + " " + first.help + "\n";
+      out += "# TYPE " + name + (first.type == Type::Counter ? " counter\n" : " histogram\n");
+      for (const auto idx : indexes)
+      {
+        const auto& metric = m_Metrics[idx];
+        if (metric.type == Type::Counter)
+        {
+          PutSeries(out, name, "", metric.labels);
+          out += std::to_string(SumSlot(metric.slot));
+          out += '\n';
+          continue;
+        }
+        // prometheus buckets count everything up to their bound
+        uint64_t count = 0;
+        for (size_t bucket = 0; bucket <= metric.bounds.size(); ++bucket)
+        {
+          count += SumSlot(metric.slot + bucket);
+          const auto le = bucket < metric.bounds.size() ? std::to_string(metric.bounds[bucket])
+                                                        : std::string{"+Inf"};
+          PutSeries(out, name, "_bucket", metric.labels, "le=\"" + le + "\"");
+          out += std::to_string(count);
+          out += '\n';
+        }
+        PutSeries(out, name, "_sum", metric.labels);
+        out += std::to_string(SumSlot(metric.slot + metric.bounds.size() + 1));
+        out += '\n';
+        PutSeries(out, name, "_count", metric.labels);
+        out += std::to_string(count);
+        out += '\n';
+      }
+    }
+    return out;
+  }
+}  // namespace llarp::metrics
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace llarp::metrics
+{
+  /// label names and values a metric is broken down by, e.g. {{"link", "iwp"}}
+  using Labels = std::vector<std::pair<std::string, std::string>>;
+
+  namespace detail
+  {
+    /// most counter slots there can be, histograms take one per bucket plus one for their sum
+    static constexpr size_t MaxSlots = 2048;
+
+    /// the counter values bumped by one thread, only that thread writes them so bumping is a
+    /// plain load and store that never contends with anyone
+    struct Shard
+    {
+      std::array<std::atomic<uint64_t>, MaxSlots> values{};
+    };
+
+    /// this thread's shard once it has one
+    inline thread_local Shard* t_Shard = nullptr;
+
+    /// makes this thread's shard the first time it counts something
+    Shard&
+    LocalShard();
+
+    inline void
+    Bump(size_t slot, uint64_t n)
+    {
+      auto* shard = t_Shard;
+      auto& value = (shard ? *shard : LocalShard()).values[slot];
+      value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+  }  // namespace detail
+
+  /// a monotonic counter any thread can bump without locking or allocating.
+  /// a default constructed one goes nowhere.
+  class Counter
+  {
+   public:
+    Counter() = default;
+
+    void
+    Add(uint64_t n = 1) const
+    {
+      if (m_Slot != NoSlot)
+        detail::Bump(m_Slot, n);
+    }
+
+   private:
+    friend class Registry;
+    static constexpr size_t NoSlot = ~size_t{0};
+
+    explicit Counter(size_t slot) : m_Slot{slot}
+    {}
+
+    size_t m_Slot = NoSlot;
+  };
+
+  /// counts values into fixed buckets, bumped the same way as a counter
+  class Histogram
+  {
+   public:
+    Histogram() = default;
+
+    void
+    Observe(uint64_t value) const
+    {
+      if (m_Bounds == nullptr)
+        return;
+      size_t bucket = 0;
+      while (bucket < m_Bounds->size() and value > (*m_Bounds)[bucket])
+        ++bucket;
+      detail::Bump(m_Slot + bucket, 1);
+      detail::Bump(m_Slot + m_Bounds->size() + 1, value);
+    }
+
+   private:
+    friend class Registry;
+
+    Histogram(size_t slot, const std::vector<uint64_t>* bounds) : m_Slot{slot}, m_Bounds{bounds}
+    {}
+
+    size_t m_Slot = 0;
+    const std::vector<uint64_t>* m_Bounds = nullptr;
+  };
+
+  /// where all the counters and histograms live. hot paths only ever touch their own thread's
+  /// shard, reading them all out takes a lock that nothing but registering a metric, a thread
+  /// exiting and other readers take.
+  class Registry
+  {
+   public:
+    static Registry&
+    Instance();
+
+    /// the counter for name and labels, the same one for every call with them
+    Counter
+    GetCounter(std::string name, std::string help, Labels labels = {});
+
+    /// the histogram for name and labels with buckets for values up to each of the ascending
+    /// upper bounds, and one for anything bigger
+    Histogram
+    GetHistogram(std::string name, std::string help, std::vector<uint64_t> bounds, Labels labels = {});
+
+    /// the current value of a counter summed up over all threads
+    uint64_t
+    Value(const Counter& counter) const;
+
+    /// everything in the prometheus text exposition format
+    std::string
+    Prometheus() const;
+
+   private:
+    friend detail::Shard& detail::LocalShard();
+
+    enum class Type
+    {
+      Counter,
+      Histogram
+    };
+
+    struct Metric
+    {
+      std::string name;
+      std::string help;
+      Type type;
+      /// prometheus formatted label pairs, without braces
+      std::string labels;
+      size_t slot;
+      std::vector<uint64_t> bounds;
+    };
+
+    struct ShardHolder;
+
+    Registry() = default;
+
+    /// find or add a metric, returns nullptr when we are out of slots or it exists with another
+    /// type
+    const Metric*
+    Register(std::string name, std::string help, Type type, Labels labels, std::vector<uint64_t> bounds);
+
+    uint64_t
+    SumSlot(size_t slot) const;
+
+    mutable std::mutex m_Mutex;
+    /// deque so the bounds histograms point at never move
+    std::deque<Metric> m_Metrics;
+    std::map<std::string, std::vector<size_t>> m_ByName;
+    size_t m_NextSlot = 0;
+    std::vector<detail::Shard*> m_Shards;
+    /// what threads that exited had counted
+    std::array<uint64_t, detail::MaxSlots> m_Retired{};
+  };
+}  // namespace llarp::metrics
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace llarp
+{
+  namespace thread
+  {
+    /// A move only void() callable that keeps small callables inline.
+    ///
+    /// Lambdas handed to the event loop capture a few pointers, a shared_ptr or a std::function
+    /// at most, which all fit in InlineSize bytes; only bigger ones go to the heap.  Unlike
+    /// std::function it doesn't need the callable to be copyable, and wrapping a std::function
+    /// doesn't allocate.
+    class Job
+    {
+     public:
+      static constexpr size_t InlineSize = 48;
+
+      Job() = default;
+
+      template <
+          typename Func,
+          typename Decayed = std::decay_t<Func>,
+          typename = std::enable_if_t<
+              not std::is_same_v<Decayed, Job> and std::is_invocable_r_v<void, Decayed&>>>
+      Job(Func&& func)
+      {
+        if constexpr (IsInline<Decayed>)
+        {
+          new (m_Storage) Decayed(std::forward<Func>(func));
+          m_Ops = &InlineOps<Decayed>;
+        }
+        else
+        {
+          *reinterpret_cast<Decayed**>(m_Storage) = new Decayed(std::forward<Func>(func));
+          m_Ops = &HeapOps<Decayed>;
+        }
+      }
+
+      Job(Job&& other) noexcept : m_Ops{other.m_Ops}
+      {
+        if (m_Ops)
+          m_Ops->move(other.m_Storage, m_Storage);
+        other.m_Ops = nullptr;
+      }
+
+      Job&
+      operator=(Job&& other) noexcept
+      {
+        if (this != &other)
+        {
+          reset();
+          m_Ops = other.m_Ops;
+          if (m_Ops)
+            m_Ops->move(other.m_Storage, m_Storage);
+          other.m_Ops = nullptr;
+        }
+        return *this;
+      }
+
+      Job(const Job&) = delete;
+      Job&
+      operator=(const Job&) = delete;
+
+      ~Job()
+      {
+        reset();
+      }
+
+      void
+      operator()()
+      {
+        if (not m_Ops)
+          throw std::bad_function_call{};
+        m_Ops->invoke(m_Storage);
+      }
+
+      explicit operator bool() const
+      {
+        return m_Ops != nullptr;
+      }
+
+      void
+      reset()
+      {
+        if (m_Ops)
+          m_Ops->destroy(m_Storage);
+        m_Ops = nullptr;
+      }
+
+      /// true if a callable of this type is stored without a heap allocation
+      template <typename Func>
+      static constexpr bool IsInline = sizeof(Func) <= InlineSize
+          and alignof(Func) <= alignof(std::max_align_t)
+          and std::is_nothrow_move_constructible_v<Func>;
+
+     private:
+      struct Ops
+      {
+        void (*invoke)(void*);
+        /// move construct into `to` and destroy what's left in `from`
+        void (*move)(void* from, void* to);
+        void (*destroy)(void*);
+      };
+
+      template <typename Func>
+      static constexpr Ops InlineOps{
+          [](void* self) { (*std::launder(static_cast<Func*>(self)))(); },
+          [](void* from, void* to) {
+            auto* func = std::launder(static_cast<Func*>(from));
+            new (to) Func(std::move(*func));
+            func->~Func();
+          },
+          [](void* self) { std::launder(static_cast<Func*>(self))->~Func(); }};
+
+      template <typename Func>
+      static constexpr Ops HeapOps{
+          [](void* self) { (**static_cast<Func**>(self))(); },
+          [](void* from, void* to) { *static_cast<Func**>(to) = *static_cast<Func**>(from); },
+          [](void* self) { delete *static_cast<Func**>(self); }};
+
+      alignas(std::max_align_t) std::byte m_Storage[InlineSize];
+      const Ops* m_Ops = nullptr;
+    };
+  }  // namespace thread
+}  // namespace llarp
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace llarp
+{
+  namespace thread
+  {
+    /// A bounded lock free queue for many producer threads and a single consumer thread.
+    ///
+    /// Each slot carries a sequence number that says whose turn it is: a producer claims the tail
+    /// with one compare and swap and then publishes its slot by bumping the slot's sequence, the
+    /// consumer waits for that and hands the slot back the same way.  Producers never touch each
+    /// other's slots and never block, a full queue just fails the push.
+    template <typename Type>
+    class MPSCQueue
+    {
+     public:
+      /// capacity is rounded up to a power of 2
+      explicit MPSCQueue(size_t capacity)
+          : m_Capacity{RoundUp(capacity)}
+          , m_Mask{m_Capacity - 1}
+          , m_Slots{std::make_unique<Slot[]>(m_Capacity)}
+      {
+        for (size_t idx = 0; idx < m_Capacity; ++idx)
+          m_Slots[idx].seq.store(idx, std::memory_order_relaxed);
+      }
+
+      ~MPSCQueue()
+      {
+        while (tryPopFront())
+          ;
+      }
+
+      MPSCQueue(const MPSCQueue&) = delete;
+      MPSCQueue&
+      operator=(const MPSCQueue&) = delete;
+
+      /// push from any thread, returns false if the queue is full
+      template <typename... Args>
+      bool
+      tryPushBack(Args&&... args)
+      {
+        size_t pos = m_Tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;)
+        {
+          slot = &m_Slots[pos & m_Mask];
+          const size_t seq = slot->seq.load(std::memory_order_acquire);
+          const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+          if (diff == 0)
+          {
+            if (m_Tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+              break;
+          }
+          else if (diff < 0)
+            return false;
+          else
+            pos = m_Tail.load(std::memory_order_relaxed);
+        }
+        new (slot->storage) Type(std::forward<Args>(args)...);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+
+      /// pop from the consumer thread only
+      std::optional<Type>
+      tryPopFront()
+      {
+        Slot& slot = m_Slots[m_Head & m_Mask];
+        if (slot.seq.load(std::memory_order_acquire) != m_Head + 1)
+          return std::nullopt;
+        std::optional<Type> value{std::move(*slot.get())};
+        Release(slot);
+        return value;
+      }
+
+      /// pop up to `max` elements and call visit on each, from the consumer thread only.
+      /// every slot is handed back before its element is visited so producers can refill it while
+      /// visit runs.  returns how many were visited.
+      template <typename Visit>
+      size_t
+      drain(Visit&& visit, size_t max)
+      {
+        size_t num = 0;
+        while (num < max)
+        {
+          Slot& slot = m_Slots[m_Head & m_Mask];
+          if (slot.seq.load(std::memory_order_acquire) != m_Head + 1)
+            break;
+          Type value{std::move(*slot.get())};
+          Release(slot);
+          ++num;
+          visit(value);
+        }
+        return num;
+      }
+
+      /// from the consumer thread only
+      bool
+      empty() const
+      {
+        return m_Slots[m_Head & m_Mask].seq.load(std::memory_order_acquire) != m_Head + 1;
+      }
+
+      size_t
+      capacity() const
+      {
+        return m_Capacity;
+      }
+
+     private:
+      struct alignas(64) Slot
+      {
+        std::atomic<size_t> seq;
+        alignas(Type) std::byte storage[sizeof(Type)];
+
+        Type*
+        get()
+        {
+          return std::launder(reinterpret_cast<Type*>(storage));
+        }
+      };
+
+      static size_t
+      RoundUp(size_t capacity)
+      {
+        size_t size = 2;
+        while (size < capacity)
+          size <<= 1;
+        return size;
+      }
+
+      void
+      Release(Slot& slot)
+      {
+        slot.get()->~Type();
+        slot.seq.store(m_Head + m_Capacity, std::memory_order_release);
+        ++m_Head;
+      }
+
+      const size_t m_Capacity;
+      const size_t m_Mask;
+      std::unique_ptr<Slot[]> m_Slots;
+      alignas(64) std::atomic<size_t> m_Tail{0};
+      /// only the consumer touches this
+      alignas(64) size_t m_Head = 0;
+    };
+  }  // namespace thread
+}  // namespace llarp
@@ -0,0 +1,244 @@
+#include "worker_pool.hpp"
+#include "threading.hpp"
+
+#include <llarp/util/logging/logger.hpp>
+
+#include <chrono>
+
+namespace llarp
+{
+  namespace thread
+  {
+    /// how long an idle worker sleeps before it looks for work to steal again
+    static constexpr auto IdleStealInterval = std::chrono::milliseconds{5};
+
+    struct alignas(64) WorkerPool::Worker
+    {
+      std::mutex mutex;
+      std::condition_variable cv;
+      /// jobs pinned to this worker by owner, never stolen
+      std::deque<Job_t> ordered;
+      /// jobs without an owner, other workers may steal these
+      std::deque<Job_t> unordered;
+      bool sleeping = false;
+      /// set once Stop found this worker with nothing left, jobs for it then run inline
+      bool stopped = false;
+
+      bool
+      HasWork() const
+      {
+        return not(ordered.empty() and unordered.empty());
+      }
+    };
+
+    namespace
+    {
+      /// the pool and worker index of the current thread, if it is a pool worker
+      thread_local const WorkerPool* current_pool = nullptr;
+      thread_local size_t current_worker = 0;
+
+      /// spread owner pointers over the workers; pointers are aligned so the low bits alone would
+      /// bunch everything up on a few workers
+      size_t
+      HashOwner(const void* owner)
+      {
+        uint64_t h = reinterpret_cast<uintptr_t>(owner);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+      }
+    }  // namespace
+
+    WorkerPool::WorkerPool(size_t threads, std::string name) : m_Name{std::move(name)}
+    {
+      if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+      m_Workers.reserve(threads);
+      while (m_Workers.size() < threads)
+        m_Workers.emplace_back(std::make_unique<Worker>());
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+      Stop();
+    }
+
+    void
+    WorkerPool::Start()
+    {
+      if (m_Running.exchange(true))
+        return;
+      for (auto& worker : m_Workers)
+      {
+        std::lock_guard lock{worker->mutex};
+        worker->stopped = false;
+      }
+      m_Threads.reserve(m_Workers.size());
+      for (size_t idx = 0; idx < m_Workers.size(); ++idx)
+        m_Threads.emplace_back([this, idx] { Run(idx); });
+      LogInfo("started ", m_Workers.size(), " ", m_Name, " threads");
+    }
+
+    void
+    WorkerPool::Stop()
+    {
+      if (not m_Running.exchange(false))
+        return;
+      for (auto& worker : m_Workers)
+      {
+        std::lock_guard lock{worker->mutex};
+        worker->cv.notify_one();
+      }
+      for (auto& thread : m_Threads)
+        thread.join();
+      m_Threads.clear();
+      // anything queued by a job that ran while the other workers were exiting runs here, and so
+      // does anything those jobs queue.  the queues are swapped out under the lock so a job
+      // queueing more work never touches a queue we are going through.
+      for (bool drained = false; not drained;)
+      {
+        drained = true;
+        for (auto& worker : m_Workers)
+        {
+          std::deque<Job_t> ordered, unordered;
+          {
+            std::lock_guard lock{worker->mutex};
+            if (not worker->HasWork())
+            {
+              worker->stopped = true;
+              continue;
+            }
+            ordered.swap(worker->ordered);
+            unordered.swap(worker->unordered);
+          }
+          drained = false;
+          for (auto& job : ordered)
+            job();
+          for (auto& job : unordered)
+            job();
+        }
+      }
+    }
+
+    void
+    WorkerPool::QueueJob(Job_t job)
+    {
+      // keep jobs queued from a worker on that worker, they are likely to touch the same memory
+      const size_t idx = current_pool == this
+          ? current_worker
+          : m_NextWorker.fetch_add(1, std::memory_order_relaxed) % m_Workers.size();
+      auto& worker = *m_Workers[idx];
+      bool stopped, busy;
+      {
+        std::lock_guard lock{worker.mutex};
+        stopped = worker.stopped;
+        if (not stopped)
+          worker.unordered.emplace_back(std::move(job));
+        busy = not worker.sleeping;
+      }
+      if (stopped)
+        job();
+      else if (busy)
+      {
+        if (m_Sleeping.load(std::memory_order_relaxed) > 0)
+          WakeIdle(idx);
+      }
+      else
+        worker.cv.notify_one();
+    }
+
+    void
+    WorkerPool::QueueOrderedJob(const void* owner, Job_t job)
+    {
+      auto& worker = *m_Workers[HashOwner(owner) % m_Workers.size()];
+      bool stopped;
+      {
+        std::lock_guard lock{worker.mutex};
+        stopped = worker.stopped;
+        if (not stopped)
+          worker.ordered.emplace_back(std::move(job));
+      }
+      // nothing is left queued for a stopped worker so running it now keeps the owner's order
+      if (stopped)
+        job();
+      else
+        worker.cv.notify_one();
+    }
+
+    void
+    WorkerPool::WakeIdle(size_t skip)
+    {
+      for (size_t idx = 0; idx < m_Workers.size(); ++idx)
+      {
+        if (idx == skip)
+          continue;
+        auto& worker = *m_Workers[idx];
+        std::unique_lock lock{worker.mutex, std::try_to_lock};
+        if (lock and worker.sleeping)
+        {
+          worker.cv.notify_one();
+          return;
+        }
+      }
+    }
+
+    bool
+    WorkerPool::TrySteal(size_t thief, Job_t& job)
+    {
+      const size_t num = m_Workers.size();
+      for (size_t n = 1; n < num; ++n)
+      {
+        auto& victim = *m_Workers[(thief + n) % num];
+        std::unique_lock lock{victim.mutex, std::try_to_lock};
+        if (not lock or victim.unordered.empty())
+          continue;
+        job = std::move(victim.unordered.front());
+        victim.unordered.pop_front();
+        return true;
+      }
+      return false;
+    }
+
+    void
+    WorkerPool::Run(size_t idx)
+    {
+      util::SetThreadName(m_Name);
+      current_pool = this;
+      current_worker = idx;
+      auto& self = *m_Workers[idx];
+      for (;;)
+      {
+        Job_t job;
+        {
+          std::unique_lock lock{self.mutex};
+          if (not self.ordered.empty())
+          {
+            job = std::move(self.ordered.front());
+            self.ordered.pop_front();
+          }
+          else if (not self.unordered.empty())
+          {
+            job = std::move(self.unordered.front());
+            self.unordered.pop_front();
+          }
+          else if (not m_Running.load())
+            break;
+        }
+        if (job or TrySteal(idx, job))
+        {
+          job();
+          continue;
+        }
+        std::unique_lock lock{self.mutex};
+        self.sleeping = true;
+        m_Sleeping.fetch_add(1, std::memory_order_relaxed);
+        self.cv.wait_for(
+            lock, IdleStealInterval, [&] { return self.HasWork() or not m_Running.load(); });
+        m_Sleeping.fetch_sub(1, std::memory_order_relaxed);
+        self.sleeping = false;
+      }
+      current_pool = nullptr;
+    }
+  }  // namespace thread
+}  // namespace llarp
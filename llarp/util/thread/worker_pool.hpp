@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace llarp
+{
+  namespace thread
+  {
+    /// A fixed size pool of threads for cpu bound jobs (i.e. crypto).
+    ///
+    /// Every worker owns its own job queues.  Jobs queued with an owner are pinned to the worker
+    /// the owner hashes to, so all jobs for the same owner (a link session, a path, a transit hop)
+    /// run one at a time and in the order they were queued.  Jobs queued without an owner are
+    /// spread over the workers round robin and can be stolen by any worker that runs dry.
+    class WorkerPool
+    {
+     public:
+      using Job_t = std::function<void(void)>;
+
+      /// construct a pool of `threads` workers; 0 means one worker per logical cpu core.
+      /// no threads are spawned until Start() is called.
+      explicit WorkerPool(size_t threads, std::string name = "llarp-worker");
+
+      ~WorkerPool();
+
+      WorkerPool(const WorkerPool&) = delete;
+      WorkerPool&
+      operator=(const WorkerPool&) = delete;
+
+      /// spawn the worker threads, does nothing if already started
+      void
+      Start();
+
+      /// finish all queued jobs, and the jobs they queue, and join the worker threads.  does
+      /// nothing if not started.  once stopped, queued jobs run right away on the calling thread.
+      void
+      Stop();
+
+      /// queue a job with no ordering constraints
+      void
+      QueueJob(Job_t job);
+
+      /// queue a job that runs after every job previously queued with the same owner
+      void
+      QueueOrderedJob(const void* owner, Job_t job);
+
+      size_t
+      NumThreads() const
+      {
+        return m_Workers.size();
+      }
+
+      bool
+      IsRunning() const
+      {
+        return m_Running.load();
+      }
+
+     private:
+      struct Worker;
+
+      void
+      Run(size_t idx);
+
+      /// try to take an unordered job from any worker other than `thief`
+      bool
+      TrySteal(size_t thief, Job_t& job);
+
+      /// wake up one sleeping worker other than `skip` so it can steal work
+      void
+      WakeIdle(size_t skip);
+
+      std::vector<std::unique_ptr<Worker>> m_Workers;
+      std::vector<std::thread> m_Threads;
+      std::atomic<size_t> m_NextWorker{0};
+      std::atomic<size_t> m_Sleeping{0};
+      std::atomic<bool> m_Running{false};
+      const std::string m_Name;
+    };
+  }  // namespace thread
+}  // namespace llarp
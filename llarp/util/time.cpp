@@ -16,6 +16,8 @@ namespace llarp
 
   const static auto started_at_steady = std::chrono::steady_clock::now();
 
+  static std::atomic<const std::atomic<Duration_t>*> time_source{nullptr};
+
   uint64_t
   ToMS(Duration_t ms)
   {
@@ -33,6 +35,8 @@ namespace llarp
   Duration_t
   time_now_ms()
   {
+    if (const auto* source = time_source.load(std::memory_order_acquire))
+      return source->load(std::memory_order_relaxed);
     auto t = uptime();
 #ifdef TESTNET_SPEED
     t /= uint64_t{TESTNET_SPEED};
@@ -40,6 +44,12 @@ namespace llarp
     return t + time_since_epoch<Duration_t, Clock_t>(started_at_system);
   }
 
+  void
+  set_time_source(const std::atomic<Duration_t>* now)
+  {
+    time_source.store(now, std::memory_order_release);
+  }
+
   nlohmann::json
   to_json(const Duration_t& t)
   {
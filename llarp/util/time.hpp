@@ -2,6 +2,7 @@
 
 #include "types.hpp"
 #include <nlohmann/json.hpp>
+#include <atomic>
 #include <iostream>
 
 using namespace std::chrono_literals;
@@ -12,6 +13,12 @@ namespace llarp
   Duration_t
   time_now_ms();
 
+  /// make time_now_ms() read *now instead of the system clock, or go back to the system clock
+  /// when nullptr; used to run routers on a simulated clock.  *now may be advanced from one
+  /// thread while others read it.
+  void
+  set_time_source(const std::atomic<Duration_t>* now);
+
   /// get the uptime of the process
   Duration_t
   uptime();
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "time.hpp"
+#include "types.hpp"
+
+#include <array>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// hierarchical timer wheel for lots of deadlines that mostly get pushed back before they come
+    /// up, like per session ack, retransmit and keepalive timers.
+    ///
+    /// scheduling is O(1) and advancing only touches the slots that come up, each level's slots
+    /// spanning a whole turn of the level below. entries are never removed, a value whose deadline
+    /// moved is scheduled again and its stale entry is left to fire, so values should be cheap
+    /// to visit for nothing (e.g. a weak_ptr to the owner that checks its own deadlines).
+    template <typename Value_t>
+    class TimerWheel
+    {
+     public:
+      static constexpr size_t LevelBits = 6;
+      static constexpr size_t SlotsPerLevel = size_t{1} << LevelBits;
+      static constexpr size_t Levels = 4;
+
+      explicit TimerWheel(llarp_time_t resolution = 1ms) : m_Resolution{resolution}
+      {}
+
+      /// how many entries are on the wheel, stale ones included
+      size_t
+      size() const
+      {
+        return m_Size;
+      }
+
+      bool
+      empty() const
+      {
+        return m_Size == 0;
+      }
+
+      /// visit `value` on the first Advance to a time at or after `at`
+      void
+      Schedule(llarp_time_t at, Value_t value)
+      {
+        ++m_Size;
+        Place(Entry{ToTick(at), std::move(value)});
+      }
+
+      /// move the wheel up to `now` calling visit(value) for every entry that came up, entries
+      /// visit schedules that are already due come up on the next Advance.
+      /// returns how many entries were visited.
+      template <typename Visit_t>
+      size_t
+      Advance(llarp_time_t now, Visit_t&& visit)
+      {
+        const uint64_t target = now.count() / m_Resolution.count();
+        if (not m_Started)
+        {
+          // anything scheduled before the first advance waits in m_Due until we know the time
+          m_Started = true;
+          m_Current = target;
+          auto early = std::move(m_Due);
+          m_Due.clear();
+          for (auto& entry : early)
+            Place(std::move(entry));
+        }
+        while (m_Current < target)
+        {
+          if (m_Size == m_Due.size())
+          {
+            // nothing left in the slots, skip straight there
+            m_Current = target;
+            break;
+          }
+          ++m_Current;
+          Cascade();
+          auto& slot = m_Slots[0][m_Current & SlotMask];
+          for (auto& entry : slot)
+            m_Due.emplace_back(std::move(entry));
+          slot.clear();
+        }
+
+        m_Visiting.swap(m_Due);
+        for (auto& entry : m_Visiting)
+        {
+          --m_Size;
+          visit(entry.value);
+        }
+        const size_t visited = m_Visiting.size();
+        m_Visiting.clear();
+        return visited;
+      }
+
+     private:
+      static constexpr uint64_t SlotMask = SlotsPerLevel - 1;
+
+      struct Entry
+      {
+        uint64_t tick;
+        Value_t value;
+      };
+
+      using Slot_t = std::vector<Entry>;
+
+      /// round up so nothing comes up early
+      uint64_t
+      ToTick(llarp_time_t at) const
+      {
+        if (at <= 0s)
+          return 0;
+        return (at.count() + m_Resolution.count() - 1) / m_Resolution.count();
+      }
+
+      void
+      Place(Entry entry)
+      {
+        if (not m_Started or entry.tick <= m_Current)
+        {
+          m_Due.emplace_back(std::move(entry));
+          return;
+        }
+        const uint64_t delta = entry.tick - m_Current;
+        for (size_t level = 0; level < Levels; ++level)
+        {
+          const size_t shift = LevelBits * level;
+          if (delta < (uint64_t{1} << (shift + LevelBits)))
+          {
+            m_Slots[level][(entry.tick >> shift) & SlotMask].emplace_back(std::move(entry));
+            return;
+          }
+        }
+        // further out than the whole wheel, park it on the last slot of the top level and it is
+        // placed again with its real deadline when that comes up
+        constexpr size_t shift = LevelBits * (Levels - 1);
+        const uint64_t last = m_Current + (uint64_t{1} << (shift + LevelBits)) - 1;
+        m_Slots[Levels - 1][(last >> shift) & SlotMask].emplace_back(std::move(entry));
+      }
+
+      /// when m_Current starts a new turn of a level, spread the slot of the level above that
+      /// comes up now over the levels below it, highest level first
+      void
+      Cascade()
+      {
+        size_t top = 0;
+        while (top + 1 < Levels and (m_Current & ((uint64_t{1} << (LevelBits * (top + 1))) - 1)) == 0)
+          ++top;
+        for (size_t level = top; level > 0; --level)
+        {
+          auto& slot = m_Slots[level][(m_Current >> (LevelBits * level)) & SlotMask];
+          if (slot.empty())
+            continue;
+          Slot_t entries;
+          entries.swap(slot);
+          for (auto& entry : entries)
+            Place(std::move(entry));
+        }
+      }
+
+      llarp_time_t m_Resolution;
+      bool m_Started = false;
+      uint64_t m_Current = 0;
+      size_t m_Size = 0;
+      std::array<std::array<Slot_t, SlotsPerLevel>, Levels> m_Slots;
+      /// entries that came up, visited on Advance
+      std::vector<Entry> m_Due;
+      std::vector<Entry> m_Visiting;
+    };
+  }  // namespace util
+}  // namespace llarp
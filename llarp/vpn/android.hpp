@@ -38,9 +38,9 @@ namespace llarp::vpn
     ReadNextPacket() override
     {
       net::IPPacket pkt{};
-      const auto sz = read(m_fd, pkt.buf, sizeof(pkt.buf));
+      const auto sz = read(m_fd, pkt.buf, net::IPPacket::MaxSize);
       if (sz >= 0)
-        pkt.sz = std::min(sz, ssize_t{sizeof(pkt.buf)});
+        pkt.sz = std::min(sz, ssize_t{net::IPPacket::MaxSize});
       return pkt;
     }
 
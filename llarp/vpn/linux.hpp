@@ -16,8 +16,20 @@
 #include <sys/socket.h>
 #include <linux/rtnetlink.h>
 #include <llarp/net/net.hpp>
+#include <llarp/net/tcp_coalesce.hpp>
 #include <llarp/util/str.hpp>
+#include <llarp/util/thread/queue.hpp>
+#include <llarp/util/thread/threading.hpp>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <poll.h>
+
+#include <array>
+#include <atomic>
 #include <exception>
+#include <optional>
+#include <thread>
+#include <vector>
 
 namespace llarp::vpn
 {
@@ -30,26 +42,163 @@ namespace llarp::vpn
 
   class LinuxInterface : public NetworkInterface
   {
-    const int m_fd;
+    /// one fd per tun queue, only ever more than one with IFF_MULTI_QUEUE
+    std::vector<int> m_fds;
     const InterfaceInfo m_Info;
 
-   public:
-    LinuxInterface(InterfaceInfo info)
-        : NetworkInterface{}, m_fd{::open("/dev/net/tun", O_RDWR)}, m_Info{std::move(info)}
-
+    /// with more than one queue each queue is read on its own thread, the packets they read are
+    /// handed to the event loop through this queue and m_WakeFD
+    static constexpr size_t ReadQueueSize = 1024;
+    /// how many packets a reader thread reads off its queue before it wakes the event loop
+    static constexpr size_t ReadBatchSize = 64;
+    std::optional<thread::Queue<net::IPPacket>> m_ReadQueue;
+    /// packets the readers dropped because m_ReadQueue was full
+    std::atomic<uint64_t> m_ReadDrops{0};
+    std::vector<std::thread> m_Readers;
+    int m_WakeFD = -1;
+    int m_StopFD = -1;
+    /// opened with IFF_VNET_HDR, every packet in either direction has a net::VNetHeader in front
+    bool m_VNetHdr = false;
+    net::TCPCoalescer m_Coalescer;
+
+    static int
+    OpenQueue(ifreq& ifr)
     {
-      if (m_fd == -1)
+      const int fd = ::open("/dev/net/tun", O_RDWR);
+      if (fd == -1)
         throw std::runtime_error("cannot open /dev/net/tun " + std::string{strerror(errno)});
+      if (::ioctl(fd, TUNSETIFF, &ifr) == -1)
+      {
+        const std::string err{strerror(errno)};
+        ::close(fd);
+        throw std::runtime_error("cannot set interface name: " + err);
+      }
+      return fd;
+    }
+
+    bool
+    MultiQueue() const
+    {
+      return m_fds.size() > 1;
+    }
+
+    /// read one packet off a queue without its vnet header, returns 0 if we dropped it
+    ssize_t
+    ReadFrom(int fd, net::IPPacket& pkt) const
+    {
+      if (not m_VNetHdr)
+        return ::read(fd, pkt.buf, net::IPPacket::MaxSize);
+      net::VNetHeader hdr;
+      std::array<iovec, 2> iov{iovec{&hdr, sizeof(hdr)}, iovec{pkt.buf, net::IPPacket::MaxSize}};
+      const auto sz = ::readv(fd, iov.data(), iov.size());
+      if (sz < static_cast<ssize_t>(sizeof(hdr)))
+        return std::min<ssize_t>(sz, 0);
+      // we never ask for receive offloads, at most the kernel leaves us a checksum to finish
+      if (hdr.gsoType != net::VNetHeader::GSONone
+          or not net::CompleteChecksum(hdr, pkt.buf, sz - sizeof(hdr)))
+        return 0;
+      return sz - sizeof(hdr);
+    }
+
+    bool
+    WriteTo(int fd, const net::VNetHeader& hdr, const byte_t* data, size_t sz)
+    {
+      if (not m_VNetHdr)
+        return ::write(fd, data, sz) == static_cast<ssize_t>(sz);
+      std::array<iovec, 2> iov{
+          iovec{const_cast<net::VNetHeader*>(&hdr), sizeof(hdr)},
+          iovec{const_cast<byte_t*>(data), sz}};
+      return ::writev(fd, iov.data(), iov.size()) == static_cast<ssize_t>(sizeof(hdr) + sz);
+    }
 
+    /// read packets off one tun queue until we are told to stop
+    void
+    ReadLoop(int fd)
+    {
+      util::SetThreadName(m_Info.ifname + "-rx");
+      std::array<pollfd, 2> fds{pollfd{fd, POLLIN, 0}, pollfd{m_StopFD, POLLIN, 0}};
+      for (;;)
+      {
+        if (::poll(fds.data(), fds.size(), -1) == -1)
+        {
+          if (errno == EINTR)
+            continue;
+          LogError("poll on ", m_Info.ifname, " failed: ", strerror(errno));
+          return;
+        }
+        if (fds[1].revents)
+          return;
+        size_t got = 0;
+        while (got < ReadBatchSize)
+        {
+          net::IPPacket pkt;
+          const auto sz = ReadFrom(fd, pkt);
+          if (sz <= 0)
+            break;
+          pkt.sz = sz;
+          // drop anything that is not an ip packet here rather than on the event loop
+          if (not(pkt.IsV4() or pkt.IsV6()))
+            continue;
+          if (m_ReadQueue->tryPushBack(std::move(pkt)) != thread::QueueReturn::Success)
+          {
+            // the event loop is behind, leave the rest on the tun queue for now
+            const auto dropped = m_ReadDrops.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (dropped % ReadQueueSize == 1)
+              LogWarn(m_Info.ifname, " read queue full, dropped ", dropped, " packets so far");
+            break;
+          }
+          ++got;
+        }
+        if (got > 0)
+        {
+          const uint64_t one = 1;
+          [[maybe_unused]] const auto n = ::write(m_WakeFD, &one, sizeof(one));
+        }
+      }
+    }
+
+    /// pick the queue for a packet by its flow so each flow stays on one queue
+    int
+    QueueFor(const net::IPPacket& pkt) const
+    {
+      uint64_t hash;
+      if (pkt.IsV4())
+        hash = (uint64_t{pkt.Header()->saddr} << 32) ^ pkt.Header()->daddr;
+      else
+      {
+        const auto src = pkt.srcv6();
+        const auto dst = pkt.dstv6();
+        hash = src.h.upper ^ src.h.lower ^ dst.h.upper ^ dst.h.lower;
+      }
+      if (const auto port = pkt.DstPort())
+        hash ^= uint64_t{port->n} << 16;
+      hash ^= hash >> 33;
+      hash *= 0xff51afd7ed558ccdULL;
+      hash ^= hash >> 33;
+      return m_fds[hash % m_fds.size()];
+    }
+
+    /// open the tun queues, set up the interface and start the readers
+    void
+    Setup()
+    {
+      const size_t numQueues = std::max<size_t>(1, m_Info.queues);
       ifreq ifr{};
       in6_ifreq ifr6{};
       ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+      if (numQueues > 1)
+        ifr.ifr_flags |= IFF_MULTI_QUEUE;
+      if (m_Info.offload)
+        ifr.ifr_flags |= IFF_VNET_HDR;
+      m_VNetHdr = m_Info.offload;
       std::copy_n(
           m_Info.ifname.c_str(),
           std::min(m_Info.ifname.size(), sizeof(ifr.ifr_name)),
           ifr.ifr_name);
-      if (::ioctl(m_fd, TUNSETIFF, &ifr) == -1)
-        throw std::runtime_error("cannot set interface name: " + std::string{strerror(errno)});
+      // every queue attaches to the interface the first one created
+      m_fds.reserve(numQueues);
+      while (m_fds.size() < numQueues)
+        m_fds.push_back(OpenQueue(ifr));
       IOCTL control{AF_INET};
 
       control.ioctl(SIOCGIFFLAGS, &ifr);
@@ -87,26 +236,92 @@ namespace llarp::vpn
       }
       ifr.ifr_flags = static_cast<short>(flags | IFF_UP | IFF_NO_PI);
       control.ioctl(SIOCSIFFLAGS, &ifr);
+      if (m_VNetHdr)
+        LogInfo(m_Info.ifname, " merging tcp segments into offload writes");
+
+      if (not MultiQueue())
+        return;
+      m_WakeFD = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      m_StopFD = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if (m_WakeFD == -1 or m_StopFD == -1)
+        throw std::runtime_error("cannot create eventfd: " + std::string{strerror(errno)});
+      m_ReadQueue.emplace(ReadQueueSize);
+      for (const int fd : m_fds)
+      {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        m_Readers.emplace_back([this, fd] { ReadLoop(fd); });
+      }
+      LogInfo(m_Info.ifname, " reading ", m_fds.size(), " tun queues");
+    }
+
+    /// stop the readers and close whatever Setup got as far as opening
+    void
+    Teardown()
+    {
+      if (m_StopFD != -1)
+      {
+        const uint64_t one = 1;
+        [[maybe_unused]] const auto n = ::write(m_StopFD, &one, sizeof(one));
+      }
+      for (auto& reader : m_Readers)
+        reader.join();
+      m_Readers.clear();
+      for (int* fd : {&m_WakeFD, &m_StopFD})
+      {
+        if (*fd != -1)
+          ::close(*fd);
+        *fd = -1;
+      }
+      for (const int fd : m_fds)
+        ::close(fd);
+      m_fds.clear();
+    }
+
+   public:
+    LinuxInterface(InterfaceInfo info) : NetworkInterface{}, m_Info{std::move(info)}
+    {
+      // the destructor does not run if we throw, so anything we opened is closed here
+      try
+      {
+        Setup();
+      }
+      catch (...)
+      {
+        Teardown();
+        throw;
+      }
     }
 
     virtual ~LinuxInterface()
     {
-      ::close(m_fd);
+      Teardown();
     }
 
     int
     PollFD() const override
     {
-      return m_fd;
+      return MultiQueue() ? m_WakeFD : m_fds[0];
     }
 
     net::IPPacket
     ReadNextPacket() override
     {
+      if (MultiQueue())
+      {
+        if (auto maybe = m_ReadQueue->tryPopFront())
+          return std::move(*maybe);
+        // clear the wakeup before looking again so a reader that pushes after this still wakes
+        // us up next time around
+        uint64_t count;
+        [[maybe_unused]] const auto n = ::read(m_WakeFD, &count, sizeof(count));
+        if (auto maybe = m_ReadQueue->tryPopFront())
+          return std::move(*maybe);
+        return net::IPPacket{};
+      }
       net::IPPacket pkt;
-      const auto sz = read(m_fd, pkt.buf, sizeof(pkt.buf));
+      const auto sz = ReadFrom(m_fds[0], pkt);
       if (sz >= 0)
-        pkt.sz = std::min(sz, ssize_t{sizeof(pkt.buf)});
+        pkt.sz = std::min(sz, ssize_t{net::IPPacket::MaxSize});
       else if (errno == EAGAIN || errno == EWOULDBLOCK)
         pkt.sz = 0;
       else
@@ -117,10 +332,26 @@ namespace llarp::vpn
     bool
     WritePacket(net::IPPacket pkt) override
     {
-      const auto sz = write(m_fd, pkt.buf, pkt.sz);
-      if (sz <= 0)
-        return false;
-      return sz == static_cast<ssize_t>(pkt.sz);
+      const int fd = MultiQueue() ? QueueFor(pkt) : m_fds[0];
+      return WriteTo(fd, net::VNetHeader{}, pkt.buf, pkt.sz);
+    }
+
+    size_t
+    WritePackets(std::vector<net::IPPacket>& pkts) override
+    {
+      // without offloads the tun device takes one packet per write no matter how we hand them
+      // over, so there is nothing to win over writing them one at a time
+      if (not m_VNetHdr)
+        return NetworkInterface::WritePackets(pkts);
+      size_t num = 0;
+      for (const auto& write : m_Coalescer.Coalesce(pkts))
+      {
+        const int fd = MultiQueue() ? QueueFor(*write.first) : m_fds[0];
+        if (WriteTo(fd, write.hdr, write.data, write.sz))
+          num += write.num;
+      }
+      pkts.clear();
+      return num;
     }
 
     std::string
@@ -452,7 +452,7 @@ namespace llarp::vpn
       void
       Read(HANDLE dev)
       {
-        ReadFile(dev, pkt.buf, sizeof(pkt.buf), nullptr, &hdr);
+        ReadFile(dev, pkt.buf, net::IPPacket::MaxSize, nullptr, &hdr);
       }
     };
 
@@ -0,0 +1,116 @@
+#include <crypto/crypto_libsodium.hpp>
+#include <crypto/verify_cache.hpp>
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+
+namespace
+{
+  struct Signed
+  {
+    PubKey pub;
+    std::vector<byte_t> data;
+    Signature sig;
+
+    VerifyJob
+    Job() const
+    {
+      return VerifyJob{&pub, data.data(), data.size(), &sig};
+    }
+  };
+
+  Signed
+  MakeSigned(Crypto& crypto, size_t size)
+  {
+    SecretKey sk;
+    crypto.identity_keygen(sk);
+    Signed blob{sk.toPublic(), std::vector<byte_t>(size), {}};
+    crypto.randbytes(blob.data.data(), blob.data.size());
+    REQUIRE(crypto.sign(blob.sig, sk, llarp_buffer_t{blob.data}));
+    return blob;
+  }
+}  // namespace
+
+TEST_CASE("VerifyCache remembers good signatures only", "[crypto]")
+{
+  sodium::CryptoLibSodium crypto;
+  CryptoManager manager{&crypto};
+  crypto::VerifyCache cache;
+
+  auto good = MakeSigned(crypto, 300);
+  CHECK(cache.Verify(good.pub, llarp_buffer_t{good.data}, good.sig));
+  CHECK(cache.size() == 1);
+  CHECK(cache.Verify(good.pub, llarp_buffer_t{good.data}, good.sig));
+  CHECK(cache.size() == 1);
+
+  // any change to what was signed misses the cache and fails
+  auto bad = good;
+  bad.data[0] ^= 1;
+  CHECK(not cache.Verify(bad.pub, llarp_buffer_t{bad.data}, bad.sig));
+  bad = good;
+  bad.sig[0] ^= 1;
+  CHECK(not cache.Verify(bad.pub, llarp_buffer_t{bad.data}, bad.sig));
+  bad = MakeSigned(crypto, 300);
+  bad.data = good.data;
+  bad.sig = good.sig;
+  CHECK(not cache.Verify(bad.pub, llarp_buffer_t{bad.data}, bad.sig));
+  CHECK(cache.size() == 1);
+
+  cache.Clear();
+  CHECK(cache.size() == 0);
+}
+
+TEST_CASE("VerifyCache batches agree with one at a time", "[crypto]")
+{
+  sodium::CryptoLibSodium crypto;
+  CryptoManager manager{&crypto};
+  crypto::VerifyCache cache;
+
+  std::vector<Signed> blobs;
+  for (size_t idx = 0; idx < 8; ++idx)
+    blobs.push_back(MakeSigned(crypto, 64 + idx * 100));
+  blobs[3].data[10] ^= 1;
+  // seen before the batch
+  REQUIRE(cache.Verify(blobs[5].pub, llarp_buffer_t{blobs[5].data}, blobs[5].sig));
+
+  std::vector<VerifyJob> jobs;
+  for (const auto& blob : blobs)
+    jobs.push_back(blob.Job());
+  // the same blob twice in one batch
+  jobs.push_back(blobs[1].Job());
+  jobs.push_back(blobs[3].Job());
+
+  CHECK(not cache.VerifyBatch(jobs));
+  for (size_t idx = 0; idx < blobs.size(); ++idx)
+    CHECK(jobs[idx].valid == (idx != 3));
+  CHECK(jobs[8].valid);
+  CHECK(not jobs[9].valid);
+  CHECK(cache.size() == 7);
+
+  jobs.erase(jobs.begin() + 3);
+  jobs.pop_back();
+  CHECK(cache.VerifyBatch(jobs));
+  CHECK(cache.size() == 7);
+}
+
+TEST_CASE("VerifyCache forgets the oldest when full", "[crypto]")
+{
+  sodium::CryptoLibSodium crypto;
+  CryptoManager manager{&crypto};
+  crypto::VerifyCache cache;
+
+  SecretKey sk;
+  crypto.identity_keygen(sk);
+  const PubKey pub = sk.toPublic();
+  for (uint64_t idx = 0; idx <= crypto::VerifyCache::MaxEntries; ++idx)
+  {
+    llarp_buffer_t buf{reinterpret_cast<byte_t*>(&idx), sizeof(idx)};
+    Signature sig;
+    REQUIRE(crypto.sign(sig, sk, buf));
+    REQUIRE(cache.Verify(pub, buf, sig));
+  }
+  CHECK(cache.size() == crypto::VerifyCache::MaxEntries);
+}
@@ -0,0 +1,81 @@
+#include <crypto/crypto_libsodium.hpp>
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+
+TEST_CASE("xchacha20 batch kernels match one at a time", "[crypto]")
+{
+  sodium::CryptoLibSodium crypto;
+
+  // odd sizes so lanes finish at different blocks, and more jobs than any kernel has lanes
+  const auto numJobs = GENERATE(1, 7, 16, 37);
+  std::vector<SharedSecret> keys(numJobs);
+  std::vector<std::vector<byte_t>> plain(numJobs);
+  std::vector<TunnelNonce> nonces(numJobs);
+  for (int idx = 0; idx < numJobs; ++idx)
+  {
+    keys[idx].Randomize();
+    nonces[idx].Randomize();
+    plain[idx].resize((idx * 97) % 1500);
+    crypto.randbytes(plain[idx].data(), plain[idx].size());
+  }
+  auto single = plain;
+  for (int idx = 0; idx < numJobs; ++idx)
+  {
+    const llarp_buffer_t buf{single[idx]};
+    REQUIRE(crypto.xchacha20(buf, keys[idx], nonces[idx]));
+  }
+
+  // every kernel the cpu can run, not just the one xchacha20_batch picks here
+  const auto kernels = crypto::xchacha20_batch_kernels();
+  for (const auto& kernel : kernels)
+  {
+    INFO("kernel " << kernel.name);
+    auto batched = plain;
+    std::vector<XChaCha20Job> jobs;
+    for (int idx = 0; idx < numJobs; ++idx)
+      jobs.push_back(
+          XChaCha20Job{batched[idx].data(), batched[idx].size(), &keys[idx], nonces[idx]});
+    kernel.run(jobs);
+    for (int idx = 0; idx < numJobs; ++idx)
+      REQUIRE(single[idx] == batched[idx]);
+  }
+
+  auto batched = plain;
+  std::vector<XChaCha20Job> jobs;
+  for (int idx = 0; idx < numJobs; ++idx)
+    jobs.push_back(
+        XChaCha20Job{batched[idx].data(), batched[idx].size(), &keys[idx], nonces[idx]});
+  REQUIRE(crypto.xchacha20_batch(jobs));
+  REQUIRE(single == batched);
+}
+
+TEST_CASE("xchacha20 batch layers commute", "[crypto]")
+{
+  sodium::CryptoLibSodium crypto;
+  SharedSecret first, second;
+  first.Randomize();
+  second.Randomize();
+  std::vector<byte_t> plain(1024);
+  crypto.randbytes(plain.data(), plain.size());
+
+  TunnelNonce nonce;
+  nonce.Randomize();
+  for (const auto& kernel : crypto::xchacha20_batch_kernels())
+  {
+    INFO("kernel " << kernel.name);
+    auto data = plain;
+    // two onion layers over the same buffer in one batch, then peel them off one at a time
+    kernel.run(
+        {XChaCha20Job{data.data(), data.size(), &first, nonce},
+         XChaCha20Job{data.data(), data.size(), &second, nonce}});
+    REQUIRE(data != plain);
+    const llarp_buffer_t buf{data};
+    REQUIRE(crypto.xchacha20(buf, second, nonce));
+    REQUIRE(crypto.xchacha20(buf, first, nonce));
+    REQUIRE(data == plain);
+  }
+}
@@ -0,0 +1,182 @@
+#include <catch2/catch.hpp>
+#include <dns/answer_cache.hpp>
+#include <dns/dns.hpp>
+#include <dns/message.hpp>
+#include <net/net_int.hpp>
+
+using llarp::dns::AnswerCache;
+using llarp::dns::Message;
+using llarp::dns::Question;
+
+namespace
+{
+  Message
+  Query(std::string name, uint16_t qtype, uint16_t id)
+  {
+    Message msg{Question{std::move(name), qtype}};
+    msg.hdr_id = id;
+    msg.hdr_fields = llarp::dns::flags_RD;
+    return msg;
+  }
+
+  std::vector<byte_t>
+  Wire(const Message& msg)
+  {
+    const auto buf = msg.ToBuffer();
+    return std::vector<byte_t>(buf.buf.get(), buf.buf.get() + buf.sz);
+  }
+}  // namespace
+
+TEST_CASE("AnswerCache hands back replies with the query's id", "[dns][cache]")
+{
+  AnswerCache cache;
+  const llarp_time_t now = 1000s;
+  auto query = Query("foo.loki.", llarp::dns::qTypeA, 0x1234);
+  CHECK(not cache.Get(query, now));
+
+  auto reply = query;
+  reply.AddINReply(llarp::huint128_t{0x0a000001}, false, 30);
+  const auto wire = Wire(reply);
+  cache.Put(reply, wire, now);
+  REQUIRE(cache.size() == 1);
+
+  auto again = Query("foo.loki.", llarp::dns::qTypeA, 0xbeef);
+  const auto hit = cache.Get(again, now + 1s);
+  REQUIRE(hit);
+  CHECK(not hit->negative);
+  CHECK(not hit->prefetch);
+  REQUIRE(hit->wire.size() == wire.size());
+  CHECK(hit->wire[0] == 0xbe);
+  CHECK(hit->wire[1] == 0xef);
+  CHECK(std::equal(wire.begin() + 2, wire.end(), hit->wire.begin() + 2));
+
+  // keyed on qtype too
+  CHECK(not cache.Get(Query("foo.loki.", llarp::dns::qTypeAAAA, 1), now));
+  CHECK(not cache.Get(Query("bar.loki.", llarp::dns::qTypeA, 1), now));
+
+  // asks for one refresh over the last fifth of the ttl
+  CHECK(not cache.Get(again, now + 23s)->prefetch);
+  CHECK(cache.Get(again, now + 25s)->prefetch);
+  CHECK(not cache.Get(again, now + 26s)->prefetch);
+  CHECK(not cache.Get(again, now + 30s));
+  CHECK(cache.size() == 0);
+
+  // a refreshed answer can be refreshed again
+  cache.Put(reply, wire, now);
+  CHECK(cache.Get(again, now + 25s)->prefetch);
+  cache.Put(reply, wire, now + 25s);
+  CHECK(not cache.Get(again, now + 26s)->prefetch);
+  CHECK(cache.Get(again, now + 50s)->prefetch);
+}
+
+TEST_CASE("AnswerCache bounds how long answers live", "[dns][cache]")
+{
+  AnswerCache cache;
+  const llarp_time_t now = 1000s;
+
+  // the 1s ttls we hand out live for 1s and no longer
+  const auto query = Query("short.loki.", llarp::dns::qTypeA, 1);
+  auto reply = query;
+  reply.AddINReply(llarp::huint128_t{0x0a000001}, false);
+  cache.Put(reply, Wire(reply), now);
+  CHECK(cache.Get(query, now + 999ms));
+  CHECK(not cache.Get(query, now + 1s));
+
+  // nor is a ttl of 0 raised
+  auto zero = query;
+  zero.AddINReply(llarp::huint128_t{0x0a000001}, false, 0);
+  cache.Put(zero, Wire(zero), now);
+  CHECK(not cache.Get(query, now));
+
+  // no records of that type is only remembered briefly
+  auto nodata = Query("nodata.loki.", llarp::dns::qTypeAAAA, 1);
+  nodata.hdr_fields |= llarp::dns::flags_QR;
+  cache.Put(nodata, Wire(nodata), now);
+  REQUIRE(cache.Get(nodata, now));
+  CHECK(cache.Get(nodata, now)->negative);
+  CHECK(not cache.Get(nodata, now + AnswerCache::NoDataLifetime));
+
+  auto nx = Query("nope.loki.", llarp::dns::qTypeA, 2);
+  nx.AddNXReply();
+  cache.Put(nx, Wire(nx), now);
+  const auto hit = cache.Get(nx, now + 1s);
+  REQUIRE(hit);
+  CHECK(hit->negative);
+  CHECK(not cache.Get(nx, now + AnswerCache::NegativeLifetime));
+
+  // servfail is never cached and drops what was there
+  cache.Put(nx, Wire(nx), now);
+  auto fail = Query("nope.loki.", llarp::dns::qTypeA, 3);
+  fail.AddServFail();
+  cache.Put(fail, Wire(fail), now);
+  CHECK(not cache.Get(fail, now));
+
+  // nor are replies with more than the question in them
+  auto odd = Query("odd.loki.", llarp::dns::qTypeA, 4);
+  odd.questions.push_back(odd.questions[0]);
+  CHECK(not AnswerCache::Cacheable(odd));
+}
+
+TEST_CASE("AnswerCache evicts what expires first when full", "[dns][cache]")
+{
+  AnswerCache cache;
+  const llarp_time_t now = 1000s;
+  for (size_t n = 0; n < AnswerCache::MaxEntries; ++n)
+  {
+    auto reply = Query("n" + std::to_string(n) + ".loki.", llarp::dns::qTypeA, 1);
+    reply.AddINReply(llarp::huint128_t{0x0a000001}, false, 10 + n);
+    cache.Put(reply, Wire(reply), now);
+  }
+  REQUIRE(cache.size() == AnswerCache::MaxEntries);
+  const auto extra = Query("extra.loki.", llarp::dns::qTypeA, 1);
+  auto reply = extra;
+  reply.AddINReply(llarp::huint128_t{0x0a000001}, false, 60);
+  cache.Put(reply, Wire(reply), now);
+  CHECK(cache.size() == AnswerCache::MaxEntries);
+  CHECK(cache.Get(extra, now));
+  CHECK(not cache.Get(Query("n0.loki.", llarp::dns::qTypeA, 1), now));
+  CHECK(cache.Get(Query("n1.loki.", llarp::dns::qTypeA, 1), now));
+}
+
+TEST_CASE("AnswerCache skips names answered differently each time", "[dns][cache]")
+{
+  AnswerCache cache;
+  const llarp_time_t now = 1000s;
+  for (const auto& [name, qtype] : std::vector<std::pair<std::string, uint16_t>>{
+           {"random.snode.", llarp::dns::qTypeA},
+           {"random.snode.", llarp::dns::qTypeCNAME},
+           {"localhost.loki.", llarp::dns::qTypeA},
+           {"exit.localhost.loki.", llarp::dns::qTypeTXT},
+           {"1.0.0.10.in-addr.arpa.", llarp::dns::qTypePTR}})
+  {
+    const auto query = Query(name, qtype, 1);
+    CHECK(not AnswerCache::Cacheable(query));
+    auto reply = query;
+    reply.AddINReply(llarp::huint128_t{0x0a000001}, false, 60);
+    cache.Put(reply, Wire(reply), now);
+    CHECK(cache.size() == 0);
+  }
+}
+
+TEST_CASE("AnswerCache forgets answers handing out a remapped address", "[dns][cache]")
+{
+  AnswerCache cache;
+  const llarp_time_t now = 1000s;
+  const auto v4 = Query("v4.loki.", llarp::dns::qTypeA, 1);
+  auto reply4 = v4;
+  reply4.AddINReply(llarp::huint128_t{0xffff0a000001}, false, 60);
+  cache.Put(reply4, Wire(reply4), now);
+  const auto v6 = Query("v6.loki.", llarp::dns::qTypeAAAA, 1);
+  auto reply6 = v6;
+  reply6.AddINReply(llarp::huint128_t{llarp::uint128_t{0xfd00'0000'0000'0000UL, 2}}, true, 60);
+  cache.Put(reply6, Wire(reply6), now);
+  REQUIRE(cache.size() == 2);
+
+  cache.Forget(llarp::huint128_t{0xffff0a000002});
+  CHECK(cache.size() == 2);
+  cache.Forget(llarp::huint128_t{0xffff0a000001});
+  CHECK(not cache.Get(v4, now));
+  CHECK(cache.Get(v6, now));
+  cache.Forget(llarp::huint128_t{llarp::uint128_t{0xfd00'0000'0000'0000UL, 2}});
+  CHECK(cache.size() == 0);
+}
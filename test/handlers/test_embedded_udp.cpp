@@ -0,0 +1,469 @@
+#include <catch2/catch.hpp>
+#include <handlers/embedded_udp.hpp>
+#include <simulation/sim_loop.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using llarp::handlers::EmbeddedUDP;
+using llarp::service::ConvoTag;
+
+namespace
+{
+  using Address_t = llarp::EndpointBase::AddressVariant_t;
+
+  /// an endpoint whose remotes are whatever the test says, sending TrafficV4 back into the
+  /// traffic handler when looped back the way a NullEndpoint hands it inbound
+  struct FakeEndpoint : public llarp::EndpointBase
+  {
+    llarp::EventLoop_ptr loop;
+    std::unordered_map<Address_t, ConvoTag> tags;
+    std::unordered_map<std::string, Address_t> names;
+    /// srv records by host and then service
+    std::unordered_map<std::string, std::vector<llarp::dns::SRVData>> srvs;
+    std::function<bool(ConvoTag, llarp::net::IPPacket)> onTraffic;
+    bool loopback = false;
+    bool pathsWork = true;
+    size_t pathsEnsured = 0;
+    size_t packetsSent = 0;
+    uint8_t nextTag = 0;
+
+    explicit FakeEndpoint(std::shared_ptr<llarp::simulate::Network> net) : loop{net->MakeLoop()}
+    {}
+
+    ConvoTag
+    AddRemote(const Address_t& remote)
+    {
+      ConvoTag tag;
+      tag[0] = ++nextTag;
+      tags[remote] = tag;
+      return tag;
+    }
+
+    void
+    SRVRecordsChanged() override
+    {}
+
+    std::optional<SendStat>
+    GetStatFor(AddressVariant_t) const override
+    {
+      return std::nullopt;
+    }
+
+    std::unordered_set<AddressVariant_t>
+    AllRemoteEndpoints() const override
+    {
+      return {};
+    }
+
+    AddressVariant_t
+    LocalAddress() const override
+    {
+      return llarp::service::Address{};
+    }
+
+    llarp::quic::TunnelManager*
+    GetQUICTunnel() override
+    {
+      return nullptr;
+    }
+
+    std::optional<AddressVariant_t>
+    GetEndpointWithConvoTag(ConvoTag tag) const override
+    {
+      for (const auto& [remote, t] : tags)
+      {
+        if (t == tag)
+          return remote;
+      }
+      return std::nullopt;
+    }
+
+    std::optional<ConvoTag>
+    GetBestConvoTagFor(AddressVariant_t addr) const override
+    {
+      if (auto itr = tags.find(addr); itr != tags.end())
+        return itr->second;
+      return std::nullopt;
+    }
+
+    bool
+    EnsurePathTo(
+        AddressVariant_t addr,
+        std::function<void(std::optional<ConvoTag>)> hook,
+        llarp_time_t) override
+    {
+      ++pathsEnsured;
+      loop->call_later(100ms, [this, addr, hook]() {
+        if (pathsWork)
+          hook(AddRemote(addr));
+        else
+          hook(std::nullopt);
+      });
+      return true;
+    }
+
+    void
+    LookupNameAsync(
+        std::string name, std::function<void(std::optional<AddressVariant_t>)> handler) override
+    {
+      std::optional<AddressVariant_t> found;
+      if (auto itr = names.find(name); itr != names.end())
+        found = itr->second;
+      loop->call_soon([handler, found]() { handler(found); });
+    }
+
+    const llarp::EventLoop_ptr&
+    Loop() override
+    {
+      return loop;
+    }
+
+    bool
+    SendToOrQueue(
+        ConvoTag tag, const llarp_buffer_t& payload, llarp::service::ProtocolType t) override
+    {
+      ++packetsSent;
+      if (not loopback or t != llarp::service::ProtocolType::TrafficV4)
+        return true;
+      llarp::net::IPPacket pkt;
+      if (not pkt.Load(payload))
+        return false;
+      loop->call_soon([this, tag, pkt = std::move(pkt)]() mutable {
+        if (onTraffic)
+          onTraffic(tag, std::move(pkt));
+      });
+      return true;
+    }
+
+    void
+    LookupServiceAsync(
+        std::string name,
+        std::string service,
+        std::function<void(std::vector<llarp::dns::SRVData>)> handler) override
+    {
+      std::vector<llarp::dns::SRVData> found;
+      if (auto itr = srvs.find(name + " " + service); itr != srvs.end())
+        found = itr->second;
+      loop->call_soon([handler, found]() { handler(found); });
+    }
+
+    void
+    MarkAddressOutbound(AddressVariant_t) override
+    {}
+  };
+
+  llarp::service::Address
+  MakeAddress(uint8_t n)
+  {
+    llarp::service::Address addr;
+    addr[0] = n;
+    addr[31] = n;
+    return addr;
+  }
+
+  std::string
+  Payload(const EmbeddedUDP::Datagram& dgram)
+  {
+    const auto offset = size_t{dgram.pkt.Header()->ihl} * 4 + 8;
+    return std::string{
+        reinterpret_cast<const char*>(dgram.pkt.buf) + offset, dgram.pkt.sz - offset};
+  }
+
+  llarp_buffer_t
+  Buffer(std::string_view str)
+  {
+    return llarp_buffer_t{str.data(), str.size()};
+  }
+
+  struct Harness
+  {
+    std::shared_ptr<llarp::simulate::Network> net = std::make_shared<llarp::simulate::Network>();
+    std::shared_ptr<FakeEndpoint> ep = std::make_shared<FakeEndpoint>(net);
+    size_t readable = 0;
+    std::shared_ptr<EmbeddedUDP> udp = std::make_shared<EmbeddedUDP>(ep, [this]() { ++readable; });
+
+    Harness()
+    {
+      ep->onTraffic = [this](auto tag, auto pkt) {
+        return udp->HandleTraffic(tag, std::move(pkt));
+      };
+    }
+
+    std::pair<int, EmbeddedUDP::Socket_ptr>
+    Establish(std::string host, std::string port, std::optional<llarp::SockAddr> local = {})
+    {
+      std::optional<std::pair<int, EmbeddedUDP::Socket_ptr>> result;
+      udp->Establish(
+          host, port, local, [&result](int err, auto sock) { result.emplace(err, sock); });
+      net->RunFor(1s);
+      REQUIRE(result);
+      return *result;
+    }
+  };
+}  // namespace
+
+TEST_CASE("EmbeddedUDP rejects bad sockets and datagrams", "[udp]")
+{
+  Harness h;
+  CHECK(h.udp->Bind(0, "", std::nullopt).first == EINVAL);
+  auto [err, bound] = h.udp->Bind(5000, "", std::nullopt);
+  REQUIRE(err == 0);
+  CHECK(h.udp->Bind(5000, "", std::nullopt).first == EADDRINUSE);
+
+  // a bound socket needs a remote and port for each datagram
+  const Address_t remote = MakeAddress(1);
+  CHECK(bound->Queue(std::nullopt, 1234, Buffer("x")) == EINVAL);
+  CHECK(bound->Queue(remote, 0, Buffer("x")) == EINVAL);
+  const std::string huge(70000, 'x');
+  CHECK(bound->Queue(remote, 1234, Buffer(huge)) == EMSGSIZE);
+  size_t queued = 0;
+  while (bound->Queue(remote, 1234, Buffer("x")) == 0)
+    ++queued;
+  CHECK(queued == EmbeddedUDP::RingSize);
+  CHECK(bound->Queue(remote, 1234, Buffer("x")) == EAGAIN);
+
+  // closing gives the port back
+  h.udp->Close(bound);
+  CHECK(h.udp->Bind(5000, "", std::nullopt).first == 0);
+
+  CHECK(h.Establish("not a lokinet address", "5000").first == EINVAL);
+  CHECK(h.Establish("nobody.loki", "").first == EINVAL);
+  CHECK(h.Establish("nobody.loki", "0").first == EINVAL);
+  CHECK(h.Establish("nobody.loki", "65536").first == EINVAL);
+  CHECK(h.Establish("nobody.loki", "5000").first == EHOSTUNREACH);
+  h.ep->pathsWork = false;
+  CHECK(h.Establish(MakeAddress(2).ToString(), "5000").first == EHOSTUNREACH);
+  CHECK(h.ep->pathsEnsured == 1);
+}
+
+TEST_CASE("EmbeddedUDP flushes once per batch of sends", "[udp]")
+{
+  Harness h;
+  const Address_t remote = MakeAddress(1);
+  h.ep->AddRemote(remote);
+  auto sock = h.udp->Bind(5000, "", std::nullopt).second;
+  REQUIRE(sock);
+
+  REQUIRE(sock->Queue(remote, 1234, Buffer("a")) == 0);
+  CHECK(sock->WantFlush());
+  REQUIRE(sock->Queue(remote, 1234, Buffer("b")) == 0);
+  // already on its way
+  CHECK(not sock->WantFlush());
+  h.udp->Flush(sock);
+  CHECK(h.ep->packetsSent == 2);
+  CHECK(sock->WantFlush());
+
+  // a flush that could not be run leaves the next send to ask again
+  sock->CancelFlush();
+  CHECK(sock->WantFlush());
+}
+
+TEST_CASE("EmbeddedUDP round trips through the endpoint", "[udp]")
+{
+  Harness h;
+  h.ep->loopback = true;
+  const auto addr = MakeAddress(7);
+  h.ep->names["friend.loki"] = addr;
+
+  auto [err, server] = h.udp->Bind(5000, "", std::nullopt);
+  REQUIRE(err == 0);
+  // no convo yet, so it builds a path first
+  auto [err2, client] = h.Establish("friend.loki", "5000");
+  REQUIRE(err2 == 0);
+  CHECK(h.ep->pathsEnsured == 1);
+  REQUIRE(client->remote);
+  CHECK(*client->remote == Address_t{addr});
+  CHECK(client->localPort >= EmbeddedUDP::EphemeralPorts);
+
+  REQUIRE(client->Queue(std::nullopt, 0, Buffer("ping")) == 0);
+  h.udp->Flush(client);
+  h.net->RunFor(1s);
+  CHECK(h.readable == 1);
+  std::vector<EmbeddedUDP::Datagram> got;
+  server->rx.drain([&got](auto& dgram) { got.emplace_back(std::move(dgram)); }, 8);
+  REQUIRE(got.size() == 1);
+  CHECK(got[0].remote == Address_t{addr});
+  CHECK(Payload(got[0]) == "ping");
+  const auto clientPort = client->localPort;
+
+  // the established flow only takes datagrams from the port it talks to
+  REQUIRE(server->Queue(addr, clientPort, Buffer("pong")) == 0);
+  auto other = h.udp->Bind(6000, "", std::nullopt).second;
+  REQUIRE(other->Queue(addr, clientPort, Buffer("stranger")) == 0);
+  h.udp->Flush(server);
+  h.udp->Flush(other);
+  h.net->RunFor(1s);
+  got.clear();
+  client->rx.drain([&got](auto& dgram) { got.emplace_back(std::move(dgram)); }, 8);
+  REQUIRE(got.size() == 1);
+  CHECK(Payload(got[0]) == "pong");
+}
+
+TEST_CASE("EmbeddedUDP keeps datagrams until a path comes up", "[udp]")
+{
+  Harness h;
+  auto sock = h.udp->Bind(5000, "", std::nullopt).second;
+  REQUIRE(sock);
+
+  // nobody to send to yet, so both wait on one path
+  const Address_t remote = MakeAddress(1);
+  REQUIRE(sock->Queue(remote, 1234, Buffer("a")) == 0);
+  h.udp->Flush(sock);
+  REQUIRE(sock->Queue(remote, 1234, Buffer("b")) == 0);
+  h.udp->Flush(sock);
+  CHECK(h.ep->pathsEnsured == 1);
+  CHECK(h.ep->packetsSent == 0);
+  h.net->RunFor(1s);
+  CHECK(h.ep->packetsSent == 2);
+  CHECK(sock->TakeError() == 0);
+
+  // the ones that never get a path are reported once
+  h.ep->pathsWork = false;
+  REQUIRE(sock->Queue(MakeAddress(2), 1234, Buffer("c")) == 0);
+  h.udp->Flush(sock);
+  h.net->RunFor(1s);
+  CHECK(h.ep->pathsEnsured == 2);
+  CHECK(h.ep->packetsSent == 2);
+  CHECK(sock->TakeError() == EHOSTUNREACH);
+  CHECK(sock->TakeError() == 0);
+
+  // a socket closed while waiting sends nothing
+  h.ep->pathsWork = true;
+  REQUIRE(sock->Queue(MakeAddress(3), 1234, Buffer("d")) == 0);
+  h.udp->Flush(sock);
+  h.udp->Close(sock);
+  h.net->RunFor(1s);
+  CHECK(h.ep->packetsSent == 2);
+}
+
+TEST_CASE("EmbeddedUDP finds named ports with srv records", "[udp]")
+{
+  Harness h;
+  const auto addr = MakeAddress(7);
+  const auto other = MakeAddress(8);
+  h.ep->names["friend.loki"] = addr;
+  h.ep->names["other.loki"] = other;
+  h.ep->AddRemote(addr);
+  h.ep->AddRemote(other);
+  h.ep->srvs["friend.loki _game._udp"] = {
+      {"_game._udp", 20, 1, 1000, ""},
+      {"_game._udp", 10, 1, 2000, "."},
+      {"_game._udp", 10, 1, 3000, ""},
+      {"_game._udp", 10, 5, 4000, ""},
+  };
+  h.ep->srvs["friend.loki _voice._udp"] = {{"_voice._udp", 10, 1, 5000, "other.loki"}};
+
+  // lowest priority, then highest weight, and "." means not here
+  auto [err, sock] = h.Establish("friend.loki", "game");
+  REQUIRE(err == 0);
+  CHECK(sock->remotePort == 4000);
+  CHECK(*sock->remote == Address_t{addr});
+
+  // the target can send us somewhere else
+  auto [err2, sock2] = h.Establish("friend.loki", "voice");
+  REQUIRE(err2 == 0);
+  CHECK(sock2->remotePort == 5000);
+  CHECK(*sock2->remote == Address_t{other});
+
+  CHECK(h.Establish("friend.loki", "chat").first == EHOSTUNREACH);
+}
+
+TEST_CASE("EmbeddedUDP relays for a local udp address", "[udp]")
+{
+  Harness h;
+  h.ep->loopback = true;
+  const auto addr = MakeAddress(7);
+  h.ep->names["friend.loki"] = addr;
+  auto appLoop = h.net->MakeLoop();
+
+  SECTION("an established flow takes datagrams on its local address")
+  {
+    auto server = h.udp->Bind(5000, "", std::nullopt).second;
+    REQUIRE(server);
+    const llarp::SockAddr local{"127.0.0.1:7000"};
+    auto [err, client] = h.Establish("friend.loki", "5000", local);
+    REQUIRE(err == 0);
+    // the port is taken now
+    CHECK(h.Establish("friend.loki", "5000", local).first == EADDRINUSE);
+    // and the flow that could not listen there gave back the port it took after the client's
+    auto [bindErr, bound] = h.udp->Bind(client->localPort + 1, "", std::nullopt);
+    CHECK(bindErr == 0);
+    if (bound)
+      h.udp->Close(bound);
+
+    std::vector<std::pair<llarp::SockAddr, std::string>> appGot;
+    auto app = appLoop->make_udp([&appGot](auto&, llarp::SockAddr src, const llarp_buffer_t& buf) {
+      appGot.emplace_back(src, std::string{reinterpret_cast<const char*>(buf.base), buf.sz});
+    });
+    REQUIRE(app->listen(llarp::SockAddr{"127.0.0.1:7100"}));
+    REQUIRE(app->send(local, Buffer("ping")));
+    h.net->RunFor(1s);
+    std::vector<EmbeddedUDP::Datagram> got;
+    server->rx.drain([&got](auto& dgram) { got.emplace_back(std::move(dgram)); }, 8);
+    REQUIRE(got.size() == 1);
+    CHECK(Payload(got[0]) == "ping");
+    // nothing for the app on the socket itself
+    CHECK(client->rx.empty());
+
+    REQUIRE(server->Queue(addr, client->localPort, Buffer("pong")) == 0);
+    h.udp->Flush(server);
+    h.net->RunFor(1s);
+    REQUIRE(appGot.size() == 1);
+    CHECK(appGot[0].first == local);
+    CHECK(appGot[0].second == "pong");
+    CHECK(client->rx.empty());
+
+    // the address is free again once the flow closes
+    h.udp->Close(client);
+    CHECK(h.Establish("friend.loki", "5000", local).first == 0);
+  }
+
+  SECTION("a bound socket relays each remote port from its own local socket")
+  {
+    const llarp::SockAddr local{"127.0.0.1:8000"};
+    auto bound = h.udp->Bind(6000, "", local).second;
+    REQUIRE(bound);
+    std::vector<llarp::SockAddr> seen;
+    auto service = appLoop->make_udp(
+        [&seen](auto& udp, llarp::SockAddr src, const llarp_buffer_t& buf) {
+          seen.push_back(src);
+          const auto reply = "echo:" + std::string{reinterpret_cast<const char*>(buf.base), buf.sz};
+          udp.send(src, Buffer(reply));
+        });
+    REQUIRE(service->listen(local));
+
+    auto a = h.Establish("friend.loki", "6000").second;
+    auto b = h.Establish("friend.loki", "6000").second;
+    REQUIRE(a);
+    REQUIRE(b);
+    REQUIRE(a->Queue(std::nullopt, 0, Buffer("a1")) == 0);
+    REQUIRE(b->Queue(std::nullopt, 0, Buffer("b1")) == 0);
+    h.udp->Flush(a);
+    h.udp->Flush(b);
+    h.net->RunFor(1s);
+    REQUIRE(a->Queue(std::nullopt, 0, Buffer("a2")) == 0);
+    h.udp->Flush(a);
+    h.net->RunFor(1s);
+
+    REQUIRE(seen.size() == 3);
+    CHECK(seen[0] == seen[2]);
+    CHECK(not(seen[0] == seen[1]));
+    CHECK(bound->rx.empty());
+
+    std::vector<std::string> gotA, gotB;
+    a->rx.drain([&gotA](auto& dgram) { gotA.push_back(Payload(dgram)); }, 8);
+    b->rx.drain([&gotB](auto& dgram) { gotB.push_back(Payload(dgram)); }, 8);
+    CHECK(gotA == std::vector<std::string>{"echo:a1", "echo:a2"});
+    CHECK(gotB == std::vector<std::string>{"echo:b1"});
+
+    // a quiet remote gets a new relay next time
+    h.net->RunFor(EmbeddedUDP::RelayTimeout + 1min);
+    REQUIRE(a->Queue(std::nullopt, 0, Buffer("a3")) == 0);
+    h.udp->Flush(a);
+    h.net->RunFor(1s);
+    REQUIRE(seen.size() == 4);
+    CHECK(not(seen[3] == seen[0]));
+  }
+}
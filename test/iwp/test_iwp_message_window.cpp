@@ -0,0 +1,147 @@
+#include <iwp/message_window.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using llarp::iwp::MessageWindow;
+using llarp::iwp::ReplayWindow;
+
+namespace
+{
+  std::vector<uint64_t>
+  IDs(MessageWindow<int>& window)
+  {
+    std::vector<uint64_t> ids;
+    window.ForEach([&ids](uint64_t id, int) { ids.push_back(id); });
+    return ids;
+  }
+}  // namespace
+
+TEST_CASE("MessageWindow holds the messages in flight", "[iwp][message-window]")
+{
+  MessageWindow<int> window{1024};
+  REQUIRE(window.empty());
+  REQUIRE(window.Find(0) == nullptr);
+
+  for (uint64_t id = 100; id < 200; ++id)
+  {
+    const auto [msg, inserted] = window.Emplace(id, int(id) * 2);
+    REQUIRE(inserted);
+    REQUIRE(*msg == int(id) * 2);
+  }
+  REQUIRE(window.size() == 100);
+  // already there
+  const auto [msg, inserted] = window.Emplace(150, 0);
+  CHECK(not inserted);
+  CHECK(*msg == 300);
+
+  window.Erase(100);
+  window.Erase(199);
+  window.Erase(150);
+  CHECK(window.Find(150) == nullptr);
+  CHECK(window.Take(150) == std::nullopt);
+  const auto taken = window.Take(101);
+  REQUIRE(taken);
+  CHECK(*taken == 202);
+  REQUIRE(window.size() == 96);
+
+  const auto ids = IDs(window);
+  REQUIRE(ids.size() == 96);
+  CHECK(ids.front() == 102);
+  CHECK(ids.back() == 198);
+  CHECK(std::is_sorted(ids.begin(), ids.end()));
+
+  for (uint64_t id = 102; id < 199; ++id)
+    window.Erase(id);
+  CHECK(window.empty());
+  // the window starts over wherever the next id is
+  REQUIRE(window.Emplace(5000, 1).second);
+  CHECK(IDs(window) == std::vector<uint64_t>{5000});
+}
+
+TEST_CASE("MessageWindow keeps ids within its span", "[iwp][message-window]")
+{
+  MessageWindow<int> window{64};
+  REQUIRE(window.Emplace(10, 0).second);
+  CHECK(window.Emplace(10 + 63, 0).second);
+  CHECK(window.Emplace(10 + 64, 0).first == nullptr);
+  // the other way round too
+  window.Erase(10 + 63);
+  CHECK(window.Emplace(10 + 63, 0).second);
+  window.Erase(10);
+  CHECK(window.Emplace(10 + 64, 0).second);
+  CHECK(window.Emplace(0, 0).first == nullptr);
+  CHECK(window.Emplace(~uint64_t{0}, 0).first == nullptr);
+}
+
+TEST_CASE("MessageWindow lets whoever takes a message out put more in", "[iwp][message-window]")
+{
+  MessageWindow<std::unique_ptr<uint64_t>> window{4096};
+  for (uint64_t id = 0; id < 8; ++id)
+    window.Emplace(id, std::make_unique<uint64_t>(id));
+
+  uint64_t next = 8;
+  std::vector<uint64_t> removed;
+  window.TakeIf(
+      [](const auto& msg) { return *msg % 2 == 0; },
+      [&](auto& msg) {
+        removed.push_back(*msg);
+        // enough to grow the ring out from under the loop
+        for (int n = 0; n < 100; ++n, ++next)
+          window.Emplace(next, std::make_unique<uint64_t>(next));
+      });
+  CHECK(removed == std::vector<uint64_t>{0, 2, 4, 6});
+  REQUIRE(window.size() == 4 + 400);
+  for (uint64_t id = 0; id < next; ++id)
+  {
+    auto* msg = window.Find(id);
+    if (id < 8 and id % 2 == 0)
+      CHECK(msg == nullptr);
+    else
+    {
+      REQUIRE(msg);
+      CHECK(**msg == id);
+    }
+  }
+}
+
+TEST_CASE("ReplayWindow remembers the ids it was given", "[iwp][replay-window]")
+{
+  ReplayWindow<128> replay;
+  CHECK(not replay.Contains(0));
+  CHECK(not replay.Behind(0));
+  CHECK(replay.Insert(0));
+  CHECK(not replay.Insert(0));
+  CHECK(replay.Contains(0));
+  CHECK(not replay.Contains(1));
+
+  // out of order
+  CHECK(replay.Insert(5));
+  CHECK(replay.Insert(3));
+  CHECK(replay.Contains(3));
+  CHECK(not replay.Contains(4));
+  CHECK(replay.size() == 3);
+
+  // sliding forward forgets what falls off the back
+  CHECK(replay.Insert(130));
+  CHECK(replay.Behind(2));
+  CHECK(replay.Contains(2));
+  CHECK(not replay.Insert(2));
+  CHECK(not replay.Behind(3));
+  CHECK(replay.Contains(3));
+  CHECK(replay.Contains(5));
+  CHECK(not replay.Contains(4));
+  CHECK(replay.Insert(4));
+
+  // and what it jumps over entirely
+  CHECK(replay.Insert(1000));
+  CHECK(replay.size() == 1);
+  CHECK(replay.Behind(130));
+  CHECK(not replay.Contains(999));
+  CHECK(not replay.Contains(1001));
+  CHECK(replay.Insert(1000 - 127));
+  CHECK(not replay.Insert(1000 - 128));
+}
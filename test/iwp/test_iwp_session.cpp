@@ -5,14 +5,18 @@
 
 #include <router_contact.hpp>
 #include <iwp/iwp.hpp>
+#include <iwp/session.hpp>
 #include <util/meta/memfn.hpp>
 #include <messages/link_message_parser.hpp>
 #include <messages/discard.hpp>
 #include <util/time.hpp>
 
 #include <net/net_if.hpp>
+#include <simulation/sim_loop.hpp>
 #include "ev/ev.hpp"
 
+#include <optional>
+
 #undef LOG_TAG
 #define LOG_TAG __FILE__
 
@@ -111,7 +115,7 @@ struct IWPLinkContext
         // pump done handler
         []() {},
         // do work function
-        [l = m_Loop](llarp::Work_t work) { l->call_soon(work); });
+        [l = m_Loop](const void*, llarp::Work_t work) { l->call_soon(work); });
     REQUIRE(link->Configure(
         m_Loop, llarp::net::LoopbackInterfaceName(), AF_INET, *localAddr.getPort()));
 
@@ -310,3 +314,60 @@ TEST_CASE("IWP send messages", "[iwp]")
     });
   });
 }
+
+/// a message whose ack is lost is acked again when it is retransmitted, whether it fit in its
+/// XMIT or needed DATA fragments too
+TEST_CASE("IWP retransmit after a lost ack", "[iwp]")
+{
+  llarp::LogSilencer shutup;
+  auto oldBlockBogons = llarp::RouterContact::BlockBogons;
+  llarp::RouterContact::BlockBogons = false;
+  llarp::sodium::CryptoLibSodium crypto{};
+  llarp::CryptoManager manager{&crypto};
+
+  auto net = std::make_shared<llarp::simulate::Network>();
+  auto alice = std::make_shared<IWPLinkContext>("127.0.0.1:3001", net->MakeLoop());
+  auto bob = std::make_shared<IWPLinkContext>("127.0.0.1:3002", net->MakeLoop());
+  llarp::ILinkSession* session = nullptr;
+  alice->InitLink<false>([&session](auto s) { session = s; });
+  bob->InitLink<true>([](auto) {});
+  REQUIRE(alice->link->Start());
+  REQUIRE(bob->link->Start());
+  alice->Call([alice, rc = bob->rc] { REQUIRE(alice->link->TryEstablishTo(rc)); });
+  net->RunFor(1s);
+  REQUIRE(session != nullptr);
+
+  // drop whatever bob sends alice while we say so, which takes out the ack for the message
+  bool loseAcks = false;
+  net->SetLinkModel([&loseAcks](const llarp::SockAddr&, const llarp::SockAddr& to) {
+    llarp::simulate::LinkModel model;
+    if (loseAcks and to.getPort() == 3001)
+      model.loss = 1.;
+    return model;
+  });
+
+  const auto msgSize = GENERATE(512, 2500);
+  std::vector<byte_t> msgBuff(msgSize);
+  llarp::DiscardMessage msg;
+  llarp_buffer_t buf(msgBuff);
+  llarp::CryptoManager::instance()->randomize(buf);
+  REQUIRE(msg.BEncode(&buf));
+
+  std::optional<llarp::ILinkSession::DeliveryStatus> status;
+  loseAcks = true;
+  alice->Call([session, msgBuff, &status] {
+    REQUIRE(session->SendMessageBuffer(msgBuff, [&status](auto s) { status = s; }));
+  });
+  // long enough for bob to get all of it and ack, not long enough for alice to retransmit
+  net->RunFor(iwp::TXFlushInterval / 2);
+  REQUIRE_FALSE(status);
+
+  loseAcks = false;
+  net->RunFor(iwp::DeliveryTimeout);
+  REQUIRE(status == llarp::ILinkSession::DeliveryStatus::eDeliverySuccess);
+
+  alice->link->Stop();
+  bob->link->Stop();
+  net->RunFor(1s);
+  llarp::RouterContact::BlockBogons = oldBlockBogons;
+}
@@ -0,0 +1,34 @@
+#include <link/packet_pool.hpp>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("PacketPool hands back the packets it was given", "[link][packet-pool]")
+{
+  llarp::PacketPool pool;
+  std::vector<byte_t> datagram(1200, 0x42);
+
+  auto first = pool.Get(llarp_buffer_t{datagram});
+  CHECK(first == datagram);
+  CHECK(pool.Misses() == 1);
+  const auto* bytes = first.data();
+  pool.Put(std::move(first));
+
+  datagram.assign(80, 0x17);
+  auto second = pool.Get(llarp_buffer_t{datagram});
+  CHECK(second == datagram);
+  CHECK(second.data() == bytes);
+  CHECK(pool.Hits() == 1);
+  CHECK(pool.Misses() == 1);
+
+  // nothing pooled, and things too small to pool are not kept
+  auto third = pool.Get(llarp_buffer_t{datagram});
+  CHECK(pool.Misses() == 2);
+  pool.Put(std::vector<byte_t>(10));
+  CHECK(pool.ExtractStatus()["pooled"] == 0);
+  pool.Put(std::move(second));
+  pool.Put(std::move(third));
+
+  const auto status = pool.ExtractStatus();
+  CHECK(status["pooled"] == 2);
+  CHECK(status["hitRate"] == Approx(1.0 / 3));
+}
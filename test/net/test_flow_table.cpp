@@ -0,0 +1,157 @@
+#include <net/flow_table.hpp>
+
+#include <map>
+#include <random>
+
+#include <catch2/catch.hpp>
+
+using llarp::huint128_t;
+using FlowTable = llarp::net::FlowTable<uint64_t>;
+
+namespace
+{
+  huint128_t
+  IP(uint64_t n)
+  {
+    return huint128_t{llarp::uint128_t{0xfd00'0000'0000'0000UL, n}};
+  }
+}  // namespace
+
+TEST_CASE("FlowTable maps ips to remotes both ways", "[flow-table]")
+{
+  FlowTable flows;
+  CHECK(flows.empty());
+  CHECK(flows.FindByIP(IP(1)) == nullptr);
+  CHECK(flows.Oldest() == nullptr);
+
+  flows.Map(IP(1), 100, false, 1s);
+  flows.Map(IP(2), 200, true, 2s);
+  REQUIRE(flows.size() == 2);
+  const auto* flow = flows.FindByIP(IP(2));
+  REQUIRE(flow);
+  CHECK(flow->remote == 200);
+  CHECK(flow->snode);
+  CHECK(flows.FindByRemote(100)->ip == IP(1));
+
+  // remapping an ip forgets the remote it had, and the other way round
+  flows.Map(IP(1), 300, false, 3s);
+  CHECK(flows.FindByRemote(100) == nullptr);
+  CHECK(flows.FindByIP(IP(1))->remote == 300);
+  flows.Map(IP(3), 300, false, 3s);
+  CHECK(flows.FindByIP(IP(1)) == nullptr);
+  CHECK(flows.FindByRemote(300)->ip == IP(3));
+  CHECK(flows.size() == 2);
+
+  CHECK(flows.EraseRemote(200));
+  CHECK(not flows.EraseRemote(200));
+  CHECK(flows.EraseIP(IP(3)));
+  CHECK(flows.empty());
+}
+
+TEST_CASE("FlowTable reclaims the least recently active flow first", "[flow-table]")
+{
+  FlowTable flows;
+  for (uint64_t n = 0; n < 5; ++n)
+    flows.Map(IP(n), n, false, std::chrono::seconds{n});
+  CHECK(flows.Oldest()->ip == IP(0));
+
+  flows.Touch(IP(0), 10s);
+  CHECK(flows.Oldest()->ip == IP(1));
+  CHECK(flows.FindByIP(IP(0))->lastActive == 10s);
+  // activity never goes backwards
+  flows.Touch(IP(0), 5s);
+  CHECK(flows.FindByIP(IP(0))->lastActive == 10s);
+
+  // pinned flows are never reclaimed
+  flows.Pin(IP(1));
+  flows.Touch(IP(1), 20s);
+  CHECK(flows.FindByIP(IP(1))->lastActive == llarp_time_t::max());
+  CHECK(flows.Oldest()->ip == IP(2));
+
+  // reclaiming is remapping the oldest ip
+  flows.Map(flows.Oldest()->ip, 99, false, 30s);
+  CHECK(flows.FindByRemote(2) == nullptr);
+  CHECK(flows.Oldest()->ip == IP(3));
+  flows.EraseIP(IP(3));
+  flows.EraseIP(IP(4));
+  flows.EraseIP(IP(0));
+  CHECK(flows.Oldest()->ip == IP(2));
+  flows.EraseIP(IP(2));
+  // only the pinned one is left
+  CHECK(flows.Oldest() == nullptr);
+  CHECK(flows.size() == 1);
+}
+
+TEST_CASE("FlowTable agrees with maps under churn", "[flow-table]")
+{
+  FlowTable flows;
+  std::map<uint64_t, uint64_t> ipToRemote;
+  std::map<uint64_t, uint64_t> remoteToIP;
+  std::map<uint64_t, llarp_time_t> activity;
+  std::mt19937_64 rng{42};
+  llarp_time_t now = 0s;
+  size_t mismatches = 0;
+
+  for (int step = 0; step < 20000; ++step)
+  {
+    now += 1ms;
+    const uint64_t ip = rng() % 512;
+    const uint64_t remote = rng() % 512;
+    switch (rng() % 4)
+    {
+      case 0:
+      case 1:
+        if (auto itr = ipToRemote.find(ip); itr != ipToRemote.end())
+          remoteToIP.erase(itr->second);
+        if (auto itr = remoteToIP.find(remote); itr != remoteToIP.end())
+        {
+          ipToRemote.erase(itr->second);
+          activity.erase(itr->second);
+        }
+        ipToRemote[ip] = remote;
+        remoteToIP[remote] = ip;
+        activity[ip] = now;
+        flows.Map(IP(ip), remote, false, now);
+        break;
+      case 2:
+        if (activity.count(ip))
+          activity[ip] = now;
+        flows.Touch(IP(ip), now);
+        break;
+      case 3:
+        if (auto itr = ipToRemote.find(ip); itr != ipToRemote.end())
+        {
+          remoteToIP.erase(itr->second);
+          ipToRemote.erase(itr);
+          activity.erase(ip);
+        }
+        flows.EraseIP(IP(ip));
+        break;
+    }
+    if (flows.size() != ipToRemote.size())
+      ++mismatches;
+    if (not activity.empty())
+    {
+      const auto oldest = std::min_element(
+          activity.begin(), activity.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.second < rhs.second;
+          });
+      if (flows.Oldest() == nullptr or flows.Oldest()->ip != IP(oldest->first))
+        ++mismatches;
+    }
+  }
+  CHECK(mismatches == 0);
+  for (uint64_t n = 0; n < 512; ++n)
+  {
+    const auto* byIP = flows.FindByIP(IP(n));
+    const auto itr = ipToRemote.find(n);
+    if (itr == ipToRemote.end())
+      CHECK(byIP == nullptr);
+    else
+    {
+      REQUIRE(byIP);
+      CHECK(byIP->remote == itr->second);
+      CHECK(flows.FindByRemote(itr->second) == byIP);
+    }
+  }
+}
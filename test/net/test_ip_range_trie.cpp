@@ -0,0 +1,150 @@
+#include <net/ip_range_map.hpp>
+#include <net/ip_range_trie.hpp>
+#include <net/traffic_policy.hpp>
+
+#include <random>
+#include <set>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using llarp::huint128_t;
+using llarp::IPRange;
+using llarp::uint128_t;
+using llarp::net::IPRangeTrie;
+
+namespace
+{
+  IPRange
+  RandomRange(std::mt19937_64& rng, const std::vector<IPRange>& near)
+  {
+    // mostly carve ranges out of ones we already have so they nest and share prefixes
+    huint128_t addr{uint128_t{rng(), rng()}};
+    if (not near.empty() and rng() % 4 != 0)
+    {
+      const auto& base = near[rng() % near.size()];
+      addr = (base.addr & base.netmask_bits) | (addr & ~base.netmask_bits);
+    }
+    else if (rng() % 2)
+      addr = huint128_t{uint128_t{0, 0x0000'ffff'0000'0000UL | (rng() & 0xffff'ffffUL)}};
+    return IPRange{addr, llarp::netmask_ipv6_bits(rng() % 129)};
+  }
+
+  huint128_t
+  RandomAddr(std::mt19937_64& rng, const std::vector<IPRange>& ranges)
+  {
+    huint128_t addr{uint128_t{rng(), rng()}};
+    if (rng() % 8 == 0)
+      return addr;
+    const auto& range = ranges[rng() % ranges.size()];
+    return (range.addr & range.netmask_bits) | (addr & ~range.netmask_bits);
+  }
+}  // namespace
+
+TEST_CASE("IPRangeTrie finds the same ranges as checking every one", "[net][trie]")
+{
+  std::mt19937_64 rng{7};
+  std::vector<IPRange> ranges;
+  IPRangeTrie trie;
+  for (uint32_t id = 0; id < 2000; ++id)
+  {
+    ranges.push_back(RandomRange(rng, ranges));
+    trie.Insert(ranges.back(), id);
+  }
+
+  for (size_t n = 0; n < 5000; ++n)
+  {
+    const auto addr = RandomAddr(rng, ranges);
+
+    std::set<uint32_t> expected;
+    int longest = -1;
+    for (uint32_t id = 0; id < ranges.size(); ++id)
+    {
+      if (ranges[id].Contains(addr))
+      {
+        expected.insert(id);
+        longest = std::max<int>(longest, llarp::bits::count_bits(ranges[id].netmask_bits));
+      }
+    }
+
+    std::set<uint32_t> found;
+    int lastLen = -1;
+    bool shortestFirst = true;
+    trie.VisitMatching(addr, [&](auto id) {
+      found.insert(id);
+      const int len = llarp::bits::count_bits(ranges[id].netmask_bits);
+      shortestFirst = shortestFirst and len >= lastLen;
+      lastLen = len;
+    });
+    REQUIRE(found == expected);
+    REQUIRE(shortestFirst);
+    REQUIRE(trie.Contains(addr) == not expected.empty());
+
+    const auto* best = trie.LongestMatch(addr);
+    REQUIRE((best != nullptr) == (longest >= 0));
+    if (best)
+    {
+      for (const auto id : *best)
+        REQUIRE(int(llarp::bits::count_bits(ranges[id].netmask_bits)) == longest);
+    }
+  }
+
+  for (uint32_t id = 0; id < ranges.size(); ++id)
+  {
+    const auto* ids = trie.Exact(ranges[id]);
+    REQUIRE(ids);
+    REQUIRE(std::find(ids->begin(), ids->end(), id) != ids->end());
+  }
+}
+
+TEST_CASE("IPRangeMap lookups survive removal", "[net][trie]")
+{
+  llarp::net::IPRangeMap<int> map;
+  const auto wide = IPRange::FromIPv4(10, 0, 0, 0, 8);
+  const auto narrow = IPRange::FromIPv4(10, 1, 0, 0, 16);
+  const auto other = IPRange::FromIPv4(192, 168, 0, 0, 16);
+  map.Insert(wide, 1);
+  map.Insert(narrow, 2);
+  map.Insert(other, 3);
+
+  const auto addr = llarp::net::ExpandV4(llarp::ipaddr_ipv4_bits(10, 1, 2, 3));
+  REQUIRE(map.FindAllEntries(addr).size() == 2);
+  REQUIRE(map.GetExact(narrow) == 2);
+
+  map.RemoveIf([](const auto& entry) { return entry.second == 1; });
+  const auto found = map.FindAllEntries(addr);
+  REQUIRE(found.size() == 1);
+  REQUIRE(found.begin()->second == 2);
+  REQUIRE_FALSE(map.GetExact(wide));
+  REQUIRE(map.GetExact(other) == 3);
+}
+
+TEST_CASE("CompiledTrafficPolicy agrees with TrafficPolicy", "[net][traffic_policy]")
+{
+  const std::string payload = "lokinet";
+  const llarp_buffer_t data{payload};
+  const auto packet = [&data](uint32_t dst, uint16_t port) {
+    return llarp::net::IPPacket::UDP(
+        llarp::nuint32_t{0x0100000a},
+        llarp::nuint16_t{0x1234},
+        llarp::ToNet(llarp::huint32_t{dst}),
+        llarp::ToNet(llarp::huint16_t{port}),
+        data);
+  };
+
+  llarp::net::TrafficPolicy policy;
+  // everything passes an empty policy
+  REQUIRE(llarp::net::CompiledTrafficPolicy{policy}.AllowsTraffic(packet(0x0a000001, 53)));
+
+  policy.protocols.emplace("udp/53");
+  policy.ranges.insert(IPRange::FromIPv4(10, 0, 0, 0, 8));
+  const llarp::net::CompiledTrafficPolicy compiled{policy};
+
+  for (const auto& [dst, port] : std::vector<std::pair<uint32_t, uint16_t>>{
+           {0x0a000001, 53}, {0x0a000001, 80}, {0x08080808, 53}, {0x08080808, 80}})
+  {
+    const auto pkt = packet(dst, port);
+    REQUIRE(compiled.AllowsTraffic(pkt) == policy.AllowsTraffic(pkt));
+  }
+  REQUIRE_FALSE(compiled.AllowsTraffic(packet(0x08080808, 80)));
+}
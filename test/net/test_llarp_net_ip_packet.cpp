@@ -0,0 +1,63 @@
+#include <net/ip_packet.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::net::IPPacket;
+
+namespace
+{
+  IPPacket
+  MakePacket()
+  {
+    const std::string payload = "lokinet";
+    const llarp_buffer_t data{payload};
+    return IPPacket::UDP(
+        llarp::nuint32_t{0x0100000a},
+        llarp::nuint16_t{0x1234},
+        llarp::nuint32_t{0x0200000a},
+        llarp::nuint16_t{0x3500},
+        data);
+  }
+}  // namespace
+
+TEST_CASE("IPPacket move hands over the pooled buffer", "[ip_packet]")
+{
+  auto pkt = MakePacket();
+  REQUIRE(pkt.sz == 28 + 7);
+  const byte_t* data = pkt.buf;
+
+  const auto allocs = IPPacket::Pool_t::ThreadAllocations();
+  IPPacket moved{std::move(pkt)};
+  IPPacket assigned;
+  assigned = std::move(moved);
+  // only the default constructed packet took a block
+  REQUIRE(IPPacket::Pool_t::ThreadAllocations() == allocs + 1);
+  REQUIRE(assigned.buf == data);
+  REQUIRE(assigned.sz == 28 + 7);
+  REQUIRE(assigned.IsV4());
+  REQUIRE(moved.buf == nullptr);
+  REQUIRE(moved.sz == 0);
+}
+
+TEST_CASE("IPPacket copy is a deep copy", "[ip_packet]")
+{
+  auto pkt = MakePacket();
+  IPPacket copy{pkt};
+  REQUIRE(copy.buf != pkt.buf);
+  REQUIRE(copy.sz == pkt.sz);
+  REQUIRE(std::equal(pkt.buf, pkt.buf + pkt.sz, copy.buf));
+
+  copy.ZeroAddresses();
+  REQUIRE(copy.dstv4() == llarp::huint32_t{0});
+  REQUIRE(pkt.dstv4() == llarp::huint32_t{0x0a000002});
+}
+
+TEST_CASE("IPPacket can be reused after being moved from", "[ip_packet]")
+{
+  auto pkt = MakePacket();
+  IPPacket other{std::move(pkt)};
+  pkt = other;
+  REQUIRE(pkt.buf != nullptr);
+  REQUIRE(pkt.sz == other.sz);
+  REQUIRE(pkt.srcv4() == other.srcv4());
+}
@@ -0,0 +1,277 @@
+#include <net/tcp_coalesce.hpp>
+
+#include <cstring>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using llarp::net::IPPacket;
+using llarp::net::TCPCoalescer;
+using llarp::net::VNetHeader;
+
+namespace
+{
+  constexpr uint8_t ACK = 0x10;
+  constexpr uint8_t PSH = 0x08;
+  constexpr uint8_t SYN = 0x02;
+  /// nop nop and a timestamp, like most bulk tcp traffic carries
+  constexpr size_t OptionsLen = 12;
+
+  struct Flow
+  {
+    bool v6 = false;
+    uint16_t srcPort = 4000;
+    uint32_t seq = 1000;
+    uint16_t id = 77;
+  };
+
+  size_t
+  IPLen(const Flow& flow)
+  {
+    return flow.v6 ? 40 : 20;
+  }
+
+  void
+  PutTCPChecksum(byte_t* ip, size_t ipLen, size_t sz)
+  {
+    const size_t tcpLen = sz - ipLen;
+    byte_t* tcp = ip + ipLen;
+    std::memset(tcp + 16, 0, 2);
+    const uint16_t pseudo = ~llarp::net::ipchksum(
+        ip + (ipLen == 20 ? 12 : 8), ipLen == 20 ? 8 : 32, htons(6) + htons(tcpLen));
+    const uint16_t sum = llarp::net::ipchksum(tcp, tcpLen, pseudo);
+    std::memcpy(tcp + 16, &sum, 2);
+  }
+
+  void
+  PutIPv4Checksum(byte_t* ip)
+  {
+    std::memset(ip + 10, 0, 2);
+    const uint16_t sum = llarp::net::ipchksum(ip, 20);
+    std::memcpy(ip + 10, &sum, 2);
+  }
+
+  /// the next segment of `flow` with a well formed header and checksums
+  IPPacket
+  Segment(Flow& flow, size_t payload, uint8_t flags = ACK)
+  {
+    IPPacket pkt;
+    const size_t ipLen = IPLen(flow);
+    const size_t tcpLen = 20 + OptionsLen;
+    pkt.sz = ipLen + tcpLen + payload;
+    std::memset(pkt.buf, 0, pkt.sz);
+    byte_t* ip = pkt.buf;
+    if (flow.v6)
+    {
+      ip[0] = 0x60;
+      ip[1] = 0x01;
+      ip[2] = 0x23;
+      ip[3] = 0x45;
+      const uint16_t len = htons(tcpLen + payload);
+      std::memcpy(ip + 4, &len, 2);
+      ip[6] = 6;
+      ip[7] = 64;
+      ip[8] = 0xfd;
+      ip[23] = 1;
+      ip[24] = 0xfd;
+      ip[39] = 2;
+    }
+    else
+    {
+      ip[0] = 0x45;
+      const uint16_t len = htons(pkt.sz);
+      const uint16_t id = htons(flow.id++);
+      std::memcpy(ip + 2, &len, 2);
+      std::memcpy(ip + 4, &id, 2);
+      ip[6] = 0x40;  // DF
+      ip[8] = 64;
+      ip[9] = 6;
+      ip[12] = 10;
+      ip[15] = 1;
+      ip[16] = 10;
+      ip[19] = 2;
+      PutIPv4Checksum(ip);
+    }
+
+    byte_t* tcp = ip + ipLen;
+    const uint16_t src = htons(flow.srcPort);
+    const uint16_t dst = htons(443);
+    const uint32_t seq = htonl(flow.seq);
+    const uint32_t ack = htonl(5555);
+    const uint16_t window = htons(512);
+    std::memcpy(tcp, &src, 2);
+    std::memcpy(tcp + 2, &dst, 2);
+    std::memcpy(tcp + 4, &seq, 4);
+    std::memcpy(tcp + 8, &ack, 4);
+    tcp[12] = (tcpLen / 4) << 4;
+    tcp[13] = flags;
+    std::memcpy(tcp + 14, &window, 2);
+    const byte_t options[OptionsLen] = {1, 1, 8, 10, 0, 0, 0, 9, 0, 0, 0, 7};
+    std::memcpy(tcp + 20, options, OptionsLen);
+    for (size_t idx = 0; idx < payload; ++idx)
+      tcp[tcpLen + idx] = flow.seq + idx;
+    PutTCPChecksum(ip, ipLen, pkt.sz);
+    flow.seq += payload;
+    return pkt;
+  }
+
+  using Bytes = std::vector<byte_t>;
+
+  /// cut a write up the way the kernel does for a segmentation offload packet
+  std::vector<Bytes>
+  Resegment(const TCPCoalescer::Write& write)
+  {
+    if (write.hdr.gsoType == VNetHeader::GSONone)
+      return {Bytes{write.data, write.data + write.sz}};
+
+    const size_t ipLen = write.hdr.csumStart;
+    const size_t hdrLen = write.hdr.hdrLen;
+    const byte_t* tcp = write.data + ipLen;
+    uint32_t seq;
+    uint16_t id;
+    std::memcpy(&seq, tcp + 4, 4);
+    std::memcpy(&id, write.data + 4, 2);
+    std::vector<Bytes> segs;
+    for (size_t off = hdrLen; off < write.sz; off += write.hdr.gsoSize)
+    {
+      const size_t payload = std::min<size_t>(write.hdr.gsoSize, write.sz - off);
+      const bool last = off + payload == write.sz;
+      Bytes seg{write.data, write.data + hdrLen};
+      seg.insert(seg.end(), write.data + off, write.data + off + payload);
+      byte_t* ip = seg.data();
+      if (ipLen == 20)
+      {
+        const uint16_t len = htons(seg.size());
+        const uint16_t segID = htons(ntohs(id) + segs.size());
+        std::memcpy(ip + 2, &len, 2);
+        std::memcpy(ip + 4, &segID, 2);
+        PutIPv4Checksum(ip);
+      }
+      else
+      {
+        const uint16_t len = htons(seg.size() - 40);
+        std::memcpy(ip + 4, &len, 2);
+      }
+      const uint32_t segSeq = htonl(ntohl(seq) + (off - hdrLen));
+      std::memcpy(ip + ipLen + 4, &segSeq, 4);
+      if (not last)
+        ip[ipLen + 13] &= ~PSH;
+      PutTCPChecksum(ip, ipLen, seg.size());
+      segs.push_back(std::move(seg));
+    }
+    return segs;
+  }
+
+  /// the packets the kernel would end up with for all of the writes
+  std::vector<Bytes>
+  Resegment(const std::vector<TCPCoalescer::Write>& writes)
+  {
+    std::vector<Bytes> all;
+    for (const auto& write : writes)
+    {
+      auto segs = Resegment(write);
+      REQUIRE(segs.size() == write.num);
+      all.insert(all.end(), segs.begin(), segs.end());
+    }
+    return all;
+  }
+
+  std::vector<Bytes>
+  AsBytes(const std::vector<IPPacket>& pkts)
+  {
+    std::vector<Bytes> all;
+    for (const auto& pkt : pkts)
+      all.emplace_back(pkt.buf, pkt.buf + pkt.sz);
+    return all;
+  }
+}  // namespace
+
+TEST_CASE("TCPCoalescer merges a run of segments", "[net][tcp_coalesce]")
+{
+  Flow flow;
+  flow.v6 = GENERATE(false, true);
+  std::vector<IPPacket> pkts;
+  for (int n = 0; n < 9; ++n)
+    pkts.push_back(Segment(flow, 1200));
+  pkts.push_back(Segment(flow, 300, ACK | PSH));
+
+  TCPCoalescer coalescer;
+  const auto& writes = coalescer.Coalesce(pkts);
+  REQUIRE(writes.size() == 1);
+  const auto& write = writes[0];
+  CHECK(write.num == pkts.size());
+  CHECK(write.first == &pkts[0]);
+  CHECK(write.hdr.gsoType == (flow.v6 ? VNetHeader::GSOTCPv6 : VNetHeader::GSOTCPv4));
+  CHECK(write.hdr.gsoSize == 1200);
+  CHECK(write.hdr.hdrLen == IPLen(flow) + 20 + OptionsLen);
+
+  // finishing the partial checksum gives a valid checksum for the merged packet
+  Bytes merged{write.data, write.data + write.sz};
+  REQUIRE(llarp::net::CompleteChecksum(write.hdr, merged.data(), merged.size()));
+  auto expected = merged;
+  PutTCPChecksum(expected.data(), IPLen(flow), expected.size());
+  CHECK(merged == expected);
+
+  CHECK(Resegment(writes) == AsBytes(pkts));
+}
+
+TEST_CASE("TCPCoalescer only merges segments that continue a run", "[net][tcp_coalesce]")
+{
+  Flow flow;
+  Flow other;
+  other.srcPort = 4001;
+  std::vector<IPPacket> pkts;
+  pkts.push_back(Segment(flow, 0, SYN));
+  pkts.push_back(Segment(flow, 1000));
+  pkts.push_back(Segment(flow, 1000));
+  // another flow in between
+  pkts.push_back(Segment(other, 1000));
+  pkts.push_back(Segment(flow, 1000));
+  pkts.push_back(Segment(flow, 1000));
+  // a gap in the sequence
+  flow.seq += 1000;
+  pkts.push_back(Segment(flow, 1000));
+  // a short segment ends a run
+  pkts.push_back(Segment(flow, 500));
+  pkts.push_back(Segment(flow, 1000));
+  // not tcp at all
+  const std::string payload = "lokinet";
+  pkts.push_back(IPPacket::UDP(
+      llarp::nuint32_t{0x0100000a},
+      llarp::nuint16_t{0x1234},
+      llarp::nuint32_t{0x0200000a},
+      llarp::nuint16_t{0x3500},
+      llarp_buffer_t{payload}));
+  pkts.push_back(Segment(flow, 1000));
+  // a pure ack
+  pkts.push_back(Segment(flow, 0));
+
+  TCPCoalescer coalescer;
+  const auto& writes = coalescer.Coalesce(pkts);
+  std::vector<size_t> nums;
+  for (const auto& write : writes)
+    nums.push_back(write.num);
+  CHECK(nums == std::vector<size_t>{1, 2, 1, 2, 2, 1, 1, 1, 1});
+  CHECK(Resegment(writes) == AsBytes(pkts));
+}
+
+TEST_CASE("TCPCoalescer caps the size of a merged packet", "[net][tcp_coalesce]")
+{
+  Flow flow;
+  std::vector<IPPacket> pkts;
+  for (int n = 0; n < 100; ++n)
+    pkts.push_back(Segment(flow, 1400));
+
+  TCPCoalescer coalescer;
+  const auto& writes = coalescer.Coalesce(pkts);
+  REQUIRE(writes.size() > 1);
+  for (const auto& write : writes)
+  {
+    CHECK(write.num <= TCPCoalescer::MaxSegments);
+    CHECK(write.sz <= TCPCoalescer::MaxSize);
+  }
+  CHECK(Resegment(writes) == AsBytes(pkts));
+
+  // and reuses its buffers on the next batch
+  CHECK(Resegment(coalescer.Coalesce(pkts)) == AsBytes(pkts));
+}
@@ -3,6 +3,9 @@
 
 #include <router_contact.hpp>
 #include <nodedb.hpp>
+#include <dht/kademlia.hpp>
+
+#include <random>
 
 using llarp_nodedb = llarp::NodeDB;
 
@@ -65,3 +68,93 @@ TEST_CASE("FindClosestTo returns properly ordered set", "[nodedb][dht]")
   REQUIRE(c.pubkey == results[0].pubkey);
   REQUIRE(b.pubkey == results[1].pubkey);
 }
+
+TEST_CASE("FindManyClosestTo matches a brute force search", "[nodedb][dht]")
+{
+  llarp_nodedb nodeDB;
+
+  std::mt19937_64 rng{42};
+  std::vector<llarp::RouterID> keys;
+  for (size_t i = 0; i < 500; ++i)
+  {
+    llarp::RouterContact rc;
+    for (auto& b : rc.pubkey)
+      b = rng();
+    // bunch some of them up under a common prefix so the index has to split deep
+    if (i % 4 == 0)
+      rc.pubkey[0] = 0x42;
+    keys.emplace_back(rc.pubkey);
+    nodeDB.Put(rc);
+  }
+  // removed entries must not come back out of the index
+  for (size_t i = 0; i < 50; ++i)
+  {
+    nodeDB.Remove(keys.back());
+    keys.pop_back();
+  }
+  REQUIRE(keys.size() == nodeDB.NumLoaded());
+
+  for (size_t n = 0; n < 20; ++n)
+  {
+    llarp::dht::Key_t location;
+    for (auto& b : location)
+      b = rng();
+    if (n % 2 == 0)
+      location[0] = 0x42;
+
+    const llarp::dht::XorMetric compare{location};
+    std::sort(keys.begin(), keys.end(), [&compare](const auto& a, const auto& b) {
+      return compare(llarp::dht::Key_t{a}, llarp::dht::Key_t{b});
+    });
+
+    const auto results = nodeDB.FindManyClosestTo(location, 8);
+    REQUIRE(results.size() == 8);
+    for (size_t i = 0; i < results.size(); ++i)
+      REQUIRE(results[i].pubkey == keys[i]);
+
+    REQUIRE(nodeDB.FindClosestTo(location).pubkey == keys[0]);
+  }
+}
+
+TEST_CASE("GetRandom only picks loaded routers that pass the filter", "[nodedb]")
+{
+  llarp_nodedb nodeDB;
+
+  std::vector<llarp::RouterID> keys;
+  for (size_t i = 1; i <= 500; ++i)
+  {
+    llarp::RouterContact rc;
+    rc.pubkey.Fill(0);
+    rc.pubkey[0] = i & 0xff;
+    rc.pubkey[1] = i >> 8;
+    keys.emplace_back(rc.pubkey);
+    nodeDB.Put(rc);
+  }
+  // remove every other one, the picks must come from what's left
+  std::unordered_set<llarp::RouterID> removed;
+  for (size_t i = 0; i < keys.size(); i += 2)
+  {
+    nodeDB.Remove(keys[i]);
+    removed.insert(keys[i]);
+  }
+  REQUIRE(nodeDB.NumLoaded() == 250);
+
+  std::unordered_set<llarp::RouterID> seen;
+  for (size_t n = 0; n < 2000; ++n)
+  {
+    const auto maybe = nodeDB.GetRandom([](const auto&) { return true; });
+    REQUIRE(maybe);
+    REQUIRE(removed.count(maybe->pubkey) == 0);
+    seen.insert(maybe->pubkey);
+  }
+  // not a real test of uniformity, just that it isn't stuck on a few of them
+  REQUIRE(seen.size() > 200);
+
+  // a filter that almost nothing passes still finds the one that does
+  const auto only = keys[1];
+  const auto maybe = nodeDB.GetRandom([&only](const auto& rc) { return rc.pubkey == only; });
+  REQUIRE(maybe);
+  REQUIRE(maybe->pubkey == only);
+
+  REQUIRE_FALSE(nodeDB.GetRandom([](const auto&) { return false; }));
+}
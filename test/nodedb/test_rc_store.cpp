@@ -0,0 +1,111 @@
+#include <catch2/catch.hpp>
+
+#include <rc_store.hpp>
+#include <router_contact.hpp>
+#include <util/buffer.hpp>
+#include <test_util.hpp>
+
+#include <fstream>
+#include <map>
+
+using llarp::RCStore;
+using llarp::RouterContact;
+using llarp::RouterID;
+
+namespace
+{
+  RouterContact
+  MakeRC(byte_t key, uint64_t version)
+  {
+    RouterContact rc;
+    rc.pubkey.Fill(key);
+    rc.last_updated = std::chrono::milliseconds{version};
+    return rc;
+  }
+
+  /// what a fresh store on the same file sees, pubkey to last_updated
+  std::map<RouterID, uint64_t>
+  Reload(const fs::path& file)
+  {
+    RCStore store{file};
+    std::vector<byte_t> data;
+    std::map<RouterID, uint64_t> found;
+    for (const auto& record : store.Load(data))
+    {
+      RouterContact rc;
+      llarp_buffer_t buf{data.data() + record.offset, record.size};
+      REQUIRE(rc.BDecode(&buf));
+      REQUIRE(RouterID{rc.pubkey} == record.pubkey);
+      found[record.pubkey] = rc.last_updated.count();
+    }
+    return found;
+  }
+}  // namespace
+
+TEST_CASE("RCStore keeps the newest record for each router", "[nodedb][rcstore]")
+{
+  const fs::path file{llarp::test::randFilename()};
+  llarp::test::FileGuard guard{file};
+
+  RCStore store{file};
+  REQUIRE(store.Append({MakeRC(1, 1), MakeRC(2, 1), MakeRC(3, 1)}));
+  REQUIRE(store.Append({MakeRC(2, 2)}));
+  REQUIRE(store.Erase({RouterID{MakeRC(3, 1).pubkey}}));
+  REQUIRE(store.NumRecords() == 2);
+  REQUIRE(store.DeadBytes() > 0);
+
+  const auto found = Reload(file);
+  REQUIRE(found.size() == 2);
+  REQUIRE(found.at(RouterID{MakeRC(1, 1).pubkey}) == 1);
+  REQUIRE(found.at(RouterID{MakeRC(2, 1).pubkey}) == 2);
+
+  const auto before = fs::file_size(file);
+  REQUIRE(store.Compact());
+  REQUIRE(store.DeadBytes() == 0);
+  REQUIRE(fs::file_size(file) < before);
+  REQUIRE(Reload(file) == found);
+
+  // appends after a compaction land where the index thinks they do
+  REQUIRE(store.Append({MakeRC(4, 1)}));
+  REQUIRE(Reload(file).size() == 3);
+}
+
+TEST_CASE("RCStore drops a record cut short at the end of the file", "[nodedb][rcstore]")
+{
+  const fs::path file{llarp::test::randFilename()};
+  llarp::test::FileGuard guard{file};
+
+  {
+    RCStore store{file};
+    REQUIRE(store.Append({MakeRC(1, 1), MakeRC(2, 1)}));
+  }
+  const auto size = fs::file_size(file);
+  fs::resize_file(file, size - 10);
+
+  REQUIRE(Reload(file).size() == 1);
+
+  // the torn record was truncated away so new records follow the last good one
+  RCStore store{file};
+  std::vector<byte_t> data;
+  REQUIRE(store.Load(data).size() == 1);
+  REQUIRE(store.Append({MakeRC(3, 1)}));
+  REQUIRE(Reload(file).size() == 2);
+}
+
+TEST_CASE("RCStore moves aside a file that is not an rc store", "[nodedb][rcstore]")
+{
+  const fs::path file{llarp::test::randFilename()};
+  fs::path bad{file};
+  bad += ".bad";
+  llarp::test::FileGuard guard{file};
+  llarp::test::FileGuard badGuard{bad};
+
+  {
+    std::ofstream f{file.string(), std::ios::binary};
+    f << "not an rc store";
+  }
+  RCStore store{file};
+  REQUIRE(store.Append({MakeRC(1, 1)}));
+  REQUIRE(fs::exists(bad));
+  REQUIRE(Reload(file).size() == 1);
+}
@@ -0,0 +1,70 @@
+#include <path/traffic_batch.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::path::TrafficBatch;
+
+TEST_CASE("TrafficBatch keeps messages and nonces in order", "[path]")
+{
+  auto batch = TrafficBatch::Acquire();
+  REQUIRE(batch->empty());
+
+  std::vector<std::vector<byte_t>> data;
+  std::vector<llarp::TunnelNonce> nonces;
+  for (size_t idx = 0; idx < TrafficBatch::MaxMessages; ++idx)
+  {
+    REQUIRE_FALSE(batch->full());
+    data.emplace_back(idx * 13 + 1, static_cast<byte_t>(idx));
+    nonces.emplace_back();
+    nonces.back().Randomize();
+    batch->Push(llarp_buffer_t{data.back()}, nonces.back());
+  }
+  REQUIRE(batch->full());
+  REQUIRE(batch->size() == TrafficBatch::MaxMessages);
+
+  size_t idx = 0;
+  for (const auto& msg : *batch)
+  {
+    REQUIRE(msg.nonce == nonces[idx]);
+    REQUIRE(msg.size == data[idx].size());
+    const auto* ptr = batch->Data(msg);
+    REQUIRE(std::equal(ptr, ptr + msg.size, data[idx].begin()));
+    ++idx;
+  }
+}
+
+TEST_CASE("TrafficBatch is recycled empty", "[path]")
+{
+  const TrafficBatch* first;
+  {
+    auto batch = TrafficBatch::Acquire();
+    first = batch.get();
+    llarp::TunnelNonce nonce;
+    const std::vector<byte_t> data(100, 1);
+    batch->Push(llarp_buffer_t{data}, nonce);
+  }
+  auto batch = TrafficBatch::Acquire();
+  REQUIRE(batch.get() == first);
+  REQUIRE(batch->empty());
+}
+
+TEST_CASE("TrafficBatch goes back once its last reference is gone", "[path]")
+{
+  const TrafficBatch* first;
+  TrafficBatch::Ptr_t copy;
+  {
+    auto batch = TrafficBatch::Acquire();
+    first = batch.get();
+    copy = batch;
+  }
+  // still held by the copy, so a new one is another batch
+  auto other = TrafficBatch::Acquire();
+  REQUIRE(other.get() != first);
+  REQUIRE(copy.get() == first);
+
+  auto moved = std::move(copy);
+  REQUIRE(copy == nullptr);
+  moved = nullptr;
+  auto batch = TrafficBatch::Acquire();
+  REQUIRE(batch.get() == first);
+}
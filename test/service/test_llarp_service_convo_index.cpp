@@ -0,0 +1,114 @@
+#include <catch2/catch.hpp>
+#include <service/convo_index.hpp>
+
+using llarp::service::Address;
+using llarp::service::ConvoIndex;
+using llarp::service::ConvoMap;
+using llarp::service::ConvoTag;
+
+namespace
+{
+  Address
+  Remote(uint32_t n)
+  {
+    Address addr;
+    std::copy_n(reinterpret_cast<const byte_t*>(&n), sizeof(n), addr.data());
+    return addr;
+  }
+
+  ConvoTag
+  Tag(uint32_t n)
+  {
+    ConvoTag tag;
+    std::copy_n(reinterpret_cast<const byte_t*>(&n), sizeof(n), tag.data());
+    return tag;
+  }
+
+  void
+  SetRemote(llarp::service::Session& session, uint32_t remote)
+  {
+    const auto key = Remote(remote);
+    session.remote = llarp::service::ServiceInfo{};
+    session.remote.Update(key.data(), key.data());
+  }
+
+  void
+  Open(ConvoMap& sessions, ConvoIndex& index, uint32_t tag, uint32_t remote)
+  {
+    SetRemote(sessions[Tag(tag)], remote);
+    index.Put(Remote(remote), Tag(tag));
+  }
+
+  std::set<ConvoTag>
+  TagsOf(ConvoIndex& index, const ConvoMap& sessions, uint32_t remote)
+  {
+    std::set<ConvoTag> tags;
+    index.ForEach(Remote(remote), sessions, [&tags](const auto& tag, const auto&) {
+      tags.insert(tag);
+    });
+    return tags;
+  }
+}  // namespace
+
+TEST_CASE("ConvoIndex finds the convos with a remote", "[service][convo]")
+{
+  ConvoMap sessions;
+  ConvoIndex index;
+  Open(sessions, index, 1, 100);
+  Open(sessions, index, 2, 100);
+  Open(sessions, index, 3, 200);
+  CHECK(index.size() == 2);
+  CHECK(TagsOf(index, sessions, 100) == std::set<ConvoTag>{Tag(1), Tag(2)});
+  CHECK(TagsOf(index, sessions, 200) == std::set<ConvoTag>{Tag(3)});
+  CHECK(TagsOf(index, sessions, 300).empty());
+
+  // dropped convos are forgotten when next looked at
+  sessions.erase(Tag(2));
+  CHECK(TagsOf(index, sessions, 100) == std::set<ConvoTag>{Tag(1)});
+  sessions.erase(Tag(1));
+  CHECK(TagsOf(index, sessions, 100).empty());
+  CHECK(index.size() == 1);
+
+  // or when pruned
+  sessions.erase(Tag(3));
+  index.Prune(sessions);
+  CHECK(index.size() == 0);
+}
+
+TEST_CASE("ConvoIndex keeps the picked convo until something changes", "[service][convo]")
+{
+  ConvoMap sessions;
+  ConvoIndex index;
+  const llarp_time_t now = 10s;
+  Open(sessions, index, 1, 100);
+  Open(sessions, index, 2, 100);
+  CHECK(not index.Best(Remote(100), sessions, now));
+
+  index.SetBest(Remote(100), Tag(2), now);
+  CHECK(index.Best(Remote(100), sessions, now) == Tag(2));
+  CHECK(index.Best(Remote(100), sessions, now + ConvoIndex::BestLifetime - 1ms) == Tag(2));
+  CHECK(not index.Best(Remote(100), sessions, now + ConvoIndex::BestLifetime));
+
+  index.SetBest(Remote(100), Tag(2), now);
+  index.Invalidate(Remote(100));
+  CHECK(not index.Best(Remote(100), sessions, now));
+
+  index.SetBest(Remote(100), Tag(2), now);
+  index.Invalidate();
+  CHECK(not index.Best(Remote(100), sessions, now));
+
+  // a new convo could be better
+  index.SetBest(Remote(100), Tag(2), now);
+  Open(sessions, index, 3, 100);
+  CHECK(not index.Best(Remote(100), sessions, now));
+
+  // as could any but the one picked if it is gone
+  index.SetBest(Remote(100), Tag(2), now);
+  sessions.erase(Tag(2));
+  CHECK(not index.Best(Remote(100), sessions, now));
+
+  // a tag reused for someone else is not theirs any more
+  index.SetBest(Remote(100), Tag(1), now);
+  SetRemote(sessions[Tag(1)], 200);
+  CHECK(not index.Best(Remote(100), sessions, now));
+}
@@ -0,0 +1,85 @@
+#include <crypto/crypto.hpp>
+#include <crypto/crypto_libsodium.hpp>
+#include <service/identity.hpp>
+#include <service/protocol.hpp>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+
+static service::ProtocolFrame
+MakeFrame()
+{
+  service::ProtocolFrame frame;
+  frame.N.Randomize();
+  frame.T.Randomize();
+  frame.F.Randomize();
+  frame.S = 42;
+  return frame;
+}
+
+static service::ProtocolMessage
+MakeMessage(const service::Identity& ident, const service::ConvoTag& tag)
+{
+  service::ProtocolMessage msg{tag};
+  msg.sender = ident.pub;
+  msg.seqno = 7;
+  const std::string payload = "session mac test payload";
+  msg.PutBuffer(llarp_buffer_t{payload});
+  return msg;
+}
+
+TEST_CASE("ProtocolFrame session mac", "[service]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+
+  service::Identity ident;
+  ident.RegenerateKeys();
+  SharedSecret sessionKey;
+  sessionKey.Randomize();
+
+  auto frame = MakeFrame();
+  const auto msg = MakeMessage(ident, frame.T);
+  REQUIRE(msg.AcceptsSessionMAC());
+
+  SECTION("mac frames verify with the session key and decrypt")
+  {
+    REQUIRE(frame.EncryptAndMAC(msg, sessionKey));
+    REQUIRE(frame.IsSessionMAC());
+    REQUIRE(frame.VerifyMAC(sessionKey));
+
+    service::ProtocolMessage decrypted;
+    REQUIRE(frame.DecryptPayloadInto(sessionKey, decrypted));
+    REQUIRE(decrypted.payload == msg.payload);
+    REQUIRE(decrypted.seqno == msg.seqno);
+  }
+
+  SECTION("mac frames do not verify with another key")
+  {
+    REQUIRE(frame.EncryptAndMAC(msg, sessionKey));
+    SharedSecret otherKey;
+    otherKey.Randomize();
+    REQUIRE_FALSE(frame.VerifyMAC(otherKey));
+  }
+
+  SECTION("tampered mac frames do not verify")
+  {
+    REQUIRE(frame.EncryptAndMAC(msg, sessionKey));
+    frame.S++;
+    REQUIRE_FALSE(frame.VerifyMAC(sessionKey));
+  }
+
+  SECTION("signed frames are not mac frames")
+  {
+    REQUIRE(frame.EncryptAndSign(msg, sessionKey, ident));
+    REQUIRE_FALSE(frame.IsSessionMAC());
+    REQUIRE(frame.Verify(ident.pub));
+  }
+
+  SECTION("old peers do not get mac frames")
+  {
+    service::ProtocolMessage old{frame.T};
+    old.version = 0;
+    REQUIRE_FALSE(old.AcceptsSessionMAC());
+  }
+}
@@ -0,0 +1,75 @@
+#include <catch2/catch.hpp>
+#include <llarp.hpp>
+#include <config/config.hpp>
+#include <router/abstractrouter.hpp>
+#include <simulation/sim_context.hpp>
+#include <util/fs.hpp>
+
+#include <optional>
+
+using llarp::simulate::LinkModel;
+using llarp::simulate::Simulation;
+
+namespace
+{
+  /// a relay reachable at `ip` on the simulated network, keeping its files in `dir`.  relays
+  /// leave bogons out of their rc, so these are public looking addresses.
+  std::shared_ptr<llarp::Config>
+  MakeRelayConfig(const fs::path& dir, const std::string& ip)
+  {
+    fs::remove_all(dir);
+    fs::create_directories(dir / "nodedb");
+    auto conf = std::make_shared<llarp::Config>(dir);
+    conf->Load(std::nullopt, true);
+    conf->router.m_dataDir = dir;
+    conf->router.m_publicAddress = llarp::IpAddress{ip + ":1090"};
+    conf->network.m_enableProfiling = false;
+    conf->network.m_endpointType = "null";
+    conf->links.m_InboundLinks = {{ip, AF_INET, 1090}};
+    conf->api.m_enableRPCServer = false;
+    conf->lokid.whitelistRouters = false;
+    return conf;
+  }
+
+  /// start a seed relay and a relay that bootstraps off it, and give the virtual time it took
+  /// until each had a session with the other
+  std::optional<llarp_time_t>
+  TimeToConnect(uint64_t seed)
+  {
+    const auto dir = fs::temp_directory_path() / "lokinet-test-sim";
+    auto sim = std::make_shared<Simulation>(seed, LinkModel{10ms, 5ms, 0.});
+
+    auto seedConf = MakeRelayConfig(dir / "seed", "1.0.0.1");
+    seedConf->bootstrap.seednode = true;
+    auto seedNode = sim->AddNode("seed", seedConf, true);
+    auto relayConf = MakeRelayConfig(dir / "relay", "1.0.0.2");
+    relayConf->bootstrap.routers.insert(seedNode->router->rc());
+    auto relayNode = sim->AddNode("relay", relayConf, true);
+
+    const llarp::RouterID seedID{seedNode->router->pubkey()};
+    const llarp::RouterID relayID{relayNode->router->pubkey()};
+    const auto start = sim->m_Net->Now();
+    std::optional<llarp_time_t> took;
+    while (not took and sim->m_Net->Now() - start < 30s)
+    {
+      sim->RunFor(10ms);
+      if (seedNode->router->HasSessionTo(relayID) and relayNode->router->HasSessionTo(seedID))
+        took = sim->m_Net->Now() - start;
+    }
+    sim->DelNode("seed");
+    sim->DelNode("relay");
+    sim->RunFor(1s);
+    fs::remove_all(dir);
+    return took;
+  }
+}  // namespace
+
+TEST_CASE("Simulated relays connect the same way every run", "[simulation]")
+{
+  llarp::LogSilencer shutup;
+  const auto first = TimeToConnect(1);
+  REQUIRE(first);
+  // the handshake is a few round trips of 10-15ms each, after the relay's first tick
+  CHECK(*first < 5s);
+  CHECK(TimeToConnect(1) == first);
+}
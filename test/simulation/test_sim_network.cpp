@@ -0,0 +1,170 @@
+#include <catch2/catch.hpp>
+#include <simulation/sim_loop.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using llarp::SockAddr;
+using llarp::simulate::LinkModel;
+using llarp::simulate::Network;
+
+namespace
+{
+  /// a socket and what it got
+  struct Peer
+  {
+    std::shared_ptr<llarp::simulate::VirtualLoop> loop;
+    std::shared_ptr<llarp::UDPHandle> udp;
+    std::vector<std::pair<SockAddr, std::string>> got;
+    std::vector<llarp_time_t> at;
+
+    Peer(const std::shared_ptr<Network>& net, const SockAddr& addr) : loop{net->MakeLoop()}
+    {
+      udp = loop->make_udp([this](auto&, SockAddr src, const llarp_buffer_t& buf) {
+        got.emplace_back(src, std::string{reinterpret_cast<const char*>(buf.base), buf.sz});
+        at.push_back(loop->time_now());
+      });
+      REQUIRE(udp->listen(addr));
+    }
+
+    void
+    Send(const SockAddr& to, std::string_view data)
+    {
+      udp->send(to, llarp_buffer_t{data.data(), data.size()});
+    }
+  };
+
+  size_t
+  CountDelivered(uint64_t seed)
+  {
+    auto net = std::make_shared<Network>(seed, LinkModel{10ms, 5ms, 0.5});
+    Peer a{net, SockAddr{"10.0.0.1:1000"}};
+    Peer b{net, SockAddr{"10.0.0.2:1000"}};
+    for (int n = 0; n < 1000; ++n)
+      a.Send(SockAddr{"10.0.0.2:1000"}, "x");
+    net->RunFor(1s);
+    CHECK(net->stats().lost + net->stats().delivered == 1000);
+    return b.got.size();
+  }
+}  // namespace
+
+TEST_CASE("Virtual loops run timers in virtual time", "[simulation]")
+{
+  auto net = std::make_shared<Network>();
+  auto loop = net->MakeLoop();
+  const auto start = net->Now();
+
+  std::vector<std::pair<int, llarp_time_t>> ran;
+  loop->call_later(5s, [&] { ran.emplace_back(2, loop->time_now()); });
+  loop->call_later(1s, [&] { ran.emplace_back(1, loop->time_now()); });
+  loop->call_soon([&] { ran.emplace_back(0, loop->time_now()); });
+
+  // an hour passes as fast as there is work to do
+  CHECK(net->RunFor(1h) == 3);
+  CHECK(net->Now() == start + 1h);
+  REQUIRE(ran.size() == 3);
+  CHECK(ran[0] == std::make_pair(0, start));
+  CHECK(ran[1] == std::make_pair(1, start + 1s));
+  CHECK(ran[2] == std::make_pair(2, start + 5s));
+
+  // repeating until the owner goes away
+  int ticks = 0;
+  auto owner = std::make_shared<int>(0);
+  loop->call_every(100ms, owner, [&] { ++ticks; });
+  net->RunFor(1s);
+  CHECK(ticks == 10);
+  owner.reset();
+  net->RunFor(1s);
+  CHECK(ticks == 10);
+  CHECK(net->Pending() == 0);
+
+  // nothing runs on a stopped loop
+  loop->call_soon([&] { ++ticks; });
+  loop->stop();
+  net->RunFor(1s);
+  CHECK(ticks == 10);
+}
+
+TEST_CASE("Virtual udp delivers after the link latency", "[simulation]")
+{
+  auto net = std::make_shared<Network>(0, LinkModel{25ms});
+  const SockAddr addrA{"10.0.0.1:1000"}, addrB{"10.0.0.2:1000"};
+  Peer a{net, addrA};
+  Peer b{net, addrB};
+  int pumps = 0;
+  b.loop->set_pump_function([&pumps] { ++pumps; });
+
+  // the address is taken
+  auto other = a.loop->make_udp([](auto&, auto, const auto&) {});
+  CHECK(not other->listen(addrB));
+
+  const auto start = net->Now();
+  a.Send(addrB, "hello");
+  a.Send(addrB, "world");
+  net->RunFor(24ms);
+  CHECK(b.got.empty());
+  net->RunFor(1ms);
+  REQUIRE(b.got.size() == 2);
+  CHECK(b.got[0] == std::make_pair(addrA, std::string{"hello"}));
+  CHECK(b.got[1] == std::make_pair(addrA, std::string{"world"}));
+  CHECK(b.at[0] == start + 25ms);
+  // both arrived in the same round so b was pumped once
+  CHECK(pumps == 1);
+
+  // a socket that sends before listening gets a port of its own
+  auto unbound = a.loop->make_udp([](auto&, auto, const auto&) {});
+  unbound->send(addrB, llarp_buffer_t{std::string_view{"!"}});
+  net->RunFor(1s);
+  REQUIRE(b.got.size() == 3);
+  CHECK(b.got[2].first.getPort() != 0);
+
+  // packets for a socket that closed on the way go nowhere
+  a.Send(addrB, "late");
+  b.udp->close();
+  net->RunFor(1s);
+  CHECK(b.got.size() == 3);
+  CHECK(net->stats().unreachable == 1);
+  CHECK(net->stats().delivered == 3);
+}
+
+TEST_CASE("Virtual udp sends from other threads go out on the network thread", "[simulation]")
+{
+  auto net = std::make_shared<Network>(0, LinkModel{10ms});
+  net->UseAsTimeSource();
+  const SockAddr addrB{"10.0.0.2:1000"};
+  Peer a{net, SockAddr{"10.0.0.1:1000"}};
+  Peer b{net, addrB};
+
+  // the iwp crypto workers send and read the clock while the network runs
+  const auto start = net->Now();
+  std::atomic<bool> clockWentBack{false};
+  std::vector<std::thread> workers;
+  for (int n = 0; n < 4; ++n)
+  {
+    workers.emplace_back([&] {
+      for (int i = 0; i < 100; ++i)
+      {
+        a.Send(addrB, "x");
+        if (llarp::time_now_ms() < start)
+          clockWentBack = true;
+      }
+    });
+  }
+  while (b.got.size() < 400)
+    net->RunFor(10ms);
+  for (auto& worker : workers)
+    worker.join();
+  net->RunFor(1s);
+  CHECK(b.got.size() == 400);
+  CHECK(net->stats().sent == 400);
+  CHECK(not clockWentBack);
+}
+
+TEST_CASE("Virtual networks are deterministic", "[simulation]")
+{
+  const auto delivered = CountDelivered(42);
+  CHECK(delivered > 400);
+  CHECK(delivered < 600);
+  CHECK(CountDelivered(42) == delivered);
+}
@@ -0,0 +1,34 @@
+#include <util/buffer.hpp>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+
+TEST_CASE("SharedBuffer copies share their bytes", "[buffer]")
+{
+  std::vector<byte_t> bytes{1, 2, 3, 4};
+  const auto* raw = bytes.data();
+  const SharedBuffer buf{std::move(bytes)};
+  REQUIRE(buf.data() == raw);
+  REQUIRE(buf.size() == 4);
+
+  const auto copy = buf;
+  REQUIRE(copy.data() == buf.data());
+  REQUIRE(std::vector<byte_t>{copy.begin(), copy.end()} == std::vector<byte_t>{1, 2, 3, 4});
+
+  const SharedBuffer empty;
+  REQUIRE(empty.empty());
+  REQUIRE(empty.begin() == empty.end());
+}
+
+TEST_CASE("SharedBuffer copy_used takes what was written", "[buffer]")
+{
+  std::vector<byte_t> scratch(16);
+  llarp_buffer_t buf{scratch};
+  REQUIRE(buf.write(std::begin("abc"), std::begin("abc") + 3));
+  const auto used = SharedBuffer::copy_used(buf);
+  REQUIRE(used.size() == 3);
+  REQUIRE(used.data() != scratch.data());
+  REQUIRE(std::equal(used.begin(), used.end(), "abc"));
+  REQUIRE(SharedBuffer::copy_from(buf).size() == 16);
+}
@@ -0,0 +1,73 @@
+#include <util/metrics.hpp>
+
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using llarp::metrics::Registry;
+
+TEST_CASE("metrics counters add up over every thread", "[metrics]")
+{
+  auto& registry = Registry::Instance();
+  const auto counter = registry.GetCounter("test_threads_total", "test counter", {{"t", "a"}});
+  const auto before = registry.Value(counter);
+
+  constexpr int Threads = 8;
+  constexpr uint64_t PerThread = 10000;
+  std::vector<std::thread> threads;
+  for (int n = 0; n < Threads; ++n)
+  {
+    threads.emplace_back([&registry] {
+      // the same counter looked up again on another thread
+      const auto mine = registry.GetCounter("test_threads_total", "test counter", {{"t", "a"}});
+      for (uint64_t i = 0; i < PerThread; ++i)
+        mine.Add();
+    });
+  }
+  counter.Add(5);
+  for (auto& thread : threads)
+    thread.join();
+  // the threads are gone, what they counted is not
+  CHECK(registry.Value(counter) == before + Threads * PerThread + 5);
+
+  // other labels are another counter
+  const auto other = registry.GetCounter("test_threads_total", "test counter", {{"t", "b"}});
+  CHECK(registry.Value(other) == 0);
+  // and a default constructed one is a no-op
+  llarp::metrics::Counter{}.Add();
+}
+
+TEST_CASE("metrics are exposed in prometheus format", "[metrics]")
+{
+  auto& registry = Registry::Instance();
+  const auto counter = registry.GetCounter("test_prom_total", "a \"counter\"", {{"op", "x\"y"}});
+  counter.Add(3);
+  const auto histogram =
+      registry.GetHistogram("test_prom_ms", "a histogram", {100, 10, 1000}, {{"path", "p"}});
+  for (const uint64_t value : {1, 10, 11, 500, 5000})
+    histogram.Observe(value);
+
+  // registering a name again as another type gets a no-op
+  const auto clash = registry.GetHistogram("test_prom_total", "clash", {1}, {{"op", "x\"y"}});
+  clash.Observe(1);
+
+  const auto text = registry.Prometheus();
+  const auto has = [&text](const std::string& line) {
+    INFO(line);
+    return text.find(line + "\n") != std::string::npos;
+  };
+  CHECK(has("# HELP test_prom_total a \"counter\""));
+  CHECK(has("# TYPE test_prom_total counter"));
+  CHECK(has("test_prom_total{op=\"x\\\"y\"} 3"));
+  CHECK(has("# TYPE test_prom_ms histogram"));
+  CHECK(has("test_prom_ms_bucket{path=\"p\",le=\"10\"} 2"));
+  CHECK(has("test_prom_ms_bucket{path=\"p\",le=\"100\"} 3"));
+  CHECK(has("test_prom_ms_bucket{path=\"p\",le=\"1000\"} 4"));
+  CHECK(has("test_prom_ms_bucket{path=\"p\",le=\"+Inf\"} 5"));
+  CHECK(has("test_prom_ms_sum{path=\"p\"} 5522"));
+  CHECK(has("test_prom_ms_count{path=\"p\"} 5"));
+  // names come out in order, once each
+  CHECK(text.find("test_prom_ms") < text.find("test_prom_total"));
+  CHECK(text.find("# TYPE test_prom_total") == text.rfind("# TYPE test_prom_total"));
+}
@@ -0,0 +1,101 @@
+#include <util/timer_wheel.hpp>
+
+#include <map>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using llarp::util::TimerWheel;
+
+TEST_CASE("TimerWheel visits entries once their time comes", "[timer-wheel]")
+{
+  const llarp_time_t start = llarp::time_now_ms();
+  TimerWheel<int> wheel;
+  std::vector<int> visited;
+  const auto visit = [&visited](int v) { visited.push_back(v); };
+
+  // scheduled before the wheel knows the time
+  wheel.Schedule(start + 10ms, 1);
+  REQUIRE(wheel.Advance(start, visit) == 0);
+  wheel.Schedule(start + 5ms, 2);
+  wheel.Schedule(start - 5ms, 3);
+  REQUIRE(wheel.size() == 3);
+
+  // already due
+  REQUIRE(wheel.Advance(start, visit) == 1);
+  CHECK(visited == std::vector<int>{3});
+  REQUIRE(wheel.Advance(start + 4ms, visit) == 0);
+  REQUIRE(wheel.Advance(start + 5ms, visit) == 1);
+  CHECK(visited.back() == 2);
+  REQUIRE(wheel.Advance(start + 9ms, visit) == 0);
+  // skipping past it is fine too
+  REQUIRE(wheel.Advance(start + 1s, visit) == 1);
+  CHECK(visited.back() == 1);
+  CHECK(wheel.empty());
+}
+
+TEST_CASE("TimerWheel entries scheduled while visiting", "[timer-wheel]")
+{
+  const llarp_time_t start = 10s;
+  TimerWheel<int> wheel;
+  wheel.Advance(start, [](int) {});
+  wheel.Schedule(start + 1ms, 0);
+  int visits = 0;
+  const auto reschedule = [&](int) {
+    ++visits;
+    // one due right away and one later on
+    wheel.Schedule(start, 1);
+    wheel.Schedule(start + 100ms, 2);
+  };
+  REQUIRE(wheel.Advance(start + 1ms, reschedule) == 1);
+  CHECK(visits == 1);
+  CHECK(wheel.size() == 2);
+  REQUIRE(wheel.Advance(start + 1ms, [](int v) { CHECK(v == 1); }) == 1);
+  REQUIRE(wheel.Advance(start + 100ms, [](int v) { CHECK(v == 2); }) == 1);
+  CHECK(wheel.empty());
+}
+
+TEST_CASE("TimerWheel never visits early or late", "[timer-wheel]")
+{
+  const llarp_time_t start = 1000s;
+  const auto resolution = GENERATE(1ms, 10ms);
+  TimerWheel<size_t> wheel{resolution};
+  wheel.Advance(start, [](size_t) {});
+
+  std::mt19937_64 rng(resolution.count());
+  // deadlines on every level of the wheel and some beyond all of them
+  std::vector<llarp_time_t> deadlines;
+  for (size_t idx = 0; idx < 5000; ++idx)
+  {
+    const uint64_t span = uint64_t{1} << (rng() % 27);
+    deadlines.push_back(start + llarp_time_t{rng() % span});
+  }
+  for (size_t idx = 0; idx < deadlines.size(); ++idx)
+    wheel.Schedule(deadlines[idx], idx);
+
+  std::vector<size_t> visits(deadlines.size());
+  llarp_time_t now = start;
+  while (not wheel.empty())
+  {
+    // uneven steps, some of them longer than a whole level
+    now += llarp_time_t{1 + rng() % ((rng() % 8) ? 50 : 500'000)};
+    size_t early = 0;
+    wheel.Advance(now, [&](size_t idx) {
+      ++visits[idx];
+      if (deadlines[idx] > now)
+        ++early;
+    });
+    REQUIRE(early == 0);
+    // and late by less than the resolution
+    size_t overdue = 0;
+    for (size_t idx = 0; idx < deadlines.size(); ++idx)
+    {
+      if (deadlines[idx] + resolution <= now and visits[idx] == 0)
+        ++overdue;
+    }
+    REQUIRE(overdue == 0);
+  }
+  for (const auto count : visits)
+    CHECK(count == 1);
+}
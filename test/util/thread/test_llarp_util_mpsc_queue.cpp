@@ -0,0 +1,118 @@
+#include <util/thread/job.hpp>
+#include <util/thread/mpsc_queue.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using llarp::thread::Job;
+using llarp::thread::MPSCQueue;
+
+TEST_CASE("Job stores small callables inline and big ones on the heap", "[job]")
+{
+  int calls = 0;
+  auto small = [&calls] { ++calls; };
+  auto big = [&calls, pad = std::array<char, 128>{}] { calls += 1 + pad[0]; };
+  STATIC_REQUIRE(Job::IsInline<decltype(small)>);
+  STATIC_REQUIRE(Job::IsInline<std::function<void()>>);
+  STATIC_REQUIRE_FALSE(Job::IsInline<decltype(big)>);
+
+  Job a{small};
+  Job b{big};
+  Job c{std::function<void()>{small}};
+  a();
+  b();
+  c();
+  REQUIRE(calls == 3);
+
+  // moving leaves the source empty and the callable working in its new home
+  Job moved{std::move(b)};
+  REQUIRE_FALSE(b);
+  moved();
+  a = std::move(moved);
+  a();
+  REQUIRE(calls == 5);
+}
+
+TEST_CASE("Job destroys what it holds exactly once", "[job]")
+{
+  auto counter = std::make_shared<int>(0);
+  {
+    Job a{[counter] { ++*counter; }};
+    Job b{[counter, pad = std::array<char, 128>{}] { ++*counter; }};
+    REQUIRE(counter.use_count() == 3);
+    Job c{std::move(a)};
+    Job d{std::move(b)};
+    REQUIRE(counter.use_count() == 3);
+    c();
+    d();
+  }
+  REQUIRE(counter.use_count() == 1);
+  REQUIRE(*counter == 2);
+}
+
+TEST_CASE("MPSCQueue is fifo and fails pushes when full", "[queue][mpsc]")
+{
+  MPSCQueue<int> queue{5};
+  REQUIRE(queue.capacity() == 8);
+  REQUIRE(queue.empty());
+
+  for (int i = 0; i < 8; ++i)
+    REQUIRE(queue.tryPushBack(i));
+  REQUIRE_FALSE(queue.tryPushBack(8));
+
+  REQUIRE(queue.tryPopFront() == 0);
+  REQUIRE(queue.tryPushBack(8));
+
+  std::vector<int> popped;
+  REQUIRE(queue.drain([&](int& i) { popped.push_back(i); }, 3) == 3);
+  REQUIRE(popped == std::vector<int>{1, 2, 3});
+  REQUIRE(queue.drain([&](int& i) { popped.push_back(i); }, 100) == 5);
+  REQUIRE(popped == std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8});
+  REQUIRE(queue.empty());
+  REQUIRE_FALSE(queue.tryPopFront());
+}
+
+TEST_CASE("MPSCQueue delivers everything from many producers in per producer order", "[queue][mpsc]")
+{
+  constexpr size_t NumProducers = 8;
+  constexpr size_t PerProducer = 10000;
+  MPSCQueue<std::pair<size_t, size_t>> queue{64};
+
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < NumProducers; ++p)
+  {
+    producers.emplace_back([&queue, p] {
+      for (size_t n = 0; n < PerProducer; ++n)
+      {
+        while (not queue.tryPushBack(p, n))
+          std::this_thread::yield();
+      }
+    });
+  }
+
+  std::array<size_t, NumProducers> next{};
+  size_t received = 0;
+  bool ordered = true;
+  while (received < NumProducers * PerProducer)
+  {
+    const auto num = queue.drain(
+        [&](auto& item) {
+          ordered = ordered and item.second == next[item.first];
+          ++next[item.first];
+        },
+        queue.capacity());
+    if (num == 0)
+      std::this_thread::yield();
+    received += num;
+  }
+  for (auto& producer : producers)
+    producer.join();
+
+  REQUIRE(ordered);
+  REQUIRE(queue.empty());
+}
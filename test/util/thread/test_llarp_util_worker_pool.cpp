@@ -0,0 +1,111 @@
+#include <util/thread/worker_pool.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp::thread;
+
+TEST_CASE("WorkerPool runs every job", "[worker_pool]")
+{
+  WorkerPool pool{4};
+  REQUIRE(pool.NumThreads() == 4);
+  pool.Start();
+  REQUIRE(pool.IsRunning());
+
+  std::atomic<size_t> ran{0};
+  constexpr size_t numJobs = 10000;
+  for (size_t idx = 0; idx < numJobs; ++idx)
+    pool.QueueJob([&ran] { ++ran; });
+
+  pool.Stop();
+  REQUIRE_FALSE(pool.IsRunning());
+  REQUIRE(ran == numJobs);
+}
+
+TEST_CASE("WorkerPool keeps per owner ordering", "[worker_pool]")
+{
+  WorkerPool pool{4};
+  pool.Start();
+
+  constexpr size_t numOwners = 16;
+  constexpr size_t jobsPerOwner = 2000;
+  std::array<int, numOwners> owners{};
+  std::array<std::vector<size_t>, numOwners> seen;
+  std::mutex mutex;
+  std::atomic<size_t> unordered{0};
+
+  for (size_t n = 0; n < jobsPerOwner; ++n)
+  {
+    for (size_t owner = 0; owner < numOwners; ++owner)
+    {
+      pool.QueueOrderedJob(&owners[owner], [&, owner, n] {
+        std::lock_guard lock{mutex};
+        seen[owner].push_back(n);
+      });
+      // interleave stealable work so the workers are busy stealing from each other
+      pool.QueueJob([&unordered] { ++unordered; });
+    }
+  }
+  pool.Stop();
+
+  REQUIRE(unordered == numOwners * jobsPerOwner);
+  for (const auto& jobs : seen)
+  {
+    REQUIRE(jobs.size() == jobsPerOwner);
+    for (size_t n = 0; n < jobsPerOwner; ++n)
+      REQUIRE(jobs[n] == n);
+  }
+}
+
+TEST_CASE("WorkerPool jobs can queue more jobs", "[worker_pool]")
+{
+  WorkerPool pool{2};
+  pool.Start();
+
+  std::atomic<size_t> ran{0};
+  for (size_t idx = 0; idx < 100; ++idx)
+  {
+    pool.QueueJob([&] {
+      ++ran;
+      pool.QueueOrderedJob(&pool, [&ran] { ++ran; });
+    });
+  }
+  pool.Stop();
+  REQUIRE(ran == 200);
+}
+
+TEST_CASE("WorkerPool runs jobs queued while it stops", "[worker_pool]")
+{
+  WorkerPool pool{4};
+  pool.Start();
+
+  // jobs that keep queueing more from a thread outside the pool while Stop drains them
+  std::atomic<size_t> ran{0};
+  std::function<void(size_t)> requeue = [&](size_t depth) {
+    // slow enough that most of these are still going when Stop is called
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    ++ran;
+    if (depth == 0)
+      return;
+    std::thread{[&, depth] {
+      pool.QueueJob([&, depth] { requeue(depth - 1); });
+      pool.QueueOrderedJob(&pool, [&ran] { ++ran; });
+    }}.join();
+  };
+  for (size_t idx = 0; idx < 50; ++idx)
+    pool.QueueJob([&] { requeue(5); });
+  pool.Stop();
+  REQUIRE(ran == 50 * (6 + 5));
+
+  // and after it stopped they run right away
+  pool.QueueJob([&ran] { ++ran; });
+  pool.QueueOrderedJob(&pool, [&ran] { ++ran; });
+  REQUIRE(ran == 50 * (6 + 5) + 2);
+}